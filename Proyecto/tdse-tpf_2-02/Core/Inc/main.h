@@ -39,6 +39,8 @@ extern "C" {
 extern I2C_HandleTypeDef hi2c1;
 extern I2C_HandleTypeDef hi2c2;
 extern TIM_HandleTypeDef htim1;
+extern TIM_HandleTypeDef htim2;
+extern DMA_HandleTypeDef hdma_tim1_up;
 extern ADC_HandleTypeDef hadc1;
 /* USER CODE END ET */
 
@@ -66,6 +68,8 @@ void Error_Handler(void);
 #define LED2_GPIO_Port GPIOC
 #define BTN_Pin GPIO_PIN_0
 #define BTN_GPIO_Port GPIOC
+#define DOOR_Pin GPIO_PIN_2
+#define DOOR_GPIO_Port GPIOC
 #define BUZ_Pin GPIO_PIN_3
 #define BUZ_GPIO_Port GPIOC
 #define R1_Pin GPIO_PIN_5
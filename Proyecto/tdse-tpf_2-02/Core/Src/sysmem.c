@@ -23,6 +23,7 @@
 /* Includes */
 #include <errno.h>
 #include <stdint.h>
+#include "main.h"
 
 /**
  * Pointer to the current high watermark of the heap usage
@@ -55,10 +56,19 @@ void *_sbrk(ptrdiff_t incr)
   extern uint8_t _end; /* Symbol defined in the linker script */
   extern uint8_t _estack; /* Symbol defined in the linker script */
   extern uint32_t _Min_Stack_Size; /* Symbol defined in the linker script */
+  extern uint8_t _No_Heap; /* Symbol defined in the linker script */
   const uint32_t stack_limit = (uint32_t)&_estack - (uint32_t)&_Min_Stack_Size;
   const uint8_t *max_heap = (uint8_t *)stack_limit;
   uint8_t *prev_heap_end;
 
+  /* No-heap build: an allocation is a bug, stop here for the debugger */
+  if (1 == (uint32_t)&_No_Heap)
+  {
+    errno = ENOMEM;
+    Error_Handler();
+    return (void *)-1;
+  }
+
   /* Initialize heap end at first call */
   if (NULL == __sbrk_heap_end)
   {
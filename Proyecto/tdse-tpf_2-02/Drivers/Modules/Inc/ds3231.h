@@ -13,6 +13,9 @@
 #define DS3231_MONTH    0x05
 #define DS3231_YEAR     0x06
 
+extern uint32_t rtc_stale_reads;     // Reads answered while the last refresh failed
+
+void DS3231_Update(void);
 void DS3231_Set_Date_Time(uint8_t dy, uint8_t mth, uint8_t yr, uint8_t dw, uint8_t hr, uint8_t mn, uint8_t sc);
 void DS3231_Get_Date(uint8_t *day, uint8_t *mth, uint8_t *year, uint8_t *dow);
 void DS3231_Get_Time(uint8_t *hr, uint8_t *min, uint8_t *sec);
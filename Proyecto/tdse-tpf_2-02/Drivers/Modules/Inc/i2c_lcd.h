@@ -2,6 +2,7 @@
 #define I2C_LCD_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /**
  * @brief Includes the HAL driver present in the project
@@ -14,12 +15,25 @@
 	#include "stm32g4xx_hal.h"
 #endif
 
+/**
+ * @brief 20x4 display. Positions are kept in DDRAM order: rows 0, 2, 1, 3
+ */
+#define LCD_COLS            20
+#define LCD_ROWS            4
+#define LCD_SIZE            (LCD_COLS * LCD_ROWS)
+
 /**
  * @brief Structure to hold LCD instance information
  */
 typedef struct {
     I2C_HandleTypeDef *hi2c;     // I2C handler for communication
     uint8_t address;            // I2C address of the LCD
+    char frame[LCD_SIZE];       // What lcd_puts() and lcd_clear() left, to be sent
+    char shown[LCD_SIZE];       // What the display shows, '\0': not known
+    uint8_t cursor;             // Next position lcd_puts() writes to
+    void (*p_shown)(void);      // Optional: the display shows the whole frame (I2C interrupt)
+    uint8_t flushes;            // Flushes put on the bus (task) ...
+    volatile uint8_t flushed;   // ... and the ones over (I2C interrupt)
 } I2C_LCD_HandleTypeDef;
 
 /**
@@ -28,29 +42,39 @@ typedef struct {
  */
 void lcd_init(I2C_LCD_HandleTypeDef *lcd);
 
+/**
+ * @brief Runs one step of the LCD power-on sequence without blocking.
+ * @param lcd: Pointer to the LCD handle
+ * @param step: Step number, from 0
+ * @retval Milliseconds to wait before the next step, -1 when done
+ */
+int lcd_init_step(I2C_LCD_HandleTypeDef *lcd, uint8_t step);
+
 /**
  * @brief Sends a command to the LCD.
  * @param lcd: Pointer to the LCD handle
  * @param cmd: Command byte to send
+ * @retval true if the bus queue took it
  */
-void lcd_send_cmd(I2C_LCD_HandleTypeDef *lcd, char cmd);
+bool lcd_send_cmd(I2C_LCD_HandleTypeDef *lcd, char cmd);
 
 /**
  * @brief Sends data (character) to the LCD.
  * @param lcd: Pointer to the LCD handle
  * @param data: Data byte to send
+ * @retval true if the bus queue took it
  */
-void lcd_send_data(I2C_LCD_HandleTypeDef *lcd, char data);
+bool lcd_send_data(I2C_LCD_HandleTypeDef *lcd, char data);
 
 /**
- * @brief Sends a single character to the LCD.
+ * @brief Writes a single character at the cursor (sent by lcd_flush()).
  * @param lcd: Pointer to the LCD handle
  * @param ch: Character to send
  */
 void lcd_putchar(I2C_LCD_HandleTypeDef *lcd, char ch);
 
 /**
- * @brief Sends a string to the LCD.
+ * @brief Writes a string at the cursor (sent by lcd_flush()).
  * @param lcd: Pointer to the LCD handle
  * @param str: Null-terminated string to send
  */
@@ -70,4 +94,12 @@ void lcd_pos(I2C_LCD_HandleTypeDef *lcd, int row, int col);
  */
 void lcd_clear(I2C_LCD_HandleTypeDef *lcd);
 
+/**
+ * @brief Sends the positions that changed, while the tick budget lasts. Once
+ *        all of them are on the bus, p_shown runs when the transfer is over.
+ * @param lcd: Pointer to the LCD handle
+ * @retval Positions still to send
+ */
+int lcd_flush(I2C_LCD_HandleTypeDef *lcd);
+
 #endif /* I2C_LCD_H */
@@ -25,6 +25,13 @@
 #define MI_OK               0
 #define MI_NOTAGERR         1
 #define MI_ERR              2
+#define MI_BUSY             3                  // MFRC522_ToCardPoll(): no answer yet
+
+// MFRC522_IsCardPoll()
+#define MFRC522_CARD_NONE   0
+#define MFRC522_CARD_FOUND  1
+#define MFRC522_CARD_BUSY   2
+#define MFRC522_POLL_MAX    25                 // Calls (ticks) before giving up, the timer is 15 mS
 
 //------------------MFRC522 Register---------------
 #define     RESERVED00          0x00
@@ -104,13 +111,18 @@ void MFRC522_Reset(void);
 void MFRC522_AntennaOn(void);
 void MFRC522_AntennaOff(void);
 void MFRC522_Init(void);
+void MFRC522_Start(void);
+void MFRC522_Config(void);
 void MFRC522_Halt(void);
 void MFRC522_CRC(uint8_t *dataIn, uint8_t length, uint8_t *dataOut);
 uint8_t MFRC522_ToCard(uint8_t cmd, uint8_t *dat, uint8_t len, uint8_t *back_dat, unsigned *back_len);
+void MFRC522_ToCardStart(uint8_t cmd, uint8_t *dat, uint8_t len);
+uint8_t MFRC522_ToCardPoll(uint8_t cmd, uint8_t *back_dat, unsigned *back_len);
 uint8_t MFRC522_Request(uint8_t reqMode, uint8_t *TagType);
 uint8_t MFRC522_SelectTag(uint8_t *serNum);
 uint8_t MFRC522_AntiColl(uint8_t *serNum);
 uint8_t MFRC522_IsCard(uint8_t *TagType);
+uint8_t MFRC522_IsCardPoll(uint8_t *TagType);
 uint8_t MFRC522_ReadCardSerial(uint8_t *str);
 uint8_t MFRC522_Compare_UID(uint8_t *l, uint8_t *u);
 
@@ -1,7 +1,44 @@
+#include <string.h>
 #include "ds3231.h"
+#include "i2c_bus.h"
+
+#define DS3231_TIMEOUT  5
+#define DS3231_REFRESH_MS  1000ul  // The registers count seconds
 
 uint8_t data_tx[8];
-uint8_t data_rx[2];
+uint8_t data_rx[7];
+
+/* Last good registers, refreshed by DS3231_Update(): reads never wait on the bus */
+uint8_t date_last[4] = {0x00, 0x01, 0x01, 0x00};
+uint8_t time_last[3];
+uint32_t rtc_stale_reads;
+
+static volatile bool rtc_in_flight;
+static volatile bool rtc_stale = true;
+static uint32_t rtc_refresh_tick = (uint32_t)(0 - DS3231_REFRESH_MS);	// First refresh on the first tick
+
+/* Burst read from reg on, through the shared bus queue. Spins: before the scheduler only */
+static HAL_StatusTypeDef DS3231_Read_Burst(uint8_t reg, uint8_t *p_data, uint16_t size)
+{
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_HIGH, DS3231_ADDRESS, reg, I2C_MEMADD_SIZE_8BIT, size, p_data, NULL, NULL};
+
+	return i2c_bus_sync(I2C_BUS_2, &xfer, DS3231_TIMEOUT);
+}
+
+/* I2C interrupt: seconds to year in one burst */
+static void DS3231_Refresh_Done(HAL_StatusTypeDef status, void *p_arg)
+{
+	(void)p_arg;
+
+	if (HAL_OK == status)
+	{
+		memcpy(time_last, &data_rx[DS3231_SEC], 3);
+		memcpy(date_last, &data_rx[DS3231_DAY], 4);
+	}
+
+	rtc_stale = (HAL_OK != status);
+	rtc_in_flight = false;
+}
 
 char dw[7][11] = {"Domingo","Lunes","Martes","Miercoles","Jueves","Viernes","Sabado"};
 
@@ -17,22 +54,52 @@ void DS3231_Set_Date_Time(uint8_t dy, uint8_t mth, uint8_t yr, uint8_t dw, uint8
 	data_tx[5] = DS3231_Bin_Bcd(dy);
 	data_tx[6] = DS3231_Bin_Bcd(mth);
 	data_tx[7] = DS3231_Bin_Bcd(yr);
-	HAL_I2C_Master_Transmit(&hi2c2, (uint16_t)DS3231_ADDRESS, data_tx, 8, 100);
+
+	/* Copied by the queue; the next refresh reads it back */
+	i2c_bus_write(I2C_BUS_2, DS3231_ADDRESS, data_tx, sizeof(data_tx));
+}
+
+/* Every system tick: queues a refresh of the cached time once a second */
+void DS3231_Update(void)
+{
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_NORMAL, DS3231_ADDRESS, DS3231_SEC, I2C_MEMADD_SIZE_8BIT,
+						   sizeof(data_rx), data_rx, DS3231_Refresh_Done, NULL};
+
+	if (rtc_in_flight || ((HAL_GetTick() - rtc_refresh_tick) < DS3231_REFRESH_MS))
+	{
+		return;
+	}
+
+	rtc_refresh_tick = HAL_GetTick();
+	rtc_in_flight = true;
+	if (!i2c_bus_submit(I2C_BUS_2, &xfer))
+	{
+		/* No slot or the RTC is backing off: next second */
+		rtc_in_flight = false;
+	}
 }
 
 void DS3231_Get_Date(uint8_t *day, uint8_t *mth, uint8_t *year, uint8_t *dow)
 {
-    *dow = DS3231_Bcd_Bin(DS3231_Read(DS3231_DAY) & 0x7F);
-    *day = DS3231_Bcd_Bin(DS3231_Read(DS3231_DATE) & 0x3F);
-    *mth = DS3231_Bcd_Bin(DS3231_Read(DS3231_MONTH) & 0x1F);
-    *year = DS3231_Bcd_Bin(DS3231_Read(DS3231_YEAR));
+    if (rtc_stale)
+    {
+        rtc_stale_reads++;
+    }
+    *dow = DS3231_Bcd_Bin(date_last[0] & 0x7F);
+    *day = DS3231_Bcd_Bin(date_last[1] & 0x3F);
+    *mth = DS3231_Bcd_Bin(date_last[2] & 0x1F);
+    *year = DS3231_Bcd_Bin(date_last[3]);
 }
 
 void DS3231_Get_Time(uint8_t *hr, uint8_t *min, uint8_t *sec)
 {
-    *sec = DS3231_Bcd_Bin(DS3231_Read(DS3231_SEC) & 0x7F);
-    *min = DS3231_Bcd_Bin(DS3231_Read(DS3231_MIN) & 0x7F);
-    *hr = DS3231_Bcd_Bin(DS3231_Read(DS3231_HOUR) & 0x3F);
+    if (rtc_stale)
+    {
+        rtc_stale_reads++;
+    }
+    *sec = DS3231_Bcd_Bin(time_last[0] & 0x7F);
+    *min = DS3231_Bcd_Bin(time_last[1] & 0x7F);
+    *hr = DS3231_Bcd_Bin(time_last[2] & 0x3F);
 }
 
 void DS3231_Get_DayOfWeek(char* str)
@@ -51,10 +118,10 @@ void DS3231_Get_DayOfWeek(char* str)
 
 uint8_t DS3231_Read(uint8_t reg)
 {
-	data_tx[0] = reg;
-	HAL_I2C_Master_Transmit(&hi2c2, (uint16_t)DS3231_ADDRESS, &data_tx[0], 1, 100);
-	HAL_I2C_Master_Receive(&hi2c2, (uint16_t)DS3231_ADDRESS, data_rx, 1, 100);
-    return data_rx[0];
+	uint8_t value = 0;
+
+	DS3231_Read_Burst(reg, &value, 1);
+    return value;
 }
 
 uint8_t DS3231_Bin_Bcd(uint8_t binary_value)
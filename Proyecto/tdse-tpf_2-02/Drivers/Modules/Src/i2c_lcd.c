@@ -3,15 +3,57 @@
  * Object-oriented version with multiple LCD support
  */
 
+#include <string.h>
+
 #include "i2c_lcd.h"
+#include "i2c_bus.h"
+#include "budget.h"
+
+#define LCD_FLUSH_CYCLES    1000u   // Budget one position takes, with margin
+#define LCD_FLUSH_SLOTS     2u      // Bus slots left for the RTC and the EEPROM
+#define LCD_IDLE            0x08u   // Backlight on, en=0: what the expander holds after a write
+#define LCD_UNKNOWN         '\0'    // Never in the frame (lcd_puts() stops there): resend
+
+/**
+ * @brief  Frame position of the first column of each row (DDRAM order).
+ */
+static const uint8_t lcd_row_start[LCD_ROWS] = {0, 40, 20, 60};
+
+/**
+ * @brief  Rewritten after a flush: its transfer queues behind the one that
+ *         carries the last position, so it ends when the display is up to date.
+ */
+static uint8_t lcd_idle = LCD_IDLE;
+
+/**
+ * @brief  I2C interrupt: end of the transfer queued after the last position.
+ *         If it failed, the writes before it may have failed too (they carry
+ *         no callback): what the display shows is unknown, so the next
+ *         flush sends the whole frame again.
+ */
+static void lcd_flush_done(HAL_StatusTypeDef status, void *p_arg)
+{
+    I2C_LCD_HandleTypeDef *lcd = (I2C_LCD_HandleTypeDef *)p_arg;
+
+    if (HAL_OK != status)
+    {
+        memset(lcd->shown, LCD_UNKNOWN, LCD_SIZE);
+    }
+
+    lcd->flushed++;
+    if (lcd->flushed == lcd->flushes)
+    {
+        lcd->p_shown();
+    }
+}
 
 /**
  * @brief  Sends a command to the LCD.
  * @param  lcd: Pointer to the LCD handle
  * @param  cmd: Command byte to send
- * @retval None
+ * @retval true if the bus queue took it
  */
-void lcd_send_cmd(I2C_LCD_HandleTypeDef *lcd, char cmd)
+bool lcd_send_cmd(I2C_LCD_HandleTypeDef *lcd, char cmd)
 {
     char upper_nibble, lower_nibble;
     uint8_t data_t[4];
@@ -24,16 +66,17 @@ void lcd_send_cmd(I2C_LCD_HandleTypeDef *lcd, char cmd)
     data_t[2] = lower_nibble | 0x0C;  // en=1, rs=0
     data_t[3] = lower_nibble | 0x08;  // en=0, rs=0
 
-    HAL_I2C_Master_Transmit(lcd->hi2c, lcd->address, data_t, 4, 100);
+    /* Queued; consecutive writes are merged into one transfer */
+    return i2c_bus_write(i2c_bus_of(lcd->hi2c), lcd->address, data_t, 4);
 }
 
 /**
  * @brief  Sends data (character) to the LCD.
  * @param  lcd: Pointer to the LCD handle
  * @param  data: Data byte to send
- * @retval None
+ * @retval true if the bus queue took it
  */
-void lcd_send_data(I2C_LCD_HandleTypeDef *lcd, char data)
+bool lcd_send_data(I2C_LCD_HandleTypeDef *lcd, char data)
 {
     char upper_nibble, lower_nibble;
     uint8_t data_t[4];
@@ -46,25 +89,20 @@ void lcd_send_data(I2C_LCD_HandleTypeDef *lcd, char data)
     data_t[2] = lower_nibble | 0x0D;  // en=1, rs=1
     data_t[3] = lower_nibble | 0x09;  // en=0, rs=1
 
-    HAL_I2C_Master_Transmit(lcd->hi2c, lcd->address, data_t, 4, 100);
+    /* Queued; consecutive writes are merged into one transfer */
+    return i2c_bus_write(i2c_bus_of(lcd->hi2c), lcd->address, data_t, 4);
 }
 
 /**
- * @brief  Clears the LCD display.
+ * @brief  Clears the LCD display. Only the frame: the 80 spaces it used to
+ *         send in one go are now whatever differs, sent by lcd_flush().
  * @param  lcd: Pointer to the LCD handle
  * @retval None
  */
 void lcd_clear(I2C_LCD_HandleTypeDef *lcd)
 {
-    lcd_send_cmd(lcd, 0x80);  // Move cursor to the home position
-    // Clear all characters
-    // 16x4 = 64 characters
-    // 20x4 = 80 characters
-    // So 80 character clearing is enough for both 16x2, 16x4, 20x2 and 20x5 displays
-    for (int i = 0; i < 80; i++)
-    {
-        lcd_send_data(lcd, ' ');  // Write a space on each position
-    }
+    memset(lcd->frame, ' ', LCD_SIZE);
+    lcd->cursor = 0;
 }
 
 /**
@@ -76,18 +114,136 @@ void lcd_clear(I2C_LCD_HandleTypeDef *lcd)
  */
 void lcd_pos(I2C_LCD_HandleTypeDef *lcd, int row, int col)
 {
-    uint8_t address;
+    if ((row < 0) || (row >= LCD_ROWS) || (col < 0) || (col >= LCD_COLS))
+    {
+        return;  // Ignore invalid positions
+    }
 
-    switch (row)
+    lcd->cursor = lcd_row_start[row] + col;
+}
+
+/**
+ * @brief  Sends the positions where the frame and the display differ, one
+ *         cursor command per run of them. Stops when the task budget or the
+ *         free bus slots run out and goes on from there on the next call, so
+ *         a new screen never holds a tick (nor waits for a bus slot). A
+ *         position the bus queue refuses stays to send.
+ * @param  lcd: Pointer to the LCD handle
+ * @retval Positions still to send
+ */
+int lcd_flush(I2C_LCD_HandleTypeDef *lcd)
+{
+    i2c_bus_id_t bus = i2c_bus_of(lcd->hi2c);
+    i2c_bus_xfer_t xfer = {I2C_BUS_OP_WRITE, I2C_BUS_PRIO_NORMAL, lcd->address, 0, 0, 1, &lcd_idle, lcd_flush_done, lcd};
+    int left = 0;
+    int sent = 0;
+    uint8_t at = LCD_SIZE;  // Where the display cursor is, LCD_SIZE: unknown
+    uint8_t index;
+
+    for (index = 0; index < LCD_SIZE; index++)
     {
-        case 0: address = 0x80 + col; break;  // First row
-        case 1: address = 0xC0 + col; break;  // Second row
-        case 2: address = 0x94 + col; break;  // Third row
-        case 3: address = 0xD4 + col; break;  // Fourth row
-        default: return;  // Ignore invalid row numbers
+        if (lcd->frame[index] == lcd->shown[index])
+        {
+            continue;
+        }
+
+        if ((0 != left) || (budget_remaining_cycles() < LCD_FLUSH_CYCLES) || (i2c_bus_free(bus) <= LCD_FLUSH_SLOTS))
+        {
+            left++;
+            continue;
+        }
+
+        // Rows 0/2 and 1/3 share a DDRAM line, lines start at 0x80 / 0xC0
+        if (((at != index) && !lcd_send_cmd(lcd, (index < 40) ? (0x80 + index) : (0xC0 + index - 40))) ||
+            !lcd_send_data(lcd, lcd->frame[index]))
+        {
+            // Where the display cursor is now is not known either
+            at = LCD_SIZE;
+            left++;
+            continue;
+        }
+
+        lcd->shown[index] = lcd->frame[index];
+        at = (index + 1 == 40) ? LCD_SIZE : (index + 1);
+        sent++;
     }
 
-    lcd_send_cmd(lcd, address);  // Send command to move the cursor
+    if ((NULL == lcd->p_shown) || (0 != left))
+    {
+        return left;
+    }
+
+    if (0 != sent)
+    {
+        // Counted first: the callback may run before i2c_bus_submit() returns
+        lcd->flushes++;
+        if (i2c_bus_submit(bus, &xfer))
+        {
+            return left;
+        }
+        lcd->flushes--;
+    }
+
+    // Nothing new (or no slot: the positions are queued at least), and no
+    // earlier flush still on the bus: the display is up to date
+    if (lcd->flushed == lcd->flushes)
+    {
+        lcd->p_shown();
+    }
+
+    return left;
+}
+
+/**
+ * @brief  4-bit mode power-on sequence: command and wait (ms) before the next one.
+ */
+static const struct {
+    char cmd;
+    uint8_t delay;
+} lcd_init_seq[] = {
+    {0x30, 5},   // Wake up command
+    {0x30, 1},   // Wake up command
+    {0x30, 10},  // Wake up command
+    {0x20, 10},  // Set to 4-bit mode
+    {0x28, 1},   // 4-bit mode, 2 lines, 5x8 font
+    {0x08, 1},   // Display off, cursor off, blink off
+    {0x01, 2},   // Clear display
+    {0x06, 1},   // Entry mode: cursor moves right
+    {0x0C, 0}    // Display on, cursor off, blink off
+};
+
+#define LCD_INIT_SEQ_QTY    (sizeof(lcd_init_seq) / sizeof(lcd_init_seq[0]))
+
+/**
+ * @brief  Runs one step of the power-on sequence, for callers that must not block.
+ *         Step 0 is the power-up wait and sends nothing.
+ * @param  lcd: Pointer to the LCD handle
+ * @param  step: Step number, from 0
+ * @retval Milliseconds to wait before the next step, -1 once the sequence is over
+ */
+int lcd_init_step(I2C_LCD_HandleTypeDef *lcd, uint8_t step)
+{
+    if (0 == step)
+    {
+        return 50;  // Wait for LCD power-up
+    }
+
+    if (LCD_INIT_SEQ_QTY < step)
+    {
+        return -1;
+    }
+
+    lcd_send_cmd(lcd, lcd_init_seq[step - 1].cmd);
+
+    if (0x01 == lcd_init_seq[step - 1].cmd)
+    {
+        // Cleared: the frame starts as what the display shows
+        memset(lcd->frame, ' ', LCD_SIZE);
+        memset(lcd->shown, ' ', LCD_SIZE);
+        lcd->cursor = 0;
+    }
+
+    return lcd_init_seq[step - 1].delay;
 }
 
 /**
@@ -97,47 +253,35 @@ void lcd_pos(I2C_LCD_HandleTypeDef *lcd, int row, int col)
  */
 void lcd_init(I2C_LCD_HandleTypeDef *lcd)
 {
-    HAL_Delay(50);  // Wait for LCD power-up
-    lcd_send_cmd(lcd, 0x30);  // Wake up command
-    HAL_Delay(5);
-    lcd_send_cmd(lcd, 0x30);  // Wake up command
-    HAL_Delay(1);
-    lcd_send_cmd(lcd, 0x30);  // Wake up command
-    HAL_Delay(10);
-    lcd_send_cmd(lcd, 0x20);  // Set to 4-bit mode
-    HAL_Delay(10);
-
-    // LCD configuration commands
-    lcd_send_cmd(lcd, 0x28);  // 4-bit mode, 2 lines, 5x8 font
-    HAL_Delay(1);
-    lcd_send_cmd(lcd, 0x08);  // Display off, cursor off, blink off
-    HAL_Delay(1);
-    lcd_send_cmd(lcd, 0x01);  // Clear display
-    HAL_Delay(2);
-    lcd_send_cmd(lcd, 0x06);  // Entry mode: cursor moves right
-    HAL_Delay(1);
-    lcd_send_cmd(lcd, 0x0C);  // Display on, cursor off, blink off
+    int delay;
+    uint8_t step = 0;
+
+    while ((delay = lcd_init_step(lcd, step++)) >= 0)
+    {
+        HAL_Delay(delay);
+    }
 }
 
 /**
- * @brief  Sends a string to the LCD.
+ * @brief  Writes a string at the cursor; lcd_flush() sends it.
  * @param  lcd: Pointer to the LCD handle
  * @param  str: Null-terminated string to display
  * @retval None
  */
 void lcd_puts(I2C_LCD_HandleTypeDef *lcd, char *str)
 {
-    while (*str) lcd_send_data(lcd, *str++);  // Send each character in the string
+    while (*str) lcd_putchar(lcd, *str++);  // Write each character in the string
 }
 
 /**
- * @brief  Sends a single character to the LCD.
+ * @brief  Writes a single character at the cursor; lcd_flush() sends it.
  * @param  lcd: Pointer to the LCD handle
  * @param  ch: Character to send
  * @retval None
  */
 void lcd_putchar(I2C_LCD_HandleTypeDef *lcd, char ch)
 {
-    lcd_send_data(lcd, ch);  // Send the character to the display
+    lcd->frame[lcd->cursor] = ch;
+    lcd->cursor = (lcd->cursor + 1) % LCD_SIZE;  // Wraps like the display: rows 0, 2, 1, 3
 }
 
@@ -89,12 +89,25 @@ void MFRC522_AntennaOff(void)
 }
 
 void MFRC522_Init(void)
+{
+	MFRC522_Start();
+	MFRC522_Config();
+}
+
+// First half of MFRC522_Init(): bus idle and reset. The oscillator restarts
+// after the soft reset, so callers that must not block can wait a tick here.
+void MFRC522_Start(void)
 {
 	HAL_GPIO_WritePin(MFRC522_SCK_GPIO_Port, MFRC522_SCK_Pin, 0);
 	HAL_GPIO_WritePin(MFRC522_MOSI_GPIO_Port, MFRC522_MOSI_Pin, 0);
     HAL_GPIO_WritePin(MFRC522_CS_GPIO_Port, MFRC522_CS_Pin, 1);
     HAL_GPIO_WritePin(MFRC522_RST_GPIO_Port, MFRC522_RST_Pin, 1);
     MFRC522_Reset();
+}
+
+// Second half of MFRC522_Init(): timer, modulation and antenna.
+void MFRC522_Config(void)
+{
     MFRC522_Wr(TMODEREG, 0x8D);
     MFRC522_Wr(TPRESCALERREG, 0x3E);
     MFRC522_Wr(TRELOADREGL, 30);
@@ -105,25 +118,20 @@ void MFRC522_Init(void)
     MFRC522_AntennaOn();
 }
 
-uint8_t MFRC522_ToCard(uint8_t cmd, uint8_t *dat, uint8_t len, uint8_t *back_dat, unsigned *back_len)
+// First half of MFRC522_ToCard(): loads the FIFO and starts the command.
+void MFRC522_ToCardStart(uint8_t cmd, uint8_t *dat, uint8_t len)
 {
-	uint8_t _status = MI_ERR;
 	uint8_t irqEn = 0x00;
-	uint8_t waitIRq = 0x00;
-	uint8_t lastBits;
-    uint8_t n;
     unsigned i;
 
     switch(cmd)
     {
         case PCD_AUTHENT:
             irqEn = 0x12;
-            waitIRq = 0x10;
             break;
 
         case PCD_TRANSCEIVE:
             irqEn = 0x77;
-            waitIRq = 0x30;
             break;
 
         default:
@@ -143,55 +151,102 @@ uint8_t MFRC522_ToCard(uint8_t cmd, uint8_t *dat, uint8_t len, uint8_t *back_dat
     {
         MFRC522_Set_Bit(BITFRAMINGREG, 0x80);
     }
-    i = 0xFFFF;
-    do
+}
+
+// Second half of MFRC522_ToCard(): one look at the interrupt flags. MI_BUSY
+// until the card answered or the MFRC522 timer (15 mS) ran out.
+uint8_t MFRC522_ToCardPoll(uint8_t cmd, uint8_t *back_dat, unsigned *back_len)
+{
+	uint8_t _status = MI_ERR;
+	uint8_t irqEn = 0x00;
+	uint8_t waitIRq = 0x00;
+	uint8_t lastBits;
+    uint8_t n;
+    unsigned i;
+
+    switch(cmd)
     {
-        n = MFRC522_Rd(COMMIRQREG);
-        i--;
-    }while(i && !(n & 0x01) && !(n & waitIRq));
+        case PCD_AUTHENT:
+            irqEn = 0x12;
+            waitIRq = 0x10;
+            break;
+
+        case PCD_TRANSCEIVE:
+            irqEn = 0x77;
+            waitIRq = 0x30;
+            break;
+
+        default:
+            break;
+    }
+
+    n = MFRC522_Rd(COMMIRQREG);
+    if(!(n & 0x01) && !(n & waitIRq))
+    {
+        return MI_BUSY;
+    }
 
     MFRC522_Clear_Bit(BITFRAMINGREG, 0x80);
-    if(i != 0)
+    if(!(MFRC522_Rd(ERRORREG) & 0x1B))
     {
-        if(!(MFRC522_Rd(ERRORREG) & 0x1B))
+        _status = MI_OK;
+        if(n & irqEn & 0x01)
+        {
+            _status = MI_NOTAGERR;
+        }
+        if(cmd == PCD_TRANSCEIVE)
         {
-            _status = MI_OK;
-            if(n & irqEn & 0x01)
+            n = MFRC522_Rd(FIFOLEVELREG);
+            lastBits = MFRC522_Rd(CONTROLREG) & 0x07;
+            if(lastBits)
             {
-                _status = MI_NOTAGERR;
+                *back_len = (n-1) * 8 + lastBits;
             }
-            if(cmd == PCD_TRANSCEIVE)
+            else
             {
-                n = MFRC522_Rd(FIFOLEVELREG);
-                lastBits = MFRC522_Rd(CONTROLREG) & 0x07;
-                if(lastBits)
-                {
-                    *back_len = (n-1) * 8 + lastBits;
-                }
-                else
-                {
-                    *back_len = n * 8;
-                }
-                if(n == 0)
-                {
-                    n = 1;
-                }
-                if(n > 16)
-                {
-                    n = 16;
-                }
-                for(i=0; i<n; i++)
-                {
-                	back_dat[i] = MFRC522_Rd(FIFODATAREG);
-                }
-                back_dat[i] = 0;
+                *back_len = n * 8;
             }
-        }
-        else
-        {
-            _status = MI_ERR;
+            if(n == 0)
+            {
+                n = 1;
+            }
+            if(n > 16)
+            {
+                n = 16;
+            }
+            for(i=0; i<n; i++)
+            {
+            	back_dat[i] = MFRC522_Rd(FIFODATAREG);
+            }
+            back_dat[i] = 0;
         }
     }
+    else
+    {
+        _status = MI_ERR;
+    }
+    return _status;
+}
+
+uint8_t MFRC522_ToCard(uint8_t cmd, uint8_t *dat, uint8_t len, uint8_t *back_dat, unsigned *back_len)
+{
+	uint8_t _status;
+    unsigned i;
+
+    MFRC522_ToCardStart(cmd, dat, len);
+
+    i = 0xFFFF;
+    do
+    {
+        _status = MFRC522_ToCardPoll(cmd, back_dat, back_len);
+        i--;
+    }while(i && (_status == MI_BUSY));
+
+    if(_status == MI_BUSY)
+    {
+        MFRC522_Clear_Bit(BITFRAMINGREG, 0x80);
+        _status = MI_ERR;
+    }
     return _status;
 }
 
@@ -257,15 +312,16 @@ uint8_t MFRC522_SelectTag(uint8_t *serNum)
     return size;
 }
 
+// A halted card does not answer, so this does not wait for the timer like
+// MFRC522_ToCard() would (15 mS): the next command stops the transceive.
 void MFRC522_Halt(void)
 {
-    unsigned unLen;
     uint8_t buff[4];
     buff[0] = PICC_HALT;
     buff[1] = 0;
     MFRC522_CRC(buff, 2, &buff[2]);
     MFRC522_Clear_Bit(STATUS2REG, 0x80);
-    MFRC522_ToCard(PCD_TRANSCEIVE, buff, 4, buff, &unLen);
+    MFRC522_ToCardStart(PCD_TRANSCEIVE, buff, 4);
     MFRC522_Clear_Bit(STATUS2REG, 0x08);
 }
 
@@ -302,6 +358,47 @@ uint8_t MFRC522_IsCard(uint8_t *TagType)
         return 0;
 }
 
+// MFRC522_IsCard() without the wait: the first call sends the request, the
+// next ones check for the answer, one register read each. MFRC522_CARD_BUSY
+// until there is one; after MFRC522_POLL_MAX calls it counts as no card.
+// The answer lands in a buffer of its own (up to 16 bytes and a 0), the
+// caller gets the first byte.
+uint8_t MFRC522_IsCardPoll(uint8_t *TagType)
+{
+    static uint8_t polls = 0;
+    static uint8_t buff[17];
+    unsigned backBits = 0;
+    uint8_t _status;
+
+    if(polls == 0)
+    {
+        MFRC522_Wr(BITFRAMINGREG, 0x07);
+        buff[0] = PICC_REQIDL;
+        MFRC522_ToCardStart(PCD_TRANSCEIVE, buff, 1);
+        polls = 1;
+        return MFRC522_CARD_BUSY;
+    }
+
+    _status = MFRC522_ToCardPoll(PCD_TRANSCEIVE, buff, &backBits);
+    TagType[0] = buff[0];
+    if((_status == MI_BUSY) && (polls < MFRC522_POLL_MAX))
+    {
+        polls++;
+        return MFRC522_CARD_BUSY;
+    }
+
+    if(_status == MI_BUSY)
+    {
+        MFRC522_Clear_Bit(BITFRAMINGREG, 0x80);
+    }
+    polls = 0;
+
+    if((_status == MI_OK) && (backBits == 0x10))
+        return MFRC522_CARD_FOUND;
+    else
+        return MFRC522_CARD_NONE;
+}
+
 uint8_t MFRC522_ReadCardSerial(uint8_t *str)
 {
 	uint8_t _status;
@@ -0,0 +1,64 @@
+/*
+ *
+ * @file   : access_queue.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef ACCESS_QUEUE_H
+#define ACCESS_QUEUE_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define ACCESS_QUEUE_CONFIG_QTY		(8)			// Events in RAM, not less than MEM_ACCESS_QTY
+#define ACCESS_QUEUE_CONFIG_PAGE	(32u)		// AT24 page: no write crosses one
+
+/********************** typedef **********************************************/
+/* One access, as read from the RTC when it happened */
+typedef struct
+{
+	uint8_t		day;
+	uint8_t		mth;
+	uint8_t		year;
+	uint8_t		hr;
+	uint8_t		min;
+	uint8_t		sec;
+	char		who[9];			// Card UID or "PIN-" and the user id
+} access_event_t;
+
+typedef struct
+{
+	uint32_t	events;			// Events queued
+	uint32_t	written;		// Records written to the log
+	uint32_t	coalesced;		// Events a later one replaced in the log before they were written
+	uint32_t	overflows;		// Events pushed out with the queue full (coalesced too)
+	uint32_t	batches;		// Entry count saves, one per batch of records
+	uint32_t	clears;			// Log clears from the console
+	uint8_t		depth_max;
+} access_queue_stats_t;
+
+/********************** external data declaration ****************************/
+extern access_queue_stats_t access_queue_stats;
+
+/********************** external functions declaration ***********************/
+extern void access_queue_put(const access_event_t *p_event);
+extern void access_queue_update(void);
+extern void access_queue_clear(void);
+extern uint8_t access_queue_depth(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ACCESS_QUEUE_H
+
+/********************** end of file ******************************************/
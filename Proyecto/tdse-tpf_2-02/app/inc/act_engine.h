@@ -0,0 +1,57 @@
+/*
+ *
+ * @file   : act_engine.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef ACT_ENGINE_H
+#define ACT_ENGINE_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define ACT_ENGINE_CHANNELS			(4)			// TIM2 CH1..CH4, one per actuator
+#define ACT_ENGINE_STEP_MAX			(0x8000ul)	// Longest compare step (uS), half the counter range
+
+#define ACT_ENGINE_DIM_PERIOD_US	(10000ul)	// Soft PWM period for dimming (100 Hz)
+
+/********************** typedef **********************************************/
+typedef struct
+{
+	GPIO_TypeDef *		gpio_port;
+	uint32_t			bsrr_on;		// BSRR value that drives the actuator on
+	uint32_t			bsrr_off;		// BSRR value that drives the actuator off
+	volatile uint32_t	on_us;			// 0: static level, no interrupts
+	volatile uint32_t	off_us;
+	volatile bool		level;
+	volatile uint32_t	remaining_us;	// Left of the current half cycle
+} act_engine_ch_t;
+
+/********************** external data declaration ****************************/
+extern act_engine_ch_t act_engine_ch[ACT_ENGINE_CHANNELS];
+
+/********************** external functions declaration ***********************/
+extern void act_engine_init(void);
+extern void act_engine_attach(uint8_t ch, GPIO_TypeDef *port, uint16_t pin, GPIO_PinState act_on);
+extern void act_engine_level(uint8_t ch, bool on);
+extern void act_engine_square(uint8_t ch, uint32_t on_us, uint32_t off_us);
+extern void act_engine_blink(uint8_t ch, uint32_t half_period_ms);
+extern void act_engine_tone(uint8_t ch, uint32_t hz);
+extern void act_engine_dim(uint8_t ch, uint8_t percent);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ACT_ENGINE_H
+
+/********************** end of file ******************************************/
@@ -0,0 +1,112 @@
+/*
+ *
+ * @file   : bench.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "latency.h"
+
+/********************** macros ***********************************************/
+#define BENCH_CONFIG_ENABLE			(1)
+#define BENCH_CONFIG_WINDOW_TICKS	(10000ul)	// Length of the free-running window
+#define BENCH_I2C_BUSES				(2)
+#define BENCH_LINES					(2 + BENCH_I2C_BUSES + LAT_QTY)	// Report lines per window
+
+#if 1 == BENCH_CONFIG_ENABLE
+#define BENCH_I2C_START(bus, len)	bench_i2c_start((bus), (len))
+#define BENCH_I2C_END(bus)			bench_i2c_end(bus)
+#else
+#define BENCH_I2C_START(bus, len)
+#define BENCH_I2C_END(bus)
+#endif
+
+/********************** typedef **********************************************/
+/* Scripted scenarios, each driven by a fixed input stream (bench.c), to be
+ * started from the PIN screen (ST_SYS_AWAIT_PWD). Each window is reported
+ * against its own baseline */
+typedef enum {
+	BENCH_SC_FREE_RUN,		// Periodic window, live inputs
+	BENCH_SC_PIN_BURST,		// Fast PIN entry bursts, erased before D
+	BENCH_SC_CARD_TAPS,		// Repeated taps of one card (BENCH_CARD_UID)
+	BENCH_SC_MENU_NAV,		// In and out of the options password screen
+	BENCH_SC_WRONG_PIN,		// Wrong-PIN lockout
+	BENCH_SC_LDR_FLIPS,		// LDR day/night flips
+	BENCH_SC_QTY
+} bench_scenario_t;
+
+typedef struct
+{
+	uint32_t	bytes;
+	uint32_t	busy_cycles;
+	uint32_t	start;
+} bench_i2c_t;
+
+typedef struct
+{
+	bench_scenario_t	scenario;
+	volatile bench_scenario_t	request;	// Written by the debugger/console to switch scenario
+	uint32_t	ticks;
+	uint64_t	cycles_sum;
+	uint32_t	cycles_max;
+	uint32_t	overruns;			// Ticks longer than the 1 mS budget
+	uint32_t	overrun_max;		// Worst overrun beyond the budget (cycles)
+	uint32_t	backlog_max;		// Worst number of ticks left pending after a tick
+	uint32_t	tick_start;
+	bench_i2c_t	i2c[BENCH_I2C_BUSES];
+} bench_t;
+
+/* Last closed window, as reported */
+typedef struct
+{
+	uint32_t	window;				// Windows closed so far
+	bench_scenario_t	scenario;
+	uint32_t	ticks;
+	uint32_t	cycles_avg;
+	uint32_t	cycles_max;
+	uint32_t	overruns;
+	uint32_t	overrun_max_us;
+	uint32_t	backlog_max;
+	uint32_t	i2c_bytes[BENCH_I2C_BUSES];
+	uint32_t	i2c_busy_us[BENCH_I2C_BUSES];
+	uint32_t	lat_count[LAT_QTY];
+	uint32_t	lat_p50_us[LAT_QTY];
+	uint32_t	lat_p99_us[LAT_QTY];
+} bench_result_t;
+
+/********************** external data declaration ****************************/
+extern bench_t bench;
+extern bench_result_t bench_result;
+
+/********************** external functions declaration ***********************/
+extern void bench_init(void);
+extern void bench_tick_begin(void);
+extern void bench_tick_end(uint32_t backlog);
+extern void bench_update(void);
+extern void bench_begin(bench_scenario_t scenario);
+extern void bench_end(void);
+extern void bench_i2c_start(uint8_t bus, uint32_t len);
+extern void bench_i2c_end(uint8_t bus);
+extern bench_scenario_t bench_scenario_find(const char *p_name);
+extern char *bench_line(char *p, uint8_t line);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BENCH_H
+
+/********************** end of file ******************************************/
@@ -64,6 +64,12 @@ extern "C" {
 #define BTN_1_PRESSED	GPIO_PIN_RESET
 #define BTN_1_HOVER		GPIO_PIN_SET
 
+/* Optional door contact (reed switch to GND when the door is closed) */
+#define DOOR_1_CONNECTED	(0)
+#define DOOR_1_PIN		DOOR_Pin
+#define DOOR_1_PORT		DOOR_GPIO_Port
+#define DOOR_1_CLOSED	GPIO_PIN_RESET
+
 #define LED_1_PIN		LED1_Pin
 #define LED_1_PORT		LED1_GPIO_Port
 #define LED_1_ON		GPIO_PIN_SET
@@ -0,0 +1,57 @@
+/*
+ *
+ * @file   : budget.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef BUDGET_H
+#define BUDGET_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define BUDGET_CONFIG_TICK_US		(900ul)		// Of the 1 mS tick, the rest is for interrupts
+#define BUDGET_CONFIG_TASKS			(4)
+
+#define BUDGET_UNLIMITED			(0xFFFFFFFFul)	// Outside the tasks (bring-up, app_init)
+
+/********************** typedef **********************************************/
+typedef struct
+{
+	uint32_t	allot;			// Cycles per tick
+	uint32_t	cycles_max;
+	uint32_t	overruns;		// Ticks the task ran past its allotment
+} budget_task_t;
+
+typedef struct
+{
+	budget_task_t	task[BUDGET_CONFIG_TASKS];
+	uint32_t		tick_max;		// Longest tick (all tasks), cycles
+} budget_stats_t;
+
+/********************** external data declaration ****************************/
+extern budget_stats_t budget_stats;
+
+/********************** external functions declaration ***********************/
+extern void budget_tick_begin(void);
+extern void budget_tick_end(void);
+extern void budget_task_begin(uint8_t task, uint32_t allot_us);
+extern void budget_task_end(void);
+extern uint32_t budget_remaining_cycles(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUDGET_H
+
+/********************** end of file ******************************************/
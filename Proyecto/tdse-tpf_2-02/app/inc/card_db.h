@@ -0,0 +1,54 @@
+/*
+ *
+ * @file   : card_db.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef CARD_DB_H
+#define CARD_DB_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define CARD_DB_CONFIG_CARDS		(64)		// Records in the AT24 table
+#define CARD_DB_CONFIG_BASE			(0x0C40u)	// AT24: header, then the records
+#define CARD_DB_CONFIG_SEED			(0x90245C21ul)	// Only card of a new table
+
+#define CARD_DB_NONE				(0xFFFFu)
+
+/********************** typedef **********************************************/
+typedef struct
+{
+	uint16_t	cards;
+	uint32_t	lookups;
+	uint32_t	hits;
+} card_db_stats_t;
+
+/********************** external data declaration ****************************/
+extern card_db_stats_t card_db_stats;
+
+/********************** external functions declaration ***********************/
+extern int32_t card_db_init_lane(uint32_t step);
+extern uint16_t card_db_find(uint32_t uid);
+extern uint16_t card_db_add(uint32_t uid);
+extern bool card_db_put(uint16_t card, uint32_t uid);
+extern bool card_db_remove(uint16_t card);
+extern bool card_db_flush(void);
+extern bool card_db_info(uint16_t card, uint32_t *p_uid);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CARD_DB_H
+
+/********************** end of file ******************************************/
@@ -0,0 +1,40 @@
+/*
+ *
+ * @file   : cobs.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef COBS_H
+#define COBS_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+
+/********************** macros ***********************************************/
+/* Worst case encoded length of size bytes, without the 0x00 delimiter */
+#define COBS_MAX(size)		((size) + ((size) / 254) + 1)
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+
+/********************** external functions declaration ***********************/
+/* Consistent Overhead Byte Stuffing: the encoded data has no 0x00, so 0x00
+ * can end each frame. Both return the output length, decode 0 if malformed */
+extern uint16_t cobs_encode(const uint8_t *p_in, uint16_t size, uint8_t *p_out);
+extern uint16_t cobs_decode(const uint8_t *p_in, uint16_t size, uint8_t *p_out);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // COBS_H
+
+/********************** end of file ******************************************/
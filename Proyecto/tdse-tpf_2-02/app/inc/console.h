@@ -0,0 +1,67 @@
+/*
+ *
+ * @file   : console.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define CONSOLE_CONFIG_RX_TICK		(64)		// Input bytes handled per tick
+#define CONSOLE_CONFIG_LINE_MAX		(48)		// Command line, NUL included
+#define CONSOLE_CONFIG_OUT_MAX		(72)		// Output line, CR LF excluded (bench.c lines: 66)
+#define CONSOLE_CONFIG_ARGS			(6)
+#define CONSOLE_CONFIG_LOGIN_MS		(300000ul)	// Idle time before an admin logout
+
+#define CONSOLE_DONE				(-1)		// Command return value: no more steps
+
+/********************** typedef **********************************************/
+/* A command runs its step number 'step' and returns the next step (the same
+ * one to wait) or CONSOLE_DONE. Each step writes one line at most: the
+ * console only calls it when that line fits in the TX ring */
+typedef int32_t (*console_cmd_t)(uint32_t step, uint8_t argc, char *argv[]);
+
+typedef struct
+{
+	const char *	p_name;
+	console_cmd_t	p_cmd;
+	bool			b_admin;		// Only after login
+	const char *	p_help;
+} console_entry_t;
+
+typedef struct
+{
+	uint32_t	lines;
+	uint32_t	commands;
+	uint32_t	unknown;
+	uint32_t	denied;			// Admin commands without login, failed logins
+	uint32_t	dropped;		// Text received while a command was running
+	uint32_t	cycles_max;		// Longest console_update()
+} console_stats_t;
+
+/********************** external data declaration ****************************/
+extern console_stats_t console_stats;
+
+/********************** external functions declaration ***********************/
+extern void console_init(void);
+extern void console_update(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONSOLE_H
+
+/********************** end of file ******************************************/
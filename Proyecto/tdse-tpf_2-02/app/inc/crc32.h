@@ -0,0 +1,39 @@
+/*
+ *
+ * @file   : crc32.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+
+/********************** macros ***********************************************/
+#define CRC32_INIT		(0xFFFFFFFFul)
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+
+/********************** external functions declaration ***********************/
+/* CRC-32 (IEEE 802.3, zlib): crc32_final(crc32_update(CRC32_INIT, p, n)) */
+extern uint32_t crc32_update(uint32_t crc, const void *p_data, uint32_t size);
+extern uint32_t crc32_final(uint32_t crc);
+extern uint32_t crc32(const void *p_data, uint32_t size);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CRC32_H
+
+/********************** end of file ******************************************/
@@ -0,0 +1,101 @@
+/*
+ *
+ * @file   : cred_store.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef CRED_STORE_H
+#define CRED_STORE_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pin_hash.h"
+#include "pin_db.h"
+
+/********************** macros ***********************************************/
+#define CRED_STORE_CONFIG_BATCH		(8)			// Changes per head-end batch
+#define CRED_STORE_CONFIG_LOCAL		(8)			// Changes made here kept for the head-end
+#define CRED_STORE_CONFIG_JOURNAL	(0x0E80u)	// AT24: one page per change of the batch
+
+#define CRED_STORE_WIRE_SIZE		(18)		// cred_store_pack()
+
+/********************** typedef **********************************************/
+typedef enum {
+	CRED_OP_PIN_PUT,
+	CRED_OP_PIN_DEL,
+	CRED_OP_CARD_PUT,
+	CRED_OP_CARD_DEL,
+	CRED_OP_QTY
+} cred_op_t;
+
+/* One change to a PIN user or a card id. key: CRC tag of the PIN or UID of
+ * the card; role, uses and digest only for PIN_PUT */
+typedef struct
+{
+	uint8_t		op;
+	uint8_t		role;
+	uint16_t	id;
+	uint16_t	uses;
+	uint32_t	key;
+	uint8_t		digest[PIN_HASH_SIZE];
+} cred_change_t;
+
+/* Version vector: changes applied from the head-end, changes made here */
+typedef struct
+{
+	uint16_t	head;
+	uint16_t	local;
+} cred_store_vv_t;
+
+typedef enum {
+	CRED_STORE_STAGED,		// Kept: the batch goes in once all its changes are
+	CRED_STORE_DONE,		// That batch is in already (a resend)
+	CRED_STORE_STALE,		// base is not the head version here
+	CRED_STORE_BUSY,		// Still writing the previous batch, or loading
+	CRED_STORE_BAD
+} cred_store_result_t;
+
+typedef struct
+{
+	uint32_t	batches;		// Batches applied
+	uint32_t	changes;		// Changes applied from the head-end
+	uint32_t	local;			// Changes made here (console)
+	uint32_t	replayed;		// Batches finished from the journal after a reset
+	uint32_t	stale;			// Changes refused, STALE or BUSY
+	uint32_t	errors;			// Changes pin_db or card_db refused
+} cred_store_stats_t;
+
+/********************** external data declaration ****************************/
+extern cred_store_vv_t cred_store_vv;
+extern cred_store_stats_t cred_store_stats;
+
+/********************** external functions declaration ***********************/
+extern int32_t cred_store_init_lane(uint32_t step);
+extern void cred_store_update(void);
+extern cred_store_result_t cred_store_stage(uint16_t base, uint16_t target, uint8_t index, uint8_t count,
+											const cred_change_t *p_change);
+extern uint8_t cred_store_staged(void);
+extern uint8_t cred_store_since(uint16_t since, uint16_t *p_first, cred_change_t changes[], uint8_t max);
+extern uint16_t cred_store_pin_add(const char *p_pin, pin_role_t role, uint16_t uses);
+extern bool cred_store_pin_remove(uint16_t user);
+extern uint16_t cred_store_card_add(uint32_t uid);
+extern bool cred_store_card_remove(uint16_t card);
+extern uint16_t cred_store_pack(uint8_t *p, const cred_change_t *p_change);
+extern bool cred_store_unpack(cred_change_t *p_change, const uint8_t *p);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CRED_STORE_H
+
+/********************** end of file ******************************************/
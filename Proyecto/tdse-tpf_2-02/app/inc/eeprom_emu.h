@@ -0,0 +1,73 @@
+/*
+ *
+ * @file   : eeprom_emu.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef EEPROM_EMU_H
+#define EEPROM_EMU_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+/* The last two 1 KB pages of the STM32F103RB flash, kept out of the FLASH
+ * region in STM32F103RBTX_FLASH.ld */
+#define EEPROM_EMU_PAGE_0			(0x0801F800ul)
+#define EEPROM_EMU_PAGE_1			(0x0801FC00ul)
+#define EEPROM_EMU_PAGE_SIZE		(0x400ul)
+
+#define EEPROM_EMU_CONFIG_COMMIT_MS	(2000ul)	// Writes closer than this go out together
+
+/********************** typedef **********************************************/
+/* Virtual 16-bit variables. Append only: the id is stored in flash */
+typedef enum {
+	EE_SYSTEM_STATUS,
+	EE_LDR_MODE,
+	EE_LDR_ADJ,
+	EE_DOOR_WINDOW,
+	EE_DOOR_HELD,
+	EE_DOOR_RELOCK,
+	EE_LOCK_PIN,			// Lockout failure counters (lockout.c)
+	EE_LOCK_CARD,
+	EE_LOCK_OPT,
+	EE_RS485_ADDR,			// RS-485 node address (rs485_link.c)
+	EE_CRED_GEN,			// Credential store version vector (cred_store.c): head-end
+	EE_CRED_LOCAL,			// and changes made at this door
+	EE_QTY
+} eeprom_emu_id_t;
+
+typedef struct
+{
+	uint32_t	commits;		// Flash commits (coalesced writes)
+	uint32_t	records;		// Records programmed
+	uint32_t	swaps;			// Page transfers
+	uint32_t	erase_count;	// Erases of the active page (wear)
+	uint32_t	errors;			// Failed program / erase operations
+} eeprom_emu_stats_t;
+
+/********************** external data declaration ****************************/
+extern eeprom_emu_stats_t eeprom_emu_stats;
+
+/********************** external functions declaration ***********************/
+extern void eeprom_emu_init(void);
+extern bool eeprom_emu_read(eeprom_emu_id_t id, uint16_t *p_value);
+extern void eeprom_emu_write(eeprom_emu_id_t id, uint16_t value);
+extern void eeprom_emu_update(void);
+extern void eeprom_emu_commit(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EEPROM_EMU_H
+
+/********************** end of file ******************************************/
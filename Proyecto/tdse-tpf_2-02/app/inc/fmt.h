@@ -0,0 +1,42 @@
+/*
+ *
+ * @file   : fmt.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef FMT_H
+#define FMT_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+
+/********************** macros ***********************************************/
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+
+/********************** external functions declaration ***********************/
+/* Each call writes at p and returns the end of what it wrote, so calls chain:
+ *   p = fmt_dec(p, day, 2); *p++ = '/'; ... *p = '\0';
+ * No NUL is written, no state is kept: callers size the buffer */
+extern char *fmt_str(char *p, const char *s);
+extern char *fmt_dec(char *p, uint32_t value, uint8_t width);	// "%0<width>lu"
+extern char *fmt_int(char *p, int32_t value);					// "%ld"
+extern char *fmt_bcd2(char *p, uint8_t bcd);					// Two digits from packed BCD
+extern char *fmt_hex2(char *p, uint8_t value);					// "%02X"
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FMT_H
+
+/********************** end of file ******************************************/
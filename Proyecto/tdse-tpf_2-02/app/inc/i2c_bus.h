@@ -0,0 +1,137 @@
+/*
+ *
+ * @file   : i2c_bus.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define I2C_BUS_CONFIG_SLOTS		(12)	// Queued transactions per bus
+#define I2C_BUS_CONFIG_INLINE		(64)	// Bytes copied into a slot (writes, polled reads)
+#define I2C_BUS_CONFIG_REPORT_TICKS	(60000ul)	// Utilisation window, 0: no report
+
+#define I2C_BUS_CONFIG_XFER_MIN_MS	(2ul)	// Transfer deadline: minimum plus ...
+#define I2C_BUS_CONFIG_BYTE_US		(90ul)	// ... time per byte at 100 kHz
+#define I2C_BUS_CONFIG_RETRIES		(1)		// Retries of a failed transfer
+#define I2C_BUS_CONFIG_DEVICES		(4)		// Devices with counters, per bus
+#define I2C_BUS_CONFIG_FAIL_MAX		(3)		// Failures in a row before fast fail
+#define I2C_BUS_CONFIG_BACKOFF_MS	(1000ul)	// Fast fail time before the next try
+
+/********************** typedef **********************************************/
+/* One manager per I2C peripheral. Values match TRACE_I2C_BUS_x - 1 */
+typedef enum {
+	I2C_BUS_1,				// hi2c1: LCD
+	I2C_BUS_2,				// hi2c2: EEPROM, DS3231
+	I2C_BUS_QTY
+} i2c_bus_id_t;
+
+typedef enum {
+	I2C_BUS_PRIO_HIGH,		// Someone is waiting (i2c_bus_poll)
+	I2C_BUS_PRIO_NORMAL,
+	I2C_BUS_PRIO_LOW,
+	I2C_BUS_PRIO_QTY
+} i2c_bus_prio_t;
+
+typedef enum {
+	I2C_BUS_OP_WRITE,
+	I2C_BUS_OP_READ,
+	I2C_BUS_OP_MEM_WRITE,
+	I2C_BUS_OP_MEM_READ
+} i2c_bus_op_t;
+
+/* Completion callback. Runs in the I2C interrupt: keep it short */
+typedef void (*i2c_bus_cb_t)(HAL_StatusTypeDef status, void *p_arg);
+
+/* Transaction descriptor. For i2c_bus_submit() p_data must stay valid until
+ * the callback; the copying helpers keep the data in the slot instead */
+typedef struct
+{
+	uint8_t				op;			// i2c_bus_op_t
+	uint8_t				priority;	// i2c_bus_prio_t
+	uint16_t			address;
+	uint16_t			mem_addr;
+	uint16_t			mem_size;	// I2C_MEMADD_SIZE_8BIT / I2C_MEMADD_SIZE_16BIT
+	uint16_t			size;
+	uint8_t *			p_data;
+	i2c_bus_cb_t		p_cb;
+	void *				p_arg;
+} i2c_bus_xfer_t;
+
+/* A transfer its caller collects with i2c_bus_poll(). Starts zeroed and is
+ * zeroed again when the result is returned */
+typedef struct
+{
+	void *				p_slot;		// NULL: not queued yet
+	uint32_t			start;		// HAL tick of the first call
+	bool				b_started;
+} i2c_bus_req_t;
+
+typedef struct
+{
+	uint32_t			xfers;
+	uint32_t			bytes;
+	uint32_t			errors;
+	uint32_t			dropped;		// No free slot: the caller tries again later
+	uint32_t			timeouts;		// Transfers past their deadline
+	uint32_t			retries;
+	uint32_t			recoveries;		// Bus clears
+	uint32_t			fast_fails;		// Refused: the device is backing off
+	uint32_t			depth;			// Queued + running now
+	uint32_t			depth_max;
+	uint32_t			busy_cycles;	// Bus in use, CPU cycles
+	uint32_t			window_start;	// Cycle counter at the last reset
+} i2c_bus_stats_t;
+
+/* Per-device counters. A device that fails I2C_BUS_CONFIG_FAIL_MAX times in a
+ * row is refused for I2C_BUS_CONFIG_BACKOFF_MS, then gets one more try */
+typedef struct
+{
+	uint16_t			address;		// 0: unused entry
+	uint8_t				fails;			// In a row
+	uint32_t			xfers;
+	uint32_t			errors;
+	uint32_t			retries;
+	uint32_t			timeouts;
+	uint32_t			down_until;		// HAL tick
+} i2c_bus_dev_t;
+
+/********************** external data declaration ****************************/
+extern i2c_bus_stats_t i2c_bus_stats[I2C_BUS_QTY];
+extern i2c_bus_dev_t i2c_bus_dev[I2C_BUS_QTY][I2C_BUS_CONFIG_DEVICES];
+
+/********************** external functions declaration ***********************/
+extern void i2c_bus_init(void);
+extern void i2c_bus_update(void);
+extern void i2c_bus_recover(i2c_bus_id_t bus);
+extern bool i2c_bus_submit(i2c_bus_id_t bus, const i2c_bus_xfer_t *p_xfer);
+extern bool i2c_bus_write(i2c_bus_id_t bus, uint16_t address, const uint8_t *p_data, uint16_t size);
+extern bool i2c_bus_mem_write(i2c_bus_id_t bus, uint16_t address, uint16_t mem_addr, const uint8_t *p_data, uint16_t size);
+extern HAL_StatusTypeDef i2c_bus_poll(i2c_bus_id_t bus, const i2c_bus_xfer_t *p_xfer, i2c_bus_req_t *p_req, uint32_t timeout_ms);
+extern HAL_StatusTypeDef i2c_bus_sync(i2c_bus_id_t bus, const i2c_bus_xfer_t *p_xfer, uint32_t timeout_ms);
+extern void i2c_bus_sync_end(void);
+extern i2c_bus_id_t i2c_bus_of(I2C_HandleTypeDef *hi2c);
+extern uint32_t i2c_bus_free(i2c_bus_id_t bus);
+extern uint32_t i2c_bus_util_pct(i2c_bus_id_t bus);
+extern void i2c_bus_stats_reset(void);
+extern void i2c_bus_report(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // I2C_BUS_H
+
+/********************** end of file ******************************************/
@@ -0,0 +1,65 @@
+/*
+ *
+ * @file   : init_seq.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef INIT_SEQ_H
+#define INIT_SEQ_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define INIT_SEQ_LANES_MAX		(5)
+#define INIT_SEQ_DONE			(-1)	// Lane return value: no more steps
+#define INIT_SEQ_AGAIN			(-2)	// Lane return value: same step on the next tick
+
+/********************** typedef **********************************************/
+/* A lane runs its step number 'step' and returns the mS to wait before the
+ * next one, INIT_SEQ_AGAIN or INIT_SEQ_DONE. Steps must be short: lanes
+ * interleave by tick. A step waiting on the bus (i2c_bus_poll()) returns
+ * INIT_SEQ_AGAIN, so it must not change anything before the transfer is done. */
+typedef int32_t (*init_seq_lane_t)(uint32_t step);
+
+typedef struct
+{
+	init_seq_lane_t		p_lane;
+	uint32_t			step;
+	uint32_t			next;		// Tick of the next step
+	uint32_t			done;		// Tick the lane finished at
+	bool				b_done;
+} init_seq_lane_dta_t;
+
+typedef struct
+{
+	init_seq_lane_dta_t	lane[INIT_SEQ_LANES_MAX];
+	uint32_t			qty;
+	uint32_t			tick;		// Ticks since init_seq_start()
+	bool				b_ready;
+	uint32_t			ready_ms;	// HAL_GetTick() when ready: time since reset
+} init_seq_t;
+
+/********************** external data declaration ****************************/
+extern init_seq_t init_seq;
+
+/********************** external functions declaration ***********************/
+extern void init_seq_start(const init_seq_lane_t *p_lanes, uint32_t qty);
+extern bool init_seq_update(void);
+extern void init_seq_report(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INIT_SEQ_H
+
+/********************** end of file ******************************************/
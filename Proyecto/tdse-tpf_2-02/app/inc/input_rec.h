@@ -0,0 +1,111 @@
+/*
+ *
+ * @file   : input_rec.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef INPUT_REC_H
+#define INPUT_REC_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define INPUT_REC_MODE_OFF				(0)
+#define INPUT_REC_MODE_RECORD			(1)	// Peripheral reads are logged to the ring
+#define INPUT_REC_MODE_REPLAY			(2)	// Peripheral reads are served from the stream
+
+#define INPUT_REC_CONFIG_MODE			INPUT_REC_MODE_OFF
+#define INPUT_REC_CONFIG_SIZE			(2048)	// Must be a power of two.
+#define INPUT_REC_CONFIG_FLUSH_TICKS	(1000ul)	// Periodic flush over the logger
+
+#define INPUT_REC_VERSION				(2)
+#define INPUT_REC_PORT_QTY				(8)
+#define INPUT_REC_PAYLOAD_MAX			(6)
+
+/********************** typedef **********************************************/
+/* Input channels. Values are part of the stream format (tools/rec2bin.py) */
+typedef enum {
+	INPUT_REC_CH_KEYPAD,		// keypad_get_char(), 1 byte
+	INPUT_REC_CH_ADC,			// LDR conversion, 2 bytes
+	INPUT_REC_CH_RFID_CARD,		// MFRC522_IsCardPoll() status, 1 byte
+	INPUT_REC_CH_RFID_SERIAL,	// MFRC522_ReadCardSerial() status + serial, 6 bytes
+	INPUT_REC_CH_RTC_DATE,		// DS3231_Get_Date(), 4 bytes
+	INPUT_REC_CH_RTC_TIME,		// DS3231_Get_Time(), 3 bytes
+	INPUT_REC_CH_PORT,			// GPIO IDR, 2 bytes (INPUT_REC_PORT_QTY channels)
+	INPUT_REC_CH_QTY = INPUT_REC_CH_PORT + INPUT_REC_PORT_QTY,
+	INPUT_REC_CH_END = INPUT_REC_CH_QTY	// Script: last step, the inputs are live again
+} input_rec_ch_t;
+
+#if INPUT_REC_MODE_OFF != INPUT_REC_CONFIG_MODE
+typedef enum {
+	INPUT_REC_ST_IDLE,
+	INPUT_REC_ST_RUN,
+	INPUT_REC_ST_OVERFLOW,		// Record: ring full, the stream is cut here
+	INPUT_REC_ST_DIVERGED,		// Replay: the firmware read other inputs than recorded
+	INPUT_REC_ST_DONE			// Replay: end of stream
+} input_rec_st_t;
+
+/* RAM image. In replay mode the debugger restores the stream into data[] and
+ * then writes its length (see app/readme.txt). */
+typedef struct
+{
+	uint32_t			mode;
+	input_rec_st_t		state;
+	volatile uint32_t	length;		// Replay: stream bytes in data[]
+	uint32_t			head;		// Bytes written (record) / consumed (replay)
+	uint32_t			tail;		// Bytes already flushed (record)
+	uint32_t			reads;		// Wrapped peripheral reads so far
+	uint32_t			skew_max;	// Replay: worst tick offset against the recording
+	uint8_t				data[INPUT_REC_CONFIG_SIZE];
+} input_rec_log_t;
+#endif
+
+/* Script step: from tick (since input_rec_script()) on, reads of ch return
+ * value, as the payload of a stream record. Steps go in tick order */
+typedef struct
+{
+	uint16_t	tick;
+	uint8_t		ch;
+	uint8_t		value[INPUT_REC_PAYLOAD_MAX];
+} input_rec_step_t;
+
+/********************** external data declaration ****************************/
+#if INPUT_REC_MODE_OFF != INPUT_REC_CONFIG_MODE
+extern input_rec_log_t input_rec_log;
+#endif
+
+/********************** external functions declaration ***********************/
+#if INPUT_REC_MODE_OFF != INPUT_REC_CONFIG_MODE
+extern void input_rec_init(void);
+#endif
+#if INPUT_REC_MODE_RECORD == INPUT_REC_CONFIG_MODE
+extern void input_rec_update(void);
+extern void input_rec_flush(void);
+#endif
+extern void input_rec_script(const input_rec_step_t *p_steps);
+extern bool input_rec_script_update(void);
+
+extern char input_rec_keypad(void);
+extern uint16_t input_rec_adc(void);
+extern uint8_t input_rec_rfid_card(uint8_t *p_tag_type);
+extern uint8_t input_rec_rfid_serial(uint8_t *p_serial);
+extern void input_rec_rtc_date(uint8_t *p_day, uint8_t *p_mth, uint8_t *p_year, uint8_t *p_dow);
+extern void input_rec_rtc_time(uint8_t *p_hr, uint8_t *p_min, uint8_t *p_sec);
+extern uint16_t input_rec_port(uint8_t id, GPIO_TypeDef *port);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INPUT_REC_H
+
+/********************** end of file ******************************************/
@@ -0,0 +1,75 @@
+/*
+ *
+ * @file   : latency.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define LATENCY_CONFIG_ENABLE			(1)
+#define LATENCY_CONFIG_TIMEOUT_US		(2000000ul)	// Spans longer than this are dropped
+#define LATENCY_CONFIG_REPORT_TICKS		(60000ul)	// Periodic report over the logger
+
+/* Histogram: 4 sub-buckets per power of two, from 1 uS up to ~2 S */
+#define LATENCY_SUB_BITS				(2)
+#define LATENCY_OCTAVES					(21)
+#define LATENCY_BUCKETS					(LATENCY_OCTAVES << LATENCY_SUB_BITS)
+
+#if 1 == LATENCY_CONFIG_ENABLE
+#define LATENCY_START(probe)	latency_start(probe)
+#define LATENCY_STOP(probe)		latency_stop(probe)
+#else
+#define LATENCY_START(probe)
+#define LATENCY_STOP(probe)
+#endif
+
+/********************** typedef **********************************************/
+/* Probe identifiers. Values are part of the trace dump (tools/trace2json.py) */
+typedef enum {
+	LAT_KEY_TO_LCD,			// Keypad key detected -> digit on the LCD (end of its I2C transfer)
+	LAT_PWD_TO_UNLOCK,		// Keypad key detected -> servo open (end of its DMA profile)
+	LAT_CARD_TO_UNLOCK,		// Card serial read -> servo open (end of its DMA profile)
+	LAT_QTY
+} latency_probe_t;
+
+typedef struct
+{
+	uint32_t	start;			// CYCCNT stamp of the open span
+	bool		open;
+	uint32_t	count;
+	uint32_t	dropped;		// Spans closed after LATENCY_CONFIG_TIMEOUT_US
+	uint32_t	min_us;
+	uint32_t	max_us;
+	uint16_t	bucket[LATENCY_BUCKETS];
+} latency_stats_t;
+
+/********************** external data declaration ****************************/
+extern latency_stats_t latency_stats[LAT_QTY];
+
+/********************** external functions declaration ***********************/
+extern void latency_init(void);
+extern void latency_start(latency_probe_t probe);
+extern void latency_stop(latency_probe_t probe);
+extern uint32_t latency_percentile_us(latency_probe_t probe, uint32_t percent);
+extern void latency_report(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LATENCY_H
+
+/********************** end of file ******************************************/
@@ -0,0 +1,72 @@
+/*
+ *
+ * @file   : lockout.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef LOCKOUT_H
+#define LOCKOUT_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define LOCKOUT_CONFIG_FREE			(3)			// Failures that only get the base wait
+#define LOCKOUT_CONFIG_BASE_MS		(2000ul)	// Wait after any failure
+#define LOCKOUT_CONFIG_MAX_MS		(900000ul)	// Longest lockout (15 min)
+#define LOCKOUT_CONFIG_DECAY_MS		(600000ul)	// Quiet time that forgives one failure
+#define LOCKOUT_CONFIG_SUBJECTS		(8)			// Cards / users with a counter of their own
+
+#define LOCKOUT_ANY					(0ul)		// No subject: the type counter only
+
+/********************** typedef **********************************************/
+/* Credential types, each with its own counter (kept in eeprom_emu) */
+typedef enum {
+	LOCKOUT_PIN,			// Wrong PIN at the door
+	LOCKOUT_CARD,			// Rejected card
+	LOCKOUT_OPT,			// Wrong or non-admin PIN at the options menu
+	LOCKOUT_QTY
+} lockout_type_t;
+
+typedef void (*lockout_cb_t)(void);
+
+typedef struct
+{
+	uint32_t	id;				// Card UID or PIN user, LOCKOUT_ANY: free
+	uint8_t		type;			// lockout_type_t
+	uint8_t		fails;
+	uint32_t	last;			// timer_service_now() of the last failure
+} lockout_subject_t;
+
+typedef struct
+{
+	uint32_t	failures;
+	uint32_t	locks;			// Waits longer than LOCKOUT_CONFIG_BASE_MS
+	uint32_t	lock_ms_max;
+	uint32_t	decays;			// Failures forgiven
+} lockout_stats_t;
+
+/********************** external data declaration ****************************/
+extern lockout_stats_t lockout_stats;
+
+/********************** external functions declaration ***********************/
+extern void lockout_init(lockout_cb_t p_done);
+extern uint32_t lockout_fail(lockout_type_t type, uint32_t id);
+extern void lockout_success(lockout_type_t type, uint32_t id);
+extern uint32_t lockout_remaining(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOCKOUT_H
+
+/********************** end of file ******************************************/
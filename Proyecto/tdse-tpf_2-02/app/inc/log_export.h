@@ -0,0 +1,72 @@
+/*
+ *
+ * @file   : log_export.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef LOG_EXPORT_H
+#define LOG_EXPORT_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define LOG_EXPORT_CONFIG_WINDOW	(8)			// Frames sent ahead of the host acks
+#define LOG_EXPORT_CONFIG_READS		(2)			// EEPROM reads in flight
+#define LOG_EXPORT_CONFIG_ACK_MS	(300ul)		// No ack: back to the first unacked frame
+#define LOG_EXPORT_CONFIG_RETRIES	(10)		// Timeouts in a row before giving up
+
+/* Frame: type, seq (16 bit), payload, CRC-32 of the previous bytes, all
+ * little endian, COBS encoded and ended by 0x00 (tools/log2csv.py). Host
+ * frames also start with 0x00: it takes the console out of text mode.
+ *  Host:   'L' start, 'A' ack (seq: next frame expected), 'X' abort
+ *  Device: 'H' {records (16 bit)}
+ *          'R' {index (16 bit), valid, day, month, year, hour, min, sec, who[8]}
+ *          'E' {records (16 bit)} */
+#define LOG_EXPORT_START			('L')
+#define LOG_EXPORT_ACK				('A')
+#define LOG_EXPORT_ABORT			('X')
+#define LOG_EXPORT_HEADER			('H')
+#define LOG_EXPORT_RECORD			('R')
+#define LOG_EXPORT_END				('E')
+
+#define LOG_EXPORT_FRAME_MAX		(32)		// Before COBS
+#define LOG_EXPORT_WHO_SIZE			(8)
+#define LOG_EXPORT_RECORD_SIZE		(9 + LOG_EXPORT_WHO_SIZE)	// Payload of an 'R' frame
+
+/********************** typedef **********************************************/
+typedef struct
+{
+	uint32_t	exports;		// Completed
+	uint32_t	aborts;			// By the host or after LOG_EXPORT_CONFIG_RETRIES
+	uint32_t	frames;
+	uint32_t	resends;		// Go-back after an ack timeout
+	uint32_t	bad_frames;		// From the host: bad COBS, size or CRC
+	uint32_t	last_ms;		// Duration of the last export
+} log_export_stats_t;
+
+/********************** external data declaration ****************************/
+extern log_export_stats_t log_export_stats;
+
+/********************** external functions declaration ***********************/
+extern void log_export_init(void);
+extern void log_export_update(void);
+extern void log_export_rx(const uint8_t *p_data, uint16_t size);
+extern bool log_export_busy(void);
+extern uint16_t log_export_pack(uint8_t *p, const uint8_t raw[], uint16_t index);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOG_EXPORT_H
+
+/********************** end of file ******************************************/
@@ -13,19 +13,34 @@
 extern "C" {
 #endif
 
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pin_hash.h"
+
+/********************** macros ***********************************************/
+/* Access records: "dd/mm/20yy | hh:mm:ss | who" and its '\0' */
+#define MEM_ACCESS_BASE		0x000F
+#define MEM_ACCESS_STRIDE	64
+#define MEM_ACCESS_QTY		5
+#define MEM_ACCESS_SIZE		33
+
 /********************** data types *******************************************/
 typedef enum {
     MEM_WRITE_PWD,
-    MEM_CLEAR,
-    MEM_WRITE_TIME,
     MEM_NO_WRITE
 } MEM_WriteType_t;
 
 /********************** external data declaration ****************************/
 extern MEM_WriteType_t MEM_WriteType;
+extern uint32_t mem_dropped;	// Records lost with the pending ring full
 
 /********************** external functions declaration ***********************/
-extern void handle_memory(uint32_t tick, MEM_WriteType_t type, char pwd[], uint8_t idx, char time_str[]);
+extern bool write_memory(uint16_t mem_addr, const uint8_t *p_data, uint16_t size);
+extern uint8_t pending_memory(void);
+extern void flush_memory(void);
+extern void handle_memory(uint32_t tick, MEM_WriteType_t type, const pin_hash_t *p_pwd);
 
 /********************** End of CPP guard *************************************/
 #ifdef __cplusplus
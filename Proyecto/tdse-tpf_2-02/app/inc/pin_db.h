@@ -0,0 +1,71 @@
+/*
+ *
+ * @file   : pin_db.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef PIN_DB_H
+#define PIN_DB_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pin_hash.h"
+
+/********************** macros ***********************************************/
+#define PIN_DB_CONFIG_USERS			(128)		// Records in the AT24 table
+#define PIN_DB_CONFIG_INDEX			(256)		// RAM index entries (power of 2)
+#define PIN_DB_CONFIG_PROBES		(8)			// Index entries checked by every lookup
+#define PIN_DB_CONFIG_BASE			(0x0400u)	// AT24: header, then the records
+
+#define PIN_DB_PIN_MAX				(5)			// Digits
+#define PIN_DB_MASTER				(0u)		// User id of the settings password
+#define PIN_DB_NONE					(0xFFFFu)
+
+/********************** typedef **********************************************/
+typedef enum {
+	PIN_ROLE_ADMIN,		// Door and options menu
+	PIN_ROLE_USER,		// Door
+	PIN_ROLE_TEMP,		// Door, a limited number of times
+	PIN_ROLE_QTY
+} pin_role_t;
+
+typedef struct
+{
+	uint16_t	users;
+	uint16_t	index_full;		// Users left out of the index (no entry within the probes)
+	uint32_t	lookups;
+	uint32_t	hits;
+} pin_db_stats_t;
+
+/********************** external data declaration ****************************/
+extern pin_db_stats_t pin_db_stats;
+
+/********************** external functions declaration ***********************/
+extern int32_t pin_db_init_lane(uint32_t step);
+extern bool pin_db_valid(const char *p_pin);
+extern uint16_t pin_db_find(const char *p_pin, uint8_t *p_role);
+extern uint16_t pin_db_add(const char *p_pin, pin_role_t role, uint16_t uses);
+extern bool pin_db_put(uint16_t user, pin_role_t role, uint16_t uses, uint32_t tag, const uint8_t digest[PIN_HASH_SIZE]);
+extern bool pin_db_remove(uint16_t user);
+extern void pin_db_used(uint16_t user);
+extern bool pin_db_flush(void);
+extern uint32_t pin_db_table_salt(void);
+extern bool pin_db_key(uint16_t user, uint32_t *p_tag, uint8_t digest[PIN_HASH_SIZE]);
+extern bool pin_db_info(uint16_t user, uint8_t *p_role, uint16_t *p_uses);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PIN_DB_H
+
+/********************** end of file ******************************************/
@@ -0,0 +1,60 @@
+/*
+ *
+ * @file   : pin_hash.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef PIN_HASH_H
+#define PIN_HASH_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define PIN_HASH_SIZE				(8)			// Digest bytes kept (SHA-256, truncated)
+#define PIN_HASH_PIN_MAX			(8)			// PINs are zero padded to this length
+
+/********************** typedef **********************************************/
+/* What is stored instead of a PIN */
+typedef struct
+{
+	uint32_t	salt;
+	uint8_t		digest[PIN_HASH_SIZE];
+} pin_hash_t;
+
+typedef struct
+{
+	uint32_t	attempts;
+	uint32_t	cycles_last;	// Whole attempt: every digest and compare
+	uint32_t	cycles_max;
+	uint32_t	over_budget;	// Attempts longer than one scheduler tick
+} pin_hash_stats_t;
+
+/********************** external data declaration ****************************/
+extern pin_hash_stats_t pin_hash_stats;
+
+/********************** external functions declaration ***********************/
+extern void pin_hash_init(void);
+extern uint32_t pin_hash_salt(void);
+extern uint32_t pin_hash_tag(uint32_t salt, const char *p_pin);
+extern void pin_hash_digest(uint32_t salt, const char *p_pin, uint8_t digest[PIN_HASH_SIZE]);
+extern void pin_hash_make(pin_hash_t *p_hash, const char *p_pin);
+extern bool pin_hash_equal(const uint8_t digest_a[PIN_HASH_SIZE], const uint8_t digest_b[PIN_HASH_SIZE]);
+extern bool pin_hash_verify(const pin_hash_t *p_hash, const char *p_pin);
+extern void pin_hash_cost(uint32_t cycles);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PIN_HASH_H
+
+/********************** end of file ******************************************/
@@ -0,0 +1,81 @@
+/*
+ *
+ * @file   : rs485_link.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef RS485_LINK_H
+#define RS485_LINK_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define RS485_LINK_CONFIG_BAUD		(230400ul)
+#define RS485_LINK_CONFIG_ADDRESS	(1)			// Until one is set (console: set rs485_addr)
+#define RS485_LINK_CONFIG_RX_TICK	(64)		// Input bytes handled per tick
+#define RS485_LINK_CONFIG_LOG_BATCH	(4)			// Access records per 'R' frame
+
+#define RS485_LINK_HEAD				(0x00)		// Address of the head-end
+#define RS485_LINK_NODE_MAX			(32)		// Node addresses: 1..RS485_LINK_NODE_MAX
+#define RS485_LINK_BROADCAST		(0xFF)
+
+/* Frame: dst, src, type, seq, payload, CRC-32 of the previous bytes, all
+ * little endian, COBS encoded between two 0x00 (tools/rs485_sim.py). A node
+ * only transmits to answer a frame addressed to it; the answer echoes seq.
+ *  'P' poll                            -> 'S' {head, users, log_next, state, lockout (s),
+ *                                              salt (32 bit), local, cards}
+ *  'C' {base, target, index (8 bit),   -> 'K' {head, local, staged (8 bit)}
+ *       count (8 bit), change}            (broadcast: staged, no answer)
+ *  'J' {since}                         -> 'L' {local, first, count (8 bit), count changes}
+ *  'G' {index, count (8 bit)}          -> 'R' {index, count (8 bit), count records of log_export_pack()}
+ * head and local are the credential store version vector (cred_store.h). A
+ * batch of count changes takes head from base to target, all or nothing;
+ * change is cred_store_pack(). 'J' returns the changes made at the door
+ * from version first on, past since + 1 if older ones are gone */
+#define RS485_LINK_POLL				('P')
+#define RS485_LINK_STATUS			('S')
+#define RS485_LINK_CRED				('C')
+#define RS485_LINK_CRED_ACK			('K')
+#define RS485_LINK_JOURNAL			('J')
+#define RS485_LINK_JOURNAL_DATA		('L')
+#define RS485_LINK_LOG				('G')
+#define RS485_LINK_LOG_DATA			('R')
+
+#define RS485_LINK_FRAME_MAX		(96)		// Before COBS
+
+/********************** typedef **********************************************/
+typedef struct
+{
+	uint32_t	rx_frames;		// Good frames for this node
+	uint32_t	bad_frames;		// Bad COBS, size or CRC
+	uint32_t	replies;
+	uint32_t	creds;			// Credential change frames
+	uint32_t	cred_stale;		// Changes for another head version
+	uint32_t	log_records;
+} rs485_link_stats_t;
+
+/********************** external data declaration ****************************/
+extern rs485_link_stats_t rs485_link_stats;
+
+/********************** external functions declaration ***********************/
+extern void rs485_link_init(void);
+extern void rs485_link_update(void);
+extern uint8_t rs485_link_address(void);
+extern void rs485_link_set_address(uint8_t address);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RS485_LINK_H
+
+/********************** end of file ******************************************/
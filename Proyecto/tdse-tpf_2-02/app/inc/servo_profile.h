@@ -0,0 +1,68 @@
+/*
+ *
+ * @file   : servo_profile.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef SERVO_PROFILE_H
+#define SERVO_PROFILE_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define SERVO_PROFILE_TRAPEZOID			(0)		// Constant acceleration ramps
+#define SERVO_PROFILE_SCURVE			(1)		// Smooth acceleration (quintic)
+
+#define SERVO_PROFILE_CONFIG_SHAPE		SERVO_PROFILE_SCURVE
+#define SERVO_PROFILE_CONFIG_OPEN_MS	(400ul)	// Full closed -> open travel time
+#define SERVO_PROFILE_CONFIG_CLOSE_MS	(600ul)	// Full open -> closed travel time
+
+#define SERVO_PROFILE_PERIOD_MS			(20ul)	// TIM1 update period: one compare value each
+#define SERVO_PROFILE_STEPS_MAX			(64)	// Longest move: 1.28 s
+
+#define SERVO_PROFILE_POS_CLOSED		(1000)	// TIM1 CH1 compare (uS)
+#define SERVO_PROFILE_POS_OPEN			(2000)
+
+/********************** typedef **********************************************/
+/* End of a move, from the DMA interrupt (from servo_profile_move() when
+ * there is nothing to move): keep it short */
+typedef void (*servo_profile_cb_t)(uint16_t target);
+
+typedef struct
+{
+	uint8_t				shape;
+	uint16_t			open_ms;
+	uint16_t			close_ms;
+	uint16_t			target;
+	uint16_t			qty;			// Compare values in table[]
+	volatile bool		busy;			// DMA is streaming table[] into CCR1
+	volatile bool		done;			// Set by the DMA interrupt, cleared by servo_profile_update()
+	servo_profile_cb_t	p_done;
+	uint16_t			table[SERVO_PROFILE_STEPS_MAX];
+} servo_profile_t;
+
+/********************** external data declaration ****************************/
+extern servo_profile_t servo_profile;
+
+/********************** external functions declaration ***********************/
+extern void servo_profile_init(servo_profile_cb_t p_done);
+extern void servo_profile_speed(uint16_t open_ms, uint16_t close_ms);
+extern void servo_profile_move(uint16_t target);
+extern void servo_profile_update(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERVO_PROFILE_H
+
+/********************** end of file ******************************************/
@@ -0,0 +1,72 @@
+/*
+ *
+ * @file   : settings.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pin_hash.h"
+
+/********************** macros ***********************************************/
+#define SETTINGS_VERSION			(2)
+#define SETTINGS_MAGIC				(0x5453u)	// "ST"
+
+/* AT24 map: the legacy header at 0x0000 (status[8] "written"/"notinit",
+ * password[6], entries) and the access records from 0x000F are untouched.
+ * Slots A/B sit past the records, one AT24 page each */
+#define SETTINGS_LEGACY_ADDR		(0x0000u)
+#define SETTINGS_SLOT_A_ADDR		(0x0200u)
+#define SETTINGS_SLOT_SIZE			(32u)
+#define SETTINGS_HEADER_SIZE		(8u)		// magic, version, size, seq
+#define SETTINGS_CRC_SIZE			(4u)
+
+#define SETTINGS_FLAG_WRITTEN		(0x01u)		// A password was set
+
+/********************** typedef **********************************************/
+/* Payload. New fields go at the end: a record from an older version has a
+ * smaller size and the missing fields keep their defaults */
+typedef struct
+{
+	char		password[6];	// Version 1 only, plain text: kept zeroed
+	uint8_t		saved_entries;
+	uint8_t		flags;
+	pin_hash_t	pwd;			// Version 2: salted digest of the password
+} settings_data_t;
+
+typedef struct
+{
+	uint32_t	loads;			// Slots found valid at boot
+	uint32_t	bad_slots;		// Bad magic, version or CRC
+	uint32_t	migrations;		// Loaded from the legacy layout or an older version
+	uint32_t	saves;
+	uint32_t	bytes;			// Bytes written by the diff writes
+} settings_stats_t;
+
+/********************** external data declaration ****************************/
+extern settings_data_t settings;
+extern settings_stats_t settings_stats;
+
+/********************** external functions declaration ***********************/
+extern HAL_StatusTypeDef settings_load(void);
+extern bool settings_save(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SETTINGS_H
+
+/********************** end of file ******************************************/
@@ -0,0 +1,37 @@
+/*
+ *
+ * @file   : sha256.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+
+/********************** macros ***********************************************/
+#define SHA256_SIZE		(32)		// Digest bytes
+
+/********************** typedef **********************************************/
+
+/********************** external data declaration ****************************/
+
+/********************** external functions declaration ***********************/
+/* FIPS 180-4 SHA-256, one call per message */
+extern void sha256(const void *p_data, uint32_t size, uint8_t digest[SHA256_SIZE]);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SHA256_H
+
+/********************** end of file ******************************************/
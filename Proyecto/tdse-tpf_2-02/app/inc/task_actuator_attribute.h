@@ -53,75 +53,73 @@ extern "C" {
  * 	| Current               | Event                 |                       | Next                  |                       |
  * 	| State                 | (Parameters)          | [Guard]               | State                 | Actions               |
  * 	|=======================+=======================+=======================+=======================+=======================|
- * 	| ST_LED_XX_OFF         | EV_LED_XX_OFF         |                       | ST_LED_XX_OFF		    |                       |
- * 	|                       |-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_LED_XX_ON          |                       | ST_LED_XX_ON		    | led = LED_ON          |
- * 	|                       |-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_LED_XX_BLINK       |                       | ST_LED_XX_BLINK_ON    | tick = tick_max       |
- * 	|                       |                       |                       |                       | led = LED_ON			|
- * 	|                       |-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_LED_XX_PULSE       |                       | ST_LED_XX_PULSE       | tick = tick_max       |
- * 	|                       |                       |                       |                       | led = LED_ON			|
- * 	|-----------------------+-----------------------+-----------------------+-----------------------+-----------------------|
- * 	| ST_LED_XX_ON          | EV_LED_XX_OFF         |                       | ST_LED_XX_OFF		    | led = LED_OFF         |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_LED_XX_ON          |                       | ST_LED_XX_ON          |                       |
- * 	|-----------------------+-----------------------+-----------------------+-----------------------+-----------------------|
- * 	| ST_LED_XX_BLINK_ON    | EV_LED_XX_OFF         |                       | ST_LED_XX_OFF         | led = LED_OFF         |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_LED_XX_ON          |                       | ST_LED_XX_ON		    | led = LED_ON          |
- * 	|                       |-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_LED_XX_NOT_BLINK   |                       | ST_LED_XX_OFF         | led = LED_OFF         |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_LED_XX_BLINK       |                       | ST_LED_XX_BLINK_ON    |                       |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       |                       | [tick >  0]           | ST_LED_XX_BLINK_ON    | tick--                |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       |                       | [tick == 0]           | ST_LED_XX_BLINK_OFF   | tick = tick_max       |
- * 	|                       |                       |                       |                       | led = LED_OFF         |
- * 	|-----------------------+-----------------------+-----------------------+-----------------------+-----------------------|
- * 	| ST_LED_XX_BLINK_OFF   | EV_LED_XX_OFF         |                       | ST_LED_XX_OFF         | led = LED_OFF         |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_LED_XX_ON          |                       | ST_LED_XX_ON		    | led = LED_ON          |
- * 	|                       |-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_LED_XX_NOT_BLINK   |                       | ST_LED_XX_OFF         | led = LED_OFF         |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_LED_XX_BLINK       |                       | ST_LED_XX_BLINK_OFF   |                       |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       |                       | [tick >  0]           | ST_LED_XX_BLINK_OFF   | tick--                |
+ * 	| ST_ACT_XX_OFF         | EV_ACT_XX_OFF         |                       | ST_ACT_XX_OFF         | act = OFF             |
+ * 	| ST_ACT_XX_ON          | EV_ACT_XX_NOT_BLINK   |                       |                       |                       |
+ * 	| ST_ACT_XX_SQUARE      +-----------------------+-----------------------+-----------------------+-----------------------|
+ * 	| ST_ACT_XX_PATTERN     | EV_ACT_XX_ON          |                       | ST_ACT_XX_ON          | act = ON              |
  * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       |                       | [tick == 0]           | ST_LED_XX_BLINK_ON    | tick = tick_max       |
- * 	|                       |                       |                       |                       | led = LED_ON          |
+ * 	|                       | EV_ACT_XX_BLINK ..    | [endless on/off]      | ST_ACT_XX_SQUARE      | act = square (TIM2)   |
+ * 	|                       | EV_ACT_XX_HELD_OPEN   +-----------------------+-----------------------+-----------------------|
+ * 	|                       |                       | [else]                | ST_ACT_XX_PATTERN     | step = 0              |
+ * 	|                       |                       |                       |                       | act = step level      |
+ * 	|                       |                       |                       |                       | deadline = now + dur  |
  * 	|-----------------------+-----------------------+-----------------------+-----------------------+-----------------------|
- * 	| ST_LED_XX_PULSE       | EV_LED_XX_OFF         |                       | ST_LED_XX_OFF         | led = LED_OFF         |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_LED_XX_ON          |                       | ST_LED_XX_ON		    | led = LED_ON          |
- * 	|                       |-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       |                       | [tick >  0]           | ST_LED_XX_PULSE       | tick--                |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       |                       | [tick == 0]           | ST_LED_XX_OFF         | tick = tick_max       |
- * 	|                       |                       |                       |                       | led = LED_OFF         |
+ * 	| ST_ACT_XX_PATTERN     | [now == deadline]     | [more steps/repeats]  | ST_ACT_XX_PATTERN     | step++                |
+ * 	|                       |                       |                       |                       | act = step level      |
+ * 	|                       |                       |                       |                       | deadline = now + dur  |
+ * 	|                       |                       +-----------------------+-----------------------+-----------------------|
+ * 	|                       |                       | [last step & repeat]  | ST_ACT_XX_OFF         | act = OFF             |
  * 	------------------------+-----------------------+-----------------------+-----------------------+------------------------
+ *
+ * Patterns are flash tables of (level, duration) steps with a repeat count
+ * (0 = forever). An endless on/off pair (blink, low battery) is handed to the
+ * TIM2 compare engine as a square wave, so its timing does not depend on the
+ * task loop. The others share one next deadline: a tick without an event and
+ * before that deadline does no work per actuator.
  */
 
-/* Events to excite Task Actuator */
+/* Events to excite Task Actuator. From EV_ACT_XX_BLINK on, each event names a pattern */
 typedef enum task_actuator_ev {EV_ACT_XX_OFF,
 							   EV_ACT_XX_ON,
 							   EV_ACT_XX_NOT_BLINK,
 							   EV_ACT_XX_BLINK,
 							   EV_ACT_XX_FAST_BLINK,
-							   EV_ACT_XX_PULSE} task_actuator_ev_t;
+							   EV_ACT_XX_PULSE,
+							   EV_ACT_XX_CHIRP,			// Access granted
+							   EV_ACT_XX_SIREN,			// Alarm
+							   EV_ACT_XX_LOW_BAT,		// Low battery
+							   EV_ACT_XX_HELD_OPEN,		// Door held open
+							   EV_ACT_XX_QTY} task_actuator_ev_t;
 
 /* States of Task Actuator */
 typedef enum task_actuator_st {ST_ACT_XX_OFF,
 							   ST_ACT_XX_ON,
-							   ST_ACT_XX_BLINK,
-							   ST_ACT_XX_FAST_BLINK,
-							   ST_ACT_XX_PULSE} task_actuator_st_t;
+							   ST_ACT_XX_SQUARE,		// Endless on/off pattern, run by TIM2
+							   ST_ACT_XX_PATTERN} task_actuator_st_t;
 
 /* Identifier of Task Actuator */
 typedef enum task_actuator_id {ID_LED_1, ID_LED_2, ID_LED_3, ID_BUZ} task_actuator_id_t;
 
+/* Output level of a pattern step */
+typedef enum task_actuator_lvl {LVL_ACT_OFF,
+								LVL_ACT_ON,
+								LVL_ACT_DIM,			// value = duty (%)
+								LVL_ACT_TONE} task_actuator_lvl_t;	// value = frequency / 10 (Hz)
+
+typedef struct
+{
+	uint8_t				level;		// task_actuator_lvl_t
+	uint8_t				value;
+	uint16_t			duration;	// Ticks (mS)
+} task_actuator_step_t;
+
+typedef struct
+{
+	const task_actuator_step_t *	p_step;
+	uint8_t							qty;
+	uint8_t							repeat;		// 0 = forever
+} task_actuator_pattern_t;
+
 typedef struct
 {
 	task_actuator_id_t	identifier;
@@ -129,20 +127,22 @@ typedef struct
 	uint16_t			pin;
 	GPIO_PinState		act_on;
 	GPIO_PinState		act_off;
-	uint32_t			tick_blink;
-	uint32_t			tick_pulse;
 } task_actuator_cfg_t;
 
 typedef struct
 {
-	uint32_t			tick;
 	task_actuator_st_t	state;
 	task_actuator_ev_t	event;
 	bool				flag;
+	const task_actuator_pattern_t *	p_pattern;
+	uint8_t				step;
+	uint8_t				repeat;		// Runs left, 0 = forever
+	uint32_t			deadline;	// End of the current step
 } task_actuator_dta_t;
 
 /********************** external data declaration ****************************/
 extern task_actuator_dta_t task_actuator_dta_list[];
+extern volatile uint32_t g_task_actuator_pending;	// One bit per actuator with an event
 
 /********************** external functions declaration ***********************/
 
@@ -48,51 +48,30 @@ extern "C" {
 /********************** macros ***********************************************/
 
 /********************** typedef **********************************************/
-/* Sensor Statechart - State Transition Table */
-/* 	------------------------+-----------------------+-----------------------+-----------------------+------------------------
- * 	| Current               | Event                 |                       | Next                  |                       |
- * 	| State                 | (Parameters)          | [Guard]               | State                 | Actions               |
- * 	|=======================+=======================+=======================+=======================+=======================|
- * 	| ST_BTN_XX_UP          | EV_BTN_XX_UP          |                       | ST_BTN_XX_UP          |                       |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_BTN_XX_DOWN        |                       | ST_BTN_XX_FALLING     | tick = TICK_MAX       |
- * 	|-----------------------+-----------------------+-----------------------+-----------------------+-----------------------|
- * 	| ST_BTN_XX_FALLING     | EV_BTN_XX_UP          | [tick >  0]           | ST_BTN_XX_FALLING     | tick--                |
- * 	|                       |                       +-----------------------+-----------------------+-----------------------|
- * 	|                       |                       | [tick == 0]           | ST_BTN_XX_UP          |                       |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_BTN_XX_DOWN        | [tick >  0]           | ST_BTN_XX_FALLING     | tick--                |
- * 	|                       |                       +-----------------------+-----------------------+-----------------------|
- * 	|                       |                       | [tick == 0]           | ST_BTN_XX_DOWN        | put_event_task_system |
- * 	|                       |                       |                       |                       |  (event)              |
- * 	|-----------------------+-----------------------+-----------------------+-----------------------+-----------------------|
- *	| ST_BTN_XX_DOWN        | EV_BTN_XX_UP          |                       | ST_BTN_XX_RISING      | tick = TICK_MAX       |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_BTN_XX_DOWN        |                       | ST_BTN_XX_DOWN        |                       |
- * 	|-----------------------+-----------------------+-----------------------+-----------------------+-----------------------|
- * 	| ST_BTN_XX_RISING      | EV_BTN_XX_UP          | [tick >  0]           | ST_BTN_XX_RISING      | tick--                |
- * 	|                       |                       +-----------------------+-----------------------+-----------------------|
- * 	|                       |                       | [tick == 0]           | ST_BTN_XX_UP          | put_event_task_system |
- * 	|                       |                       |                       |                       |  (event)              |
- * 	|                       +-----------------------+-----------------------+-----------------------+-----------------------|
- * 	|                       | EV_BTN_XX_DOWN        | [tick >  0]           | ST_BTN_XX_RISING      | tick--                |
- * 	|                       |						+-----------------------+-----------------------+-----------------------|
- * 	|                       |                       | [tick == 0]           | ST_BTN_XX_DOWN        |                       |
- * 	------------------------+-----------------------+-----------------------+-----------------------+------------------------
+/* Sensor debouncer - Vertical counters
+ *
+ * Inputs are grouped by GPIO port. Every DEL_BTN_XX_SAMPLE ticks each port is
+ * read once (IDR) and all its inputs are debounced in parallel: bit n of ct1:ct0
+ * is a 2-bit counter for pin n that runs while the pin differs from the
+ * debounced level and is reset when it matches again.
+ *
+ *	delta = level ^ state		pins that differ from the debounced level
+ *	ct0   = ~(ct0 & delta)		count down 3 -> 2 -> 1 -> 0, or reset to 3
+ *	ct1   = ct0 ^ (ct1 & delta)
+ *	delta = delta & ct0 & ct1	counter wrapped: 4 equal samples in a row
+ *	state = state ^ delta		toggle the debounced level
+ *
+ * Every bit set in the final delta is an edge: put_event_task_system(signal_down)
+ * when the input becomes pressed and put_event_task_system(signal_up) when it
+ * is released.
  */
 
 /* Events to excite Task Sensor */
 typedef enum task_sensor_ev {EV_BTN_XX_UP,
 							 EV_BTN_XX_DOWN} task_sensor_ev_t;
 
-/* States of Task Sensor */
-typedef enum task_sensor_st {ST_BTN_XX_UP,
-							 ST_BTN_XX_FALLING,
-							 ST_BTN_XX_DOWN,
-						     ST_BTN_XX_RISING} task_sensor_st_t;
-
 /* Identifier of Task Sensor */
-typedef enum task_sensor_id {ID_BTN} task_sensor_id_t;
+typedef enum task_sensor_id {ID_BTN, ID_DOOR} task_sensor_id_t;
 
 typedef struct
 {
@@ -100,18 +79,26 @@ typedef struct
 	GPIO_TypeDef *		gpio_port;
 	uint16_t			pin;
 	GPIO_PinState		pressed;
-	uint32_t			tick_max;
 	task_sensor_ev_t	signal_up;
 	task_sensor_ev_t	signal_down;
 } task_sensor_cfg_t;
 
 typedef struct
 {
-	uint32_t			tick;
-	task_sensor_st_t	state;
-	task_sensor_ev_t	event;
+	task_sensor_ev_t	event;		// Debounced level
 } task_sensor_dta_t;
 
+/* One entry per GPIO port with at least one input */
+typedef struct
+{
+	GPIO_TypeDef *		gpio_port;
+	uint16_t			mask;		// Pins debounced on this port
+	uint16_t			invert;		// Pins pressed at GPIO_PIN_RESET
+	uint16_t			ct0;		// Vertical counter, low bits
+	uint16_t			ct1;		// Vertical counter, high bits
+	uint16_t			state;		// Debounced levels, 1 = pressed
+} task_sensor_port_t;
+
 /********************** external data declaration ****************************/
 
 /********************** external functions declaration ***********************/
@@ -44,6 +44,7 @@ extern "C" {
 #endif
 
 /********************** inclusions *******************************************/
+#include "pin_hash.h"
 
 /********************** macros ***********************************************/
 
@@ -63,7 +64,20 @@ extern "C" {
 
 /* Events to excite Task System */
 typedef enum task_system_ev {EV_SYS_XX_BTN_IDLE,
-							 EV_SYS_XX_BTN_ACTIVE} task_system_ev_t;
+							 EV_SYS_XX_BTN_ACTIVE,
+							 EV_SYS_XX_LOCK_OPENED,		// Servo profile finished (servo_profile.c)
+							 EV_SYS_XX_LOCK_CLOSED,
+							 EV_SYS_XX_DOOR_TIMEOUT,	// TIMER_DOOR expired (timer_service.c)
+							 EV_SYS_XX_DOOR_OPENED,		// Door contact (optional, DOOR_1_CONNECTED)
+							 EV_SYS_XX_DOOR_CLOSED,
+							 EV_SYS_XX_LOCKOUT_END} task_system_ev_t;	// TIMER_LOCKOUT expired (lockout.c)
+
+/* Door cycle inside ST_SYS_OPEN_DOOR: unlock -> open window -> relock */
+typedef enum task_system_door {DOOR_UNLOCKING,		// Servo opening, window timer running
+							   DOOR_WINDOW,			// Unlocked, waiting for the door to open
+							   DOOR_OPEN,			// Door open (contact), held-open timer running
+							   DOOR_HELD_OPEN,		// Held-open alarm on, waiting for the door to close
+							   DOOR_RELOCKING} task_system_door_t;	// Servo closing, guard timer running
 
 /* State of Task System */
 typedef enum task_system_st {ST_SYS_INIT,
@@ -73,17 +87,21 @@ typedef enum task_system_st {ST_SYS_INIT,
 							 ST_SYS_OPT_PWD,
 							 ST_SYS_OPT_MENU,
 							 ST_SYS_OPEN_DOOR,
-							 ST_SYS_WAIT} task_system_st_t;
+							 ST_SYS_WAIT,
+							 ST_SYS_LOCKED} task_system_st_t;
 
 typedef struct
 {
-	char mem_status[8];
-	char password[6];
+	bool mem_written;			// A password is stored (settings.c)
+	pin_hash_t pwd;				// Salted digest of the settings password
 	bool system_status;
 	bool alarm_status;
 	bool ldr_mode;
 	uint8_t ldr_adj;
 	uint8_t saved_entries;
+	uint16_t door_window;		// mS unlocked before an unused door relocks
+	uint16_t door_held;			// mS open before the held-open alarm
+	uint16_t door_relock;		// mS allowed for the servo to report closed
 } system_parameters_t;
 
 typedef struct
@@ -97,6 +115,11 @@ typedef struct
 	task_system_ev_t	event;
 	bool				flag;
 	system_parameters_t system_parameters;
+	task_system_door_t	door;
+	uint32_t			door_cycles;		// Completed unlock/relock cycles
+	uint16_t			door_cycles_hour;	// Cycles in the last full hour
+	uint16_t			door_cycles_cnt;	// Cycles in the current hour
+	bool				rtc_present;		// DS3231 answered the bring-up probe
 } task_system_dta_t;
 
 /********************** external data declaration ****************************/
@@ -0,0 +1,60 @@
+/*
+ *
+ * @file   : timer_service.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+
+/********************** typedef **********************************************/
+/* Soft timers. Each user owns a fixed slot */
+typedef enum {
+	TIMER_DOOR,				// Door cycle: open window, held open, relock guard
+	TIMER_DOOR_STATS,		// Door cycles per hour (periodic)
+	TIMER_LOCKOUT,			// End of a wrong PIN / card lockout
+	TIMER_LOCKOUT_DECAY,	// Forgives old failures (periodic)
+	TIMER_QTY
+} timer_service_id_t;
+
+typedef void (*timer_service_cb_t)(void);
+
+typedef struct
+{
+	bool				active;
+	uint32_t			deadline;	// timer_service_now() at expiry
+	uint32_t			period;		// 0: one shot
+	timer_service_cb_t	p_cb;
+} timer_service_tmr_t;
+
+/********************** external data declaration ****************************/
+extern timer_service_tmr_t timer_service_list[TIMER_QTY];
+
+/********************** external functions declaration ***********************/
+extern void timer_service_init(void);
+extern void timer_service_start(timer_service_id_t id, uint32_t ms, uint32_t period_ms, timer_service_cb_t p_cb);
+extern void timer_service_stop(timer_service_id_t id);
+extern bool timer_service_active(timer_service_id_t id);
+extern uint32_t timer_service_now(void);
+extern void timer_service_update(void);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TIMER_SERVICE_H
+
+/********************** end of file ******************************************/
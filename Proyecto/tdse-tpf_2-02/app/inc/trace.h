@@ -0,0 +1,114 @@
+/*
+ *
+ * @file   : trace.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+
+/********************** macros ***********************************************/
+#define TRACE_CONFIG_ENABLE			(1)
+#define TRACE_CONFIG_RECORDS		(256)	// Must be a power of two.
+
+#define TRACE_MAGIC					(0x45435254ul)	// "TRCE"
+#define TRACE_VERSION				(1ul)
+
+/* Identifiers for TRACE_EV_ISR records */
+#define TRACE_ISR_SYSTICK			(0)
+
+/* Identifiers for TRACE_EV_I2C_* records */
+#define TRACE_I2C_BUS_1				(1)
+#define TRACE_I2C_BUS_2				(2)
+
+/* Packs an I2C device address and transfer length into a record argument */
+#define TRACE_I2C_ARG(addr, len)	((uint16_t)((((addr) & 0xFF) << 8) | (((len) > 0xFF) ? 0xFF : ((len) & 0xFF))))
+
+#if 1 == TRACE_CONFIG_ENABLE
+#define TRACE_TASK_ENTER(task)			trace_put(TRACE_EV_TASK_ENTER, (task), 0)
+#define TRACE_TASK_EXIT(task)			trace_put(TRACE_EV_TASK_EXIT, (task), 0)
+#define TRACE_SYS_PUT(event)			trace_put(TRACE_EV_SYS_PUT, 0, (event))
+#define TRACE_SYS_GET(event)			trace_put(TRACE_EV_SYS_GET, 0, (event))
+#define TRACE_ACT_PUT(act, event)		trace_put(TRACE_EV_ACT_PUT, (act), (event))
+#define TRACE_ACT_GET(act, event)		trace_put(TRACE_EV_ACT_GET, (act), (event))
+#define TRACE_STATE(from, to)			trace_put(TRACE_EV_STATE, (from), (to))
+#define TRACE_I2C_START(bus, addr, len)	trace_put(TRACE_EV_I2C_START, (bus), TRACE_I2C_ARG((addr), (len)))
+#define TRACE_I2C_END(bus, status)		trace_put(TRACE_EV_I2C_END, (bus), (status))
+#define TRACE_ISR(isr)					trace_put(TRACE_EV_ISR, (isr), 0)
+#define TRACE_LAT_START(probe)			trace_put(TRACE_EV_LAT_START, (probe), 0)
+#define TRACE_LAT_STOP(probe)			trace_put(TRACE_EV_LAT_STOP, (probe), 0)
+#else
+#define TRACE_TASK_ENTER(task)
+#define TRACE_TASK_EXIT(task)
+#define TRACE_SYS_PUT(event)
+#define TRACE_SYS_GET(event)
+#define TRACE_ACT_PUT(act, event)
+#define TRACE_ACT_GET(act, event)
+#define TRACE_STATE(from, to)
+#define TRACE_I2C_START(bus, addr, len)
+#define TRACE_I2C_END(bus, status)
+#define TRACE_ISR(isr)
+#define TRACE_LAT_START(probe)
+#define TRACE_LAT_STOP(probe)
+#endif
+
+/********************** typedef **********************************************/
+/* Record types. Values are part of the dump format read by tools/trace2json.py */
+typedef enum {
+	TRACE_EV_TASK_ENTER,
+	TRACE_EV_TASK_EXIT,
+	TRACE_EV_SYS_PUT,
+	TRACE_EV_SYS_GET,
+	TRACE_EV_ACT_PUT,
+	TRACE_EV_ACT_GET,
+	TRACE_EV_STATE,
+	TRACE_EV_I2C_START,
+	TRACE_EV_I2C_END,
+	TRACE_EV_ISR,
+	TRACE_EV_LAT_START,
+	TRACE_EV_LAT_STOP
+} trace_ev_t;
+
+typedef struct
+{
+	uint32_t	cycles;		// DWT CYCCNT at the time of the record
+	uint8_t		type;		// trace_ev_t
+	uint8_t		id;			// Task, actuator, bus or ISR identifier
+	uint16_t	arg;		// Event, state or packed I2C arguments
+} trace_record_t;
+
+/* RAM image dumped by the debugger (dump binary value trace.bin trace_log) */
+typedef struct
+{
+	uint32_t		magic;
+	uint32_t		version;
+	uint32_t		core_clock;
+	uint32_t		capacity;
+	volatile uint32_t	head;	// Total number of records written
+	trace_record_t	record[TRACE_CONFIG_RECORDS];
+} trace_log_t;
+
+/********************** external data declaration ****************************/
+extern trace_log_t trace_log;
+
+/********************** external functions declaration ***********************/
+extern void trace_init(void);
+extern void trace_put(trace_ev_t type, uint8_t id, uint16_t arg);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_H
+
+/********************** end of file ******************************************/
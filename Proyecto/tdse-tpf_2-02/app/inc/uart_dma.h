@@ -0,0 +1,62 @@
+/*
+ *
+ * @file   : uart_dma.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef UART_DMA_H
+#define UART_DMA_H
+
+/********************** CPP guard ********************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/********************** macros ***********************************************/
+#define UART_DMA_CONFIG_BAUD		(460800ul)
+#define UART_DMA_CONFIG_TX_SIZE		(512)		// TX ring (bytes)
+#define UART_DMA_CONFIG_RX_SIZE		(128)		// RX circular DMA buffer (bytes)
+#define UART_DMA_CONFIG_IRQ_PRIO	(5)
+
+/********************** typedef **********************************************/
+/* USART2 (PA2/PA3) is the ST-LINK virtual COM port of the Nucleo board.
+ * USART3 is remapped to PC10/PC11 (PB10/PB11 are I2C2) and drives an RS-485
+ * transceiver: DE (and /RE) on PC12, high while the port transmits */
+typedef enum {
+	UART_DMA_2,					// USART2, TX DMA1 channel 7, RX DMA1 channel 6
+	UART_DMA_3,					// USART3, TX DMA1 channel 2, RX DMA1 channel 3
+	UART_DMA_QTY
+} uart_dma_id_t;
+
+typedef struct
+{
+	uint32_t	tx_bytes;
+	uint32_t	rx_bytes;
+	uint32_t	tx_full;		// Writes refused: not enough room in the TX ring
+	uint32_t	rx_lost;		// USART overruns (RX bytes lost)
+} uart_dma_stats_t;
+
+/********************** external data declaration ****************************/
+extern uart_dma_stats_t uart_dma_stats[UART_DMA_QTY];
+
+/********************** external functions declaration ***********************/
+extern void uart_dma_init(uart_dma_id_t id, uint32_t baud);
+extern bool uart_dma_write(uart_dma_id_t id, const uint8_t *p_data, uint16_t size);
+extern uint16_t uart_dma_free(uart_dma_id_t id);
+extern uint16_t uart_dma_read(uart_dma_id_t id, uint8_t *p_data, uint16_t size);
+extern void uart_dma_tx_isr(uart_dma_id_t id);
+extern void uart_dma_usart_isr(uart_dma_id_t id);
+
+/********************** End of CPP guard *************************************/
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UART_DMA_H
+
+/********************** end of file ******************************************/
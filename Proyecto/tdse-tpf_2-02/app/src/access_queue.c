@@ -0,0 +1,181 @@
+/*
+ *
+ * @file   : access_queue.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "fmt.h"
+#include "memory_handler.h"
+#include "settings.h"
+#include "task_system_attribute.h"
+#include "access_queue.h"
+
+/********************** macros and definitions *******************************/
+#define ACCESS_QUEUE_RECORD_ADDR(entry)	(MEM_ACCESS_BASE + (MEM_ACCESS_STRIDE * ((entry) - 1)))
+
+/********************** internal data definition *****************************/
+/* Events wait here for the write_memory queue: a burst of accesses costs RAM,
+ * not records, and the log ring only ever keeps the last MEM_ACCESS_QTY */
+static access_event_t access_queue[ACCESS_QUEUE_CONFIG_QTY];
+static uint8_t access_queue_head;
+static uint8_t access_queue_qty;
+static uint8_t access_queue_unsaved;	// Records in the log, not in the entry count yet
+static uint8_t access_queue_wipe;		// Records left to blank, last first
+
+/********************** external data definition *****************************/
+access_queue_stats_t access_queue_stats;
+
+/********************** internal functions definition ************************/
+// Access record stored in the EEPROM: "dd/mm/20yy | hh:mm:ss | who" (32 chars).
+static void access_queue_record(char record[], const access_event_t *p_event)
+{
+	char *p = record;
+
+	p = fmt_dec(p, p_event->day, 2);
+	*p++ = '/';
+	p = fmt_dec(p, p_event->mth, 2);
+	p = fmt_str(p, "/20");
+	p = fmt_dec(p, p_event->year, 2);
+	p = fmt_str(p, " | ");
+	p = fmt_dec(p, p_event->hr, 2);
+	*p++ = ':';
+	p = fmt_dec(p, p_event->min, 2);
+	*p++ = ':';
+	p = fmt_dec(p, p_event->sec, 2);
+	p = fmt_str(p, " | ");
+	fmt_str(p, p_event->who);
+}
+
+static uint8_t access_queue_next_entry(void)
+{
+	uint8_t entry = task_system_dta.system_parameters.saved_entries;
+
+	return (MEM_ACCESS_QTY <= entry) ? 1 : (entry + 1);
+}
+
+static void access_queue_pop(void)
+{
+	task_system_dta.system_parameters.saved_entries = access_queue_next_entry();
+	access_queue_unsaved++;
+
+	access_queue_head = (access_queue_head + 1) % ACCESS_QUEUE_CONFIG_QTY;
+	access_queue_qty--;
+}
+
+// One record, in writes that stop at the AT24 page boundaries.
+static bool access_queue_write(uint8_t entry, const char record[])
+{
+	uint16_t addr = ACCESS_QUEUE_RECORD_ADDR(entry);
+	uint16_t done = 0;
+	uint16_t size;
+
+	while (MEM_ACCESS_SIZE > done)
+	{
+		size = ACCESS_QUEUE_CONFIG_PAGE - ((addr + done) % ACCESS_QUEUE_CONFIG_PAGE);
+		size = (size < (MEM_ACCESS_SIZE - done)) ? size : (MEM_ACCESS_SIZE - done);
+
+		if (!write_memory(addr + done, (const uint8_t*)&record[done], size))
+		{
+			return false;
+		}
+		done += size;
+	}
+
+	return true;
+}
+
+/********************** external functions definition ************************/
+// Access to log. With the queue full the oldest event goes: the log would
+// overwrite it with the ones after it anyway.
+void access_queue_put(const access_event_t *p_event)
+{
+	if (ACCESS_QUEUE_CONFIG_QTY <= access_queue_qty)
+	{
+		access_queue_head = (access_queue_head + 1) % ACCESS_QUEUE_CONFIG_QTY;
+		access_queue_qty--;
+		access_queue_stats.overflows++;
+	}
+
+	access_queue[(access_queue_head + access_queue_qty) % ACCESS_QUEUE_CONFIG_QTY] = *p_event;
+	access_queue_qty++;
+
+	access_queue_stats.events++;
+	if (access_queue_stats.depth_max < access_queue_qty)
+	{
+		access_queue_stats.depth_max = access_queue_qty;
+	}
+}
+
+// Every system tick, only with the write_memory queue empty: one record, or
+// the entry count once the batch is in the EEPROM (a reset in between loses
+// the records of the batch only). Events beyond the last MEM_ACCESS_QTY
+// take their entry without being written.
+void access_queue_update(void)
+{
+	char record[MEM_ACCESS_SIZE] = {0};
+
+	if (0 != pending_memory())
+	{
+		return;
+	}
+
+	if (0 != access_queue_wipe)
+	{
+		if (access_queue_write(access_queue_wipe, record) && (0 == --access_queue_wipe))
+		{
+			settings.saved_entries = 0;
+			settings_save();
+		}
+		return;
+	}
+
+	while (MEM_ACCESS_QTY < access_queue_qty)
+	{
+		access_queue_pop();
+		access_queue_stats.coalesced++;
+	}
+
+	if ((0 != access_queue_qty) && (MEM_ACCESS_QTY > access_queue_unsaved))
+	{
+		access_queue_record(record, &access_queue[access_queue_head]);
+		if (access_queue_write(access_queue_next_entry(), record))
+		{
+			access_queue_pop();
+			access_queue_stats.written++;
+		}
+		return;
+	}
+
+	if (0 != access_queue_unsaved)
+	{
+		settings.saved_entries = task_system_dta.system_parameters.saved_entries;
+		settings_save();
+		access_queue_unsaved = 0;
+		access_queue_stats.batches++;
+	}
+}
+
+// Admin only (console "log clear"): queued events are dropped, the records
+// blanked one per tick and the entry count saved as 0 after the last one.
+// Events from now on queue behind the wipe and start again at entry 1.
+void access_queue_clear(void)
+{
+	access_queue_head = 0;
+	access_queue_qty = 0;
+	access_queue_unsaved = 0;
+	access_queue_wipe = MEM_ACCESS_QTY;
+	task_system_dta.system_parameters.saved_entries = 0;
+	access_queue_stats.clears++;
+}
+
+uint8_t access_queue_depth(void)
+{
+	return access_queue_qty;
+}
+
+/********************** end of file ******************************************/
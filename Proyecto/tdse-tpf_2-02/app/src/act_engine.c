@@ -0,0 +1,193 @@
+/*
+ *
+ * @file   : act_engine.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "act_engine.h"
+
+/********************** macros and definitions *******************************/
+/* TIM2 counts at 1 MHz (prescaler 63) and wraps at 0xFFFF: compares are in uS */
+
+/********************** internal data definition *****************************/
+static const uint32_t act_engine_tim_ch[ACT_ENGINE_CHANNELS] = {
+	TIM_CHANNEL_1, TIM_CHANNEL_2, TIM_CHANNEL_3, TIM_CHANNEL_4
+};
+
+static const uint32_t act_engine_tim_it[ACT_ENGINE_CHANNELS] = {
+	TIM_IT_CC1, TIM_IT_CC2, TIM_IT_CC3, TIM_IT_CC4
+};
+
+/********************** external data definition *****************************/
+act_engine_ch_t act_engine_ch[ACT_ENGINE_CHANNELS];
+
+/********************** internal functions definition ************************/
+static void act_engine_write(act_engine_ch_t *p_ch)
+{
+	p_ch->gpio_port->BSRR = p_ch->level ? p_ch->bsrr_on : p_ch->bsrr_off;
+}
+
+// Moves the channel compare forward by the next chunk of the half cycle.
+static void act_engine_schedule(uint8_t ch, uint32_t from)
+{
+	act_engine_ch_t *p_ch = &act_engine_ch[ch];
+	uint32_t step = (p_ch->remaining_us > ACT_ENGINE_STEP_MAX) ? ACT_ENGINE_STEP_MAX : p_ch->remaining_us;
+
+	p_ch->remaining_us -= step;
+	__HAL_TIM_SET_COMPARE(&htim2, act_engine_tim_ch[ch], (from + step) & 0xFFFF);
+}
+
+// Called from the TIM2 compare interrupt: end of a chunk or of a half cycle.
+static void act_engine_isr(uint8_t ch)
+{
+	act_engine_ch_t *p_ch = &act_engine_ch[ch];
+
+	if (0 == p_ch->remaining_us)
+	{
+		p_ch->level = !p_ch->level;
+		act_engine_write(p_ch);
+		p_ch->remaining_us = p_ch->level ? p_ch->on_us : p_ch->off_us;
+	}
+
+	act_engine_schedule(ch, __HAL_TIM_GET_COMPARE(&htim2, act_engine_tim_ch[ch]));
+}
+
+static void act_engine_stop(uint8_t ch)
+{
+	__HAL_TIM_DISABLE_IT(&htim2, act_engine_tim_it[ch]);
+	__HAL_TIM_CLEAR_IT(&htim2, act_engine_tim_it[ch]);
+}
+
+/********************** external functions definition ************************/
+void act_engine_init(void)
+{
+	memset(act_engine_ch, 0, sizeof(act_engine_ch));
+
+	HAL_TIM_Base_Start(&htim2);
+}
+
+void act_engine_attach(uint8_t ch, GPIO_TypeDef *port, uint16_t pin, GPIO_PinState act_on)
+{
+	act_engine_ch_t *p_ch = &act_engine_ch[ch];
+
+	act_engine_stop(ch);
+
+	p_ch->gpio_port = port;
+	p_ch->bsrr_on = (GPIO_PIN_SET == act_on) ? pin : ((uint32_t)pin << 16);
+	p_ch->bsrr_off = (GPIO_PIN_SET == act_on) ? ((uint32_t)pin << 16) : pin;
+	p_ch->on_us = 0;
+	p_ch->level = false;
+	act_engine_write(p_ch);
+}
+
+// Static level; the channel interrupt is left off.
+void act_engine_level(uint8_t ch, bool on)
+{
+	act_engine_ch_t *p_ch = &act_engine_ch[ch];
+
+	act_engine_stop(ch);
+
+	p_ch->on_us = 0;
+	p_ch->level = on;
+	act_engine_write(p_ch);
+}
+
+// Square wave starting with the on half. Runs in the compare interrupt only,
+// so its timing does not depend on the task loop.
+void act_engine_square(uint8_t ch, uint32_t on_us, uint32_t off_us)
+{
+	act_engine_ch_t *p_ch = &act_engine_ch[ch];
+
+	if ((0 == on_us) || (0 == off_us))
+	{
+		act_engine_level(ch, (0 != on_us));
+		return;
+	}
+
+	act_engine_stop(ch);
+
+	p_ch->on_us = on_us;
+	p_ch->off_us = off_us;
+	p_ch->level = true;
+	p_ch->remaining_us = on_us;
+	act_engine_write(p_ch);
+
+	act_engine_schedule(ch, __HAL_TIM_GET_COUNTER(&htim2));
+	__HAL_TIM_ENABLE_IT(&htim2, act_engine_tim_it[ch]);
+}
+
+void act_engine_blink(uint8_t ch, uint32_t half_period_ms)
+{
+	act_engine_square(ch, half_period_ms * 1000, half_period_ms * 1000);
+}
+
+// Square wave at audio frequency (passive buzzer). 0 Hz silences the channel.
+void act_engine_tone(uint8_t ch, uint32_t hz)
+{
+	if (0 == hz)
+	{
+		act_engine_level(ch, false);
+		return;
+	}
+
+	act_engine_square(ch, 500000 / hz, 500000 / hz);
+}
+
+// Soft PWM at ACT_ENGINE_DIM_PERIOD_US; 0 and 100 are static levels.
+void act_engine_dim(uint8_t ch, uint8_t percent)
+{
+	if (percent >= 100)
+	{
+		act_engine_level(ch, true);
+		return;
+	}
+
+	act_engine_square(ch, (ACT_ENGINE_DIM_PERIOD_US / 100) * percent,
+					  (ACT_ENGINE_DIM_PERIOD_US / 100) * (100 - percent));
+}
+
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim)
+{
+	if (TIM2 != htim->Instance)
+	{
+		return;
+	}
+
+	switch (htim->Channel)
+	{
+		case HAL_TIM_ACTIVE_CHANNEL_1:
+
+			act_engine_isr(0);
+
+			break;
+
+		case HAL_TIM_ACTIVE_CHANNEL_2:
+
+			act_engine_isr(1);
+
+			break;
+
+		case HAL_TIM_ACTIVE_CHANNEL_3:
+
+			act_engine_isr(2);
+
+			break;
+
+		case HAL_TIM_ACTIVE_CHANNEL_4:
+
+			act_engine_isr(3);
+
+			break;
+
+		default:
+
+			break;
+	}
+}
+
+/********************** end of file ******************************************/
@@ -41,6 +41,15 @@
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "trace.h"
+#include "latency.h"
+#include "bench.h"
+#include "budget.h"
+#include "input_rec.h"
+#include "i2c_bus.h"
+#include "pin_hash.h"
+#include "log_export.h"
+#include "console.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
@@ -61,6 +70,7 @@ typedef struct {
 	void (*task_update)(void *);	// Pointer to task (must be a
 									// 'void (void *)' function)
 	void *parameters;				// Pointer to parameters
+	uint32_t budget_us;				// Time per tick (budget.c)
 } task_cfg_t;
 
 typedef struct {
@@ -69,9 +79,9 @@ typedef struct {
 
 /********************** internal data declaration ****************************/
 const task_cfg_t task_cfg_list[]	= {
-		{task_sensor_init, 		task_sensor_update, 	NULL},
-		{task_system_init, 		task_system_update, 	NULL},
-		{task_actuator_init,	task_actuator_update, 	NULL}
+		{task_sensor_init, 		task_sensor_update, 	NULL,	100ul},
+		{task_system_init, 		task_system_update, 	NULL,	650ul},
+		{task_actuator_init,	task_actuator_update, 	NULL,	150ul}
 };
 
 #define TASK_QTY	(sizeof(task_cfg_list)/sizeof(task_cfg_t))
@@ -107,6 +117,25 @@ void app_init(void)
 	/* Print out: Application execution counter */
 	LOGGER_LOG(" %s = %lu\r\n", GET_NAME(g_app_cnt), g_app_cnt);
 
+	/* Start the cycle counter before the tasks so init work is traced too */
+	cycle_counter_init();
+	trace_init();
+	latency_init();
+#if 1 == BENCH_CONFIG_ENABLE
+	bench_init();
+#endif
+	/* Before the tasks: their init lanes already go through the bus queues */
+	i2c_bus_init();
+	/* Needs the cycle counter: logs the cost of a PIN attempt */
+	pin_hash_init();
+	/* USART2 (ST-LINK virtual COM port): access log export */
+	log_export_init();
+	console_init();
+#if INPUT_REC_MODE_OFF != INPUT_REC_CONFIG_MODE
+	/* Replay blocks here until the debugger loads the stream */
+	input_rec_init();
+#endif
+
 	/* Go through the task arrays */
 	for (index = 0; TASK_QTY > index; index++)
 	{
@@ -117,7 +146,8 @@ void app_init(void)
 		task_dta_list[index].WCET = TASK_X_WCET_INI;
 	}
 
-	cycle_counter_init();
+	/* From the first tick on the tasks poll the bus queues, never spin on them */
+	i2c_bus_sync_end();
 
 	__asm("CPSID i");	/* disable interrupts*/
 	g_app_tick_cnt = G_APP_TICK_CNT_INI;
@@ -130,6 +160,7 @@ void app_init(void)
 void app_update(void)
 {
 	uint32_t index;
+	uint32_t cycle_counter_start;
 	uint32_t cycle_counter_time_us;
 
 	/* Check if it's time to run tasks */
@@ -141,15 +172,26 @@ void app_update(void)
     	g_app_cnt++;
     	g_app_time_us = 0;
 
+		budget_tick_begin();
+
+#if 1 == BENCH_CONFIG_ENABLE
+		bench_tick_begin();
+#endif
+
     	/* Go through the task arrays */
     	for (index = 0; TASK_QTY > index; index++)
     	{
-			cycle_counter_reset();
+			/* CYCCNT is free running (the trace timestamps rely on it) */
+			cycle_counter_start = cycle_counter_get();
+			TRACE_TASK_ENTER(index);
+			budget_task_begin(index, task_cfg_list[index].budget_us);
 
     		/* Run task_x_update */
 			(*task_cfg_list[index].task_update)(task_cfg_list[index].parameters);
 
-			cycle_counter_time_us = cycle_counter_time_us();
+			budget_task_end();
+			TRACE_TASK_EXIT(index);
+			cycle_counter_time_us = (cycle_counter_get() - cycle_counter_start) / cycles_per_us;
 
 			/* Update variables */
 	    	g_app_time_us += cycle_counter_time_us;
@@ -159,11 +201,40 @@ void app_update(void)
 				task_dta_list[index].WCET = cycle_counter_time_us;
 			}
 	    }
+
+		budget_tick_end();
+
+#if INPUT_REC_MODE_RECORD == INPUT_REC_CONFIG_MODE
+		input_rec_update();
+#endif
+
+#if 1 == BENCH_CONFIG_ENABLE
+		/* The benchmark windows own the latency histograms and report them */
+		bench_tick_end(g_app_tick_cnt);
+		bench_update();
+#elif 1 == LATENCY_CONFIG_ENABLE
+		/* Export end-to-end latency percentiles over the debug channel */
+		if (0 == (g_app_cnt % LATENCY_CONFIG_REPORT_TICKS))
+		{
+			latency_report();
+		}
+#endif
+
+#if 0 != I2C_BUS_CONFIG_REPORT_TICKS
+		/* Bus utilisation and queue depth over the last window */
+		if (0 == (g_app_cnt % I2C_BUS_CONFIG_REPORT_TICKS))
+		{
+			i2c_bus_report();
+			i2c_bus_stats_reset();
+		}
+#endif
     }
 }
 
 void HAL_SYSTICK_Callback(void)
 {
+	TRACE_ISR(TRACE_ISR_SYSTICK);
+
 	g_app_tick_cnt++;
 
 	g_task_sensor_tick_cnt++;
@@ -0,0 +1,302 @@
+/*
+ *
+ * @file   : bench.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "dwt.h"
+#include "fmt.h"
+#include "latency.h"
+#include "mfrc522.h"
+#include "input_rec.h"
+#include "bench.h"
+
+/********************** macros and definitions *******************************/
+#define BENCH_TICK_BUDGET	(cycles_per_us * 1000ul)	// One SysTick period
+
+/* Script steps, ticks from the start of the window */
+#define BENCH_KEY(t, k)		{(t), INPUT_REC_CH_KEYPAD, {(k)}}
+#define BENCH_ADC(t, v)		{(t), INPUT_REC_CH_ADC, {(v) & 0xFF, (v) >> 8}}
+#define BENCH_CARD(t, st)	{(t), INPUT_REC_CH_RFID_CARD, {(st)}}
+#define BENCH_SERIAL(t)		{(t), INPUT_REC_CH_RFID_SERIAL, {1, BENCH_CARD_UID, 0}}
+#define BENCH_END(t)		{(t), INPUT_REC_CH_END, {0}}
+
+/* "BENC": "cards add 42454E43" at the console benches the unlock path,
+ * without it the taps go the rejected card way */
+#define BENCH_CARD_UID		0x42, 0x45, 0x4E, 0x43
+
+/* One tap: found for a whole DEL_RFID_READ (400 mS), so read exactly once */
+#define BENCH_TAP(t)		BENCH_CARD(t, MFRC522_CARD_FOUND), BENCH_SERIAL(t), BENCH_CARD((t) + 400, MFRC522_CARD_NONE)
+
+/* Five digits and five erases, 30 mS apart */
+#define BENCH_BURST(t)		BENCH_KEY(t, '1'), BENCH_KEY((t) + 30, '2'), BENCH_KEY((t) + 60, '3'), \
+							BENCH_KEY((t) + 90, '4'), BENCH_KEY((t) + 120, '5'), BENCH_KEY((t) + 150, 'A'), \
+							BENCH_KEY((t) + 180, 'A'), BENCH_KEY((t) + 210, 'A'), BENCH_KEY((t) + 240, 'A'), \
+							BENCH_KEY((t) + 270, 'A')
+
+#define BENCH_WRONG(t)		BENCH_KEY(t, '0'), BENCH_KEY((t) + 100, '0'), BENCH_KEY((t) + 200, '0'), \
+							BENCH_KEY((t) + 300, '0'), BENCH_KEY((t) + 400, '0'), BENCH_KEY((t) + 500, 'D')
+
+/* Options password screen: C in, a digit, erased, C back */
+#define BENCH_MENU(t)		BENCH_KEY(t, 'C'), BENCH_KEY((t) + 200, '7'), BENCH_KEY((t) + 400, 'A'), \
+							BENCH_KEY((t) + 600, 'C')
+
+/********************** internal data definition *****************************/
+/* Short keys: every report line must fit in a console line */
+static const char *bench_scenario_name[BENCH_SC_QTY] = {
+	"free_run",
+	"pin_burst",
+	"card_taps",
+	"menu_nav",
+	"wrong_pin",
+	"ldr_flips"
+};
+
+static const input_rec_step_t bench_pin_burst[] = {
+	BENCH_BURST(0), BENCH_BURST(1000), BENCH_BURST(2000), BENCH_BURST(3000),
+	BENCH_END(5000)
+};
+
+static const input_rec_step_t bench_card_taps[] = {
+	BENCH_TAP(0), BENCH_TAP(2000), BENCH_TAP(4000), BENCH_TAP(6000), BENCH_TAP(8000),
+	BENCH_END(12000)
+};
+
+static const input_rec_step_t bench_menu_nav[] = {
+	BENCH_MENU(0), BENCH_MENU(1000), BENCH_MENU(2000), BENCH_MENU(3000),
+	BENCH_END(5000)
+};
+
+/* Three failures, 2 S apart: the back-off of lockout.c */
+static const input_rec_step_t bench_wrong_pin[] = {
+	BENCH_WRONG(0), BENCH_WRONG(2000), BENCH_WRONG(4000),
+	BENCH_END(8000)
+};
+
+/* The LDR is read every DEL_ADC_READ (5 S): each level is held past a read */
+static const input_rec_step_t bench_ldr_flips[] = {
+	BENCH_ADC(0, 4000), BENCH_ADC(6000, 0), BENCH_ADC(12000, 4000), BENCH_ADC(18000, 0),
+	BENCH_END(24000)
+};
+
+/* Indexed by bench_scenario_t */
+static const input_rec_step_t * const bench_script[BENCH_SC_QTY] = {
+	NULL,
+	bench_pin_burst,
+	bench_card_taps,
+	bench_menu_nav,
+	bench_wrong_pin,
+	bench_ldr_flips
+};
+
+/********************** external data definition *****************************/
+bench_t bench;
+bench_result_t bench_result;
+
+/********************** internal functions definition ************************/
+// Snapshot of the window: the console prints it while the next one runs.
+static void bench_report(void)
+{
+	uint32_t index;
+
+	if (0 == bench.ticks)
+	{
+		return;
+	}
+
+	bench_result.window++;
+	bench_result.scenario = bench.scenario;
+	bench_result.ticks = bench.ticks;
+	bench_result.cycles_avg = (uint32_t)(bench.cycles_sum / bench.ticks);
+	bench_result.cycles_max = bench.cycles_max;
+	bench_result.overruns = bench.overruns;
+	bench_result.overrun_max_us = bench.overrun_max / cycles_per_us;
+	bench_result.backlog_max = bench.backlog_max;
+
+	for (index = 0; BENCH_I2C_BUSES > index; index++)
+	{
+		bench_result.i2c_bytes[index] = bench.i2c[index].bytes;
+		bench_result.i2c_busy_us[index] = bench.i2c[index].busy_cycles / cycles_per_us;
+	}
+
+	for (index = 0; LAT_QTY > index; index++)
+	{
+		bench_result.lat_count[index] = latency_stats[index].count;
+		bench_result.lat_p50_us[index] = latency_percentile_us(index, 50);
+		bench_result.lat_p99_us[index] = latency_percentile_us(index, 99);
+	}
+}
+
+static char *bench_field(char *p, const char *p_key, uint32_t value)
+{
+	p = fmt_str(p, p_key);
+
+	return fmt_dec(p, value, 1);
+}
+
+/********************** external functions definition ************************/
+void bench_init(void)
+{
+	bench_begin(BENCH_SC_FREE_RUN);
+}
+
+// Opens a measurement window. The latency histograms belong to the window,
+// and so does the input script of the scenario.
+void bench_begin(bench_scenario_t scenario)
+{
+	memset(&bench, 0, sizeof(bench));
+	bench.scenario = scenario;
+	bench.request = scenario;
+
+	latency_init();
+	input_rec_script(bench_script[scenario]);
+}
+
+void bench_end(void)
+{
+	bench_report();
+}
+
+void bench_tick_begin(void)
+{
+	bench.tick_start = cycle_counter_get();
+}
+
+// Accounts one app_update() tick. backlog = ticks still pending after it.
+void bench_tick_end(uint32_t backlog)
+{
+	uint32_t cycles = cycle_counter_get() - bench.tick_start;
+
+	bench.ticks++;
+	bench.cycles_sum += cycles;
+
+	if (cycles > bench.cycles_max)
+	{
+		bench.cycles_max = cycles;
+	}
+
+	if (cycles > BENCH_TICK_BUDGET)
+	{
+		bench.overruns++;
+
+		if ((cycles - BENCH_TICK_BUDGET) > bench.overrun_max)
+		{
+			bench.overrun_max = cycles - BENCH_TICK_BUDGET;
+		}
+	}
+
+	if (backlog > bench.backlog_max)
+	{
+		bench.backlog_max = backlog;
+	}
+}
+
+// Closes the window when a new scenario is requested, the free-running
+// window is complete or the script of the scenario is over; a scenario is
+// followed by free running.
+void bench_update(void)
+{
+	bench_scenario_t request = bench.request;
+
+	if ((BENCH_SC_QTY <= request) || (request == bench.scenario))
+	{
+		request = BENCH_SC_FREE_RUN;
+
+		if (BENCH_SC_FREE_RUN == bench.scenario)
+		{
+			if (BENCH_CONFIG_WINDOW_TICKS > bench.ticks)
+			{
+				return;
+			}
+		}
+		else if (input_rec_script_update())
+		{
+			return;
+		}
+	}
+
+	bench_end();
+	bench_begin(request);
+}
+
+void bench_i2c_start(uint8_t bus, uint32_t len)
+{
+	bench.i2c[bus - 1].bytes += len;
+	bench.i2c[bus - 1].start = cycle_counter_get();
+}
+
+void bench_i2c_end(uint8_t bus)
+{
+	bench.i2c[bus - 1].busy_cycles += cycle_counter_get() - bench.i2c[bus - 1].start;
+}
+
+// BENCH_SC_QTY if no scenario has that name.
+bench_scenario_t bench_scenario_find(const char *p_name)
+{
+	uint32_t index;
+
+	for (index = 0; BENCH_SC_QTY > index; index++)
+	{
+		if (0 == strcmp(p_name, bench_scenario_name[index]))
+		{
+			break;
+		}
+	}
+
+	return (bench_scenario_t)index;
+}
+
+// Line 'line' (< BENCH_LINES) of the last window report, one JSON object
+// each; tools/bench_compare.py merges them per scenario. NULL past the last
+// line or before the first window.
+char *bench_line(char *p, uint8_t line)
+{
+	uint32_t index;
+
+	if ((0 == bench_result.window) || (BENCH_LINES <= line))
+	{
+		return NULL;
+	}
+
+	p = fmt_str(p, "{\"s\":\"");
+	p = fmt_str(p, bench_scenario_name[bench_result.scenario]);
+	p = fmt_str(p, "\"");
+
+	if (0 == line)
+	{
+		p = bench_field(p, ",\"n\":", bench_result.ticks);
+		p = bench_field(p, ",\"cyc\":[", bench_result.cycles_avg);
+		p = bench_field(p, ",", bench_result.cycles_max);
+		p = fmt_str(p, "]");
+	}
+	else if (1 == line)
+	{
+		p = bench_field(p, ",\"ovr\":[", bench_result.overruns);
+		p = bench_field(p, ",", bench_result.overrun_max_us);
+		p = bench_field(p, "],\"blog\":", bench_result.backlog_max);
+	}
+	else if ((2 + BENCH_I2C_BUSES) > line)
+	{
+		index = line - 2;
+		p = bench_field(p, ",\"i2c\":", index + 1);
+		p = bench_field(p, ",\"b\":", bench_result.i2c_bytes[index]);
+		p = bench_field(p, ",\"us\":", bench_result.i2c_busy_us[index]);
+	}
+	else
+	{
+		index = line - 2 - BENCH_I2C_BUSES;
+		p = bench_field(p, ",\"l\":", index);
+		p = bench_field(p, ",\"n\":", bench_result.lat_count[index]);
+		p = bench_field(p, ",\"p50\":", bench_result.lat_p50_us[index]);
+		p = bench_field(p, ",\"p99\":", bench_result.lat_p99_us[index]);
+	}
+
+	return fmt_str(p, "}");
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,106 @@
+/*
+ *
+ * @file   : budget.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include "main.h"
+#include "dwt.h"
+#include "budget.h"
+
+/********************** macros and definitions *******************************/
+#define BUDGET_NO_TASK		(0xFFu)
+
+/********************** internal data definition *****************************/
+static uint32_t budget_tick_start;
+static uint32_t budget_task_start;
+static uint32_t budget_task_cycles;		// Allotment of the running task, capped by the tick
+static uint8_t budget_task = BUDGET_NO_TASK;
+
+/********************** external data definition *****************************/
+budget_stats_t budget_stats;
+
+/********************** external functions definition ************************/
+void budget_tick_begin(void)
+{
+	budget_tick_start = cycle_counter_get();
+}
+
+void budget_tick_end(void)
+{
+	uint32_t cycles = cycle_counter_get() - budget_tick_start;
+
+	if (budget_stats.tick_max < cycles)
+	{
+		budget_stats.tick_max = cycles;
+	}
+}
+
+// The task gets allot_us, or what is left of the tick if less: a task after
+// one that overran gets nothing and does one step of each job.
+void budget_task_begin(uint8_t task, uint32_t allot_us)
+{
+	uint32_t tick_cycles = BUDGET_CONFIG_TICK_US * cycles_per_us;
+	uint32_t used;
+
+	budget_task_start = cycle_counter_get();
+	budget_task = (BUDGET_CONFIG_TASKS > task) ? task : BUDGET_NO_TASK;
+
+	used = budget_task_start - budget_tick_start;
+	budget_task_cycles = allot_us * cycles_per_us;
+	if (used >= tick_cycles)
+	{
+		budget_task_cycles = 0;
+	}
+	else if ((tick_cycles - used) < budget_task_cycles)
+	{
+		budget_task_cycles = tick_cycles - used;
+	}
+
+	if (BUDGET_NO_TASK != budget_task)
+	{
+		budget_stats.task[task].allot = allot_us * cycles_per_us;
+	}
+}
+
+void budget_task_end(void)
+{
+	budget_task_t *p_task;
+	uint32_t cycles = cycle_counter_get() - budget_task_start;
+
+	if (BUDGET_NO_TASK != budget_task)
+	{
+		p_task = &budget_stats.task[budget_task];
+
+		if (p_task->cycles_max < cycles)
+		{
+			p_task->cycles_max = cycles;
+		}
+		if (p_task->allot < cycles)
+		{
+			p_task->overruns++;
+		}
+	}
+
+	budget_task = BUDGET_NO_TASK;
+}
+
+// Cycles the running task has left this tick. Long jobs do a step while
+// there are enough for it and go on from there next tick.
+uint32_t budget_remaining_cycles(void)
+{
+	uint32_t used;
+
+	if (BUDGET_NO_TASK == budget_task)
+	{
+		return BUDGET_UNLIMITED;
+	}
+
+	used = cycle_counter_get() - budget_task_start;
+
+	return (used < budget_task_cycles) ? (budget_task_cycles - used) : 0;
+}
+
+/********************** end of file ******************************************/
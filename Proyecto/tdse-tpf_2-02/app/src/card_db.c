@@ -0,0 +1,309 @@
+/*
+ *
+ * @file   : card_db.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "logger.h"
+#include "i2c_bus.h"
+#include "crc32.h"
+#include "init_seq.h"
+#include "memory_handler.h"
+#include "card_db.h"
+
+/********************** macros and definitions *******************************/
+#define CARD_DB_I2C_ADDRESS		(0xA0)
+#define CARD_DB_I2C_TIMEOUT		(50ul)
+#define CARD_DB_WRITE_CYCLE_MS	(5)
+
+/* AT24 map: one page of header (magic, version, CRC-32), then 8 byte
+ * records: UID (the 4 bytes read, first one most significant), state */
+#define CARD_DB_MAGIC			(0x4443u)	// "CD"
+#define CARD_DB_VERSION			(1)
+#define CARD_DB_HEADER_SIZE		(32u)
+#define CARD_DB_HEADER_USED		(8u)
+#define CARD_DB_RECORD_SIZE		(8u)
+#define CARD_DB_RECORDS_ADDR	(CARD_DB_CONFIG_BASE + CARD_DB_HEADER_SIZE)
+#define CARD_DB_TABLE_SIZE		(CARD_DB_CONFIG_CARDS * CARD_DB_RECORD_SIZE)
+#define CARD_DB_BURST			(64u)		// Load: records per read, 8
+#define CARD_DB_PAGE			(32u)		// Wipe: bytes per write
+
+#define CARD_DB_ACTIVE			(0xA5u)		// Anything else is a free record
+#define CARD_DB_OFS_STATE		(4u)
+#define CARD_DB_FREE			(0ul)		// UID of a free card id
+
+/********************** internal data definition *****************************/
+static uint32_t card_db_uid[CARD_DB_CONFIG_CARDS];
+static uint8_t card_db_dirty[CARD_DB_CONFIG_CARDS / 8];
+static bool card_db_wipe;
+static i2c_bus_req_t card_db_req;		// Init lane transfer
+
+/********************** external data definition *****************************/
+card_db_stats_t card_db_stats;
+
+/********************** internal functions definition ************************/
+static void card_db_record_dirty(uint16_t slot)
+{
+	card_db_dirty[slot / 8] |= (uint8_t)(1u << (slot % 8));
+}
+
+static bool card_db_record_write(uint16_t slot)
+{
+	uint8_t record[CARD_DB_RECORD_SIZE] = {0};
+
+	memcpy(&record[0], &card_db_uid[slot], 4);
+	record[CARD_DB_OFS_STATE] = (CARD_DB_FREE != card_db_uid[slot]) ? CARD_DB_ACTIVE : 0x00;
+
+	return write_memory(CARD_DB_RECORDS_ADDR + (slot * CARD_DB_RECORD_SIZE), record, sizeof(record));
+}
+
+static void card_db_load(const uint8_t record[], uint16_t slot)
+{
+	uint32_t uid;
+
+	memcpy(&uid, &record[0], 4);
+	if ((CARD_DB_ACTIVE != record[CARD_DB_OFS_STATE]) || (CARD_DB_FREE == uid))
+	{
+		return;
+	}
+
+	card_db_uid[slot] = uid;
+	card_db_stats.cards++;
+}
+
+static int32_t card_db_header(void)
+{
+	uint8_t header[CARD_DB_HEADER_USED];
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_HIGH, CARD_DB_I2C_ADDRESS, CARD_DB_CONFIG_BASE,
+						   I2C_MEMADD_SIZE_16BIT, sizeof(header), header, NULL, NULL};
+	HAL_StatusTypeDef status;
+	uint32_t crc;
+
+	if (HAL_BUSY == (status = i2c_bus_poll(I2C_BUS_2, &xfer, &card_db_req, CARD_DB_I2C_TIMEOUT)))
+	{
+		return INIT_SEQ_AGAIN;
+	}
+
+	if (HAL_OK != status)
+	{
+		/* No EEPROM: the card a new table starts with */
+		card_db_uid[0] = CARD_DB_CONFIG_SEED;
+		card_db_stats.cards = 1;
+		return INIT_SEQ_DONE;
+	}
+
+	memcpy(&crc, &header[4], 4);
+	card_db_wipe = !((header[0] | (header[1] << 8)) == CARD_DB_MAGIC && (CARD_DB_VERSION == header[2]) &&
+					 (crc32(header, 4) == crc));
+
+	return 0;
+}
+
+// false until the header write is done.
+static bool card_db_header_write(void)
+{
+	uint8_t header[CARD_DB_HEADER_USED];
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_WRITE, I2C_BUS_PRIO_HIGH, CARD_DB_I2C_ADDRESS, CARD_DB_CONFIG_BASE,
+						   I2C_MEMADD_SIZE_16BIT, sizeof(header), header, NULL, NULL};
+	uint32_t crc;
+
+	header[0] = (uint8_t)CARD_DB_MAGIC;
+	header[1] = (uint8_t)(CARD_DB_MAGIC >> 8);
+	header[2] = CARD_DB_VERSION;
+	header[3] = 0;
+	crc = crc32(header, 4);
+	memcpy(&header[4], &crc, 4);
+
+	return (HAL_BUSY != i2c_bus_poll(I2C_BUS_2, &xfer, &card_db_req, CARD_DB_I2C_TIMEOUT));
+}
+
+/********************** external functions definition ************************/
+// Init lane (init_seq), like pin_db_init_lane(): header, then one burst of
+// records per step. A new table is wiped first and gets the card that was
+// built in before the table existed.
+int32_t card_db_init_lane(uint32_t step)
+{
+	uint8_t buffer[CARD_DB_BURST];
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_HIGH, CARD_DB_I2C_ADDRESS, 0,
+						   I2C_MEMADD_SIZE_16BIT, CARD_DB_BURST, buffer, NULL, NULL};
+	HAL_StatusTypeDef status;
+	uint32_t index;
+
+	if (0 == step)
+	{
+		memset(card_db_uid, 0, sizeof(card_db_uid));
+		memset(card_db_dirty, 0, sizeof(card_db_dirty));
+		memset(&card_db_stats, 0, sizeof(card_db_stats));
+
+		return card_db_header();
+	}
+
+	if (card_db_wipe)
+	{
+		if ((step * CARD_DB_PAGE) > CARD_DB_TABLE_SIZE)
+		{
+			if (!card_db_header_write())
+			{
+				return INIT_SEQ_AGAIN;
+			}
+
+			card_db_wipe = false;
+
+			card_db_put(1, CARD_DB_CONFIG_SEED);
+
+			return INIT_SEQ_DONE;
+		}
+
+		memset(buffer, 0, CARD_DB_PAGE);
+		xfer.op = I2C_BUS_OP_MEM_WRITE;
+		xfer.mem_addr = CARD_DB_RECORDS_ADDR + ((step - 1) * CARD_DB_PAGE);
+		xfer.size = CARD_DB_PAGE;
+
+		return (HAL_BUSY == i2c_bus_poll(I2C_BUS_2, &xfer, &card_db_req, CARD_DB_I2C_TIMEOUT)) ? INIT_SEQ_AGAIN : CARD_DB_WRITE_CYCLE_MS;
+	}
+
+	xfer.mem_addr = CARD_DB_RECORDS_ADDR + ((step - 1) * CARD_DB_BURST);
+	if (HAL_BUSY == (status = i2c_bus_poll(I2C_BUS_2, &xfer, &card_db_req, CARD_DB_I2C_TIMEOUT)))
+	{
+		return INIT_SEQ_AGAIN;
+	}
+
+	if (HAL_OK == status)
+	{
+		for (index = 0; (CARD_DB_BURST / CARD_DB_RECORD_SIZE) > index; index++)
+		{
+			card_db_load(&buffer[index * CARD_DB_RECORD_SIZE], ((step - 1) * (CARD_DB_BURST / CARD_DB_RECORD_SIZE)) + index);
+		}
+	}
+
+	if ((step * CARD_DB_BURST) >= CARD_DB_TABLE_SIZE)
+	{
+		LOGGER_LOG("card db %u cards\r\n", card_db_stats.cards);
+		return INIT_SEQ_DONE;
+	}
+
+	return 0;
+}
+
+// Card id (1..CARD_DB_CONFIG_CARDS) of a UID, CARD_DB_NONE if unknown. The
+// whole table is compared every time.
+uint16_t card_db_find(uint32_t uid)
+{
+	uint16_t card = CARD_DB_NONE;
+	uint16_t slot;
+
+	for (slot = 0; CARD_DB_CONFIG_CARDS > slot; slot++)
+	{
+		card = ((CARD_DB_FREE != uid) && (uid == card_db_uid[slot])) ? (slot + 1) : card;
+	}
+
+	card_db_stats.lookups++;
+	if (CARD_DB_NONE != card)
+	{
+		card_db_stats.hits++;
+	}
+
+	return card;
+}
+
+// New card in the first free id; CARD_DB_NONE if known already or no room.
+uint16_t card_db_add(uint32_t uid)
+{
+	uint16_t slot;
+
+	if ((CARD_DB_FREE == uid) || (CARD_DB_NONE != card_db_find(uid)))
+	{
+		return CARD_DB_NONE;
+	}
+
+	for (slot = 0; CARD_DB_CONFIG_CARDS > slot; slot++)
+	{
+		if (CARD_DB_FREE == card_db_uid[slot])
+		{
+			card_db_put(slot + 1, uid);
+			return slot + 1;
+		}
+	}
+
+	return CARD_DB_NONE;
+}
+
+// Card pushed by the head-end (cred_store.c). Whatever the id held before
+// is replaced.
+bool card_db_put(uint16_t card, uint32_t uid)
+{
+	uint16_t slot = card - 1;
+
+	if ((0 == card) || (CARD_DB_CONFIG_CARDS < card) || (CARD_DB_FREE == uid))
+	{
+		return false;
+	}
+
+	if (CARD_DB_FREE == card_db_uid[slot])
+	{
+		card_db_stats.cards++;
+	}
+
+	card_db_uid[slot] = uid;
+	card_db_record_dirty(slot);
+
+	return true;
+}
+
+bool card_db_remove(uint16_t card)
+{
+	uint16_t slot = card - 1;
+
+	if ((0 == card) || (CARD_DB_CONFIG_CARDS < card) || (CARD_DB_FREE == card_db_uid[slot]))
+	{
+		return false;
+	}
+
+	card_db_uid[slot] = CARD_DB_FREE;
+	card_db_stats.cards--;
+	card_db_record_dirty(slot);
+
+	return true;
+}
+
+// Writes one record the AT24 is behind on; false if there is none.
+bool card_db_flush(void)
+{
+	uint16_t slot;
+
+	for (slot = 0; CARD_DB_CONFIG_CARDS > slot; slot++)
+	{
+		if (0 != (card_db_dirty[slot / 8] & (1u << (slot % 8))))
+		{
+			if (card_db_record_write(slot))
+			{
+				card_db_dirty[slot / 8] &= (uint8_t)~(1u << (slot % 8));
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// UID of a card id, false if the id is free. For listings and the journal.
+bool card_db_info(uint16_t card, uint32_t *p_uid)
+{
+	uint16_t slot = card - 1;
+
+	if ((0 == card) || (CARD_DB_CONFIG_CARDS < card) || (CARD_DB_FREE == card_db_uid[slot]))
+	{
+		return false;
+	}
+
+	*p_uid = card_db_uid[slot];
+
+	return true;
+}
+
+/********************** end of file ******************************************/
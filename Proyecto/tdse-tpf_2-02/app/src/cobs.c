@@ -0,0 +1,77 @@
+/*
+ *
+ * @file   : cobs.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include "cobs.h"
+
+/********************** macros and definitions *******************************/
+
+/********************** internal data definition *****************************/
+
+/********************** external functions definition ************************/
+uint16_t cobs_encode(const uint8_t *p_in, uint16_t size, uint8_t *p_out)
+{
+	uint16_t code_at = 0;
+	uint16_t out = 1;
+	uint8_t code = 1;
+	uint16_t index;
+
+	for (index = 0; size > index; index++)
+	{
+		if (0 != p_in[index])
+		{
+			p_out[out++] = p_in[index];
+			code++;
+		}
+
+		if ((0 == p_in[index]) || (0xFF == code))
+		{
+			p_out[code_at] = code;
+			code_at = out++;
+			code = 1;
+		}
+	}
+
+	p_out[code_at] = code;
+
+	return out;
+}
+
+uint16_t cobs_decode(const uint8_t *p_in, uint16_t size, uint8_t *p_out)
+{
+	uint16_t in = 0;
+	uint16_t out = 0;
+	uint8_t code;
+	uint8_t index;
+
+	while (size > in)
+	{
+		code = p_in[in++];
+		if (0 == code)
+		{
+			return 0;
+		}
+
+		for (index = 1; code > index; index++)
+		{
+			if ((size <= in) || (0 == p_in[in]))
+			{
+				return 0;
+			}
+			p_out[out++] = p_in[in++];
+		}
+
+		if ((0xFF != code) && (size > in))
+		{
+			p_out[out++] = 0;
+		}
+	}
+
+	return out;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,1153 @@
+/*
+ *
+ * @file   : console.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "dwt.h"
+#include "ds3231.h"
+#include "trace.h"
+#include "bench.h"
+#include "budget.h"
+#include "i2c_bus.h"
+#include "uart_dma.h"
+#include "fmt.h"
+#include "eeprom_emu.h"
+#include "timer_service.h"
+#include "memory_handler.h"
+#include "access_queue.h"
+#include "pin_hash.h"
+#include "pin_db.h"
+#include "card_db.h"
+#include "cred_store.h"
+#include "lockout.h"
+#include "log_export.h"
+#include "rs485_link.h"
+#include "task_system_attribute.h"
+#include "console.h"
+
+/********************** macros and definitions *******************************/
+#define CONSOLE_UART			UART_DMA_2
+#define CONSOLE_I2C_ADDRESS		(0xA0)
+#define CONSOLE_TRACE_LINES		(8)			// trace: default number of records
+#define CONSOLE_RTC_REGS		(7)			// Seconds to year
+#define CONSOLE_NAME_WIDTH		(8)
+
+#define CONSOLE_CTRL_C			(0x03)
+#define CONSOLE_BACKSPACE		(0x08)
+#define CONSOLE_DELETE			(0x7F)
+
+typedef enum {
+	CONSOLE_READ_IDLE,
+	CONSOLE_READ_BUSY,
+	CONSOLE_READ_READY,
+	CONSOLE_READ_FAILED
+} console_read_st_t;
+
+typedef struct
+{
+	const char *	p_name;
+	eeprom_emu_id_t	id;
+	uint16_t		min;
+	uint16_t		max;
+} console_setting_t;
+
+/********************** internal data definition *****************************/
+static int32_t console_help(uint32_t step, uint8_t argc, char *argv[]);
+static int32_t console_login(uint32_t step, uint8_t argc, char *argv[]);
+static int32_t console_logout(uint32_t step, uint8_t argc, char *argv[]);
+static int32_t console_stats_cmd(uint32_t step, uint8_t argc, char *argv[]);
+static int32_t console_users(uint32_t step, uint8_t argc, char *argv[]);
+static int32_t console_cards(uint32_t step, uint8_t argc, char *argv[]);
+static int32_t console_log(uint32_t step, uint8_t argc, char *argv[]);
+static int32_t console_set(uint32_t step, uint8_t argc, char *argv[]);
+static int32_t console_time(uint32_t step, uint8_t argc, char *argv[]);
+static int32_t console_trace(uint32_t step, uint8_t argc, char *argv[]);
+#if 1 == BENCH_CONFIG_ENABLE
+static int32_t console_bench(uint32_t step, uint8_t argc, char *argv[]);
+#endif
+
+static const console_entry_t console_table[] = {
+	{"help",	console_help,		false,	"this list"},
+	{"login",	console_login,		false,	"<pin>: admin login"},
+	{"logout",	console_logout,		false,	""},
+	{"stats",	console_stats_cmd,	false,	"task, bus and module counters"},
+	{"trace",	console_trace,		false,	"[n]: last n trace records"},
+	{"time",	console_time,		false,	"[dd/mm/yy hh:mm:ss]: show or set the RTC"},
+	{"users",	console_users,		true,	"[add <pin> <role> [uses] | del <id>]"},
+	{"cards",	console_cards,		true,	"[add <uid> | del <id>]"},
+	{"log",		console_log,		true,	"[clear]: access records"},
+	{"set",		console_set,		true,	"[<name> <value>]: show or change settings"},
+#if 1 == BENCH_CONFIG_ENABLE
+	{"bench",	console_bench,		true,	"[<scenario>]: last window, or run one"},
+#endif
+};
+
+#define CONSOLE_CMDS			(sizeof(console_table) / sizeof(console_table[0]))
+
+static const console_setting_t console_settings[] = {
+	{"ldr_adj",		EE_LDR_ADJ,		1,		9},
+	{"door_window",	EE_DOOR_WINDOW,	500,	60000},
+	{"door_held",	EE_DOOR_HELD,	1000,	60000},
+	{"door_relock",	EE_DOOR_RELOCK,	500,	10000},
+	{"rs485_addr",	EE_RS485_ADDR,	1,		RS485_LINK_NODE_MAX},
+};
+
+#define CONSOLE_SETTINGS		(sizeof(console_settings) / sizeof(console_settings[0]))
+
+/* Indexed by pin_role_t */
+static const char * const console_roles[PIN_ROLE_QTY] = {"admin", "user", "temp"};
+
+static char console_line[CONSOLE_CONFIG_LINE_MAX];
+static uint16_t console_line_len;
+static char console_last;						// Previous text byte, for CR LF
+static bool console_b_frame;					// Between the 0x00 of a host frame
+
+static const console_entry_t *console_p_run;	// Command running, NULL: none
+static uint32_t console_step;
+static char *console_argv[CONSOLE_CONFIG_ARGS];
+static uint8_t console_argc;
+static uint32_t console_arg;					// Command scratch, set at step 0
+
+static bool console_b_admin;
+static uint32_t console_login_tick;
+
+static char console_out[CONSOLE_CONFIG_OUT_MAX + 2];
+
+static uint8_t console_buf[MEM_ACCESS_SIZE];	// I2C reads of log and time
+static volatile uint8_t console_read_st;
+
+/********************** external data definition *****************************/
+console_stats_t console_stats;
+
+/********************** internal functions definition ************************/
+static void console_write(const char *p_text)
+{
+	uart_dma_write(CONSOLE_UART, (const uint8_t *)p_text, strlen(p_text));
+}
+
+// console_out up to p (as returned by fmt_*), ended by CR LF.
+static void console_send(char *p)
+{
+	*p++ = '\r';
+	*p++ = '\n';
+	uart_dma_write(CONSOLE_UART, (const uint8_t *)console_out, p - console_out);
+}
+
+static int32_t console_reply(const char *p_text)
+{
+	console_send(fmt_str(console_out, p_text));
+
+	return CONSOLE_DONE;
+}
+
+static char *console_value(char *p, const char *p_label, uint32_t value)
+{
+	p = fmt_str(p, p_label);
+
+	return fmt_dec(p, value, 1);
+}
+
+static bool console_number(const char *p_text, uint32_t *p_value)
+{
+	uint32_t value = 0;
+
+	if ('\0' == *p_text)
+	{
+		return false;
+	}
+
+	for (; '\0' != *p_text; p_text++)
+	{
+		if ((*p_text < '0') || (*p_text > '9') || (value > 99999999ul))
+		{
+			return false;
+		}
+		value = (value * 10) + (*p_text - '0');
+	}
+
+	*p_value = value;
+
+	return true;
+}
+
+// Card UID as shown in the access records: 8 hex digits.
+static bool console_uid(const char *p_text, uint32_t *p_value)
+{
+	uint32_t value = 0;
+	uint8_t digits;
+	char c;
+
+	for (digits = 0; '\0' != p_text[digits]; digits++)
+	{
+		c = p_text[digits];
+		if ((8 <= digits) || !(((c >= '0') && (c <= '9')) || ((c >= 'A') && (c <= 'F')) || ((c >= 'a') && (c <= 'f'))))
+		{
+			return false;
+		}
+		value = (value << 4) | (uint32_t)((c <= '9') ? (c - '0') : ((c & 0x0F) + 9));
+	}
+
+	*p_value = value;
+
+	return (8 == digits);
+}
+
+// "dd/mm/yy" or "hh:mm:ss" into three values.
+static bool console_triplet(const char *p_text, char separator, uint8_t value[3])
+{
+	uint8_t index;
+
+	if (8 != strlen(p_text))
+	{
+		return false;
+	}
+
+	for (index = 0; 3 > index; index++)
+	{
+		const char *p = &p_text[index * 3];
+
+		if ((p[0] < '0') || (p[0] > '9') || (p[1] < '0') || (p[1] > '9') ||
+			((2 > index) && (separator != p[2])))
+		{
+			return false;
+		}
+		value[index] = (uint8_t)(((p[0] - '0') * 10) + (p[1] - '0'));
+	}
+
+	return true;
+}
+
+// Sakamoto's method, 0: Sunday (the day numbering of ds3231.c).
+static uint8_t console_dow(uint8_t day, uint8_t mth, uint16_t year)
+{
+	static const uint8_t offset[12] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+
+	if (3 > mth)
+	{
+		year--;
+	}
+
+	return (uint8_t)((year + (year / 4) - (year / 100) + (year / 400) + offset[mth - 1] + day) % 7);
+}
+
+// I2C interrupt.
+static void console_read_done(HAL_StatusTypeDef status, void *p_arg)
+{
+	(void)p_arg;
+
+	console_read_st = (HAL_OK == status) ? CONSOLE_READ_READY : CONSOLE_READ_FAILED;
+}
+
+static bool console_read(uint16_t address, uint16_t mem_addr, uint16_t mem_size, uint16_t size)
+{
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_LOW, address, mem_addr, mem_size, size, console_buf, console_read_done, NULL};
+
+	/* A command stopped by Ctrl-C may still have its read in flight */
+	if (CONSOLE_READ_BUSY == console_read_st)
+	{
+		return false;
+	}
+
+	console_read_st = CONSOLE_READ_BUSY;
+	if (!i2c_bus_submit(I2C_BUS_2, &xfer))
+	{
+		console_read_st = CONSOLE_READ_IDLE;
+		return false;
+	}
+
+	return true;
+}
+
+static int32_t console_help(uint32_t step, uint8_t argc, char *argv[])
+{
+	const console_entry_t *p_entry = &console_table[step];
+	char *p;
+
+	if (CONSOLE_CMDS <= step)
+	{
+		return CONSOLE_DONE;
+	}
+
+	p = fmt_str(console_out, p_entry->p_name);
+	while ((console_out + CONSOLE_NAME_WIDTH) > p)
+	{
+		*p++ = ' ';
+	}
+	console_send(fmt_str(p, p_entry->p_help));
+
+	return step + 1;
+}
+
+// Same check as the options menu: the settings password or an admin PIN.
+// Failures count against LOCKOUT_OPT, so they also lock the keypad.
+static int32_t console_login(uint32_t step, uint8_t argc, char *argv[])
+{
+	uint8_t role = PIN_ROLE_QTY;
+	uint16_t user;
+	uint32_t cycles;
+	uint32_t wait = lockout_remaining();
+
+	if (2 != argc)
+	{
+		return console_reply("usage: login <pin>");
+	}
+
+	if (0 != wait)
+	{
+		console_send(fmt_str(console_value(console_out, "locked ", (wait + 999) / 1000), " s"));
+		return CONSOLE_DONE;
+	}
+
+	/* Anything the keypad could not type fails like a wrong PIN */
+	user = PIN_DB_NONE;
+	if (pin_db_valid(argv[1]))
+	{
+		cycles = cycle_counter_get();
+		user = pin_db_find(argv[1], &role);
+		if (pin_hash_verify(&task_system_dta.system_parameters.pwd, argv[1]))
+		{
+			user = PIN_DB_MASTER;
+			role = PIN_ROLE_ADMIN;
+		}
+		pin_hash_cost(cycle_counter_get() - cycles);
+	}
+
+	/* Not kept in the line buffer */
+	memset(argv[1], 0, strlen(argv[1]));
+
+	if ((PIN_DB_NONE == user) || (PIN_ROLE_ADMIN != role))
+	{
+		console_stats.denied++;
+		wait = lockout_fail(LOCKOUT_OPT, (PIN_DB_NONE == user) ? LOCKOUT_ANY : user);
+		console_send(fmt_str(console_value(console_out, "denied, wait ", (wait + 999) / 1000), " s"));
+		return CONSOLE_DONE;
+	}
+
+	lockout_success(LOCKOUT_OPT, user);
+	console_b_admin = true;
+
+	return console_reply("ok");
+}
+
+static int32_t console_logout(uint32_t step, uint8_t argc, char *argv[])
+{
+	console_b_admin = false;
+
+	return console_reply("ok");
+}
+
+// One line per module. The tick line covers the current bench window.
+static int32_t console_stats_cmd(uint32_t step, uint8_t argc, char *argv[])
+{
+	char *p = console_out;
+
+	switch (step)
+	{
+		case 0:
+
+			p = console_value(p, "tick avg ", (0 != bench.ticks) ? (uint32_t)(bench.cycles_sum / bench.ticks) : 0);
+			p = console_value(p, " max ", bench.cycles_max);
+			p = console_value(p, " over ", bench.overruns);
+			p = console_value(p, " backlog ", bench.backlog_max);
+
+			break;
+
+		case 1:
+		case 2:
+
+			p = console_value(p, "i2c", step);
+			p = console_value(p, " xfers ", i2c_bus_stats[step - 1].xfers);
+			p = console_value(p, " err ", i2c_bus_stats[step - 1].errors);
+			p = console_value(p, " drop ", i2c_bus_stats[step - 1].dropped);
+			p = console_value(p, " util ", i2c_bus_util_pct((i2c_bus_id_t)(step - 1)));
+			*p++ = '%';
+
+			break;
+
+		case 3:
+
+			p = console_value(p, "uart tx ", uart_dma_stats[CONSOLE_UART].tx_bytes);
+			p = console_value(p, " rx ", uart_dma_stats[CONSOLE_UART].rx_bytes);
+			p = console_value(p, " full ", uart_dma_stats[CONSOLE_UART].tx_full);
+			p = console_value(p, " lost ", uart_dma_stats[CONSOLE_UART].rx_lost);
+
+			break;
+
+		case 4:
+
+			p = console_value(p, "export ", log_export_stats.exports);
+			p = console_value(p, " abort ", log_export_stats.aborts);
+			p = console_value(p, " resend ", log_export_stats.resends);
+			p = console_value(p, " last ", log_export_stats.last_ms);
+			p = fmt_str(p, " ms");
+
+			break;
+
+		case 5:
+
+			p = console_value(p, "users ", pin_db_stats.users);
+			p = console_value(p, " lookups ", pin_db_stats.lookups);
+			p = console_value(p, " hash ", pin_hash_stats.cycles_max);
+			p = fmt_str(p, " cyc");
+
+			break;
+
+		case 6:
+
+			p = console_value(p, "lockout fail ", lockout_stats.failures);
+			p = console_value(p, " locks ", lockout_stats.locks);
+			p = console_value(p, " left ", (lockout_remaining() + 999) / 1000);
+			p = fmt_str(p, " s");
+
+			break;
+
+		case 7:
+
+			p = console_value(p, "flash commits ", eeprom_emu_stats.commits);
+			p = console_value(p, " erases ", eeprom_emu_stats.erase_count);
+			p = console_value(p, " err ", eeprom_emu_stats.errors);
+
+			break;
+
+		case 8:
+
+			p = console_value(p, "rs485 node ", rs485_link_address());
+			p = console_value(p, " rx ", rs485_link_stats.rx_frames);
+			p = console_value(p, " bad ", rs485_link_stats.bad_frames);
+			p = console_value(p, " creds ", rs485_link_stats.creds);
+
+			break;
+
+		case 9:
+
+			p = console_value(p, "creds head ", cred_store_vv.head);
+			p = console_value(p, " local ", cred_store_vv.local);
+			p = console_value(p, " cards ", card_db_stats.cards);
+			p = console_value(p, " replay ", cred_store_stats.replayed);
+
+			break;
+
+		case 10:
+
+			p = console_value(p, "access queue ", access_queue_depth());
+			p = console_value(p, " max ", access_queue_stats.depth_max);
+			p = console_value(p, " coal ", access_queue_stats.coalesced);
+			p = console_value(p, " over ", access_queue_stats.overflows);
+			p = console_value(p, " clr ", access_queue_stats.clears);
+
+			break;
+
+		case 11:
+
+			/* Task 1 is task_system (app.c) */
+			p = console_value(p, "budget tick ", budget_stats.tick_max);
+			p = console_value(p, " sys ", budget_stats.task[1].cycles_max);
+			p = console_value(p, " cyc over ", budget_stats.task[1].overruns);
+
+			break;
+
+		case 12:
+
+			p = console_value(p, "console cmds ", console_stats.commands);
+			p = console_value(p, " drop ", console_stats.dropped);
+			p = console_value(p, " max ", console_stats.cycles_max);
+			p = fmt_str(p, " cyc");
+
+			break;
+
+		default:
+
+			return CONSOLE_DONE;
+	}
+
+	console_send(p);
+
+	return step + 1;
+}
+
+static int32_t console_users_list(uint32_t step)
+{
+	uint16_t user = (uint16_t)step;
+	uint16_t uses;
+	uint8_t role;
+	char *p;
+
+	if (0 == step)
+	{
+		console_send(console_value(console_out, "users ", pin_db_stats.users));
+		return 1;
+	}
+
+	for (; PIN_DB_CONFIG_USERS >= user; user++)
+	{
+		if (pin_db_info(user, &role, &uses))
+		{
+			break;
+		}
+	}
+
+	if (PIN_DB_CONFIG_USERS < user)
+	{
+		return CONSOLE_DONE;
+	}
+
+	p = fmt_dec(console_out, user, 4);
+	*p++ = ' ';
+	p = fmt_str(p, console_roles[role]);
+	if (PIN_ROLE_TEMP == role)
+	{
+		p = console_value(p, " ", uses);
+	}
+	console_send(p);
+
+	return user + 1;
+}
+
+// users add <pin> <role> [uses] / users del <id>: through cred_store, so the
+// head-end can ask for them ('J'), and the EEPROM follows a record per tick.
+static int32_t console_users(uint32_t step, uint8_t argc, char *argv[])
+{
+	uint32_t value = 1;
+	uint16_t user;
+	uint8_t role;
+
+	if (1 == argc)
+	{
+		return console_users_list(step);
+	}
+
+	if ((3 == argc) && (0 == strcmp(argv[1], "del")))
+	{
+		if (!console_number(argv[2], &value) || (0xFFFF < value) || !cred_store_pin_remove((uint16_t)value))
+		{
+			return console_reply("no such user");
+		}
+		return console_reply("ok");
+	}
+
+	if ((4 > argc) || (0 != strcmp(argv[1], "add")))
+	{
+		return console_reply("usage: users [add <pin> <role> [uses] | del <id>]");
+	}
+
+	for (role = 0; PIN_ROLE_QTY > role; role++)
+	{
+		if (0 == strcmp(argv[3], console_roles[role]))
+		{
+			break;
+		}
+	}
+
+	if ((PIN_ROLE_QTY == role) || ((5 == argc) && (!console_number(argv[4], &value) || (0xFFFF < value))))
+	{
+		memset(argv[2], 0, strlen(argv[2]));
+		return console_reply("usage: users add <pin> admin|user|temp [uses]");
+	}
+
+	if (!pin_db_valid(argv[2]))
+	{
+		memset(argv[2], 0, strlen(argv[2]));
+		return console_reply("pin: 1 to 5 digits");
+	}
+
+	user = cred_store_pin_add(argv[2], (pin_role_t)role, (uint16_t)value);
+	memset(argv[2], 0, strlen(argv[2]));
+
+	if (PIN_DB_NONE == user)
+	{
+		return console_reply("refused: bad, duplicate, no room or busy");
+	}
+
+	console_send(console_value(console_out, "user ", user));
+
+	return CONSOLE_DONE;
+}
+
+static int32_t console_cards_list(uint32_t step)
+{
+	uint16_t card = (uint16_t)step;
+	uint32_t uid;
+	uint8_t index;
+	char *p;
+
+	if (0 == step)
+	{
+		console_send(console_value(console_out, "cards ", card_db_stats.cards));
+		return 1;
+	}
+
+	for (; CARD_DB_CONFIG_CARDS >= card; card++)
+	{
+		if (card_db_info(card, &uid))
+		{
+			break;
+		}
+	}
+
+	if (CARD_DB_CONFIG_CARDS < card)
+	{
+		return CONSOLE_DONE;
+	}
+
+	p = fmt_dec(console_out, card, 4);
+	*p++ = ' ';
+	for (index = 0; 4 > index; index++)
+	{
+		p = fmt_hex2(p, (uint8_t)(uid >> (24 - (8 * index))));
+	}
+	console_send(p);
+
+	return card + 1;
+}
+
+// cards add <uid> / cards del <id>, like users.
+static int32_t console_cards(uint32_t step, uint8_t argc, char *argv[])
+{
+	uint32_t value;
+	uint16_t card;
+
+	if (1 == argc)
+	{
+		return console_cards_list(step);
+	}
+
+	if ((3 == argc) && (0 == strcmp(argv[1], "del")))
+	{
+		if (!console_number(argv[2], &value) || (0xFFFF < value) || !cred_store_card_remove((uint16_t)value))
+		{
+			return console_reply("no such card");
+		}
+		return console_reply("ok");
+	}
+
+	if ((3 != argc) || (0 != strcmp(argv[1], "add")) || !console_uid(argv[2], &value))
+	{
+		return console_reply("usage: cards [add <8 hex digits> | del <id>]");
+	}
+
+	card = cred_store_card_add(value);
+	if (CARD_DB_NONE == card)
+	{
+		return console_reply("refused: known, no room or busy");
+	}
+
+	console_send(console_value(console_out, "card ", card));
+
+	return CONSOLE_DONE;
+}
+
+// Even steps read a record, odd steps wait for it and print it.
+static int32_t console_log(uint32_t step, uint8_t argc, char *argv[])
+{
+	uint16_t record = (uint16_t)(step / 2);
+	char *p;
+
+	if ((2 == argc) && (0 == strcmp(argv[1], "clear")))
+	{
+		access_queue_clear();
+		return console_reply("ok");
+	}
+
+	if (1 != argc)
+	{
+		return console_reply("usage: log [clear]");
+	}
+
+	if (MEM_ACCESS_QTY <= record)
+	{
+		return CONSOLE_DONE;
+	}
+
+	if (0 == (step % 2))
+	{
+		if (!console_read(CONSOLE_I2C_ADDRESS, MEM_ACCESS_BASE + (record * MEM_ACCESS_STRIDE), I2C_MEMADD_SIZE_16BIT, MEM_ACCESS_SIZE))
+		{
+			return step;
+		}
+		return step + 1;
+	}
+
+	if (CONSOLE_READ_BUSY == console_read_st)
+	{
+		return step;
+	}
+
+	if (CONSOLE_READ_READY != console_read_st)
+	{
+		return console_reply("read error");
+	}
+
+	console_buf[MEM_ACCESS_SIZE - 1] = '\0';
+	p = fmt_dec(console_out, record, 2);
+	p = fmt_str(p, "  ");
+	p = fmt_str(p, (('0' <= console_buf[0]) && ('9' >= console_buf[0])) ? (const char *)console_buf : "-");
+	console_send(p);
+
+	return step + 1;
+}
+
+static uint16_t console_setting_get(eeprom_emu_id_t id)
+{
+	system_parameters_t *p_parameters = &task_system_dta.system_parameters;
+
+	switch (id)
+	{
+		case EE_LDR_ADJ:
+			return p_parameters->ldr_adj;
+		case EE_DOOR_WINDOW:
+			return p_parameters->door_window;
+		case EE_DOOR_HELD:
+			return p_parameters->door_held;
+		case EE_RS485_ADDR:
+			return rs485_link_address();
+		default:
+			return p_parameters->door_relock;
+	}
+}
+
+// Same effect as the options menu: RAM copy and eeprom_emu.
+static void console_setting_put(eeprom_emu_id_t id, uint16_t value)
+{
+	system_parameters_t *p_parameters = &task_system_dta.system_parameters;
+
+	switch (id)
+	{
+		case EE_LDR_ADJ:
+			p_parameters->ldr_adj = (uint8_t)value;
+			break;
+		case EE_DOOR_WINDOW:
+			p_parameters->door_window = value;
+			break;
+		case EE_DOOR_HELD:
+			p_parameters->door_held = value;
+			break;
+		case EE_RS485_ADDR:
+			rs485_link_set_address((uint8_t)value);
+			break;
+		default:
+			p_parameters->door_relock = value;
+			break;
+	}
+
+	eeprom_emu_write(id, value);
+}
+
+static int32_t console_set(uint32_t step, uint8_t argc, char *argv[])
+{
+	const console_setting_t *p_setting;
+	uint32_t value;
+	uint8_t index;
+	char *p;
+
+	if (1 == argc)
+	{
+		if (CONSOLE_SETTINGS <= step)
+		{
+			return CONSOLE_DONE;
+		}
+
+		p_setting = &console_settings[step];
+		p = fmt_str(console_out, p_setting->p_name);
+		p = console_value(p, " ", console_setting_get(p_setting->id));
+		p = console_value(p, " (", p_setting->min);
+		p = console_value(p, "..", p_setting->max);
+		*p++ = ')';
+		console_send(p);
+
+		return step + 1;
+	}
+
+	for (index = 0; CONSOLE_SETTINGS > index; index++)
+	{
+		if (0 == strcmp(argv[1], console_settings[index].p_name))
+		{
+			break;
+		}
+	}
+
+	if ((3 != argc) || (CONSOLE_SETTINGS == index))
+	{
+		return console_reply("usage: set <name> <value>");
+	}
+
+	p_setting = &console_settings[index];
+	if (!console_number(argv[2], &value) || (p_setting->min > value) || (p_setting->max < value))
+	{
+		return console_reply("out of range");
+	}
+
+	console_setting_put(p_setting->id, (uint16_t)value);
+
+	return console_reply("ok");
+}
+
+// Reads the DS3231 through the bus queue, sets it with a copying write.
+static int32_t console_time(uint32_t step, uint8_t argc, char *argv[])
+{
+	uint8_t date[3];
+	uint8_t time[3];
+	uint8_t regs[1 + CONSOLE_RTC_REGS];
+	char *p;
+
+	if (1 == argc)
+	{
+		if (0 == step)
+		{
+			return console_read(DS3231_ADDRESS, DS3231_SEC, I2C_MEMADD_SIZE_8BIT, CONSOLE_RTC_REGS) ? 1 : 0;
+		}
+
+		if (CONSOLE_READ_BUSY == console_read_st)
+		{
+			return step;
+		}
+
+		if (CONSOLE_READ_READY != console_read_st)
+		{
+			return console_reply("rtc error");
+		}
+
+		p = fmt_bcd2(console_out, console_buf[DS3231_DATE] & 0x3F);
+		*p++ = '/';
+		p = fmt_bcd2(p, console_buf[DS3231_MONTH] & 0x1F);
+		p = fmt_str(p, "/20");
+		p = fmt_bcd2(p, console_buf[DS3231_YEAR]);
+		*p++ = ' ';
+		p = fmt_bcd2(p, console_buf[DS3231_HOUR] & 0x3F);
+		*p++ = ':';
+		p = fmt_bcd2(p, console_buf[DS3231_MIN] & 0x7F);
+		*p++ = ':';
+		p = fmt_bcd2(p, console_buf[DS3231_SEC] & 0x7F);
+		console_send(p);
+
+		return CONSOLE_DONE;
+	}
+
+	if (!console_b_admin)
+	{
+		console_stats.denied++;
+		return console_reply("login first");
+	}
+
+	if ((3 != argc) || !console_triplet(argv[1], '/', date) || !console_triplet(argv[2], ':', time) ||
+		(1 > date[0]) || (31 < date[0]) || (1 > date[1]) || (12 < date[1]) ||
+		(23 < time[0]) || (59 < time[1]) || (59 < time[2]))
+	{
+		return console_reply("usage: time dd/mm/yy hh:mm:ss");
+	}
+
+	regs[0] = DS3231_SEC;
+	regs[1 + DS3231_SEC] = DS3231_Bin_Bcd(time[2]);
+	regs[1 + DS3231_MIN] = DS3231_Bin_Bcd(time[1]);
+	regs[1 + DS3231_HOUR] = DS3231_Bin_Bcd(time[0]);
+	regs[1 + DS3231_DAY] = DS3231_Bin_Bcd(console_dow(date[0], date[1], 2000 + date[2]));
+	regs[1 + DS3231_DATE] = DS3231_Bin_Bcd(date[0]);
+	regs[1 + DS3231_MONTH] = DS3231_Bin_Bcd(date[1]);
+	regs[1 + DS3231_YEAR] = DS3231_Bin_Bcd(date[2]);
+
+	return console_reply(i2c_bus_write(I2C_BUS_2, DS3231_ADDRESS, regs, sizeof(regs)) ? "ok" : "rtc busy");
+}
+
+// "cycles type id arg" of the last records, oldest first (trace2json.py
+// decodes the types).
+static int32_t console_trace(uint32_t step, uint8_t argc, char *argv[])
+{
+	const trace_record_t *p_record;
+	uint32_t head;
+	char *p;
+
+	if (0 == step)
+	{
+		console_arg = CONSOLE_TRACE_LINES;
+		if ((2 <= argc) && (!console_number(argv[1], &console_arg) || (0 == console_arg)))
+		{
+			return console_reply("usage: trace [n]");
+		}
+
+		head = trace_log.head;
+		if (console_arg > head)
+		{
+			console_arg = head;
+		}
+		if (console_arg > TRACE_CONFIG_RECORDS)
+		{
+			console_arg = TRACE_CONFIG_RECORDS;
+		}
+
+		/* Index of the first record, fixed while the lines go out */
+		console_arg = head - console_arg;
+		console_send(console_value(console_out, "head ", head));
+
+		return (console_arg == head) ? CONSOLE_DONE : 1;
+	}
+
+	head = trace_log.head;
+	if ((console_arg + step) > head)
+	{
+		return CONSOLE_DONE;
+	}
+
+	/* Overwritten since the command started */
+	if ((head - (console_arg + step - 1)) > TRACE_CONFIG_RECORDS)
+	{
+		return console_reply("overrun");
+	}
+
+	p_record = &trace_log.record[(console_arg + step - 1) & (TRACE_CONFIG_RECORDS - 1)];
+	p = fmt_dec(console_out, p_record->cycles, 10);
+	p = console_value(p, " ", p_record->type);
+	p = console_value(p, " ", p_record->id);
+	p = console_value(p, " ", p_record->arg);
+	console_send(p);
+
+	return step + 1;
+}
+
+static void console_prompt(void)
+{
+	console_write("> ");
+}
+
+// Splits the line in place and starts its command.
+static void console_exec(void)
+{
+	char *p = console_line;
+	uint8_t index;
+
+	console_argc = 0;
+	while ('\0' != *p)
+	{
+		if (' ' == *p)
+		{
+			*p++ = '\0';
+			continue;
+		}
+
+		if (CONSOLE_CONFIG_ARGS == console_argc)
+		{
+			console_reply("too many arguments");
+			console_prompt();
+			return;
+		}
+
+		console_argv[console_argc++] = p;
+		while (('\0' != *p) && (' ' != *p))
+		{
+			p++;
+		}
+	}
+
+	if (0 == console_argc)
+	{
+		console_prompt();
+		return;
+	}
+
+	for (index = 0; CONSOLE_CMDS > index; index++)
+	{
+		if (0 == strcmp(console_argv[0], console_table[index].p_name))
+		{
+			break;
+		}
+	}
+
+	if (CONSOLE_CMDS == index)
+	{
+		console_stats.unknown++;
+		console_reply("unknown command, try help");
+		console_prompt();
+		return;
+	}
+
+	if (console_table[index].b_admin && !console_b_admin)
+	{
+		console_stats.denied++;
+		console_reply("login first");
+		console_prompt();
+		return;
+	}
+
+	console_stats.commands++;
+	console_p_run = &console_table[index];
+	console_step = 0;
+}
+
+// A text byte: line editing with echo. While a command runs only Ctrl-C is
+// taken, the rest is dropped.
+static void console_char(char c)
+{
+	char last = console_last;
+
+	console_last = c;
+
+	if (('\n' == c) && ('\r' == last))
+	{
+		return;
+	}
+
+	if (NULL != console_p_run)
+	{
+		if (CONSOLE_CTRL_C == c)
+		{
+			console_p_run = NULL;
+			console_write("^C\r\n");
+			console_prompt();
+		}
+		else
+		{
+			console_stats.dropped++;
+		}
+		return;
+	}
+
+	if (('\r' == c) || ('\n' == c))
+	{
+		console_write("\r\n");
+		console_line[console_line_len] = '\0';
+		console_line_len = 0;
+		console_stats.lines++;
+		console_login_tick = timer_service_now();
+		console_exec();
+	}
+	else if ((CONSOLE_BACKSPACE == c) || (CONSOLE_DELETE == c))
+	{
+		if (0 != console_line_len)
+		{
+			console_line_len--;
+			console_write("\b \b");
+		}
+	}
+	else if ((' ' <= c) && ('~' >= c) && ((CONSOLE_CONFIG_LINE_MAX - 1) > console_line_len))
+	{
+		console_line[console_line_len++] = c;
+		uart_dma_write(CONSOLE_UART, (const uint8_t *)&c, 1);
+	}
+}
+
+#if 1 == BENCH_CONFIG_ENABLE
+// bench <scenario>: the scripted inputs drive the firmware, and the report
+// of that window is printed once it closes (a window of another scenario,
+// as the free-running one the request cuts short, is skipped). bench alone
+// prints the last window. The lines are the input of tools/bench_compare.py.
+static int32_t console_bench(uint32_t step, uint8_t argc, char *argv[])
+{
+	bench_scenario_t scenario = (2 == argc) ? bench_scenario_find(argv[1]) : BENCH_SC_QTY;
+	uint32_t first = (2 == argc) ? 2 : 0;
+	char *p;
+
+	if ((2 == argc) && (BENCH_SC_QTY == scenario))
+	{
+		return console_reply("scenarios: free_run pin_burst card_taps menu_nav wrong_pin ldr_flips");
+	}
+
+	if ((0 == step) && (2 == argc))
+	{
+		console_arg = bench_result.window;
+		bench.request = scenario;
+		return 1;
+	}
+
+	if (first > step)
+	{
+		if (console_arg == bench_result.window)
+		{
+			return step;
+		}
+		if (scenario != bench_result.scenario)
+		{
+			console_arg = bench_result.window;
+			return step;
+		}
+		return first;
+	}
+
+	p = bench_line(console_out, (uint8_t)(step - first));
+	if (NULL == p)
+	{
+		return (first == step) ? console_reply("no window yet") : CONSOLE_DONE;
+	}
+	console_send(p);
+
+	return step + 1;
+}
+#endif
+
+/********************** external functions definition ************************/
+void console_init(void)
+{
+	memset(&console_stats, 0, sizeof(console_stats));
+	console_line_len = 0;
+	console_last = 0;
+	console_b_frame = false;
+	console_p_run = NULL;
+	console_b_admin = false;
+	console_read_st = CONSOLE_READ_IDLE;
+
+	uart_dma_init(CONSOLE_UART, UART_DMA_CONFIG_BAUD);
+
+	console_write("\r\n> ");
+}
+
+// Every system tick: at most CONSOLE_CONFIG_RX_TICK input bytes and one step
+// of the running command. USART2 RX is shared: bytes between two 0x00 are a
+// host frame for log_export, the rest is console text. Command output waits
+// while an export is running, so text never lands inside its frames.
+void console_update(void)
+{
+	uint32_t cycles = cycle_counter_get();
+	uint8_t chunk[CONSOLE_CONFIG_RX_TICK];
+	uint16_t qty = uart_dma_read(CONSOLE_UART, chunk, sizeof(chunk));
+	uint16_t index;
+	int32_t next;
+
+	for (index = 0; qty > index; index++)
+	{
+		if (0x00 == chunk[index])
+		{
+			console_b_frame = !console_b_frame;
+			console_line_len = 0;
+			log_export_rx(&chunk[index], 1);
+		}
+		else if (console_b_frame)
+		{
+			log_export_rx(&chunk[index], 1);
+		}
+		else
+		{
+			console_char((char)chunk[index]);
+		}
+	}
+
+	if (console_b_admin && ((timer_service_now() - console_login_tick) >= CONSOLE_CONFIG_LOGIN_MS))
+	{
+		console_b_admin = false;
+	}
+
+	if ((NULL != console_p_run) && !log_export_busy() &&
+		((CONSOLE_CONFIG_OUT_MAX + 2) <= uart_dma_free(CONSOLE_UART)))
+	{
+		next = console_p_run->p_cmd(console_step, console_argc, console_argv);
+		if (CONSOLE_DONE == next)
+		{
+			console_p_run = NULL;
+			console_prompt();
+		}
+		else
+		{
+			console_step = (uint32_t)next;
+		}
+	}
+
+	cycles = cycle_counter_get() - cycles;
+	if (console_stats.cycles_max < cycles)
+	{
+		console_stats.cycles_max = cycles;
+	}
+}
+
+/********************** end of file ******************************************/
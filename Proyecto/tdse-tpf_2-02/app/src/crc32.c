@@ -0,0 +1,47 @@
+/*
+ *
+ * @file   : crc32.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include "crc32.h"
+
+/********************** macros and definitions *******************************/
+
+/********************** internal data definition *****************************/
+/* Reflected polynomial 0xEDB88320, one nibble per lookup: 64 bytes of flash */
+static const uint32_t crc32_nibble[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+	0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+	0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/********************** external functions definition ************************/
+uint32_t crc32_update(uint32_t crc, const void *p_data, uint32_t size)
+{
+	const uint8_t *p = (const uint8_t *)p_data;
+
+	while (0 != size--)
+	{
+		crc ^= *p++;
+		crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+		crc = (crc >> 4) ^ crc32_nibble[crc & 0x0F];
+	}
+
+	return crc;
+}
+
+uint32_t crc32_final(uint32_t crc)
+{
+	return ~crc;
+}
+
+uint32_t crc32(const void *p_data, uint32_t size)
+{
+	return crc32_final(crc32_update(CRC32_INIT, p_data, size));
+}
+
+/********************** end of file ******************************************/
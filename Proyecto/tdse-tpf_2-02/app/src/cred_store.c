@@ -0,0 +1,544 @@
+/*
+ *
+ * @file   : cred_store.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "logger.h"
+#include "i2c_bus.h"
+#include "crc32.h"
+#include "init_seq.h"
+#include "eeprom_emu.h"
+#include "memory_handler.h"
+#include "pin_hash.h"
+#include "pin_db.h"
+#include "card_db.h"
+#include "cred_store.h"
+
+/********************** macros and definitions *******************************/
+#define CRED_STORE_I2C_ADDRESS	(0xA0)
+#define CRED_STORE_I2C_TIMEOUT	(50ul)
+
+/* Journal: change i of the batch in page i: target, base, index, count,
+ * the change (cred_store_pack()), CRC-32 of the first 28 bytes */
+#define CRED_STORE_PAGE			(32u)
+#define CRED_STORE_PAGE_USED	(28u)
+#define CRED_STORE_OFS_CHANGE	(6u)
+
+#define CRED_STORE_ALL(count)	((uint8_t)((1u << (count)) - 1u))
+
+typedef enum {
+	CRED_STORE_IDLE,
+	CRED_STORE_JOURNAL,		// Batch going to the journal, one page at a time
+	CRED_STORE_PERSIST,		// Applied: tables following in the AT24
+	CRED_STORE_CLOSE		// Journal closed, waiting for that write
+} cred_store_st_t;
+
+typedef enum {
+	CRED_STORE_LANE_PIN,
+	CRED_STORE_LANE_CARD,
+	CRED_STORE_LANE_REPLAY
+} cred_store_lane_t;
+
+/********************** internal data definition *****************************/
+static cred_store_st_t cred_store_st;
+static bool cred_store_b_ready;
+
+/* Batch being received: base -> target, count changes */
+static uint16_t cred_store_base;
+static uint16_t cred_store_target;
+static uint8_t cred_store_count;
+static uint8_t cred_store_mask;					// Changes in, bit per index
+static uint8_t cred_store_slot;					// Next journal page
+static cred_change_t cred_store_batch[CRED_STORE_CONFIG_BATCH];
+
+/* Changes made here, the newest one is version cred_store_vv.local */
+static cred_change_t cred_store_local[CRED_STORE_CONFIG_LOCAL];
+static uint8_t cred_store_local_qty;
+
+static cred_store_lane_t cred_store_lane;
+static uint32_t cred_store_lane_step0;
+static i2c_bus_req_t cred_store_req;				// Journal page being read
+
+/********************** external data definition *****************************/
+cred_store_vv_t cred_store_vv;
+cred_store_stats_t cred_store_stats;
+
+/********************** internal functions definition ************************/
+static bool cred_store_apply(const cred_change_t *p_change)
+{
+	switch (p_change->op)
+	{
+		case CRED_OP_PIN_PUT:
+
+			return pin_db_put(p_change->id, (pin_role_t)p_change->role, p_change->uses, p_change->key, p_change->digest);
+
+		case CRED_OP_PIN_DEL:
+
+			/* Already free is fine: the result is the same */
+			pin_db_remove(p_change->id);
+			return true;
+
+		case CRED_OP_CARD_PUT:
+
+			return card_db_put(p_change->id, p_change->key);
+
+		case CRED_OP_CARD_DEL:
+
+			card_db_remove(p_change->id);
+			return true;
+
+		default:
+
+			return false;
+	}
+}
+
+// The whole batch reaches the RAM tables in one call: no lookup sees half
+// of it. The AT24 follows from the dirty records.
+static void cred_store_apply_batch(void)
+{
+	uint8_t index;
+
+	for (index = 0; cred_store_count > index; index++)
+	{
+		if (cred_store_apply(&cred_store_batch[index]))
+		{
+			cred_store_stats.changes++;
+		}
+		else
+		{
+			cred_store_stats.errors++;
+		}
+	}
+
+	cred_store_vv.head = cred_store_target;
+	cred_store_mask = 0;
+}
+
+static bool cred_store_journal_write(uint8_t slot)
+{
+	uint8_t page[CRED_STORE_PAGE_USED + 4] = {0};
+	uint32_t crc;
+
+	memcpy(&page[0], &cred_store_target, 2);
+	memcpy(&page[2], &cred_store_base, 2);
+	page[4] = slot;
+	page[5] = cred_store_count;
+	cred_store_pack(&page[CRED_STORE_OFS_CHANGE], &cred_store_batch[slot]);
+	crc = crc32(page, CRED_STORE_PAGE_USED);
+	memcpy(&page[CRED_STORE_PAGE_USED], &crc, 4);
+
+	return write_memory(CRED_STORE_CONFIG_JOURNAL + (slot * CRED_STORE_PAGE), page, sizeof(page));
+}
+
+// Reads journal page 'slot' into the batch. The pages of the last batch
+// applied stay there until its tables are in the AT24: a batch is replayed
+// when every page is valid and its target is the head version in the flash.
+// HAL_BUSY while the read is on the bus, HAL_ERROR for a page not to replay.
+static HAL_StatusTypeDef cred_store_journal_read(uint8_t slot)
+{
+	uint8_t page[CRED_STORE_PAGE_USED + 4];
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_HIGH, CRED_STORE_I2C_ADDRESS,
+						   CRED_STORE_CONFIG_JOURNAL + (slot * CRED_STORE_PAGE), I2C_MEMADD_SIZE_16BIT,
+						   sizeof(page), page, NULL, NULL};
+	HAL_StatusTypeDef status;
+	uint16_t target;
+	uint16_t base;
+	uint32_t crc;
+
+	if (HAL_OK != (status = i2c_bus_poll(I2C_BUS_2, &xfer, &cred_store_req, CRED_STORE_I2C_TIMEOUT)))
+	{
+		return (HAL_BUSY == status) ? HAL_BUSY : HAL_ERROR;
+	}
+
+	memcpy(&target, &page[0], 2);
+	memcpy(&base, &page[2], 2);
+	memcpy(&crc, &page[CRED_STORE_PAGE_USED], 4);
+
+	if ((crc32(page, CRED_STORE_PAGE_USED) != crc) || (cred_store_vv.head != target) || (slot != page[4]) ||
+		(0 == page[5]) || (CRED_STORE_CONFIG_BATCH < page[5]))
+	{
+		return HAL_ERROR;
+	}
+
+	if (0 == slot)
+	{
+		cred_store_target = target;
+		cred_store_base = base;
+		cred_store_count = page[5];
+	}
+	else if ((cred_store_base != base) || (cred_store_count != page[5]))
+	{
+		return HAL_ERROR;
+	}
+
+	return cred_store_unpack(&cred_store_batch[slot], &page[CRED_STORE_OFS_CHANGE]) ? HAL_OK : HAL_ERROR;
+}
+
+// Init lane part after the tables: one journal page per step.
+static int32_t cred_store_replay(uint32_t step)
+{
+	HAL_StatusTypeDef status = cred_store_journal_read((uint8_t)step);
+
+	if (HAL_BUSY == status)
+	{
+		return INIT_SEQ_AGAIN;
+	}
+
+	if (HAL_OK != status)
+	{
+		cred_store_count = 0;
+		cred_store_b_ready = true;
+		return INIT_SEQ_DONE;
+	}
+
+	if ((step + 1) < cred_store_count)
+	{
+		return 0;
+	}
+
+	/* Tables as the batch left them, then written again and closed */
+	cred_store_apply_batch();
+	cred_store_stats.replayed++;
+	cred_store_st = CRED_STORE_PERSIST;
+
+	LOGGER_LOG("cred store: batch %u replayed\r\n", cred_store_vv.head);
+	cred_store_b_ready = true;
+
+	return INIT_SEQ_DONE;
+}
+
+static void cred_store_local_add(const cred_change_t *p_change)
+{
+	cred_store_vv.local++;
+	cred_store_local[cred_store_vv.local % CRED_STORE_CONFIG_LOCAL] = *p_change;
+	if (CRED_STORE_CONFIG_LOCAL > cred_store_local_qty)
+	{
+		cred_store_local_qty++;
+	}
+
+	eeprom_emu_write(EE_CRED_LOCAL, cred_store_vv.local);
+	cred_store_stats.local++;
+}
+
+// A change made here while a batch is on its way to the AT24 could be
+// undone by its replay after a reset: they wait for IDLE.
+static bool cred_store_local_ready(void)
+{
+	return cred_store_b_ready && (CRED_STORE_IDLE == cred_store_st);
+}
+
+/********************** external functions definition ************************/
+// Init lane (init_seq): pin_db, card_db, then the journal of the last batch.
+// Replaces their own lanes, so a replay always finds the tables loaded.
+int32_t cred_store_init_lane(uint32_t step)
+{
+	int32_t wait;
+
+	if (0 == step)
+	{
+		memset(&cred_store_stats, 0, sizeof(cred_store_stats));
+		memset(&cred_store_vv, 0, sizeof(cred_store_vv));
+		eeprom_emu_read(EE_CRED_GEN, &cred_store_vv.head);
+		eeprom_emu_read(EE_CRED_LOCAL, &cred_store_vv.local);
+
+		cred_store_st = CRED_STORE_IDLE;
+		cred_store_b_ready = false;
+		cred_store_mask = 0;
+		cred_store_count = 0;
+		cred_store_local_qty = 0;
+		cred_store_lane = CRED_STORE_LANE_PIN;
+		cred_store_lane_step0 = 0;
+	}
+
+	switch (cred_store_lane)
+	{
+		case CRED_STORE_LANE_PIN:
+
+			wait = pin_db_init_lane(step - cred_store_lane_step0);
+
+			break;
+
+		case CRED_STORE_LANE_CARD:
+
+			wait = card_db_init_lane(step - cred_store_lane_step0);
+
+			break;
+
+		default:
+
+			return cred_store_replay(step - cred_store_lane_step0);
+	}
+
+	if (INIT_SEQ_DONE == wait)
+	{
+		cred_store_lane = (cred_store_lane_t)(cred_store_lane + 1);
+		cred_store_lane_step0 = step + 1;
+		return 0;
+	}
+
+	return wait;
+}
+
+// Every system tick. The AT24 gets one record at a time, and only with the
+// write queue empty, so access records never wait behind a batch:
+//  IDLE     dirty pin_db / card_db records; a complete batch once they are in
+//  JOURNAL  the batch pages; then the head version goes to the flash, which
+//           commits the batch, and the batch to the RAM tables
+//  PERSIST  their dirty records; then journal page 0 is invalidated
+void cred_store_update(void)
+{
+	static const uint8_t closed[4] = {0};
+
+	if (!cred_store_b_ready || (0 != pending_memory()))
+	{
+		return;
+	}
+
+	switch (cred_store_st)
+	{
+		case CRED_STORE_IDLE:
+
+			if (pin_db_flush() || card_db_flush())
+			{
+				break;
+			}
+
+			if ((0 != cred_store_count) && (CRED_STORE_ALL(cred_store_count) == cred_store_mask))
+			{
+				cred_store_slot = 0;
+				cred_store_st = CRED_STORE_JOURNAL;
+			}
+
+			break;
+
+		case CRED_STORE_JOURNAL:
+
+			if (cred_store_count > cred_store_slot)
+			{
+				if (cred_store_journal_write(cred_store_slot))
+				{
+					cred_store_slot++;
+				}
+				break;
+			}
+
+			eeprom_emu_write(EE_CRED_GEN, cred_store_target);
+			eeprom_emu_commit();
+			cred_store_apply_batch();
+			cred_store_stats.batches++;
+			cred_store_st = CRED_STORE_PERSIST;
+
+			break;
+
+		case CRED_STORE_PERSIST:
+
+			if (pin_db_flush() || card_db_flush())
+			{
+				break;
+			}
+
+			if (write_memory(CRED_STORE_CONFIG_JOURNAL + CRED_STORE_PAGE_USED, closed, sizeof(closed)))
+			{
+				cred_store_st = CRED_STORE_CLOSE;
+			}
+
+			break;
+
+		default:
+
+			cred_store_count = 0;
+			cred_store_st = CRED_STORE_IDLE;
+
+			break;
+	}
+}
+
+// Change 'index' of the batch that takes the head version from base to
+// target. The batch is applied as a whole once all its changes are in;
+// changes of another batch start it over.
+cred_store_result_t cred_store_stage(uint16_t base, uint16_t target, uint8_t index, uint8_t count,
+									 const cred_change_t *p_change)
+{
+	bool b_same = (base == cred_store_base) && (target == cred_store_target) && (count == cred_store_count);
+
+	if ((0 == count) || (CRED_STORE_CONFIG_BATCH < count) || (count <= index) ||
+		((uint16_t)(target - base) >= 0x8000u) || (base == target) || (CRED_OP_QTY <= p_change->op))
+	{
+		return CRED_STORE_BAD;
+	}
+
+	if (target == cred_store_vv.head)
+	{
+		return CRED_STORE_DONE;
+	}
+
+	if (!cred_store_b_ready || ((CRED_STORE_IDLE != cred_store_st) && !b_same))
+	{
+		cred_store_stats.stale++;
+		return CRED_STORE_BUSY;
+	}
+
+	if (base != cred_store_vv.head)
+	{
+		cred_store_stats.stale++;
+		return CRED_STORE_STALE;
+	}
+
+	if (CRED_STORE_IDLE != cred_store_st)
+	{
+		/* A resend of the batch being written */
+		return CRED_STORE_STAGED;
+	}
+
+	if (!b_same)
+	{
+		cred_store_base = base;
+		cred_store_target = target;
+		cred_store_count = count;
+		cred_store_mask = 0;
+	}
+
+	cred_store_batch[index] = *p_change;
+	cred_store_mask |= (uint8_t)(1u << index);
+
+	return CRED_STORE_STAGED;
+}
+
+// Changes of the batch in, bit per index.
+uint8_t cred_store_staged(void)
+{
+	return cred_store_mask;
+}
+
+// Changes made here after version since, oldest first, up to max. *p_first
+// is the version of changes[0]: past since + 1 when older ones are gone
+// (only the last CRED_STORE_CONFIG_LOCAL are kept, and none over a reset).
+uint8_t cred_store_since(uint16_t since, uint16_t *p_first, cred_change_t changes[], uint8_t max)
+{
+	uint16_t oldest = cred_store_vv.local - cred_store_local_qty + 1;
+	uint16_t version = since + 1;
+	uint8_t qty = 0;
+
+	if ((uint16_t)(cred_store_vv.local - since) >= 0x8000u)
+	{
+		/* The head-end is ahead of this door: nothing to send */
+		version = cred_store_vv.local + 1;
+	}
+	else if ((uint16_t)(version - oldest) >= 0x8000u)
+	{
+		version = oldest;
+	}
+
+	*p_first = version;
+	for (; (max > qty) && (version != (uint16_t)(cred_store_vv.local + 1)); version++)
+	{
+		changes[qty++] = cred_store_local[version % CRED_STORE_CONFIG_LOCAL];
+	}
+
+	return qty;
+}
+
+// Console changes: the table, then the journal of changes made here.
+uint16_t cred_store_pin_add(const char *p_pin, pin_role_t role, uint16_t uses)
+{
+	cred_change_t change = {CRED_OP_PIN_PUT, (uint8_t)role, 0, 0, 0, {0}};
+
+	if (!cred_store_local_ready())
+	{
+		return PIN_DB_NONE;
+	}
+
+	change.id = pin_db_add(p_pin, role, uses);
+	if (PIN_DB_NONE == change.id)
+	{
+		return PIN_DB_NONE;
+	}
+
+	change.uses = (PIN_ROLE_TEMP == role) ? uses : 0;
+	pin_db_key(change.id, &change.key, change.digest);
+	cred_store_local_add(&change);
+
+	return change.id;
+}
+
+bool cred_store_pin_remove(uint16_t user)
+{
+	cred_change_t change = {CRED_OP_PIN_DEL, 0, user, 0, 0, {0}};
+
+	if (!cred_store_local_ready() || !pin_db_remove(user))
+	{
+		return false;
+	}
+
+	cred_store_local_add(&change);
+
+	return true;
+}
+
+uint16_t cred_store_card_add(uint32_t uid)
+{
+	cred_change_t change = {CRED_OP_CARD_PUT, 0, 0, 0, uid, {0}};
+
+	if (!cred_store_local_ready())
+	{
+		return CARD_DB_NONE;
+	}
+
+	change.id = card_db_add(uid);
+	if (CARD_DB_NONE == change.id)
+	{
+		return CARD_DB_NONE;
+	}
+
+	cred_store_local_add(&change);
+
+	return change.id;
+}
+
+bool cred_store_card_remove(uint16_t card)
+{
+	cred_change_t change = {CRED_OP_CARD_DEL, 0, card, 0, 0, {0}};
+
+	if (!cred_store_local_ready() || !card_db_remove(card))
+	{
+		return false;
+	}
+
+	cred_store_local_add(&change);
+
+	return true;
+}
+
+// Wire form, little endian: op, role, id, uses, key, digest.
+uint16_t cred_store_pack(uint8_t *p, const cred_change_t *p_change)
+{
+	p[0] = p_change->op;
+	p[1] = p_change->role;
+	memcpy(&p[2], &p_change->id, 2);
+	memcpy(&p[4], &p_change->uses, 2);
+	memcpy(&p[6], &p_change->key, 4);
+	memcpy(&p[10], p_change->digest, PIN_HASH_SIZE);
+
+	return CRED_STORE_WIRE_SIZE;
+}
+
+bool cred_store_unpack(cred_change_t *p_change, const uint8_t *p)
+{
+	p_change->op = p[0];
+	p_change->role = p[1];
+	memcpy(&p_change->id, &p[2], 2);
+	memcpy(&p_change->uses, &p[4], 2);
+	memcpy(&p_change->key, &p[6], 4);
+	memcpy(p_change->digest, &p[10], PIN_HASH_SIZE);
+
+	return (CRED_OP_QTY > p_change->op);
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,304 @@
+/*
+ *
+ * @file   : eeprom_emu.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "logger.h"
+#include "eeprom_emu.h"
+
+/********************** macros and definitions *******************************/
+/* Page: status (16 bit), reserved (16 bit), erase count (32 bit), then 4 byte
+ * records: value (16 bit) followed by id (16 bit). The id is programmed last,
+ * so a record cut by a reset has no id and is skipped. */
+#define EE_PAGE_ERASED			(0xFFFFu)
+#define EE_PAGE_RECEIVE			(0xEEEEu)	// Being filled by a transfer
+#define EE_PAGE_VALID			(0x0000u)	// Programmed over RECEIVE: 0 is always writable
+
+#define EE_OFS_STATUS			(0u)
+#define EE_OFS_COUNT			(4u)
+#define EE_OFS_RECORDS			(8u)
+#define EE_RECORD_SIZE			(4u)
+
+#define EE_HALFWORD(addr)		(*(__IO uint16_t *)(addr))
+#define EE_WORD(addr)			(*(__IO uint32_t *)(addr))
+
+typedef struct
+{
+	uint16_t	value[EE_QTY];
+	uint32_t	present;		// Bit per id: found in flash or written
+	uint32_t	dirty;			// Bit per id: not in flash yet
+	uint32_t	page;			// Active page address, 0: none
+	uint32_t	next;			// Next free record address
+	uint32_t	deadline;		// HAL tick of the coalesced commit
+} eeprom_emu_t;
+
+/********************** internal data definition *****************************/
+static eeprom_emu_t eeprom_emu;
+
+/********************** external data definition *****************************/
+eeprom_emu_stats_t eeprom_emu_stats;
+
+/********************** internal functions definition ************************/
+static uint32_t eeprom_emu_other(uint32_t page)
+{
+	return (EEPROM_EMU_PAGE_0 == page) ? EEPROM_EMU_PAGE_1 : EEPROM_EMU_PAGE_0;
+}
+
+static bool eeprom_emu_program(uint32_t addr, uint16_t data)
+{
+	if (HAL_OK != HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, addr, data))
+	{
+		eeprom_emu_stats.errors++;
+		return false;
+	}
+
+	return true;
+}
+
+static bool eeprom_emu_erase(uint32_t page)
+{
+	FLASH_EraseInitTypeDef erase = {FLASH_TYPEERASE_PAGES, FLASH_BANK_1, page, 1};
+	uint32_t page_error;
+
+	if (HAL_OK != HAL_FLASHEx_Erase(&erase, &page_error))
+	{
+		eeprom_emu_stats.errors++;
+		return false;
+	}
+
+	return true;
+}
+
+static bool eeprom_emu_blank(uint32_t page)
+{
+	uint32_t addr;
+
+	for (addr = page; (page + EEPROM_EMU_PAGE_SIZE) > addr; addr += 4)
+	{
+		if (0xFFFFFFFFul != EE_WORD(addr))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Loads the cache from the records of a page, the last record of an id wins.
+static void eeprom_emu_load(uint32_t page)
+{
+	uint32_t addr;
+	uint16_t id;
+
+	eeprom_emu.page = page;
+	eeprom_emu.next = page + EE_OFS_RECORDS;
+	eeprom_emu_stats.erase_count = EE_WORD(page + EE_OFS_COUNT);
+
+	for (addr = page + EE_OFS_RECORDS; (page + EEPROM_EMU_PAGE_SIZE) > addr; addr += EE_RECORD_SIZE)
+	{
+		if (0xFFFFFFFFul == EE_WORD(addr))
+		{
+			continue;
+		}
+
+		eeprom_emu.next = addr + EE_RECORD_SIZE;
+		id = EE_HALFWORD(addr + 2);
+		if (EE_QTY > id)
+		{
+			eeprom_emu.value[id] = EE_HALFWORD(addr);
+			eeprom_emu.present |= (1ul << id);
+		}
+	}
+}
+
+// Page transfer: the new page gets one record per known id. Each step leaves
+// the pair of pages in a state eeprom_emu_init() can finish or undo:
+// RECEIVE + VALID (undo), RECEIVE + ERASED (finish).
+static bool eeprom_emu_swap(void)
+{
+	uint32_t page = (0 != eeprom_emu.page) ? eeprom_emu_other(eeprom_emu.page) : EEPROM_EMU_PAGE_0;
+	uint32_t count = (0 != eeprom_emu.page) ? EE_WORD(eeprom_emu.page + EE_OFS_COUNT) + 1 : 1;
+	uint32_t addr = page + EE_OFS_RECORDS;
+	uint32_t id;
+
+	if (!eeprom_emu_blank(page) && !eeprom_emu_erase(page))
+	{
+		return false;
+	}
+
+	if (!eeprom_emu_program(page + EE_OFS_COUNT, (uint16_t)count) ||
+		!eeprom_emu_program(page + EE_OFS_COUNT + 2, (uint16_t)(count >> 16)) ||
+		!eeprom_emu_program(page + EE_OFS_STATUS, EE_PAGE_RECEIVE))
+	{
+		return false;
+	}
+
+	for (id = 0; EE_QTY > id; id++)
+	{
+		if (0 != (eeprom_emu.present & (1ul << id)))
+		{
+			if (!eeprom_emu_program(addr, eeprom_emu.value[id]) || !eeprom_emu_program(addr + 2, (uint16_t)id))
+			{
+				return false;
+			}
+			addr += EE_RECORD_SIZE;
+			eeprom_emu_stats.records++;
+		}
+	}
+
+	if ((0 != eeprom_emu.page) && !eeprom_emu_erase(eeprom_emu.page))
+	{
+		return false;
+	}
+
+	if (!eeprom_emu_program(page + EE_OFS_STATUS, EE_PAGE_VALID))
+	{
+		return false;
+	}
+
+	eeprom_emu.page = page;
+	eeprom_emu.next = addr;
+	eeprom_emu.dirty = 0;
+	eeprom_emu_stats.erase_count = count;
+	eeprom_emu_stats.swaps++;
+
+	return true;
+}
+
+/********************** external functions definition ************************/
+// Finds the active page, finishing or undoing a transfer cut by a reset, and
+// fills the RAM cache. Reads never touch the flash after this.
+void eeprom_emu_init(void)
+{
+	uint16_t status_0 = EE_HALFWORD(EEPROM_EMU_PAGE_0 + EE_OFS_STATUS);
+	uint16_t status_1 = EE_HALFWORD(EEPROM_EMU_PAGE_1 + EE_OFS_STATUS);
+
+	memset(&eeprom_emu, 0, sizeof(eeprom_emu));
+	memset(&eeprom_emu_stats, 0, sizeof(eeprom_emu_stats));
+
+	HAL_FLASH_Unlock();
+
+	if (EE_PAGE_VALID == status_0)
+	{
+		eeprom_emu_load(EEPROM_EMU_PAGE_0);
+		if ((EE_PAGE_ERASED != status_1) || !eeprom_emu_blank(EEPROM_EMU_PAGE_1))
+		{
+			eeprom_emu_erase(EEPROM_EMU_PAGE_1);
+		}
+	}
+	else if (EE_PAGE_VALID == status_1)
+	{
+		eeprom_emu_load(EEPROM_EMU_PAGE_1);
+		if ((EE_PAGE_ERASED != status_0) || !eeprom_emu_blank(EEPROM_EMU_PAGE_0))
+		{
+			eeprom_emu_erase(EEPROM_EMU_PAGE_0);
+		}
+	}
+	else if ((EE_PAGE_RECEIVE == status_0) || (EE_PAGE_RECEIVE == status_1))
+	{
+		/* The old page was already erased: the copy is complete */
+		eeprom_emu_load((EE_PAGE_RECEIVE == status_0) ? EEPROM_EMU_PAGE_0 : EEPROM_EMU_PAGE_1);
+		eeprom_emu_erase(eeprom_emu_other(eeprom_emu.page));
+		eeprom_emu_program(eeprom_emu.page + EE_OFS_STATUS, EE_PAGE_VALID);
+	}
+	else
+	{
+		/* Blank or unknown: start over */
+		eeprom_emu_swap();
+	}
+
+	HAL_FLASH_Lock();
+
+	LOGGER_LOG("ee page %08lX wear %lu\r\n", eeprom_emu.page, eeprom_emu_stats.erase_count);
+}
+
+// From the RAM cache. False if the id was never written (keep the default).
+bool eeprom_emu_read(eeprom_emu_id_t id, uint16_t *p_value)
+{
+	if ((EE_QTY <= id) || (0 == (eeprom_emu.present & (1ul << id))))
+	{
+		return false;
+	}
+
+	*p_value = eeprom_emu.value[id];
+
+	return true;
+}
+
+// RAM only: eeprom_emu_update() commits EEPROM_EMU_CONFIG_COMMIT_MS after the
+// last write, so a burst of menu changes costs one commit.
+void eeprom_emu_write(eeprom_emu_id_t id, uint16_t value)
+{
+	if ((EE_QTY <= id) || ((0 != (eeprom_emu.present & (1ul << id))) && (value == eeprom_emu.value[id])))
+	{
+		return;
+	}
+
+	eeprom_emu.value[id] = value;
+	eeprom_emu.present |= (1ul << id);
+	eeprom_emu.dirty |= (1ul << id);
+	eeprom_emu.deadline = HAL_GetTick() + EEPROM_EMU_CONFIG_COMMIT_MS;
+}
+
+void eeprom_emu_update(void)
+{
+	if ((0 != eeprom_emu.dirty) && ((int32_t)(HAL_GetTick() - eeprom_emu.deadline) >= 0))
+	{
+		eeprom_emu_commit();
+	}
+}
+
+// One record per changed id; a full page is transferred first. Flash writes
+// stall the CPU (about 50 uS per half word, 20 mS per page erase).
+void eeprom_emu_commit(void)
+{
+	uint32_t id;
+
+	if (0 == eeprom_emu.dirty)
+	{
+		return;
+	}
+
+	HAL_FLASH_Unlock();
+
+	for (id = 0; EE_QTY > id; id++)
+	{
+		if (0 == (eeprom_emu.dirty & (1ul << id)))
+		{
+			continue;
+		}
+
+		if (((eeprom_emu.page + EEPROM_EMU_PAGE_SIZE) <= eeprom_emu.next) || (0 == eeprom_emu.page))
+		{
+			/* The transfer writes every id, dirty ones included */
+			eeprom_emu_swap();
+			break;
+		}
+
+		if (eeprom_emu_program(eeprom_emu.next, eeprom_emu.value[id]) &&
+			eeprom_emu_program(eeprom_emu.next + 2, (uint16_t)id))
+		{
+			eeprom_emu.dirty &= ~(1ul << id);
+			eeprom_emu_stats.records++;
+		}
+		eeprom_emu.next += EE_RECORD_SIZE;
+	}
+
+	HAL_FLASH_Lock();
+
+	if (0 != eeprom_emu.dirty)
+	{
+		/* Failed: try again later, not on every tick */
+		eeprom_emu.deadline = HAL_GetTick() + EEPROM_EMU_CONFIG_COMMIT_MS;
+	}
+
+	eeprom_emu_stats.commits++;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,83 @@
+/*
+ *
+ * @file   : fmt.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include "fmt.h"
+
+/********************** macros and definitions *******************************/
+#define FMT_DEC_DIGITS_MAX	(10)	// 4294967295
+
+/********************** internal data definition *****************************/
+static const char fmt_hex_digit[16] = "0123456789ABCDEF";
+
+/********************** external functions definition ************************/
+char *fmt_str(char *p, const char *s)
+{
+	while ('\0' != *s)
+	{
+		*p++ = *s++;
+	}
+
+	return p;
+}
+
+// Zero padded to width; wider values are written in full, as printf does.
+char *fmt_dec(char *p, uint32_t value, uint8_t width)
+{
+	char digit[FMT_DEC_DIGITS_MAX];
+	uint8_t qty = 0;
+
+	do
+	{
+		digit[qty++] = (char)('0' + (value % 10));
+		value /= 10;
+	} while (0 != value);
+
+	while (width > qty)
+	{
+		*p++ = '0';
+		width--;
+	}
+
+	while (0 != qty)
+	{
+		*p++ = digit[--qty];
+	}
+
+	return p;
+}
+
+char *fmt_int(char *p, int32_t value)
+{
+	if (0 > value)
+	{
+		*p++ = '-';
+
+		return fmt_dec(p, (uint32_t)0 - (uint32_t)value, 0);
+	}
+
+	return fmt_dec(p, (uint32_t)value, 0);
+}
+
+// DS3231 registers are BCD already: no division needed.
+char *fmt_bcd2(char *p, uint8_t bcd)
+{
+	*p++ = (char)('0' + (bcd >> 4));
+	*p++ = (char)('0' + (bcd & 0x0F));
+
+	return p;
+}
+
+char *fmt_hex2(char *p, uint8_t value)
+{
+	*p++ = fmt_hex_digit[value >> 4];
+	*p++ = fmt_hex_digit[value & 0x0F];
+
+	return p;
+}
+
+/********************** end of file ******************************************/
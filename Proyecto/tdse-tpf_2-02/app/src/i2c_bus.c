@@ -0,0 +1,748 @@
+/*
+ *
+ * @file   : i2c_bus.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "logger.h"
+#include "dwt.h"
+#include "trace.h"
+#include "bench.h"
+#include "i2c_bus.h"
+
+/********************** macros and definitions *******************************/
+#define I2C_BUS_CLEAR_HALF_US		(5ul)	// Bus clear clock: 100 kHz
+#define I2C_BUS_CLEAR_CLOCKS		(9)
+
+#define I2C_BUS_LOCK(primask)		do { (primask) = __get_PRIMASK(); __disable_irq(); } while (0)
+#define I2C_BUS_UNLOCK(primask)		__set_PRIMASK(primask)
+
+typedef enum {
+	I2C_BUS_SLOT_FREE,
+	I2C_BUS_SLOT_RESERVED,		// Being filled by the submitter
+	I2C_BUS_SLOT_QUEUED,
+	I2C_BUS_SLOT_RUNNING,
+	I2C_BUS_SLOT_DONE			// i2c_bus_poll() collects the result
+} i2c_bus_slot_st_t;
+
+typedef struct
+{
+	i2c_bus_xfer_t				xfer;
+	volatile uint8_t			state;
+	volatile bool				b_orphan;	// The poller timed out
+	bool						b_polled;
+	uint8_t						retries;
+	volatile HAL_StatusTypeDef	status;
+	uint8_t						data[I2C_BUS_CONFIG_INLINE];
+} i2c_bus_slot_t;
+
+typedef struct
+{
+	I2C_HandleTypeDef *	hi2c;
+	i2c_bus_slot_t		slot[I2C_BUS_CONFIG_SLOTS];
+	uint8_t				fifo[I2C_BUS_PRIO_QTY][I2C_BUS_CONFIG_SLOTS];
+	uint8_t				head[I2C_BUS_PRIO_QTY];
+	uint8_t				count[I2C_BUS_PRIO_QTY];
+	i2c_bus_slot_t *	p_run;
+	uint32_t			start;			// Cycle counter
+	uint32_t			deadline;		// HAL tick
+	volatile bool		b_recover;		// Hold the queue until the bus is cleared
+} i2c_bus_t;
+
+typedef struct
+{
+	GPIO_TypeDef *		port;
+	uint16_t			scl;
+	uint16_t			sda;
+} i2c_bus_pins_t;
+
+/********************** internal data definition *****************************/
+static i2c_bus_t i2c_bus[I2C_BUS_QTY];
+static bool i2c_bus_b_sync_end;
+
+/* I2C1 is remapped to PB8/PB9 */
+static const i2c_bus_pins_t i2c_bus_pins[I2C_BUS_QTY] = {
+	{GPIOB, GPIO_PIN_8, GPIO_PIN_9},
+	{GPIOB, GPIO_PIN_10, GPIO_PIN_11}
+};
+
+/********************** external data definition *****************************/
+i2c_bus_stats_t i2c_bus_stats[I2C_BUS_QTY];
+i2c_bus_dev_t i2c_bus_dev[I2C_BUS_QTY][I2C_BUS_CONFIG_DEVICES];
+
+/********************** internal functions definition ************************/
+static void i2c_bus_kick(i2c_bus_id_t bus);
+
+static void i2c_bus_delay_us(uint32_t us)
+{
+	uint32_t start = cycle_counter_get();
+
+	while ((cycle_counter_get() - start) < (us * cycles_per_us))
+	{
+	}
+}
+
+// Entry of the device, added on first use. NULL when the table is full.
+static i2c_bus_dev_t *i2c_bus_dev_get(i2c_bus_id_t bus, uint16_t address)
+{
+	uint32_t index;
+
+	for (index = 0; I2C_BUS_CONFIG_DEVICES > index; index++)
+	{
+		if ((address == i2c_bus_dev[bus][index].address) || (0 == i2c_bus_dev[bus][index].address))
+		{
+			i2c_bus_dev[bus][index].address = address;
+
+			return &i2c_bus_dev[bus][index];
+		}
+	}
+
+	return NULL;
+}
+
+// Fast fail: a device that keeps failing is not waited on again until its
+// back-off is over.
+static bool i2c_bus_refused(i2c_bus_id_t bus, uint16_t address)
+{
+	i2c_bus_dev_t *p_dev;
+	bool b_refused = false;
+	uint32_t primask;
+
+	I2C_BUS_LOCK(primask);
+	p_dev = i2c_bus_dev_get(bus, address);
+	if ((NULL != p_dev) && (I2C_BUS_CONFIG_FAIL_MAX <= p_dev->fails) && ((int32_t)(HAL_GetTick() - p_dev->down_until) < 0))
+	{
+		i2c_bus_stats[bus].fast_fails++;
+		b_refused = true;
+	}
+	I2C_BUS_UNLOCK(primask);
+
+	return b_refused;
+}
+
+// Called with interrupts masked or from the I2C interrupt.
+static void i2c_bus_complete(i2c_bus_id_t bus, HAL_StatusTypeDef status)
+{
+	i2c_bus_t *p_bus = &i2c_bus[bus];
+	i2c_bus_slot_t *p_slot = p_bus->p_run;
+	i2c_bus_stats_t *p_stats = &i2c_bus_stats[bus];
+	i2c_bus_dev_t *p_dev;
+	uint32_t prio;
+
+	if (NULL == p_slot)
+	{
+		return;
+	}
+
+	p_bus->p_run = NULL;
+
+	BENCH_I2C_END(bus + 1);
+	TRACE_I2C_END(bus + 1, status);
+
+	p_stats->busy_cycles += cycle_counter_get() - p_bus->start;
+	p_dev = i2c_bus_dev_get(bus, p_slot->xfer.address);
+
+	if ((HAL_OK != status) && !p_slot->b_orphan && (I2C_BUS_CONFIG_RETRIES > p_slot->retries))
+	{
+		/* Back to the front of its queue; after a bus clear if one is due */
+		p_slot->retries++;
+		p_stats->retries++;
+		if (NULL != p_dev)
+		{
+			p_dev->retries++;
+		}
+
+		prio = p_slot->xfer.priority;
+		p_bus->head[prio] = (p_bus->head[prio] + I2C_BUS_CONFIG_SLOTS - 1) % I2C_BUS_CONFIG_SLOTS;
+		p_bus->fifo[prio][p_bus->head[prio]] = (uint8_t)(p_slot - p_bus->slot);
+		p_bus->count[prio]++;
+		p_slot->state = I2C_BUS_SLOT_QUEUED;
+
+		i2c_bus_kick(bus);
+		return;
+	}
+
+	p_stats->xfers++;
+	p_stats->bytes += p_slot->xfer.size;
+	p_stats->depth--;
+
+	if (NULL != p_dev)
+	{
+		p_dev->xfers++;
+	}
+
+	if (HAL_OK != status)
+	{
+		p_stats->errors++;
+		if (NULL != p_dev)
+		{
+			p_dev->errors++;
+			if (I2C_BUS_CONFIG_FAIL_MAX <= ++p_dev->fails)
+			{
+				p_dev->fails = I2C_BUS_CONFIG_FAIL_MAX;
+				p_dev->down_until = HAL_GetTick() + I2C_BUS_CONFIG_BACKOFF_MS;
+			}
+		}
+	}
+	else if (NULL != p_dev)
+	{
+		p_dev->fails = 0;
+	}
+
+	p_slot->status = status;
+
+	if (NULL != p_slot->xfer.p_cb)
+	{
+		p_slot->xfer.p_cb(status, p_slot->xfer.p_arg);
+	}
+
+	p_slot->state = (p_slot->b_polled && !p_slot->b_orphan) ? I2C_BUS_SLOT_DONE : I2C_BUS_SLOT_FREE;
+
+	i2c_bus_kick(bus);
+}
+
+static HAL_StatusTypeDef i2c_bus_start(i2c_bus_t *p_bus, const i2c_bus_xfer_t *p_xfer)
+{
+	switch (p_xfer->op)
+	{
+		case I2C_BUS_OP_WRITE:
+
+			return HAL_I2C_Master_Transmit_IT(p_bus->hi2c, p_xfer->address, p_xfer->p_data, p_xfer->size);
+
+		case I2C_BUS_OP_READ:
+
+			return HAL_I2C_Master_Receive_IT(p_bus->hi2c, p_xfer->address, p_xfer->p_data, p_xfer->size);
+
+		case I2C_BUS_OP_MEM_WRITE:
+
+			return HAL_I2C_Mem_Write_IT(p_bus->hi2c, p_xfer->address, p_xfer->mem_addr, p_xfer->mem_size, p_xfer->p_data, p_xfer->size);
+
+		case I2C_BUS_OP_MEM_READ:
+
+			return HAL_I2C_Mem_Read_IT(p_bus->hi2c, p_xfer->address, p_xfer->mem_addr, p_xfer->mem_size, p_xfer->p_data, p_xfer->size);
+
+		default:
+
+			return HAL_ERROR;
+	}
+}
+
+// Starts the oldest transaction of the highest priority if the bus is idle.
+// Called with interrupts masked or from the I2C interrupt.
+static void i2c_bus_kick(i2c_bus_id_t bus)
+{
+	i2c_bus_t *p_bus = &i2c_bus[bus];
+	i2c_bus_slot_t *p_slot;
+	HAL_StatusTypeDef status;
+	uint32_t prio;
+
+	while ((NULL == p_bus->p_run) && !p_bus->b_recover)
+	{
+		for (prio = 0; I2C_BUS_PRIO_QTY > prio; prio++)
+		{
+			if (0 != p_bus->count[prio])
+			{
+				break;
+			}
+		}
+
+		if (I2C_BUS_PRIO_QTY == prio)
+		{
+			return;
+		}
+
+		p_slot = &p_bus->slot[p_bus->fifo[prio][p_bus->head[prio]]];
+		p_bus->head[prio] = (p_bus->head[prio] + 1) % I2C_BUS_CONFIG_SLOTS;
+		p_bus->count[prio]--;
+
+		if (p_slot->b_orphan)
+		{
+			i2c_bus_stats[bus].depth--;
+			p_slot->state = I2C_BUS_SLOT_FREE;
+			continue;
+		}
+
+		p_slot->state = I2C_BUS_SLOT_RUNNING;
+		p_bus->p_run = p_slot;
+		p_bus->start = cycle_counter_get();
+		p_bus->deadline = HAL_GetTick() + I2C_BUS_CONFIG_XFER_MIN_MS +
+						  ((p_slot->xfer.size * I2C_BUS_CONFIG_BYTE_US) + 999) / 1000;
+
+		TRACE_I2C_START(bus + 1, p_slot->xfer.address, p_slot->xfer.size);
+		BENCH_I2C_START(bus + 1, p_slot->xfer.size);
+
+		status = i2c_bus_start(p_bus, &p_slot->xfer);
+
+		if (HAL_OK != status)
+		{
+			/* HAL_BUSY: BUSY flag stuck, a slave holds SDA low */
+			if (HAL_BUSY == status)
+			{
+				p_bus->b_recover = true;
+			}
+
+			/* Completes now and moves on to the next one */
+			i2c_bus_complete(bus, status);
+		}
+	}
+}
+
+// Reserves a free slot. With none free it does not wait: a stuck transfer
+// holds its slot until i2c_bus_update() fails it, so the caller tries again
+// on a later tick.
+static i2c_bus_slot_t *i2c_bus_reserve(i2c_bus_id_t bus)
+{
+	i2c_bus_t *p_bus = &i2c_bus[bus];
+	uint32_t primask;
+	uint32_t index;
+
+	I2C_BUS_LOCK(primask);
+	for (index = 0; I2C_BUS_CONFIG_SLOTS > index; index++)
+	{
+		if (I2C_BUS_SLOT_FREE == p_bus->slot[index].state)
+		{
+			p_bus->slot[index].state = I2C_BUS_SLOT_RESERVED;
+			p_bus->slot[index].b_orphan = false;
+			p_bus->slot[index].b_polled = false;
+			I2C_BUS_UNLOCK(primask);
+
+			return &p_bus->slot[index];
+		}
+	}
+	I2C_BUS_UNLOCK(primask);
+
+	i2c_bus_stats[bus].dropped++;
+
+	return NULL;
+}
+
+static void i2c_bus_enqueue(i2c_bus_id_t bus, i2c_bus_slot_t *p_slot)
+{
+	i2c_bus_t *p_bus = &i2c_bus[bus];
+	i2c_bus_stats_t *p_stats = &i2c_bus_stats[bus];
+	uint32_t prio = (I2C_BUS_PRIO_QTY > p_slot->xfer.priority) ? p_slot->xfer.priority : I2C_BUS_PRIO_LOW;
+	uint32_t primask;
+
+	I2C_BUS_LOCK(primask);
+	p_bus->fifo[prio][(p_bus->head[prio] + p_bus->count[prio]) % I2C_BUS_CONFIG_SLOTS] = (uint8_t)(p_slot - p_bus->slot);
+	p_bus->count[prio]++;
+	p_slot->state = I2C_BUS_SLOT_QUEUED;
+
+	p_stats->depth++;
+	if (p_stats->depth > p_stats->depth_max)
+	{
+		p_stats->depth_max = p_stats->depth;
+	}
+
+	i2c_bus_kick(bus);
+	I2C_BUS_UNLOCK(primask);
+}
+
+// Appends to the last queued plain write of the same device if it has not
+// started yet: back-to-back writes (LCD characters) go out as one transfer.
+static bool i2c_bus_merge(i2c_bus_id_t bus, uint16_t address, const uint8_t *p_data, uint16_t size, uint8_t priority)
+{
+	i2c_bus_t *p_bus = &i2c_bus[bus];
+	i2c_bus_slot_t *p_slot;
+	bool b_merged = false;
+	uint32_t primask;
+
+	I2C_BUS_LOCK(primask);
+	if (0 != p_bus->count[priority])
+	{
+		p_slot = &p_bus->slot[p_bus->fifo[priority][(p_bus->head[priority] + p_bus->count[priority] - 1) % I2C_BUS_CONFIG_SLOTS]];
+
+		if ((I2C_BUS_SLOT_QUEUED == p_slot->state) && (I2C_BUS_OP_WRITE == p_slot->xfer.op) &&
+			(address == p_slot->xfer.address) && (NULL == p_slot->xfer.p_cb) &&
+			(I2C_BUS_CONFIG_INLINE >= (p_slot->xfer.size + size)))
+		{
+			memcpy(&p_slot->data[p_slot->xfer.size], p_data, size);
+			p_slot->xfer.size += size;
+			b_merged = true;
+		}
+	}
+	I2C_BUS_UNLOCK(primask);
+
+	return b_merged;
+}
+
+static bool i2c_bus_copy(i2c_bus_id_t bus, const i2c_bus_xfer_t *p_xfer, const uint8_t *p_data)
+{
+	i2c_bus_slot_t *p_slot;
+
+	if ((I2C_BUS_CONFIG_INLINE < p_xfer->size) || i2c_bus_refused(bus, p_xfer->address))
+	{
+		return false;
+	}
+
+	if ((I2C_BUS_OP_WRITE == p_xfer->op) && i2c_bus_merge(bus, p_xfer->address, p_data, p_xfer->size, p_xfer->priority))
+	{
+		return true;
+	}
+
+	if (NULL == (p_slot = i2c_bus_reserve(bus)))
+	{
+		return false;
+	}
+
+	p_slot->xfer = *p_xfer;
+	p_slot->xfer.p_data = p_slot->data;
+	memcpy(p_slot->data, p_data, p_xfer->size);
+
+	i2c_bus_enqueue(bus, p_slot);
+
+	return true;
+}
+
+/********************** external functions definition ************************/
+void i2c_bus_init(void)
+{
+	memset(i2c_bus, 0, sizeof(i2c_bus));
+	memset(i2c_bus_dev, 0, sizeof(i2c_bus_dev));
+
+	i2c_bus[I2C_BUS_1].hi2c = &hi2c1;
+	i2c_bus[I2C_BUS_2].hi2c = &hi2c2;
+
+	i2c_bus_stats_reset();
+}
+
+// Queues a caller-owned descriptor; p_xfer->p_data must live until the callback.
+bool i2c_bus_submit(i2c_bus_id_t bus, const i2c_bus_xfer_t *p_xfer)
+{
+	i2c_bus_slot_t *p_slot;
+
+	if (i2c_bus_refused(bus, p_xfer->address) || (NULL == (p_slot = i2c_bus_reserve(bus))))
+	{
+		return false;
+	}
+
+	p_slot->xfer = *p_xfer;
+	i2c_bus_enqueue(bus, p_slot);
+
+	return true;
+}
+
+// Fire and forget: the data is copied, the caller does not wait.
+bool i2c_bus_write(i2c_bus_id_t bus, uint16_t address, const uint8_t *p_data, uint16_t size)
+{
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_WRITE, I2C_BUS_PRIO_NORMAL, address, 0, 0, size, NULL, NULL, NULL};
+
+	return i2c_bus_copy(bus, &xfer, p_data);
+}
+
+bool i2c_bus_mem_write(i2c_bus_id_t bus, uint16_t address, uint16_t mem_addr, const uint8_t *p_data, uint16_t size)
+{
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_WRITE, I2C_BUS_PRIO_LOW, address, mem_addr, I2C_MEMADD_SIZE_16BIT, size, NULL, NULL, NULL};
+
+	return i2c_bus_copy(bus, &xfer, p_data);
+}
+
+// For callers that need the answer before they go on (init lanes): the
+// first call queues the transfer at high priority and every call returns
+// HAL_BUSY until it is done, so the caller calls again on a later tick with
+// the same descriptor and request. Works on a copy of the data, so a timeout
+// leaves nothing pointing into the caller's stack.
+HAL_StatusTypeDef i2c_bus_poll(i2c_bus_id_t bus, const i2c_bus_xfer_t *p_xfer, i2c_bus_req_t *p_req, uint32_t timeout_ms)
+{
+	i2c_bus_slot_t *p_slot = (i2c_bus_slot_t *)p_req->p_slot;
+	HAL_StatusTypeDef status;
+	uint32_t primask;
+
+	if (!p_req->b_started)
+	{
+		if ((I2C_BUS_CONFIG_INLINE < p_xfer->size) || i2c_bus_refused(bus, p_xfer->address))
+		{
+			return HAL_ERROR;
+		}
+
+		p_req->start = HAL_GetTick();
+		p_req->b_started = true;
+	}
+
+	if (NULL == p_slot)
+	{
+		if (NULL != (p_slot = i2c_bus_reserve(bus)))
+		{
+			p_slot->xfer = *p_xfer;
+			p_slot->xfer.priority = I2C_BUS_PRIO_HIGH;
+			p_slot->xfer.p_data = p_slot->data;
+			p_slot->xfer.p_cb = NULL;
+			p_slot->b_polled = true;
+
+			if ((I2C_BUS_OP_WRITE == p_xfer->op) || (I2C_BUS_OP_MEM_WRITE == p_xfer->op))
+			{
+				memcpy(p_slot->data, p_xfer->p_data, p_xfer->size);
+			}
+
+			i2c_bus_enqueue(bus, p_slot);
+			p_req->p_slot = p_slot;
+
+			return HAL_BUSY;
+		}
+
+		if ((HAL_GetTick() - p_req->start) < timeout_ms)
+		{
+			return HAL_BUSY;
+		}
+
+		memset(p_req, 0, sizeof(*p_req));
+
+		return HAL_TIMEOUT;
+	}
+
+	I2C_BUS_LOCK(primask);
+	if (I2C_BUS_SLOT_DONE != p_slot->state)
+	{
+		if ((HAL_GetTick() - p_req->start) < timeout_ms)
+		{
+			I2C_BUS_UNLOCK(primask);
+
+			return HAL_BUSY;
+		}
+
+		/* Freed by the queue when it gets to it */
+		p_slot->b_orphan = true;
+		I2C_BUS_UNLOCK(primask);
+		memset(p_req, 0, sizeof(*p_req));
+
+		return HAL_TIMEOUT;
+	}
+	I2C_BUS_UNLOCK(primask);
+
+	status = p_slot->status;
+
+	if ((HAL_OK == status) && ((I2C_BUS_OP_READ == p_xfer->op) || (I2C_BUS_OP_MEM_READ == p_xfer->op)))
+	{
+		memcpy(p_xfer->p_data, p_slot->data, p_xfer->size);
+	}
+
+	p_slot->state = I2C_BUS_SLOT_FREE;
+	memset(p_req, 0, sizeof(*p_req));
+
+	/* HAL_BUSY means "call again": a bus stuck busy is an error here */
+	return (HAL_BUSY == status) ? HAL_ERROR : status;
+}
+
+// i2c_bus_poll() until it is done. It spins, so it is only for code that runs
+// before the scheduler (task init functions): after i2c_bus_sync_end() it
+// refuses.
+HAL_StatusTypeDef i2c_bus_sync(i2c_bus_id_t bus, const i2c_bus_xfer_t *p_xfer, uint32_t timeout_ms)
+{
+	i2c_bus_req_t req = {NULL, 0, false};
+	HAL_StatusTypeDef status;
+
+	if (i2c_bus_b_sync_end)
+	{
+		return HAL_ERROR;
+	}
+
+	while (HAL_BUSY == (status = i2c_bus_poll(bus, p_xfer, &req, timeout_ms)))
+	{
+		i2c_bus_update();
+	}
+
+	return status;
+}
+
+// app_init(), once the tasks are initialized: from the first tick on no
+// caller may spin on the bus.
+void i2c_bus_sync_end(void)
+{
+	i2c_bus_b_sync_end = true;
+}
+
+// Task context, once per tick: fails the transfer that overran its deadline
+// and clears the bus before the queue moves on.
+void i2c_bus_update(void)
+{
+	i2c_bus_t *p_bus;
+	i2c_bus_dev_t *p_dev;
+	uint32_t primask;
+	uint32_t bus;
+
+	for (bus = 0; I2C_BUS_QTY > bus; bus++)
+	{
+		p_bus = &i2c_bus[bus];
+
+		I2C_BUS_LOCK(primask);
+		if ((NULL != p_bus->p_run) && ((int32_t)(HAL_GetTick() - p_bus->deadline) >= 0))
+		{
+			i2c_bus_stats[bus].timeouts++;
+			if (NULL != (p_dev = i2c_bus_dev_get(bus, p_bus->p_run->xfer.address)))
+			{
+				p_dev->timeouts++;
+			}
+
+			/* No more interrupts from the stuck transfer */
+			p_bus->b_recover = true;
+			HAL_I2C_DeInit(p_bus->hi2c);
+			i2c_bus_complete(bus, HAL_TIMEOUT);
+		}
+		I2C_BUS_UNLOCK(primask);
+
+		if (p_bus->b_recover)
+		{
+			i2c_bus_recover(bus);
+
+			I2C_BUS_LOCK(primask);
+			p_bus->b_recover = false;
+			i2c_bus_kick(bus);
+			I2C_BUS_UNLOCK(primask);
+		}
+	}
+}
+
+// Bus clear (I2C-bus specification 3.1.16): up to 9 clocks on SCL until the
+// slave releases SDA, then a STOP, then the peripheral is set up again.
+// Only with no transfer running on the bus.
+void i2c_bus_recover(i2c_bus_id_t bus)
+{
+	const i2c_bus_pins_t *p_pins = &i2c_bus_pins[bus];
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	uint32_t index;
+
+	HAL_I2C_DeInit(i2c_bus[bus].hi2c);
+
+	HAL_GPIO_WritePin(p_pins->port, p_pins->scl | p_pins->sda, GPIO_PIN_SET);
+	GPIO_InitStruct.Pin = p_pins->scl | p_pins->sda;
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+	HAL_GPIO_Init(p_pins->port, &GPIO_InitStruct);
+
+	for (index = 0; I2C_BUS_CLEAR_CLOCKS > index; index++)
+	{
+		if (GPIO_PIN_SET == HAL_GPIO_ReadPin(p_pins->port, p_pins->sda))
+		{
+			break;
+		}
+
+		HAL_GPIO_WritePin(p_pins->port, p_pins->scl, GPIO_PIN_RESET);
+		i2c_bus_delay_us(I2C_BUS_CLEAR_HALF_US);
+		HAL_GPIO_WritePin(p_pins->port, p_pins->scl, GPIO_PIN_SET);
+		i2c_bus_delay_us(I2C_BUS_CLEAR_HALF_US);
+	}
+
+	/* STOP: SDA low to high with SCL high */
+	HAL_GPIO_WritePin(p_pins->port, p_pins->scl, GPIO_PIN_RESET);
+	HAL_GPIO_WritePin(p_pins->port, p_pins->sda, GPIO_PIN_RESET);
+	i2c_bus_delay_us(I2C_BUS_CLEAR_HALF_US);
+	HAL_GPIO_WritePin(p_pins->port, p_pins->scl, GPIO_PIN_SET);
+	i2c_bus_delay_us(I2C_BUS_CLEAR_HALF_US);
+	HAL_GPIO_WritePin(p_pins->port, p_pins->sda, GPIO_PIN_SET);
+	i2c_bus_delay_us(I2C_BUS_CLEAR_HALF_US);
+
+	/* Back to alternate function; HAL_I2C_Init() also pulses SWRST */
+	HAL_GPIO_DeInit(p_pins->port, p_pins->scl | p_pins->sda);
+	HAL_I2C_Init(i2c_bus[bus].hi2c);
+
+	i2c_bus_stats[bus].recoveries++;
+}
+
+i2c_bus_id_t i2c_bus_of(I2C_HandleTypeDef *hi2c)
+{
+	return (&hi2c1 == hi2c) ? I2C_BUS_1 : I2C_BUS_2;
+}
+
+// Free slots now. Callers that must not wait in i2c_bus_reserve() (the LCD
+// flush) only queue while there are some.
+uint32_t i2c_bus_free(i2c_bus_id_t bus)
+{
+	uint32_t free = 0;
+	uint32_t index;
+
+	for (index = 0; I2C_BUS_CONFIG_SLOTS > index; index++)
+	{
+		free += (I2C_BUS_SLOT_FREE == i2c_bus[bus].slot[index].state) ? 1 : 0;
+	}
+
+	return free;
+}
+
+uint32_t i2c_bus_util_pct(i2c_bus_id_t bus)
+{
+	uint32_t elapsed = cycle_counter_get() - i2c_bus_stats[bus].window_start;
+
+	return (0 == elapsed) ? 0 : (uint32_t)(((uint64_t)i2c_bus_stats[bus].busy_cycles * 100) / elapsed);
+}
+
+void i2c_bus_stats_reset(void)
+{
+	uint32_t bus;
+	uint32_t depth;
+
+	for (bus = 0; I2C_BUS_QTY > bus; bus++)
+	{
+		depth = i2c_bus_stats[bus].depth;
+		memset(&i2c_bus_stats[bus], 0, sizeof(i2c_bus_stats_t));
+		i2c_bus_stats[bus].depth = depth;
+		i2c_bus_stats[bus].depth_max = depth;
+		i2c_bus_stats[bus].window_start = cycle_counter_get();
+	}
+}
+
+void i2c_bus_report(void)
+{
+	i2c_bus_dev_t *p_dev;
+	uint32_t bus;
+	uint32_t index;
+
+	for (bus = 0; I2C_BUS_QTY > bus; bus++)
+	{
+		LOGGER_LOG("i2c%lu util %lu%% xf %lu err %lu qd %lu\r\n", bus + 1,
+				   i2c_bus_util_pct(bus), i2c_bus_stats[bus].xfers,
+				   i2c_bus_stats[bus].errors, i2c_bus_stats[bus].depth_max);
+		LOGGER_LOG("i2c%lu to %lu rt %lu clr %lu ff %lu\r\n", bus + 1,
+				   i2c_bus_stats[bus].timeouts, i2c_bus_stats[bus].retries,
+				   i2c_bus_stats[bus].recoveries, i2c_bus_stats[bus].fast_fails);
+
+		for (index = 0; I2C_BUS_CONFIG_DEVICES > index; index++)
+		{
+			p_dev = &i2c_bus_dev[bus][index];
+			if (0 != p_dev->address)
+			{
+				LOGGER_LOG(" %02lX xf %lu er %lu rt %lu to %lu\r\n", (uint32_t)p_dev->address,
+						   p_dev->xfers, p_dev->errors, p_dev->retries, p_dev->timeouts);
+			}
+		}
+	}
+}
+
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	i2c_bus_complete(i2c_bus_of(hi2c), HAL_OK);
+}
+
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	i2c_bus_complete(i2c_bus_of(hi2c), HAL_OK);
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	i2c_bus_complete(i2c_bus_of(hi2c), HAL_OK);
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	i2c_bus_complete(i2c_bus_of(hi2c), HAL_OK);
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	i2c_bus_id_t bus = i2c_bus_of(hi2c);
+
+	/* A NACK only fails the transfer; bus or arbitration errors clear the bus */
+	if (0 != (hi2c->ErrorCode & (HAL_I2C_ERROR_BERR | HAL_I2C_ERROR_ARLO)))
+	{
+		i2c_bus[bus].b_recover = true;
+	}
+
+	i2c_bus_complete(bus, HAL_ERROR);
+}
+
+/********************** end of file ******************************************/
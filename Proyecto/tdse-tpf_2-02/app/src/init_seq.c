@@ -0,0 +1,112 @@
+/*
+ *
+ * @file   : init_seq.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "logger.h"
+#include "init_seq.h"
+
+/********************** macros and definitions *******************************/
+
+/********************** internal data definition *****************************/
+
+/********************** external data definition *****************************/
+init_seq_t init_seq;
+
+/********************** external functions definition ************************/
+void init_seq_start(const init_seq_lane_t *p_lanes, uint32_t qty)
+{
+	uint32_t index;
+
+	memset(&init_seq, 0, sizeof(init_seq));
+
+	init_seq.qty = (INIT_SEQ_LANES_MAX < qty) ? INIT_SEQ_LANES_MAX : qty;
+
+	for (index = 0; init_seq.qty > index; index++)
+	{
+		init_seq.lane[index].p_lane = p_lanes[index];
+	}
+}
+
+// One call per tick. Every lane whose wait is over runs one step, so a lane
+// waiting on a device (LCD power-up, RFID oscillator) never holds the others.
+bool init_seq_update(void)
+{
+	uint32_t index;
+	uint32_t pending = 0;
+	int32_t delay;
+	init_seq_lane_dta_t *p_lane;
+
+	if (init_seq.b_ready)
+	{
+		return true;
+	}
+
+	for (index = 0; init_seq.qty > index; index++)
+	{
+		p_lane = &init_seq.lane[index];
+
+		if (p_lane->b_done)
+		{
+			continue;
+		}
+
+		if (init_seq.tick >= p_lane->next)
+		{
+			delay = p_lane->p_lane(p_lane->step);
+
+			if (INIT_SEQ_DONE == delay)
+			{
+				p_lane->step++;
+				p_lane->b_done = true;
+				p_lane->done = init_seq.tick;
+				continue;
+			}
+
+			if (INIT_SEQ_AGAIN == delay)
+			{
+				delay = 0;
+			}
+			else
+			{
+				p_lane->step++;
+			}
+
+			p_lane->next = init_seq.tick + (uint32_t)delay;
+		}
+
+		pending++;
+	}
+
+	init_seq.tick++;
+
+	if (0 == pending)
+	{
+		init_seq.b_ready = true;
+		init_seq.ready_ms = HAL_GetTick();
+		init_seq_report();
+	}
+
+	return init_seq.b_ready;
+}
+
+void init_seq_report(void)
+{
+	uint32_t index;
+
+	LOGGER_LOG("init ready %lu ms after reset\r\n", init_seq.ready_ms);
+
+	for (index = 0; init_seq.qty > index; index++)
+	{
+		LOGGER_LOG(" lane %lu done at %lu ms (%lu steps)\r\n", index,
+				   init_seq.lane[index].done, init_seq.lane[index].step);
+	}
+}
+
+/********************** end of file ******************************************/
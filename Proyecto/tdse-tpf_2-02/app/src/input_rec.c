@@ -0,0 +1,467 @@
+/*
+ *
+ * @file   : input_rec.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include "main.h"
+#include "logger.h"
+#include "keypad_4x4.h"
+#include "mfrc522.h"
+#include "ds3231.h"
+#include "app.h"
+#include "input_rec.h"
+
+/********************** macros and definitions *******************************/
+#define INPUT_REC_INDEX_MASK	(INPUT_REC_CONFIG_SIZE - 1)
+#define INPUT_REC_RECORD_MAX	(5 + 5 + 1 + INPUT_REC_PAYLOAD_MAX)	// Two varints, channel, payload
+#define INPUT_REC_FLUSH_LINE	(24)	// Bytes per logger line
+
+/* Stream header: "INR" + version */
+#define INPUT_REC_HEADER_0		('I')
+#define INPUT_REC_HEADER_1		('N')
+#define INPUT_REC_HEADER_2		('R')
+#define INPUT_REC_HEADER_SIZE	(4)
+
+#if (INPUT_REC_MODE_RECORD == INPUT_REC_CONFIG_MODE) && (1 != LOGGER_CONFIG_ENABLE)
+#error "INPUT_REC_MODE_RECORD drains the ring over the logger: set LOGGER_CONFIG_ENABLE"
+#endif
+
+/********************** internal data definition *****************************/
+static const uint8_t input_rec_payload_len[INPUT_REC_CH_QTY] = {
+	1, 2, 1, 6, 4, 3,
+	2, 2, 2, 2, 2, 2, 2, 2
+};
+
+#if INPUT_REC_MODE_OFF != INPUT_REC_CONFIG_MODE
+static uint8_t input_rec_last[INPUT_REC_CH_QTY][INPUT_REC_PAYLOAD_MAX];
+static bool input_rec_seen[INPUT_REC_CH_QTY];
+static uint32_t input_rec_last_reads;
+static uint32_t input_rec_last_tick;
+
+/* Replay: next record already decoded from the stream */
+static bool input_rec_next_valid;
+static uint32_t input_rec_next_reads;
+static uint32_t input_rec_next_tick;
+static uint8_t input_rec_next_ch;
+static uint8_t input_rec_next_payload[INPUT_REC_PAYLOAD_MAX];
+#endif
+
+/* Script: values that replace the live ones, one bit per channel */
+static const input_rec_step_t *input_rec_p_step;
+static uint32_t input_rec_script_start;
+static uint16_t input_rec_script_held;
+static uint8_t input_rec_script_value[INPUT_REC_CH_QTY][INPUT_REC_PAYLOAD_MAX];
+
+/********************** external data definition *****************************/
+#if INPUT_REC_MODE_OFF != INPUT_REC_CONFIG_MODE
+input_rec_log_t input_rec_log;
+#endif
+
+/********************** internal functions definition ************************/
+#if INPUT_REC_MODE_OFF != INPUT_REC_CONFIG_MODE
+static void input_rec_put_byte(uint8_t byte)
+{
+	input_rec_log.data[input_rec_log.head & INPUT_REC_INDEX_MASK] = byte;
+	input_rec_log.head++;
+}
+
+static void input_rec_put_varint(uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		input_rec_put_byte((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	input_rec_put_byte((uint8_t)value);
+}
+
+static bool input_rec_get_byte(uint8_t *p_byte)
+{
+	if (input_rec_log.head >= input_rec_log.length)
+	{
+		return false;
+	}
+
+	*p_byte = input_rec_log.data[input_rec_log.head++];
+
+	return true;
+}
+
+static bool input_rec_get_varint(uint32_t *p_value)
+{
+	uint32_t shift = 0;
+	uint8_t byte;
+
+	*p_value = 0;
+
+	do
+	{
+		if ((false == input_rec_get_byte(&byte)) || (shift > 28))
+		{
+			return false;
+		}
+		*p_value |= (uint32_t)(byte & 0x7F) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	return true;
+}
+
+// Decodes the record at the stream cursor. Returns false at the end of the stream.
+static bool input_rec_decode(void)
+{
+	uint32_t dreads;
+	uint32_t dticks;
+	uint8_t index;
+
+	if ((false == input_rec_get_varint(&dreads)) || (false == input_rec_get_varint(&dticks)) ||
+		(false == input_rec_get_byte(&input_rec_next_ch)) || (INPUT_REC_CH_QTY <= input_rec_next_ch))
+	{
+		return false;
+	}
+
+	for (index = 0; input_rec_payload_len[input_rec_next_ch] > index; index++)
+	{
+		if (false == input_rec_get_byte(&input_rec_next_payload[index]))
+		{
+			return false;
+		}
+	}
+
+	input_rec_next_reads += dreads;
+	input_rec_next_tick += dticks;
+
+	return true;
+}
+
+static void input_rec_append(uint8_t ch, const uint8_t *p_value, uint8_t len)
+{
+	uint8_t index;
+
+	if (INPUT_REC_RECORD_MAX > (INPUT_REC_CONFIG_SIZE - (input_rec_log.head - input_rec_log.tail)))
+	{
+		/* A gap would break the replay, so the stream ends here */
+		input_rec_log.state = INPUT_REC_ST_OVERFLOW;
+		LOGGER_LOG("rec overflow reads=%lu\r\n", input_rec_log.reads);
+		return;
+	}
+
+	input_rec_put_varint(input_rec_log.reads - input_rec_last_reads);
+	input_rec_put_varint(g_app_cnt - input_rec_last_tick);
+	input_rec_put_byte(ch);
+
+	for (index = 0; len > index; index++)
+	{
+		input_rec_put_byte(p_value[index]);
+	}
+
+	input_rec_last_reads = input_rec_log.reads;
+	input_rec_last_tick = g_app_cnt;
+}
+
+static void input_rec_replay(uint8_t ch)
+{
+	uint32_t skew;
+
+	if ((false == input_rec_next_valid) || (input_rec_next_reads != input_rec_log.reads))
+	{
+		return;
+	}
+
+	if (input_rec_next_ch != ch)
+	{
+		input_rec_log.state = INPUT_REC_ST_DIVERGED;
+		LOGGER_LOG("rec diverged reads=%lu ch=%u/%u\r\n", input_rec_log.reads, ch, input_rec_next_ch);
+		return;
+	}
+
+	memcpy(input_rec_last[ch], input_rec_next_payload, input_rec_payload_len[ch]);
+
+	/* Same read, different tick: the firmware got slower or faster */
+	skew = (g_app_cnt > input_rec_next_tick) ? (g_app_cnt - input_rec_next_tick) : (input_rec_next_tick - g_app_cnt);
+
+	if (skew > input_rec_log.skew_max)
+	{
+		input_rec_log.skew_max = skew;
+	}
+
+	input_rec_next_valid = input_rec_decode();
+
+	if (false == input_rec_next_valid)
+	{
+		input_rec_log.state = INPUT_REC_ST_DONE;
+		LOGGER_LOG("rec done reads=%lu skew=%lu\r\n", input_rec_log.reads, input_rec_log.skew_max);
+	}
+}
+#endif
+
+// Every wrapped read goes through here. Record: logs the live value when it
+// changed. Replay: overwrites it with the recorded value. Reads are counted so
+// the replay matches the recording read by read, whatever the timing.
+static void input_rec_sample(uint8_t ch, void *p_value)
+{
+	uint8_t len = input_rec_payload_len[ch];
+
+	/* Scripted value: a key only for one read, as keypad_get_char() reports a press */
+	if (0 != (input_rec_script_held & (1u << ch)))
+	{
+		memcpy(p_value, input_rec_script_value[ch], len);
+		if (INPUT_REC_CH_KEYPAD == ch)
+		{
+			input_rec_script_held &= ~(1u << ch);
+		}
+	}
+
+#if INPUT_REC_MODE_OFF != INPUT_REC_CONFIG_MODE
+	input_rec_log.reads++;
+
+	if (INPUT_REC_MODE_RECORD == INPUT_REC_CONFIG_MODE)
+	{
+		if ((INPUT_REC_ST_RUN == input_rec_log.state) &&
+			((false == input_rec_seen[ch]) || (0 != memcmp(input_rec_last[ch], p_value, len))))
+		{
+			input_rec_append(ch, p_value, len);
+			memcpy(input_rec_last[ch], p_value, len);
+			input_rec_seen[ch] = true;
+		}
+	}
+	else if (INPUT_REC_MODE_REPLAY == INPUT_REC_CONFIG_MODE)
+	{
+		if (INPUT_REC_ST_RUN == input_rec_log.state)
+		{
+			input_rec_replay(ch);
+		}
+
+		/* After the end of the stream the inputs stay as last replayed */
+		memcpy(p_value, input_rec_last[ch], len);
+	}
+#endif
+}
+
+/********************** external functions definition ************************/
+#if INPUT_REC_MODE_OFF != INPUT_REC_CONFIG_MODE
+void input_rec_init(void)
+{
+	memset(input_rec_last, 0, sizeof(input_rec_last));
+	memset(input_rec_seen, 0, sizeof(input_rec_seen));
+	input_rec_last_reads = 0;
+	input_rec_last_tick = 0;
+	input_rec_next_reads = 0;
+	input_rec_next_tick = 0;
+
+	input_rec_log.mode = INPUT_REC_CONFIG_MODE;
+	input_rec_log.head = 0;
+	input_rec_log.tail = 0;
+	input_rec_log.reads = 0;
+	input_rec_log.skew_max = 0;
+	input_rec_log.state = INPUT_REC_ST_IDLE;
+
+	if (INPUT_REC_MODE_RECORD == INPUT_REC_CONFIG_MODE)
+	{
+		input_rec_put_byte(INPUT_REC_HEADER_0);
+		input_rec_put_byte(INPUT_REC_HEADER_1);
+		input_rec_put_byte(INPUT_REC_HEADER_2);
+		input_rec_put_byte(INPUT_REC_VERSION);
+		input_rec_log.state = INPUT_REC_ST_RUN;
+	}
+	else if (INPUT_REC_MODE_REPLAY == INPUT_REC_CONFIG_MODE)
+	{
+		LOGGER_LOG("rec waiting for the replay stream\r\n");
+
+		/* The debugger restores data[] and then writes length */
+		while (0 == input_rec_log.length)
+		{
+		}
+
+		if ((INPUT_REC_HEADER_SIZE <= input_rec_log.length) && (INPUT_REC_CONFIG_SIZE >= input_rec_log.length) &&
+			(INPUT_REC_HEADER_0 == input_rec_log.data[0]) && (INPUT_REC_HEADER_1 == input_rec_log.data[1]) &&
+			(INPUT_REC_HEADER_2 == input_rec_log.data[2]) && (INPUT_REC_VERSION == input_rec_log.data[3]))
+		{
+			input_rec_log.head = INPUT_REC_HEADER_SIZE;
+			input_rec_next_valid = input_rec_decode();
+			input_rec_log.state = input_rec_next_valid ? INPUT_REC_ST_RUN : INPUT_REC_ST_DONE;
+		}
+		else
+		{
+			LOGGER_LOG("rec bad replay stream\r\n");
+			input_rec_log.state = INPUT_REC_ST_DONE;
+		}
+	}
+}
+#endif
+
+#if INPUT_REC_MODE_RECORD == INPUT_REC_CONFIG_MODE
+void input_rec_update(void)
+{
+	if (((INPUT_REC_CONFIG_SIZE / 2) <= (input_rec_log.head - input_rec_log.tail)) ||
+		(0 == (g_app_cnt % INPUT_REC_CONFIG_FLUSH_TICKS)))
+	{
+		input_rec_flush();
+	}
+}
+
+// Drains the ring as "rec <hex>" lines; tools/rec2bin.py rebuilds the stream.
+void input_rec_flush(void)
+{
+	static const char hex[] = "0123456789ABCDEF";
+	char line[2 * INPUT_REC_FLUSH_LINE + 1];
+	uint32_t index;
+	uint8_t byte;
+
+	while (input_rec_log.tail != input_rec_log.head)
+	{
+		for (index = 0; (INPUT_REC_FLUSH_LINE > index) && (input_rec_log.tail != input_rec_log.head); index++)
+		{
+			byte = input_rec_log.data[input_rec_log.tail & INPUT_REC_INDEX_MASK];
+			input_rec_log.tail++;
+
+			line[2 * index] = hex[byte >> 4];
+			line[2 * index + 1] = hex[byte & 0x0F];
+		}
+		line[2 * index] = '\0';
+
+		LOGGER_LOG("rec %s\r\n", line);
+	}
+}
+#endif
+
+// Fixed input stream (bench.c scenarios), in any mode: the peripherals are
+// still read, so the bus and CPU cost stays, but the firmware sees the
+// scripted values. NULL ends the script.
+void input_rec_script(const input_rec_step_t *p_steps)
+{
+	input_rec_p_step = p_steps;
+	input_rec_script_start = g_app_cnt;
+	input_rec_script_held = 0;
+}
+
+// Every tick while a script runs: applies the steps due. Returns false once
+// the INPUT_REC_CH_END step is reached.
+bool input_rec_script_update(void)
+{
+	if (NULL == input_rec_p_step)
+	{
+		return false;
+	}
+
+	while ((g_app_cnt - input_rec_script_start) >= input_rec_p_step->tick)
+	{
+		if (INPUT_REC_CH_QTY <= input_rec_p_step->ch)
+		{
+			input_rec_script(NULL);
+			return false;
+		}
+
+		memcpy(input_rec_script_value[input_rec_p_step->ch], input_rec_p_step->value, INPUT_REC_PAYLOAD_MAX);
+		input_rec_script_held |= (1u << input_rec_p_step->ch);
+		input_rec_p_step++;
+	}
+
+	return true;
+}
+
+char input_rec_keypad(void)
+{
+	char key = 0;
+
+	if (INPUT_REC_MODE_REPLAY != INPUT_REC_CONFIG_MODE)
+	{
+		key = keypad_get_char();
+	}
+	input_rec_sample(INPUT_REC_CH_KEYPAD, &key);
+
+	return key;
+}
+
+uint16_t input_rec_adc(void)
+{
+	uint16_t value = 0;
+
+	if (INPUT_REC_MODE_REPLAY != INPUT_REC_CONFIG_MODE)
+	{
+		HAL_ADC_Start(&hadc1);
+		HAL_ADC_PollForConversion(&hadc1, 0);
+		value = HAL_ADC_GetValue(&hadc1);
+	}
+	input_rec_sample(INPUT_REC_CH_ADC, &value);
+
+	return value;
+}
+
+uint8_t input_rec_rfid_card(uint8_t *p_tag_type)
+{
+	uint8_t status = 0;
+
+	if (INPUT_REC_MODE_REPLAY != INPUT_REC_CONFIG_MODE)
+	{
+		status = MFRC522_IsCardPoll(p_tag_type);
+	}
+	input_rec_sample(INPUT_REC_CH_RFID_CARD, &status);
+
+	return status;
+}
+
+uint8_t input_rec_rfid_serial(uint8_t *p_serial)
+{
+	uint8_t value[6] = {0};
+
+	if (INPUT_REC_MODE_REPLAY != INPUT_REC_CONFIG_MODE)
+	{
+		value[0] = MFRC522_ReadCardSerial(p_serial);
+		memcpy(&value[1], p_serial, 5);
+	}
+	input_rec_sample(INPUT_REC_CH_RFID_SERIAL, value);
+	memcpy(p_serial, &value[1], 5);
+
+	return value[0];
+}
+
+void input_rec_rtc_date(uint8_t *p_day, uint8_t *p_mth, uint8_t *p_year, uint8_t *p_dow)
+{
+	uint8_t value[4] = {0};
+
+	if (INPUT_REC_MODE_REPLAY != INPUT_REC_CONFIG_MODE)
+	{
+		DS3231_Get_Date(&value[0], &value[1], &value[2], &value[3]);
+	}
+	input_rec_sample(INPUT_REC_CH_RTC_DATE, value);
+
+	*p_day = value[0];
+	*p_mth = value[1];
+	*p_year = value[2];
+	*p_dow = value[3];
+}
+
+void input_rec_rtc_time(uint8_t *p_hr, uint8_t *p_min, uint8_t *p_sec)
+{
+	uint8_t value[3] = {0};
+
+	if (INPUT_REC_MODE_REPLAY != INPUT_REC_CONFIG_MODE)
+	{
+		DS3231_Get_Time(&value[0], &value[1], &value[2]);
+	}
+	input_rec_sample(INPUT_REC_CH_RTC_TIME, value);
+
+	*p_hr = value[0];
+	*p_min = value[1];
+	*p_sec = value[2];
+}
+
+// Whole port input register; id is the port slot of the caller (< INPUT_REC_PORT_QTY).
+uint16_t input_rec_port(uint8_t id, GPIO_TypeDef *port)
+{
+	uint16_t value = 0;
+
+	if (INPUT_REC_MODE_REPLAY != INPUT_REC_CONFIG_MODE)
+	{
+		value = (uint16_t)port->IDR;
+	}
+	input_rec_sample(INPUT_REC_CH_PORT + id, &value);
+
+	return value;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,162 @@
+/*
+ *
+ * @file   : latency.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include "main.h"
+#include "logger.h"
+#include "dwt.h"
+#include "trace.h"
+#include "latency.h"
+
+/********************** macros and definitions *******************************/
+#define LATENCY_SUB_MASK	((1ul << LATENCY_SUB_BITS) - 1)
+
+/********************** internal data definition *****************************/
+static const char *latency_probe_name[LAT_QTY] = {
+	"key_to_lcd",
+	"pwd_to_unlock",
+	"card_to_unlock"
+};
+
+/********************** external data definition *****************************/
+latency_stats_t latency_stats[LAT_QTY];
+
+/********************** internal functions definition ************************/
+// Log-linear bucket: exact below 4 uS, then 4 buckets per power of two.
+static uint32_t latency_bucket(uint32_t us)
+{
+	uint32_t msb;
+	uint32_t bucket;
+
+	if (us <= LATENCY_SUB_MASK)
+	{
+		return us;
+	}
+
+	msb = 31 - __CLZ(us);
+	bucket = ((msb - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) + ((us >> (msb - LATENCY_SUB_BITS)) & LATENCY_SUB_MASK);
+
+	return (bucket < LATENCY_BUCKETS) ? bucket : (LATENCY_BUCKETS - 1);
+}
+
+// Largest value (uS) that falls into the given bucket.
+static uint32_t latency_bucket_upper(uint32_t bucket)
+{
+	uint32_t shift;
+
+	if (bucket <= LATENCY_SUB_MASK)
+	{
+		return bucket;
+	}
+
+	shift = (bucket >> LATENCY_SUB_BITS) - 1;
+
+	return ((((1ul << LATENCY_SUB_BITS) | (bucket & LATENCY_SUB_MASK)) + 1) << shift) - 1;
+}
+
+/********************** external functions definition ************************/
+void latency_init(void)
+{
+	memset(latency_stats, 0, sizeof(latency_stats));
+}
+
+// Stamps the input of a span. A newer input restarts an already open span.
+void latency_start(latency_probe_t probe)
+{
+	latency_stats_t *p_stats = &latency_stats[probe];
+
+	p_stats->start = cycle_counter_get();
+	p_stats->open = true;
+
+	TRACE_LAT_START(probe);
+}
+
+// Closes an open span and accumulates it. Without an open span it does nothing.
+void latency_stop(latency_probe_t probe)
+{
+	latency_stats_t *p_stats = &latency_stats[probe];
+	uint32_t us;
+
+	if (false == p_stats->open)
+	{
+		return;
+	}
+
+	TRACE_LAT_STOP(probe);
+
+	p_stats->open = false;
+	us = (cycle_counter_get() - p_stats->start) / cycles_per_us;
+
+	if (us > LATENCY_CONFIG_TIMEOUT_US)
+	{
+		p_stats->dropped++;
+		return;
+	}
+
+	if ((0 == p_stats->count) || (us < p_stats->min_us))
+	{
+		p_stats->min_us = us;
+	}
+
+	if (us > p_stats->max_us)
+	{
+		p_stats->max_us = us;
+	}
+
+	p_stats->count++;
+
+	if (UINT16_MAX > p_stats->bucket[latency_bucket(us)])
+	{
+		p_stats->bucket[latency_bucket(us)]++;
+	}
+}
+
+// Upper bound (uS) of the bucket holding the requested percentile.
+uint32_t latency_percentile_us(latency_probe_t probe, uint32_t percent)
+{
+	const latency_stats_t *p_stats = &latency_stats[probe];
+	uint32_t target;
+	uint32_t accum = 0;
+	uint32_t bucket;
+
+	if (0 == p_stats->count)
+	{
+		return 0;
+	}
+
+	target = (p_stats->count * percent + 99) / 100;
+
+	for (bucket = 0; LATENCY_BUCKETS > bucket; bucket++)
+	{
+		accum += p_stats->bucket[bucket];
+
+		if (accum >= target)
+		{
+			break;
+		}
+	}
+
+	bucket = latency_bucket_upper(bucket);
+
+	return (bucket < p_stats->max_us) ? bucket : p_stats->max_us;
+}
+
+void latency_report(void)
+{
+	uint32_t probe;
+
+	for (probe = 0; LAT_QTY > probe; probe++)
+	{
+		LOGGER_LOG("lat %s n=%lu p50=%lu p90=%lu p99=%lu min=%lu max=%lu drop=%lu\r\n",
+				   latency_probe_name[probe], latency_stats[probe].count,
+				   latency_percentile_us(probe, 50), latency_percentile_us(probe, 90),
+				   latency_percentile_us(probe, 99), latency_stats[probe].min_us,
+				   latency_stats[probe].max_us, latency_stats[probe].dropped);
+	}
+}
+
+/********************** end of file ******************************************/
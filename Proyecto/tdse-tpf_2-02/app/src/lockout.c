@@ -0,0 +1,261 @@
+/*
+ *
+ * @file   : lockout.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "logger.h"
+#include "timer_service.h"
+#include "eeprom_emu.h"
+#include "lockout.h"
+
+/********************** macros and definitions *******************************/
+#define LOCKOUT_FAILS_MAX		(255u)
+
+/********************** internal data definition *****************************/
+static const eeprom_emu_id_t lockout_ee_id[LOCKOUT_QTY] = {EE_LOCK_PIN, EE_LOCK_CARD, EE_LOCK_OPT};
+
+static uint8_t lockout_fails[LOCKOUT_QTY];
+static uint32_t lockout_last[LOCKOUT_QTY];
+static lockout_subject_t lockout_subject[LOCKOUT_CONFIG_SUBJECTS];
+static bool lockout_b_locked;
+static uint32_t lockout_until;
+static lockout_cb_t lockout_p_done;
+
+/********************** external data definition *****************************/
+lockout_stats_t lockout_stats;
+
+/********************** internal functions definition ************************/
+// LOCKOUT_CONFIG_BASE_MS up to LOCKOUT_CONFIG_FREE failures, then doubled on
+// each one up to LOCKOUT_CONFIG_MAX_MS.
+static uint32_t lockout_wait(uint8_t fails)
+{
+	uint32_t wait = LOCKOUT_CONFIG_BASE_MS;
+	uint8_t n;
+
+	for (n = LOCKOUT_CONFIG_FREE; (fails > n) && (LOCKOUT_CONFIG_MAX_MS > wait); n++)
+	{
+		wait <<= 1;
+	}
+
+	return (LOCKOUT_CONFIG_MAX_MS < wait) ? LOCKOUT_CONFIG_MAX_MS : wait;
+}
+
+// Counter of a card or user. A new one takes a free entry or the one that
+// failed longest ago. The table is RAM only: a subject counts and decays
+// along with its type, and only its own success clears it, so the type
+// counter (in eeprom_emu) is never below it and a reset loses no wait.
+static lockout_subject_t *lockout_subject_of(lockout_type_t type, uint32_t id, bool b_new)
+{
+	lockout_subject_t *p_oldest = &lockout_subject[0];
+	uint32_t index;
+
+	for (index = 0; LOCKOUT_CONFIG_SUBJECTS > index; index++)
+	{
+		if ((id == lockout_subject[index].id) && (type == lockout_subject[index].type))
+		{
+			return &lockout_subject[index];
+		}
+		if ((LOCKOUT_ANY == lockout_subject[index].id) ||
+			((LOCKOUT_ANY != p_oldest->id) && ((int32_t)(lockout_subject[index].last - p_oldest->last) < 0)))
+		{
+			p_oldest = &lockout_subject[index];
+		}
+	}
+
+	if (!b_new)
+	{
+		return NULL;
+	}
+
+	p_oldest->id = id;
+	p_oldest->type = type;
+	p_oldest->fails = 0;
+
+	return p_oldest;
+}
+
+// A failure goes to flash now, not after the deferred commit: a power cut
+// within it would give the attempt back. Decays can wait.
+static void lockout_set(lockout_type_t type, uint8_t fails)
+{
+	if (fails != lockout_fails[type])
+	{
+		eeprom_emu_write(lockout_ee_id[type], fails);
+		if (fails > lockout_fails[type])
+		{
+			eeprom_emu_commit();
+		}
+		lockout_fails[type] = fails;
+	}
+}
+
+static void lockout_end(void)
+{
+	lockout_b_locked = false;
+
+	if (NULL != lockout_p_done)
+	{
+		lockout_p_done();
+	}
+}
+
+// A running lockout is only ever extended.
+static void lockout_lock(uint32_t wait)
+{
+	uint32_t now = timer_service_now();
+
+	if (lockout_b_locked && ((int32_t)(lockout_until - (now + wait)) >= 0))
+	{
+		return;
+	}
+
+	lockout_b_locked = true;
+	lockout_until = now + wait;
+	timer_service_start(TIMER_LOCKOUT, wait, 0, lockout_end);
+}
+
+// TIMER_LOCKOUT_DECAY: one failure forgiven per LOCKOUT_CONFIG_DECAY_MS without
+// a new one, per type and per subject.
+static void lockout_decay(void)
+{
+	uint32_t now = timer_service_now();
+	uint32_t index;
+
+	for (index = 0; LOCKOUT_QTY > index; index++)
+	{
+		if ((0 != lockout_fails[index]) && ((now - lockout_last[index]) >= LOCKOUT_CONFIG_DECAY_MS))
+		{
+			lockout_set(index, lockout_fails[index] - 1);
+			lockout_last[index] = now;
+			lockout_stats.decays++;
+		}
+	}
+
+	for (index = 0; LOCKOUT_CONFIG_SUBJECTS > index; index++)
+	{
+		if ((LOCKOUT_ANY != lockout_subject[index].id) && ((now - lockout_subject[index].last) >= LOCKOUT_CONFIG_DECAY_MS))
+		{
+			lockout_subject[index].last = now;
+			lockout_stats.decays++;
+			if (0 == --lockout_subject[index].fails)
+			{
+				lockout_subject[index].id = LOCKOUT_ANY;
+			}
+		}
+	}
+}
+
+/********************** external functions definition ************************/
+// After eeprom_emu_init() and timer_service_init(). The type counters survive
+// a reset, and so does a lockout: the longest one due starts over.
+void lockout_init(lockout_cb_t p_done)
+{
+	uint32_t now = timer_service_now();
+	uint8_t fails_max = 0;
+	uint16_t value;
+	uint32_t index;
+
+	memset(lockout_subject, 0, sizeof(lockout_subject));
+	memset(&lockout_stats, 0, sizeof(lockout_stats));
+	lockout_b_locked = false;
+	lockout_p_done = p_done;
+
+	for (index = 0; LOCKOUT_QTY > index; index++)
+	{
+		lockout_fails[index] = 0;
+		if (eeprom_emu_read(lockout_ee_id[index], &value))
+		{
+			lockout_fails[index] = (LOCKOUT_FAILS_MAX < value) ? LOCKOUT_FAILS_MAX : (uint8_t)value;
+		}
+		lockout_last[index] = now;
+
+		if (lockout_fails[index] > fails_max)
+		{
+			fails_max = lockout_fails[index];
+		}
+	}
+
+	timer_service_start(TIMER_LOCKOUT_DECAY, LOCKOUT_CONFIG_DECAY_MS, LOCKOUT_CONFIG_DECAY_MS, lockout_decay);
+
+	if (LOCKOUT_CONFIG_FREE < fails_max)
+	{
+		lockout_lock(lockout_wait(fails_max));
+		LOGGER_LOG("lockout %u fails, %lu ms\r\n", fails_max, lockout_remaining());
+	}
+}
+
+// Counts a failure for the type and the subject (card UID, PIN user) and locks
+// for the wait of the worse of both. Returns the wait in mS.
+uint32_t lockout_fail(lockout_type_t type, uint32_t id)
+{
+	uint32_t now = timer_service_now();
+	lockout_subject_t *p_subject;
+	uint8_t fails;
+	uint32_t wait;
+
+	if (LOCKOUT_FAILS_MAX > lockout_fails[type])
+	{
+		lockout_set(type, lockout_fails[type] + 1);
+	}
+	lockout_last[type] = now;
+	fails = lockout_fails[type];
+
+	if (LOCKOUT_ANY != id)
+	{
+		p_subject = lockout_subject_of(type, id, true);
+		if (LOCKOUT_FAILS_MAX > p_subject->fails)
+		{
+			p_subject->fails++;
+		}
+		p_subject->last = now;
+		fails = (p_subject->fails > fails) ? p_subject->fails : fails;
+	}
+
+	wait = lockout_wait(fails);
+
+	lockout_stats.failures++;
+	if (LOCKOUT_CONFIG_BASE_MS < wait)
+	{
+		lockout_stats.locks++;
+		if (wait > lockout_stats.lock_ms_max)
+		{
+			lockout_stats.lock_ms_max = wait;
+		}
+	}
+
+	lockout_lock(wait);
+
+	return lockout_remaining();
+}
+
+// A granted access clears the counter of its subject only. The type counter
+// decays as usual: a good card or PIN between guesses does not reset them.
+void lockout_success(lockout_type_t type, uint32_t id)
+{
+	lockout_subject_t *p_subject;
+
+	if (LOCKOUT_ANY != id)
+	{
+		p_subject = lockout_subject_of(type, id, false);
+		if (NULL != p_subject)
+		{
+			p_subject->id = LOCKOUT_ANY;
+		}
+	}
+}
+
+// mS left of the running lockout, 0 if none.
+uint32_t lockout_remaining(void)
+{
+	int32_t left = (int32_t)(lockout_until - timer_service_now());
+
+	return (lockout_b_locked && (0 < left)) ? (uint32_t)left : 0;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,386 @@
+/*
+ *
+ * @file   : log_export.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "logger.h"
+#include "i2c_bus.h"
+#include "crc32.h"
+#include "cobs.h"
+#include "uart_dma.h"
+#include "memory_handler.h"
+#include "log_export.h"
+
+/********************** macros and definitions *******************************/
+#define LOG_EXPORT_I2C_ADDRESS	(0xA0)
+#define LOG_EXPORT_UART			UART_DMA_2
+#define LOG_EXPORT_OVERHEAD		(3 + 4)			// Type, seq and CRC
+
+typedef enum {
+	LOG_EXPORT_RAW_EMPTY,
+	LOG_EXPORT_RAW_READING,
+	LOG_EXPORT_RAW_READY
+} log_export_raw_st_t;
+
+/********************** internal data definition *****************************/
+/* Go-back-N: seq 0 is the header, 1..MEM_ACCESS_QTY the records, then the
+ * end frame. A record is read from the EEPROM into the slot of its seq */
+static bool log_export_b_running;
+static uint16_t log_export_total;
+static uint16_t log_export_base;			// First frame not acked
+static uint16_t log_export_next;			// Next frame to send
+static uint32_t log_export_ack_tick;
+static uint32_t log_export_start_tick;
+static uint8_t log_export_timeouts;
+
+static uint8_t log_export_raw[LOG_EXPORT_CONFIG_WINDOW][MEM_ACCESS_SIZE];
+static uint16_t log_export_raw_seq[LOG_EXPORT_CONFIG_WINDOW];
+static volatile uint8_t log_export_raw_st[LOG_EXPORT_CONFIG_WINDOW];
+
+static uint8_t log_export_rx_buf[COBS_MAX(LOG_EXPORT_FRAME_MAX)];
+static uint16_t log_export_rx_len;
+
+/********************** external data definition *****************************/
+log_export_stats_t log_export_stats;
+
+/********************** internal functions definition ************************/
+// I2C interrupt. A failed read leaves the slot empty to be read again.
+static void log_export_read_done(HAL_StatusTypeDef status, void *p_arg)
+{
+	uint32_t slot = (uint32_t)(uintptr_t)p_arg;
+
+	log_export_raw_st[slot] = (HAL_OK == status) ? LOG_EXPORT_RAW_READY : LOG_EXPORT_RAW_EMPTY;
+}
+
+static uint8_t log_export_digits(const uint8_t *p, bool *p_valid)
+{
+	if ((p[0] < '0') || (p[0] > '9') || (p[1] < '0') || (p[1] > '9'))
+	{
+		*p_valid = false;
+		return 0;
+	}
+
+	return (uint8_t)(((p[0] - '0') * 10) + (p[1] - '0'));
+}
+
+// Frame of seq, COBS encoded, into the TX ring. False if its record is not
+// read yet or the ring is full: it is tried again on the next tick.
+static bool log_export_send(uint16_t seq)
+{
+	uint8_t frame[LOG_EXPORT_FRAME_MAX];
+	uint8_t encoded[COBS_MAX(LOG_EXPORT_FRAME_MAX) + 1];
+	uint8_t slot = seq % LOG_EXPORT_CONFIG_WINDOW;
+	uint16_t length = 3;
+	uint16_t size;
+	uint32_t crc;
+
+	if (0 == seq)
+	{
+		frame[0] = LOG_EXPORT_HEADER;
+		frame[length++] = (uint8_t)MEM_ACCESS_QTY;
+		frame[length++] = (uint8_t)(MEM_ACCESS_QTY >> 8);
+	}
+	else if ((log_export_total - 1) == seq)
+	{
+		frame[0] = LOG_EXPORT_END;
+		frame[length++] = (uint8_t)MEM_ACCESS_QTY;
+		frame[length++] = (uint8_t)(MEM_ACCESS_QTY >> 8);
+	}
+	else
+	{
+		if ((seq != log_export_raw_seq[slot]) || (LOG_EXPORT_RAW_READY != log_export_raw_st[slot]))
+		{
+			return false;
+		}
+
+		frame[0] = LOG_EXPORT_RECORD;
+		length += log_export_pack(&frame[length], log_export_raw[slot], seq - 1);
+	}
+
+	frame[1] = (uint8_t)seq;
+	frame[2] = (uint8_t)(seq >> 8);
+	crc = crc32(frame, length);
+	memcpy(&frame[length], &crc, 4);
+	length += 4;
+
+	size = cobs_encode(frame, length, encoded);
+	encoded[size++] = 0x00;
+
+	if (!uart_dma_write(LOG_EXPORT_UART, encoded, size))
+	{
+		return false;
+	}
+
+	log_export_stats.frames++;
+
+	return true;
+}
+
+// Reads ahead the records of the window that are not in their slot yet.
+static void log_export_fetch(void)
+{
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_NORMAL, LOG_EXPORT_I2C_ADDRESS, 0,
+						   I2C_MEMADD_SIZE_16BIT, MEM_ACCESS_SIZE, NULL, log_export_read_done, NULL};
+	uint32_t reading = 0;
+	uint32_t slot;
+	uint16_t seq;
+
+	for (slot = 0; LOG_EXPORT_CONFIG_WINDOW > slot; slot++)
+	{
+		reading += (LOG_EXPORT_RAW_READING == log_export_raw_st[slot]) ? 1 : 0;
+	}
+
+	for (seq = log_export_next; (log_export_base + LOG_EXPORT_CONFIG_WINDOW > seq) && (log_export_total - 1 > seq); seq++)
+	{
+		slot = seq % LOG_EXPORT_CONFIG_WINDOW;
+
+		/* A slot still being read (maybe for an aborted export) is left alone */
+		if ((0 == seq) || (LOG_EXPORT_RAW_READING == log_export_raw_st[slot]) ||
+			((seq == log_export_raw_seq[slot]) && (LOG_EXPORT_RAW_READY == log_export_raw_st[slot])))
+		{
+			continue;
+		}
+
+		if (LOG_EXPORT_CONFIG_READS <= reading)
+		{
+			break;
+		}
+
+		log_export_raw_seq[slot] = seq;
+		log_export_raw_st[slot] = LOG_EXPORT_RAW_READING;
+
+		xfer.mem_addr = MEM_ACCESS_BASE + (MEM_ACCESS_STRIDE * (seq - 1));
+		xfer.p_data = log_export_raw[slot];
+		xfer.p_arg = (void *)(uintptr_t)slot;
+		if (!i2c_bus_submit(I2C_BUS_2, &xfer))
+		{
+			log_export_raw_st[slot] = LOG_EXPORT_RAW_EMPTY;
+			break;
+		}
+
+		reading++;
+	}
+}
+
+static void log_export_stop(bool b_done)
+{
+	log_export_b_running = false;
+
+	if (b_done)
+	{
+		log_export_stats.exports++;
+		log_export_stats.last_ms = HAL_GetTick() - log_export_start_tick;
+		LOGGER_LOG("log export %u rec %lu ms\r\n", MEM_ACCESS_QTY, log_export_stats.last_ms);
+	}
+	else
+	{
+		log_export_stats.aborts++;
+	}
+}
+
+static void log_export_command(const uint8_t frame[], uint16_t length)
+{
+	uint32_t crc;
+	uint16_t seq;
+	uint32_t slot;
+
+	if (LOG_EXPORT_OVERHEAD > length)
+	{
+		log_export_stats.bad_frames++;
+		return;
+	}
+
+	memcpy(&crc, &frame[length - 4], 4);
+	if (crc32(frame, length - 4) != crc)
+	{
+		log_export_stats.bad_frames++;
+		return;
+	}
+
+	seq = (uint16_t)(frame[1] | (frame[2] << 8));
+
+	switch (frame[0])
+	{
+		case LOG_EXPORT_START:
+
+			/* Also restarts a running export (host restarted). A read still in flight from an aborted export keeps its slot */
+			for (slot = 0; LOG_EXPORT_CONFIG_WINDOW > slot; slot++)
+			{
+				if (LOG_EXPORT_RAW_READING != log_export_raw_st[slot])
+				{
+					log_export_raw_st[slot] = LOG_EXPORT_RAW_EMPTY;
+				}
+				log_export_raw_seq[slot] = 0;
+			}
+
+			log_export_b_running = true;
+			log_export_total = MEM_ACCESS_QTY + 2;
+			log_export_base = 0;
+			log_export_next = 0;
+			log_export_timeouts = 0;
+			log_export_ack_tick = HAL_GetTick();
+			log_export_start_tick = log_export_ack_tick;
+
+			break;
+
+		case LOG_EXPORT_ACK:
+
+			if (log_export_b_running && (seq > log_export_base) && (seq <= log_export_next))
+			{
+				log_export_base = seq;
+				log_export_ack_tick = HAL_GetTick();
+				log_export_timeouts = 0;
+
+				if (log_export_total == log_export_base)
+				{
+					log_export_stop(true);
+				}
+			}
+
+			break;
+
+		case LOG_EXPORT_ABORT:
+
+			if (log_export_b_running)
+			{
+				log_export_stop(false);
+			}
+
+			break;
+
+		default:
+
+			log_export_stats.bad_frames++;
+
+			break;
+	}
+}
+
+/********************** external functions definition ************************/
+void log_export_init(void)
+{
+	memset(&log_export_stats, 0, sizeof(log_export_stats));
+	memset((void *)log_export_raw_st, LOG_EXPORT_RAW_EMPTY, sizeof(log_export_raw_st));
+	log_export_b_running = false;
+	log_export_rx_len = 0;
+}
+
+// Every system tick: EEPROM reads ahead and frames out while the window and
+// the TX ring allow. Nothing here waits.
+void log_export_update(void)
+{
+	if (!log_export_b_running)
+	{
+		return;
+	}
+
+	if ((log_export_base != log_export_next) && ((HAL_GetTick() - log_export_ack_tick) >= LOG_EXPORT_CONFIG_ACK_MS))
+	{
+		log_export_stats.resends += log_export_next - log_export_base;
+		log_export_next = log_export_base;
+		log_export_ack_tick = HAL_GetTick();
+
+		if (LOG_EXPORT_CONFIG_RETRIES <= ++log_export_timeouts)
+		{
+			log_export_stop(false);
+			return;
+		}
+	}
+
+	log_export_fetch();
+
+	while ((log_export_total > log_export_next) && ((log_export_base + LOG_EXPORT_CONFIG_WINDOW) > log_export_next))
+	{
+		if (!log_export_send(log_export_next))
+		{
+			break;
+		}
+
+		if (log_export_base == log_export_next)
+		{
+			log_export_ack_tick = HAL_GetTick();
+		}
+		log_export_next++;
+	}
+}
+
+// Host frames from the console (console.c owns the USART2 RX), split on 0x00.
+void log_export_rx(const uint8_t *p_data, uint16_t size)
+{
+	uint8_t frame[LOG_EXPORT_FRAME_MAX];
+	uint16_t index;
+	uint16_t length;
+
+	for (index = 0; size > index; index++)
+	{
+		if (0x00 != p_data[index])
+		{
+			/* Too long: dropped up to the next delimiter */
+			if (sizeof(log_export_rx_buf) > log_export_rx_len)
+			{
+				log_export_rx_buf[log_export_rx_len] = p_data[index];
+			}
+			log_export_rx_len++;
+			continue;
+		}
+
+		if (0 == log_export_rx_len)
+		{
+			continue;
+		}
+
+		length = (sizeof(log_export_rx_buf) >= log_export_rx_len) ? cobs_decode(log_export_rx_buf, log_export_rx_len, frame) : 0;
+		if (0 != length)
+		{
+			log_export_command(frame, length);
+		}
+		else
+		{
+			log_export_stats.bad_frames++;
+		}
+		log_export_rx_len = 0;
+	}
+}
+
+// "dd/mm/20yy | hh:mm:ss | who" to its binary record. Empty or damaged
+// entries go out with valid = 0. Also used by the RS-485 link (rs485_link.c).
+uint16_t log_export_pack(uint8_t *p, const uint8_t raw[], uint16_t index)
+{
+	bool b_valid = ('/' == raw[2]) && (0 == memcmp(&raw[5], "/20", 3)) &&
+				   (0 == memcmp(&raw[10], " | ", 3)) && (':' == raw[15]) && (':' == raw[18]) &&
+				   (0 == memcmp(&raw[21], " | ", 3));
+	uint8_t *p_start = p;
+
+	*p++ = (uint8_t)index;
+	*p++ = (uint8_t)(index >> 8);
+	p++;
+	*p++ = log_export_digits(&raw[0], &b_valid);
+	*p++ = log_export_digits(&raw[3], &b_valid);
+	*p++ = log_export_digits(&raw[8], &b_valid);
+	*p++ = log_export_digits(&raw[13], &b_valid);
+	*p++ = log_export_digits(&raw[16], &b_valid);
+	*p++ = log_export_digits(&raw[19], &b_valid);
+	memcpy(p, &raw[24], LOG_EXPORT_WHO_SIZE);
+	p += LOG_EXPORT_WHO_SIZE;
+
+	p_start[2] = b_valid ? 1 : 0;
+	if (!b_valid)
+	{
+		memset(&p_start[3], 0, p - &p_start[3]);
+	}
+
+	return p - p_start;
+}
+
+bool log_export_busy(void)
+{
+	return log_export_b_running;
+}
+
+/********************** end of file ******************************************/
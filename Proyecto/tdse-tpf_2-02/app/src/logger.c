@@ -52,6 +52,8 @@
 
 /********************** internal functions declaration ***********************/
 
+extern int _write(int file, char *ptr, int len);
+
 /********************** internal data definition *****************************/
 
 /********************** external data definition *****************************/
@@ -67,8 +69,8 @@ int logger_msg_len;
 #if 1 == LOGGER_CONFIG_USE_SEMIHOSTING
 void logger_log_print_(char* const msg)
 {
-	printf(msg);
-	fflush(stdout);
+	/* Straight to the low level write: stdio would malloc its stdout buffer */
+	_write(1, msg, strlen(msg));
 }
 #else
 void logger_log_print_(char* const msg)
@@ -6,64 +6,141 @@
  */
 
 /********************** inclusions *******************************************/
+#include <string.h>
+
 #include "main.h"
 #include "logger.h"
+#include "i2c_bus.h"
 #include "memory_handler.h"
+#include "settings.h"
 
 /********************** macros and definitions *******************************/
+#define MEM_I2C_ADDRESS		0xA0
+#define MEM_WRITE_CYCLE_MS	5ul		// AT24 internal write cycle
+#define MEM_PENDING_QTY		6		// Records kept in RAM while the EEPROM fails
+#define MEM_RECORD_MAX		40		// Longest record
+
+typedef struct
+{
+	uint16_t	mem_addr;
+	uint16_t	size;
+	uint8_t		data[MEM_RECORD_MAX];
+} mem_record_t;
+
+/********************** internal data definition *****************************/
+/* Writes go out one at a time from this ring and leave it only once the
+ * EEPROM acked them: a failing EEPROM costs RAM, not tick time */
+static mem_record_t mem_pending[MEM_PENDING_QTY];
+static volatile uint8_t mem_pending_head;
+static volatile uint8_t mem_pending_qty;
+static volatile bool mem_in_flight;
+static volatile uint32_t mem_done_tick;
+
+/********************** external data definition *****************************/
+uint32_t mem_dropped;
+
+/********************** internal functions definition ************************/
+// I2C interrupt: the head record is done, or stays for the next try.
+static void mem_write_done(HAL_StatusTypeDef status, void *p_arg)
+{
+	if (HAL_OK == status)
+	{
+		mem_pending_head = (mem_pending_head + 1) % MEM_PENDING_QTY;
+		mem_pending_qty--;
+	}
+
+	mem_done_tick = HAL_GetTick();
+	mem_in_flight = false;
+}
 
 /********************** external functions definition ************************/
-void handle_memory(uint32_t tick, MEM_WriteType_t type, char pwd[], uint8_t idx, char time_str[])
+// Queues a write (within one AT24 page); false if the pending ring is full.
+bool write_memory(uint16_t mem_addr, const uint8_t *p_data, uint16_t size)
 {
-	switch (type)
+	mem_record_t *p_record = NULL;
+
+	/* mem_write_done() moves head and qty from the I2C interrupt: the tail
+	 * slot is taken with both read at once. It is filled afterwards, which is
+	 * safe because only flush_memory(), in task context, sends it */
+	__disable_irq();
+	if ((MEM_PENDING_QTY > mem_pending_qty) && (MEM_RECORD_MAX >= size))
 	{
-		case MEM_NO_WRITE:
+		p_record = &mem_pending[(mem_pending_head + mem_pending_qty) % MEM_PENDING_QTY];
+		mem_pending_qty++;
+	}
+	__enable_irq();
 
-			break;
+	if (NULL == p_record)
+	{
+		mem_dropped++;
+		return false;
+	}
 
-		case MEM_WRITE_TIME:
+	p_record->mem_addr = mem_addr;
+	p_record->size = size;
+	memcpy(p_record->data, p_data, size);
 
-			if (tick == 200)
-			{
-				HAL_I2C_Mem_Write(&hi2c2, 0xA0, 0x000F + 64*(idx - 1), I2C_MEMADD_SIZE_16BIT, (uint8_t*)time_str, strlen(time_str) + 1, HAL_MAX_DELAY);
-			}
-			else if (tick == 100)
-			{
-				HAL_I2C_Mem_Write(&hi2c2, 0xA0, 0x000E, I2C_MEMADD_SIZE_16BIT, &idx, 1, HAL_MAX_DELAY);
-			}
+	flush_memory();
 
-			break;
+	return true;
+}
 
-		case MEM_WRITE_PWD:
+// Records queued and not acked yet: 0 once all writes are in the EEPROM.
+uint8_t pending_memory(void)
+{
+	return mem_pending_qty;
+}
 
-			if (tick == 300)
-			{
-				HAL_I2C_Mem_Write(&hi2c2, 0xA0, 0x0000, I2C_MEMADD_SIZE_16BIT, (uint8_t*)"written", 8, HAL_MAX_DELAY);
-			}
-			else if (tick == 200)
-			{
-				HAL_I2C_Mem_Write(&hi2c2, 0xA0, 0x0008, I2C_MEMADD_SIZE_16BIT, (uint8_t*)pwd, 6, HAL_MAX_DELAY);
-			}
-			else if (tick == 100)
-			{
-				HAL_I2C_Mem_Write(&hi2c2, 0xA0, 0x000E, I2C_MEMADD_SIZE_16BIT, 0x00, 1, HAL_MAX_DELAY);
-			}
+// Every system tick: queues the oldest pending record (low priority) once
+// the EEPROM write cycle of the previous one is over.
+void flush_memory(void)
+{
+	mem_record_t *p_record;
+	i2c_bus_xfer_t xfer;
+
+	if ((0 == mem_pending_qty) || mem_in_flight || ((HAL_GetTick() - mem_done_tick) < MEM_WRITE_CYCLE_MS))
+	{
+		return;
+	}
+
+	p_record = &mem_pending[mem_pending_head];
+	xfer.op = I2C_BUS_OP_MEM_WRITE;
+	xfer.priority = I2C_BUS_PRIO_LOW;
+	xfer.address = MEM_I2C_ADDRESS;
+	xfer.mem_addr = p_record->mem_addr;
+	xfer.mem_size = I2C_MEMADD_SIZE_16BIT;
+	xfer.size = p_record->size;
+	xfer.p_data = p_record->data;
+	xfer.p_cb = mem_write_done;
+	xfer.p_arg = NULL;
+
+	mem_in_flight = true;
+	if (!i2c_bus_submit(I2C_BUS_2, &xfer))
+	{
+		/* Refused (EEPROM backing off) or no slot: try again later */
+		mem_done_tick = HAL_GetTick();
+		mem_in_flight = false;
+	}
+}
+
+// Settings writes of the options menu. Access records go through
+// access_queue.c.
+void handle_memory(uint32_t tick, MEM_WriteType_t type, const pin_hash_t *p_pwd)
+{
+	switch (type)
+	{
+		case MEM_NO_WRITE:
 
 			break;
 
-		case MEM_CLEAR:
+		case MEM_WRITE_PWD:
 
 			if (tick == 300)
 			{
-				HAL_I2C_Mem_Write(&hi2c2, 0xA0, 0x0000, I2C_MEMADD_SIZE_16BIT, (uint8_t*)"notinit", 8, HAL_MAX_DELAY);
-			}
-			else if (tick == 200)
-			{
-				HAL_I2C_Mem_Write(&hi2c2, 0xA0, 0x0008, I2C_MEMADD_SIZE_16BIT, (uint8_t*)"xxxxx", 6, HAL_MAX_DELAY);
-			}
-			else if (tick == 100)
-			{
-				HAL_I2C_Mem_Write(&hi2c2, 0xA0, 0x000E, I2C_MEMADD_SIZE_16BIT, 0x00, 1, HAL_MAX_DELAY);
+				settings.pwd = *p_pwd;
+				settings.saved_entries = 0;
+				settings.flags |= SETTINGS_FLAG_WRITTEN;
+				settings_save();
 			}
 
 			break;
@@ -0,0 +1,486 @@
+/*
+ *
+ * @file   : pin_db.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "logger.h"
+#include "i2c_bus.h"
+#include "crc32.h"
+#include "pin_hash.h"
+#include "init_seq.h"
+#include "memory_handler.h"
+#include "pin_db.h"
+
+/********************** macros and definitions *******************************/
+#define PIN_DB_I2C_ADDRESS		(0xA0)
+#define PIN_DB_I2C_TIMEOUT		(50ul)
+#define PIN_DB_WRITE_CYCLE_MS	(5)
+
+/* AT24 map: one page of header (magic, version, salt, CRC-32), then 16 byte
+ * records: PIN digest, CRC tag, role, state, uses left (16 bit) */
+#define PIN_DB_MAGIC			(0x4450u)	// "PD"
+#define PIN_DB_VERSION			(2)
+#define PIN_DB_HEADER_SIZE		(32u)
+#define PIN_DB_HEADER_USED		(12u)
+#define PIN_DB_RECORD_SIZE		(16u)
+#define PIN_DB_RECORDS_ADDR		(PIN_DB_CONFIG_BASE + PIN_DB_HEADER_SIZE)
+#define PIN_DB_TABLE_SIZE		(PIN_DB_CONFIG_USERS * PIN_DB_RECORD_SIZE)
+#define PIN_DB_BURST			(64u)		// Load: records per read, 4
+#define PIN_DB_PAGE				(32u)		// Wipe: bytes per write
+
+#define PIN_DB_ACTIVE			(0xA5u)		// Anything else is a free record
+#define PIN_DB_OFS_TAG			(PIN_HASH_SIZE)
+#define PIN_DB_OFS_ROLE			(PIN_HASH_SIZE + 4u)
+#define PIN_DB_OFS_STATE		(PIN_HASH_SIZE + 5u)
+#define PIN_DB_OFS_USES			(PIN_HASH_SIZE + 6u)
+
+#define PIN_DB_INDEX_MASK		(PIN_DB_CONFIG_INDEX - 1)
+
+/********************** internal data definition *****************************/
+/* Record cache: lookups never go to the EEPROM. ~2.4 KB for 128 users */
+static uint32_t pin_db_tag[PIN_DB_CONFIG_USERS];
+static uint8_t pin_db_digest[PIN_DB_CONFIG_USERS][PIN_HASH_SIZE];
+static uint8_t pin_db_role[PIN_DB_CONFIG_USERS];		// PIN_ROLE_QTY: free
+static uint16_t pin_db_uses[PIN_DB_CONFIG_USERS];
+static uint16_t pin_db_index[PIN_DB_CONFIG_INDEX];		// Record + 1, 0: empty
+static uint8_t pin_db_dirty[PIN_DB_CONFIG_USERS / 8];	// Records the AT24 is behind on
+static uint32_t pin_db_salt;
+static bool pin_db_wipe;
+static i2c_bus_req_t pin_db_req;			// Init lane transfer
+
+/********************** external data definition *****************************/
+pin_db_stats_t pin_db_stats;
+
+/********************** internal functions definition ************************/
+static bool pin_db_index_add(uint16_t slot)
+{
+	uint32_t home = pin_db_tag[slot] & PIN_DB_INDEX_MASK;
+	uint32_t probe;
+
+	for (probe = 0; PIN_DB_CONFIG_PROBES > probe; probe++)
+	{
+		if (0 == pin_db_index[(home + probe) & PIN_DB_INDEX_MASK])
+		{
+			pin_db_index[(home + probe) & PIN_DB_INDEX_MASK] = slot + 1;
+			return true;
+		}
+	}
+
+	pin_db_stats.index_full++;
+
+	return false;
+}
+
+static void pin_db_index_remove(uint16_t slot)
+{
+	uint32_t home = pin_db_tag[slot] & PIN_DB_INDEX_MASK;
+	uint32_t probe;
+
+	for (probe = 0; PIN_DB_CONFIG_PROBES > probe; probe++)
+	{
+		if ((slot + 1) == pin_db_index[(home + probe) & PIN_DB_INDEX_MASK])
+		{
+			pin_db_index[(home + probe) & PIN_DB_INDEX_MASK] = 0;
+		}
+	}
+}
+
+// The record goes out with the next pin_db_flush(), free or active.
+static void pin_db_record_dirty(uint16_t slot)
+{
+	pin_db_dirty[slot / 8] |= (uint8_t)(1u << (slot % 8));
+}
+
+static bool pin_db_record_write(uint16_t slot)
+{
+	uint8_t record[PIN_DB_RECORD_SIZE];
+
+	memcpy(&record[0], pin_db_digest[slot], PIN_HASH_SIZE);
+	memcpy(&record[PIN_DB_OFS_TAG], &pin_db_tag[slot], 4);
+	record[PIN_DB_OFS_ROLE] = pin_db_role[slot];
+	record[PIN_DB_OFS_STATE] = (PIN_ROLE_QTY > pin_db_role[slot]) ? PIN_DB_ACTIVE : 0x00;
+	memcpy(&record[PIN_DB_OFS_USES], &pin_db_uses[slot], 2);
+
+	return write_memory(PIN_DB_RECORDS_ADDR + (slot * PIN_DB_RECORD_SIZE), record, sizeof(record));
+}
+
+static void pin_db_load(const uint8_t record[], uint16_t slot)
+{
+	if ((PIN_DB_ACTIVE != record[PIN_DB_OFS_STATE]) || (PIN_ROLE_QTY <= record[PIN_DB_OFS_ROLE]))
+	{
+		return;
+	}
+
+	memcpy(pin_db_digest[slot], &record[0], PIN_HASH_SIZE);
+	memcpy(&pin_db_tag[slot], &record[PIN_DB_OFS_TAG], 4);
+	pin_db_role[slot] = record[PIN_DB_OFS_ROLE];
+	memcpy(&pin_db_uses[slot], &record[PIN_DB_OFS_USES], 2);
+
+	if (pin_db_index_add(slot))
+	{
+		pin_db_stats.users++;
+	}
+	else
+	{
+		pin_db_role[slot] = PIN_ROLE_QTY;
+	}
+}
+
+static int32_t pin_db_header(void)
+{
+	uint8_t header[PIN_DB_HEADER_USED];
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_HIGH, PIN_DB_I2C_ADDRESS, PIN_DB_CONFIG_BASE,
+						   I2C_MEMADD_SIZE_16BIT, sizeof(header), header, NULL, NULL};
+	HAL_StatusTypeDef status;
+	uint32_t crc;
+
+	if (HAL_BUSY == (status = i2c_bus_poll(I2C_BUS_2, &xfer, &pin_db_req, PIN_DB_I2C_TIMEOUT)))
+	{
+		return INIT_SEQ_AGAIN;
+	}
+
+	if (HAL_OK != status)
+	{
+		/* No EEPROM: master password only */
+		return INIT_SEQ_DONE;
+	}
+
+	memcpy(&crc, &header[8], 4);
+	if ((header[0] | (header[1] << 8)) == PIN_DB_MAGIC && (PIN_DB_VERSION == header[2]) && (crc32(header, 8) == crc))
+	{
+		memcpy(&pin_db_salt, &header[4], 4);
+		pin_db_wipe = false;
+	}
+	else
+	{
+		/* New table: a salt of its own, and no stale record may survive */
+		pin_db_salt = pin_hash_salt();
+		pin_db_wipe = true;
+	}
+
+	return 0;
+}
+
+// false until the header write is done.
+static bool pin_db_header_write(void)
+{
+	uint8_t header[PIN_DB_HEADER_USED];
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_WRITE, I2C_BUS_PRIO_HIGH, PIN_DB_I2C_ADDRESS, PIN_DB_CONFIG_BASE,
+						   I2C_MEMADD_SIZE_16BIT, sizeof(header), header, NULL, NULL};
+	uint32_t crc;
+
+	header[0] = (uint8_t)PIN_DB_MAGIC;
+	header[1] = (uint8_t)(PIN_DB_MAGIC >> 8);
+	header[2] = PIN_DB_VERSION;
+	header[3] = 0;
+	memcpy(&header[4], &pin_db_salt, 4);
+	crc = crc32(header, 8);
+	memcpy(&header[8], &crc, 4);
+
+	return (HAL_BUSY != i2c_bus_poll(I2C_BUS_2, &xfer, &pin_db_req, PIN_DB_I2C_TIMEOUT));
+}
+
+/********************** external functions definition ************************/
+// Init lane (init_seq): header, then one burst of records per step. A new
+// table is wiped one page per step first; its header goes last, so a reset
+// during the wipe starts it over.
+int32_t pin_db_init_lane(uint32_t step)
+{
+	uint8_t buffer[PIN_DB_BURST];
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_HIGH, PIN_DB_I2C_ADDRESS, 0,
+						   I2C_MEMADD_SIZE_16BIT, PIN_DB_BURST, buffer, NULL, NULL};
+	HAL_StatusTypeDef status;
+	uint32_t index;
+
+	if (0 == step)
+	{
+		memset(pin_db_index, 0, sizeof(pin_db_index));
+		memset(pin_db_role, PIN_ROLE_QTY, sizeof(pin_db_role));
+		memset(pin_db_dirty, 0, sizeof(pin_db_dirty));
+		memset(&pin_db_stats, 0, sizeof(pin_db_stats));
+
+		return pin_db_header();
+	}
+
+	if (pin_db_wipe)
+	{
+		if ((step * PIN_DB_PAGE) > PIN_DB_TABLE_SIZE)
+		{
+			if (!pin_db_header_write())
+			{
+				return INIT_SEQ_AGAIN;
+			}
+
+			pin_db_wipe = false;
+
+			return INIT_SEQ_DONE;
+		}
+
+		memset(buffer, 0, PIN_DB_PAGE);
+		xfer.op = I2C_BUS_OP_MEM_WRITE;
+		xfer.mem_addr = PIN_DB_RECORDS_ADDR + ((step - 1) * PIN_DB_PAGE);
+		xfer.size = PIN_DB_PAGE;
+
+		return (HAL_BUSY == i2c_bus_poll(I2C_BUS_2, &xfer, &pin_db_req, PIN_DB_I2C_TIMEOUT)) ? INIT_SEQ_AGAIN : PIN_DB_WRITE_CYCLE_MS;
+	}
+
+	xfer.mem_addr = PIN_DB_RECORDS_ADDR + ((step - 1) * PIN_DB_BURST);
+	if (HAL_BUSY == (status = i2c_bus_poll(I2C_BUS_2, &xfer, &pin_db_req, PIN_DB_I2C_TIMEOUT)))
+	{
+		return INIT_SEQ_AGAIN;
+	}
+
+	if (HAL_OK == status)
+	{
+		for (index = 0; (PIN_DB_BURST / PIN_DB_RECORD_SIZE) > index; index++)
+		{
+			pin_db_load(&buffer[index * PIN_DB_RECORD_SIZE], ((step - 1) * (PIN_DB_BURST / PIN_DB_RECORD_SIZE)) + index);
+		}
+	}
+
+	if ((step * PIN_DB_BURST) >= PIN_DB_TABLE_SIZE)
+	{
+		LOGGER_LOG("pin db %u users\r\n", pin_db_stats.users);
+		return INIT_SEQ_DONE;
+	}
+
+	return 0;
+}
+
+// The CRC tag (CRC unit) picks the index entries and the salted SHA-256
+// digest decides. Both are computed, and all PIN_DB_CONFIG_PROBES entries
+// compared in constant time, on every attempt: the cost does not depend on
+// the PIN or on what the table holds.
+uint16_t pin_db_find(const char *p_pin, uint8_t *p_role)
+{
+	uint32_t tag = pin_hash_tag(pin_db_salt, p_pin);
+	uint32_t home = tag & PIN_DB_INDEX_MASK;
+	uint8_t digest[PIN_HASH_SIZE];
+	uint16_t user = PIN_DB_NONE;
+	uint32_t probe;
+	uint16_t entry;
+	uint16_t slot;
+	uint32_t match;
+
+	pin_hash_digest(pin_db_salt, p_pin, digest);
+
+	for (probe = 0; PIN_DB_CONFIG_PROBES > probe; probe++)
+	{
+		entry = pin_db_index[(home + probe) & PIN_DB_INDEX_MASK];
+		slot = (0 != entry) ? (entry - 1) : 0;
+		match = (0 != entry) & (tag == pin_db_tag[slot]) & pin_hash_equal(digest, pin_db_digest[slot]) &
+				(PIN_ROLE_QTY > pin_db_role[slot]);
+		user = match ? entry : user;
+	}
+
+	pin_db_stats.lookups++;
+	if (PIN_DB_NONE != user)
+	{
+		pin_db_stats.hits++;
+		*p_role = pin_db_role[user - 1];
+	}
+
+	return user;
+}
+
+// What the keypad can type: 1..PIN_DB_PIN_MAX decimal digits, nothing after.
+bool pin_db_valid(const char *p_pin)
+{
+	size_t length;
+
+	for (length = 0; '\0' != p_pin[length]; length++)
+	{
+		if ((PIN_DB_PIN_MAX <= length) || ('0' > p_pin[length]) || ('9' < p_pin[length]))
+		{
+			return false;
+		}
+	}
+
+	return (0 != length);
+}
+
+// New user (id 1..PIN_DB_CONFIG_USERS). uses only counts for PIN_ROLE_TEMP.
+uint16_t pin_db_add(const char *p_pin, pin_role_t role, uint16_t uses)
+{
+	uint8_t role_found;
+	uint16_t slot;
+
+	if (!pin_db_valid(p_pin) || (PIN_ROLE_QTY <= role) ||
+		(PIN_DB_NONE != pin_db_find(p_pin, &role_found)))
+	{
+		return PIN_DB_NONE;
+	}
+
+	for (slot = 0; PIN_DB_CONFIG_USERS > slot; slot++)
+	{
+		if (PIN_ROLE_QTY == pin_db_role[slot])
+		{
+			break;
+		}
+	}
+
+	if (PIN_DB_CONFIG_USERS == slot)
+	{
+		return PIN_DB_NONE;
+	}
+
+	pin_db_tag[slot] = pin_hash_tag(pin_db_salt, p_pin);
+	pin_hash_digest(pin_db_salt, p_pin, pin_db_digest[slot]);
+	pin_db_role[slot] = role;
+	pin_db_uses[slot] = (PIN_ROLE_TEMP == role) ? uses : 0;
+
+	if (!pin_db_index_add(slot))
+	{
+		pin_db_role[slot] = PIN_ROLE_QTY;
+		return PIN_DB_NONE;
+	}
+
+	pin_db_record_dirty(slot);
+	pin_db_stats.users++;
+
+	return slot + 1;
+}
+
+// Record pushed by the head-end (cred_store.c): tag and digest come computed
+// with the salt of this table, so the PIN itself never travels. Whatever the
+// id held before is replaced.
+bool pin_db_put(uint16_t user, pin_role_t role, uint16_t uses, uint32_t tag, const uint8_t digest[PIN_HASH_SIZE])
+{
+	uint16_t slot = user - 1;
+
+	if ((PIN_DB_MASTER == user) || (PIN_DB_CONFIG_USERS < user) || (PIN_ROLE_QTY <= role))
+	{
+		return false;
+	}
+
+	if (PIN_ROLE_QTY != pin_db_role[slot])
+	{
+		pin_db_index_remove(slot);
+		pin_db_role[slot] = PIN_ROLE_QTY;
+		pin_db_stats.users--;
+	}
+
+	pin_db_tag[slot] = tag;
+	memcpy(pin_db_digest[slot], digest, PIN_HASH_SIZE);
+	pin_db_role[slot] = role;
+	pin_db_uses[slot] = (PIN_ROLE_TEMP == role) ? uses : 0;
+
+	/* Failed or not, the old record must not come back at the next boot */
+	pin_db_record_dirty(slot);
+
+	if (!pin_db_index_add(slot))
+	{
+		pin_db_role[slot] = PIN_ROLE_QTY;
+		return false;
+	}
+
+	pin_db_stats.users++;
+
+	return true;
+}
+
+bool pin_db_remove(uint16_t user)
+{
+	uint16_t slot = user - 1;
+
+	if ((PIN_DB_MASTER == user) || (PIN_DB_CONFIG_USERS < user) || (PIN_ROLE_QTY == pin_db_role[slot]))
+	{
+		return false;
+	}
+
+	pin_db_index_remove(slot);
+	pin_db_role[slot] = PIN_ROLE_QTY;
+	pin_db_stats.users--;
+
+	pin_db_record_dirty(slot);
+
+	return true;
+}
+
+// After a granted access: a temporary PIN loses one use, the last one removes it.
+void pin_db_used(uint16_t user)
+{
+	uint16_t slot = user - 1;
+
+	if ((PIN_DB_MASTER == user) || (PIN_DB_CONFIG_USERS < user) || (PIN_ROLE_TEMP != pin_db_role[slot]))
+	{
+		return;
+	}
+
+	if (1 >= pin_db_uses[slot])
+	{
+		pin_db_remove(user);
+		return;
+	}
+
+	pin_db_uses[slot]--;
+	pin_db_record_dirty(slot);
+}
+
+// Writes one record the AT24 is behind on; false if there is none. Changes
+// only reach the RAM cache at once: the EEPROM follows one record at a time
+// (cred_store_update()), so a batch of them never floods the write queue.
+bool pin_db_flush(void)
+{
+	uint16_t slot;
+
+	for (slot = 0; PIN_DB_CONFIG_USERS > slot; slot++)
+	{
+		if (0 != (pin_db_dirty[slot / 8] & (1u << (slot % 8))))
+		{
+			if (pin_db_record_write(slot))
+			{
+				pin_db_dirty[slot / 8] &= (uint8_t)~(1u << (slot % 8));
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Salt of the table: the head-end needs it to compute pushed records.
+uint32_t pin_db_table_salt(void)
+{
+	return pin_db_salt;
+}
+
+// Tag and digest of a user, false if the id is free. For the change journal.
+bool pin_db_key(uint16_t user, uint32_t *p_tag, uint8_t digest[PIN_HASH_SIZE])
+{
+	uint16_t slot = user - 1;
+
+	if ((PIN_DB_MASTER == user) || (PIN_DB_CONFIG_USERS < user) || (PIN_ROLE_QTY == pin_db_role[slot]))
+	{
+		return false;
+	}
+
+	*p_tag = pin_db_tag[slot];
+	memcpy(digest, pin_db_digest[slot], PIN_HASH_SIZE);
+
+	return true;
+}
+
+// Role and uses left of a user, false if the id is free. For listings.
+bool pin_db_info(uint16_t user, uint8_t *p_role, uint16_t *p_uses)
+{
+	uint16_t slot = user - 1;
+
+	if ((PIN_DB_MASTER == user) || (PIN_DB_CONFIG_USERS < user) || (PIN_ROLE_QTY == pin_db_role[slot]))
+	{
+		return false;
+	}
+
+	*p_role = pin_db_role[slot];
+	*p_uses = pin_db_uses[slot];
+
+	return true;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,141 @@
+/*
+ *
+ * @file   : pin_hash.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "logger.h"
+#include "dwt.h"
+#include "sha256.h"
+#include "pin_hash.h"
+
+/********************** macros and definitions *******************************/
+#define PIN_HASH_TICK_CYCLES	(SystemCoreClock / 1000)	// Scheduler tick budget
+
+/********************** internal data definition *****************************/
+
+/********************** external data definition *****************************/
+pin_hash_stats_t pin_hash_stats;
+
+/********************** internal functions definition ************************/
+// Salt (little endian) and the zero padded PIN: a fixed size input, so every
+// digest takes a single SHA-256 block whatever the PIN.
+static void pin_hash_input(uint8_t input[4 + PIN_HASH_PIN_MAX], uint32_t salt, const char *p_pin)
+{
+	uint32_t index;
+
+	memcpy(&input[0], &salt, 4);
+	memset(&input[4], 0, PIN_HASH_PIN_MAX);
+	for (index = 0; (PIN_HASH_PIN_MAX > index) && ('\0' != p_pin[index]); index++)
+	{
+		input[4 + index] = (uint8_t)p_pin[index];
+	}
+}
+
+/********************** external functions definition ************************/
+// Clocks the CRC unit and measures one attempt (tag and digest) with the DWT:
+// the figure that has to stay below a tick on the target itself.
+void pin_hash_init(void)
+{
+	uint8_t digest[PIN_HASH_SIZE];
+	uint32_t cycles;
+
+	__HAL_RCC_CRC_CLK_ENABLE();
+	memset(&pin_hash_stats, 0, sizeof(pin_hash_stats));
+
+	cycles = cycle_counter_get();
+	(void)pin_hash_tag(0, "00000");
+	pin_hash_digest(0, "00000", digest);
+	(void)pin_hash_equal(digest, digest);
+	cycles = cycle_counter_get() - cycles;
+
+	LOGGER_LOG("pin hash %lu cyc (tick %lu)\r\n", cycles, PIN_HASH_TICK_CYCLES);
+}
+
+// Per device and per table: the unique ID and the free-running cycle counter.
+uint32_t pin_hash_salt(void)
+{
+	return HAL_GetUIDw0() ^ HAL_GetUIDw1() ^ HAL_GetUIDw2() ^ cycle_counter_get();
+}
+
+// Pre-filter: CRC-32 of the same input on the CRC unit, three words and no
+// software loop. It picks the index entries; the digest decides.
+uint32_t pin_hash_tag(uint32_t salt, const char *p_pin)
+{
+	uint8_t input[4 + PIN_HASH_PIN_MAX];
+	uint32_t word;
+	uint32_t index;
+
+	pin_hash_input(input, salt, p_pin);
+
+	CRC->CR = CRC_CR_RESET;
+	for (index = 0; sizeof(input) > index; index += 4)
+	{
+		memcpy(&word, &input[index], 4);
+		CRC->DR = word;
+	}
+
+	return CRC->DR;
+}
+
+void pin_hash_digest(uint32_t salt, const char *p_pin, uint8_t digest[PIN_HASH_SIZE])
+{
+	uint8_t input[4 + PIN_HASH_PIN_MAX];
+	uint8_t full[SHA256_SIZE];
+
+	pin_hash_input(input, salt, p_pin);
+	sha256(input, sizeof(input), full);
+	memcpy(digest, full, PIN_HASH_SIZE);
+}
+
+// New salt and its digest, for a PIN being stored.
+void pin_hash_make(pin_hash_t *p_hash, const char *p_pin)
+{
+	p_hash->salt = pin_hash_salt();
+	pin_hash_digest(p_hash->salt, p_pin, p_hash->digest);
+}
+
+// Constant time: every byte is compared, no early exit on the first mismatch.
+bool pin_hash_equal(const uint8_t digest_a[PIN_HASH_SIZE], const uint8_t digest_b[PIN_HASH_SIZE])
+{
+	volatile uint8_t diff = 0;
+	uint32_t index;
+
+	for (index = 0; PIN_HASH_SIZE > index; index++)
+	{
+		diff |= digest_a[index] ^ digest_b[index];
+	}
+
+	return (0 == diff);
+}
+
+bool pin_hash_verify(const pin_hash_t *p_hash, const char *p_pin)
+{
+	uint8_t digest[PIN_HASH_SIZE];
+
+	pin_hash_digest(p_hash->salt, p_pin, digest);
+
+	return pin_hash_equal(digest, p_hash->digest);
+}
+
+// Cost of a whole PIN attempt, measured by the caller with the DWT.
+void pin_hash_cost(uint32_t cycles)
+{
+	pin_hash_stats.attempts++;
+	pin_hash_stats.cycles_last = cycles;
+	if (cycles > pin_hash_stats.cycles_max)
+	{
+		pin_hash_stats.cycles_max = cycles;
+	}
+	if (cycles > PIN_HASH_TICK_CYCLES)
+	{
+		pin_hash_stats.over_budget++;
+	}
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,411 @@
+/*
+ *
+ * @file   : rs485_link.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "i2c_bus.h"
+#include "crc32.h"
+#include "cobs.h"
+#include "uart_dma.h"
+#include "eeprom_emu.h"
+#include "memory_handler.h"
+#include "pin_hash.h"
+#include "pin_db.h"
+#include "card_db.h"
+#include "cred_store.h"
+#include "lockout.h"
+#include "log_export.h"
+#include "task_system_attribute.h"
+#include "rs485_link.h"
+
+/********************** macros and definitions *******************************/
+#define RS485_LINK_UART			UART_DMA_3
+#define RS485_LINK_I2C_ADDRESS	(0xA0)
+#define RS485_LINK_HEADER		(4)				// dst, src, type, seq
+#define RS485_LINK_OVERHEAD		(RS485_LINK_HEADER + 4)
+#define RS485_LINK_CRED_SIZE	(6 + CRED_STORE_WIRE_SIZE)
+#define RS485_LINK_JOURNAL_MAX	(4)				// Changes per 'L' frame
+
+typedef enum {
+	RS485_LINK_RAW_EMPTY,
+	RS485_LINK_RAW_READING,
+	RS485_LINK_RAW_READY
+} rs485_link_raw_st_t;
+
+/********************** internal data definition *****************************/
+static uint8_t rs485_link_addr;
+
+static uint8_t rs485_link_rx[COBS_MAX(RS485_LINK_FRAME_MAX)];
+static uint16_t rs485_link_rx_len;
+
+/* Log request being read: answered once all its records are in */
+static bool rs485_link_b_log;
+static uint8_t rs485_link_log_seq;
+static uint16_t rs485_link_log_index;
+static uint8_t rs485_link_log_count;
+static uint8_t rs485_link_raw[RS485_LINK_CONFIG_LOG_BATCH][MEM_ACCESS_SIZE];
+static volatile uint8_t rs485_link_raw_st[RS485_LINK_CONFIG_LOG_BATCH];
+
+/********************** external data definition *****************************/
+rs485_link_stats_t rs485_link_stats;
+
+/********************** internal functions definition ************************/
+// I2C interrupt. A failed read is sent zeroed: the record goes out invalid.
+static void rs485_link_read_done(HAL_StatusTypeDef status, void *p_arg)
+{
+	uint32_t slot = (uint32_t)(uintptr_t)p_arg;
+
+	if (HAL_OK != status)
+	{
+		memset(rs485_link_raw[slot], 0, MEM_ACCESS_SIZE);
+	}
+	rs485_link_raw_st[slot] = RS485_LINK_RAW_READY;
+}
+
+static void rs485_link_send(uint8_t type, uint8_t seq, const uint8_t *p_payload, uint16_t size)
+{
+	uint8_t frame[RS485_LINK_FRAME_MAX];
+	uint8_t encoded[COBS_MAX(RS485_LINK_FRAME_MAX) + 2];
+	uint16_t length;
+	uint32_t crc;
+
+	frame[0] = RS485_LINK_HEAD;
+	frame[1] = rs485_link_addr;
+	frame[2] = type;
+	frame[3] = seq;
+	memcpy(&frame[RS485_LINK_HEADER], p_payload, size);
+	length = RS485_LINK_HEADER + size;
+	crc = crc32(frame, length);
+	memcpy(&frame[length], &crc, 4);
+	length += 4;
+
+	encoded[0] = 0x00;
+	length = 1 + cobs_encode(frame, length, &encoded[1]);
+	encoded[length++] = 0x00;
+
+	if (uart_dma_write(RS485_LINK_UART, encoded, length))
+	{
+		rs485_link_stats.replies++;
+	}
+}
+
+static void rs485_link_status(uint8_t seq)
+{
+	uint8_t payload[16];
+	uint16_t lock_s = (uint16_t)((lockout_remaining() + 999) / 1000);
+	uint32_t salt = pin_db_table_salt();
+
+	memcpy(&payload[0], &cred_store_vv.head, 2);
+	memcpy(&payload[2], &pin_db_stats.users, 2);
+	payload[4] = task_system_dta.system_parameters.saved_entries;
+	payload[5] = (uint8_t)task_system_dta.state;
+	memcpy(&payload[6], &lock_s, 2);
+	memcpy(&payload[8], &salt, 4);
+	memcpy(&payload[12], &cred_store_vv.local, 2);
+	memcpy(&payload[14], &card_db_stats.cards, 2);
+
+	rs485_link_send(RS485_LINK_STATUS, seq, payload, sizeof(payload));
+}
+
+// One change of a batch (cred_store_stage()). The answer says where the
+// node stands: the head-end resends what is missing, or starts over from
+// the head version it reports.
+static void rs485_link_cred(const uint8_t *p, bool b_reply, uint8_t seq)
+{
+	uint8_t payload[5];
+	cred_change_t change;
+	uint16_t base;
+	uint16_t target;
+
+	memcpy(&base, &p[0], 2);
+	memcpy(&target, &p[2], 2);
+
+	if (cred_store_unpack(&change, &p[6]))
+	{
+		rs485_link_stats.creds++;
+		if (CRED_STORE_STALE == cred_store_stage(base, target, p[4], p[5], &change))
+		{
+			rs485_link_stats.cred_stale++;
+		}
+	}
+
+	if (b_reply)
+	{
+		memcpy(&payload[0], &cred_store_vv.head, 2);
+		memcpy(&payload[2], &cred_store_vv.local, 2);
+		payload[4] = cred_store_staged();
+		rs485_link_send(RS485_LINK_CRED_ACK, seq, payload, sizeof(payload));
+	}
+}
+
+// Changes made at this door after the version asked for.
+static void rs485_link_journal(const uint8_t *p, uint8_t seq)
+{
+	cred_change_t changes[RS485_LINK_JOURNAL_MAX];
+	uint8_t payload[5 + (RS485_LINK_JOURNAL_MAX * CRED_STORE_WIRE_SIZE)];
+	uint16_t length = 5;
+	uint16_t since;
+	uint16_t first;
+	uint8_t qty;
+	uint8_t index;
+
+	memcpy(&since, &p[0], 2);
+	qty = cred_store_since(since, &first, changes, RS485_LINK_JOURNAL_MAX);
+
+	memcpy(&payload[0], &cred_store_vv.local, 2);
+	memcpy(&payload[2], &first, 2);
+	payload[4] = qty;
+	for (index = 0; qty > index; index++)
+	{
+		length += cred_store_pack(&payload[length], &changes[index]);
+	}
+
+	rs485_link_send(RS485_LINK_JOURNAL_DATA, seq, payload, length);
+}
+
+static void rs485_link_log(const uint8_t *p, uint8_t seq)
+{
+	uint8_t slot;
+	uint8_t payload[3];
+
+	/* A request dropped by the head-end may still have reads in flight */
+	for (slot = 0; RS485_LINK_CONFIG_LOG_BATCH > slot; slot++)
+	{
+		if (RS485_LINK_RAW_READING == rs485_link_raw_st[slot])
+		{
+			return;
+		}
+	}
+
+	memcpy(&rs485_link_log_index, &p[0], 2);
+	rs485_link_log_count = (RS485_LINK_CONFIG_LOG_BATCH < p[2]) ? RS485_LINK_CONFIG_LOG_BATCH : p[2];
+	if (MEM_ACCESS_QTY <= rs485_link_log_index)
+	{
+		rs485_link_log_count = 0;
+	}
+	else if ((MEM_ACCESS_QTY - rs485_link_log_index) < rs485_link_log_count)
+	{
+		rs485_link_log_count = MEM_ACCESS_QTY - rs485_link_log_index;
+	}
+
+	if (0 == rs485_link_log_count)
+	{
+		memcpy(&payload[0], &rs485_link_log_index, 2);
+		payload[2] = 0;
+		rs485_link_send(RS485_LINK_LOG_DATA, seq, payload, sizeof(payload));
+		return;
+	}
+
+	memset((void *)rs485_link_raw_st, RS485_LINK_RAW_EMPTY, sizeof(rs485_link_raw_st));
+	rs485_link_log_seq = seq;
+	rs485_link_b_log = true;
+}
+
+// Reads the records of the pending log request, answers once all are in.
+static void rs485_link_log_update(void)
+{
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_NORMAL, RS485_LINK_I2C_ADDRESS, 0,
+						   I2C_MEMADD_SIZE_16BIT, MEM_ACCESS_SIZE, NULL, rs485_link_read_done, NULL};
+	uint8_t payload[3 + (RS485_LINK_CONFIG_LOG_BATCH * LOG_EXPORT_RECORD_SIZE)];
+	uint16_t length = 3;
+	uint8_t ready = 0;
+	uint8_t slot;
+
+	for (slot = 0; rs485_link_log_count > slot; slot++)
+	{
+		if (RS485_LINK_RAW_EMPTY == rs485_link_raw_st[slot])
+		{
+			rs485_link_raw_st[slot] = RS485_LINK_RAW_READING;
+
+			xfer.mem_addr = MEM_ACCESS_BASE + (MEM_ACCESS_STRIDE * (rs485_link_log_index + slot));
+			xfer.p_data = rs485_link_raw[slot];
+			xfer.p_arg = (void *)(uintptr_t)slot;
+			if (!i2c_bus_submit(I2C_BUS_2, &xfer))
+			{
+				rs485_link_raw_st[slot] = RS485_LINK_RAW_EMPTY;
+			}
+		}
+
+		ready += (RS485_LINK_RAW_READY == rs485_link_raw_st[slot]) ? 1 : 0;
+	}
+
+	if (rs485_link_log_count != ready)
+	{
+		return;
+	}
+
+	memcpy(&payload[0], &rs485_link_log_index, 2);
+	payload[2] = rs485_link_log_count;
+	for (slot = 0; rs485_link_log_count > slot; slot++)
+	{
+		length += log_export_pack(&payload[length], rs485_link_raw[slot], rs485_link_log_index + slot);
+		rs485_link_raw_st[slot] = RS485_LINK_RAW_EMPTY;
+	}
+
+	rs485_link_send(RS485_LINK_LOG_DATA, rs485_link_log_seq, payload, length);
+	rs485_link_stats.log_records += rs485_link_log_count;
+	rs485_link_b_log = false;
+}
+
+static void rs485_link_frame(const uint8_t *p_frame, uint16_t length)
+{
+	const uint8_t *p_payload = &p_frame[RS485_LINK_HEADER];
+	uint16_t size = length - RS485_LINK_OVERHEAD;
+	bool b_mine = (rs485_link_addr == p_frame[0]);
+	uint32_t crc;
+
+	memcpy(&crc, &p_frame[length - 4], 4);
+	if (crc32(p_frame, length - 4) != crc)
+	{
+		rs485_link_stats.bad_frames++;
+		return;
+	}
+
+	/* Other nodes' traffic, answers included */
+	if ((!b_mine && (RS485_LINK_BROADCAST != p_frame[0])) || (RS485_LINK_HEAD != p_frame[1]))
+	{
+		return;
+	}
+
+	rs485_link_stats.rx_frames++;
+
+	/* A new request from the head-end means it gave up on the pending one */
+	if (b_mine)
+	{
+		rs485_link_b_log = false;
+	}
+
+	switch (p_frame[2])
+	{
+		case RS485_LINK_POLL:
+
+			if (b_mine)
+			{
+				rs485_link_status(p_frame[3]);
+			}
+
+			break;
+
+		case RS485_LINK_CRED:
+
+			if (RS485_LINK_CRED_SIZE == size)
+			{
+				rs485_link_cred(p_payload, b_mine, p_frame[3]);
+			}
+
+			break;
+
+		case RS485_LINK_LOG:
+
+			if (b_mine && (3 == size))
+			{
+				rs485_link_log(p_payload, p_frame[3]);
+			}
+
+			break;
+
+		case RS485_LINK_JOURNAL:
+
+			if (b_mine && (2 == size))
+			{
+				rs485_link_journal(p_payload, p_frame[3]);
+			}
+
+			break;
+
+		default:
+
+			break;
+	}
+}
+
+// Bus bytes, split on 0x00. Frames start and end with one.
+static void rs485_link_receive(void)
+{
+	uint8_t chunk[RS485_LINK_CONFIG_RX_TICK];
+	uint8_t frame[RS485_LINK_FRAME_MAX];
+	uint16_t qty = uart_dma_read(RS485_LINK_UART, chunk, sizeof(chunk));
+	uint16_t index;
+	uint16_t length;
+
+	for (index = 0; qty > index; index++)
+	{
+		if (0x00 != chunk[index])
+		{
+			/* Too long: dropped up to the next delimiter */
+			if (sizeof(rs485_link_rx) > rs485_link_rx_len)
+			{
+				rs485_link_rx[rs485_link_rx_len] = chunk[index];
+			}
+			rs485_link_rx_len++;
+			continue;
+		}
+
+		if (0 == rs485_link_rx_len)
+		{
+			continue;
+		}
+
+		length = (sizeof(rs485_link_rx) >= rs485_link_rx_len) ? cobs_decode(rs485_link_rx, rs485_link_rx_len, frame) : 0;
+		if (RS485_LINK_OVERHEAD <= length)
+		{
+			rs485_link_frame(frame, length);
+		}
+		else
+		{
+			rs485_link_stats.bad_frames++;
+		}
+		rs485_link_rx_len = 0;
+	}
+}
+
+/********************** external functions definition ************************/
+// After eeprom_emu_init(): the address is kept there.
+void rs485_link_init(void)
+{
+	uint16_t value;
+
+	memset(&rs485_link_stats, 0, sizeof(rs485_link_stats));
+	memset((void *)rs485_link_raw_st, RS485_LINK_RAW_EMPTY, sizeof(rs485_link_raw_st));
+	rs485_link_rx_len = 0;
+	rs485_link_b_log = false;
+
+	rs485_link_addr = RS485_LINK_CONFIG_ADDRESS;
+	if (eeprom_emu_read(EE_RS485_ADDR, &value) && (1 <= value) && (RS485_LINK_NODE_MAX >= value))
+	{
+		rs485_link_addr = (uint8_t)value;
+	}
+
+	uart_dma_init(RS485_LINK_UART, RS485_LINK_CONFIG_BAUD);
+}
+
+// Every system tick: frames in, answers out in the same tick, log records
+// read through the I2C queue. Nothing here waits.
+void rs485_link_update(void)
+{
+	rs485_link_receive();
+
+	if (rs485_link_b_log)
+	{
+		rs485_link_log_update();
+	}
+}
+
+uint8_t rs485_link_address(void)
+{
+	return rs485_link_addr;
+}
+
+// Takes effect on the next frame; the caller stores it (EE_RS485_ADDR).
+void rs485_link_set_address(uint8_t address)
+{
+	rs485_link_addr = address;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,176 @@
+/*
+ *
+ * @file   : servo_profile.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include "main.h"
+#include "servo_profile.h"
+#include "task_system_attribute.h"
+#include "task_system_interface.h"
+
+/********************** macros and definitions *******************************/
+#define SERVO_PROFILE_SPAN		(SERVO_PROFILE_POS_OPEN - SERVO_PROFILE_POS_CLOSED)
+
+/********************** internal data definition *****************************/
+
+/********************** external data definition *****************************/
+servo_profile_t servo_profile;
+
+/********************** internal functions definition ************************/
+// Runs in the DMA1 channel 5 interrupt once the last compare value is loaded.
+static void servo_profile_dma_cplt(DMA_HandleTypeDef *hdma)
+{
+	__HAL_TIM_DISABLE_DMA(&htim1, TIM_DMA_UPDATE);
+
+	servo_profile.busy = false;
+	servo_profile.done = true;
+
+	if (NULL != servo_profile.p_done)
+	{
+		servo_profile.p_done(servo_profile.target);
+	}
+}
+
+static void servo_profile_stop(void)
+{
+	__HAL_TIM_DISABLE_DMA(&htim1, TIM_DMA_UPDATE);
+
+	if (servo_profile.busy)
+	{
+		HAL_DMA_Abort(htim1.hdma[TIM_DMA_ID_UPDATE]);
+		servo_profile.busy = false;
+	}
+}
+
+// Trapezoid: velocity ramps up over the first quarter of the steps, holds,
+// and ramps down over the last quarter. Positions are the running sum.
+static void servo_profile_trapezoid(uint16_t from, int32_t span, uint32_t qty)
+{
+	uint32_t i;
+	uint32_t ramp = (qty / 4) ? (qty / 4) : 1;
+	uint32_t weight;
+	uint32_t total = 0;
+	uint32_t sum = 0;
+
+	for (i = 1; qty >= i; i++)
+	{
+		weight = (i < ramp) ? i : ramp;
+		weight = ((qty + 1 - i) < weight) ? (qty + 1 - i) : weight;
+		total += weight;
+	}
+
+	for (i = 1; qty >= i; i++)
+	{
+		weight = (i < ramp) ? i : ramp;
+		weight = ((qty + 1 - i) < weight) ? (qty + 1 - i) : weight;
+		sum += weight;
+		servo_profile.table[i - 1] = from + (span * (int32_t)sum) / (int32_t)total;
+	}
+}
+
+// S-curve: p(t) = t^3 (10 - 15 t + 6 t^2), zero speed and acceleration at both ends.
+static void servo_profile_scurve(uint16_t from, int32_t span, uint32_t qty)
+{
+	uint32_t i;
+	int64_t n = qty;
+	int64_t den = n * n * n * n * n;
+	int64_t num;
+
+	for (i = 1; qty >= i; i++)
+	{
+		num = (int64_t)i * i * i * (10 * n * n - 15 * (int64_t)i * n + 6 * (int64_t)i * i);
+		servo_profile.table[i - 1] = from + (int32_t)((span * num) / den);
+	}
+}
+
+/********************** external functions definition ************************/
+void servo_profile_init(servo_profile_cb_t p_done)
+{
+	servo_profile.shape = SERVO_PROFILE_CONFIG_SHAPE;
+	servo_profile.open_ms = SERVO_PROFILE_CONFIG_OPEN_MS;
+	servo_profile.close_ms = SERVO_PROFILE_CONFIG_CLOSE_MS;
+	servo_profile.target = SERVO_PROFILE_POS_CLOSED;
+	servo_profile.qty = 0;
+	servo_profile.busy = false;
+	servo_profile.done = false;
+	servo_profile.p_done = p_done;
+
+	htim1.hdma[TIM_DMA_ID_UPDATE]->XferCpltCallback = servo_profile_dma_cplt;
+
+	HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
+	__HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, SERVO_PROFILE_POS_CLOSED);
+}
+
+void servo_profile_speed(uint16_t open_ms, uint16_t close_ms)
+{
+	servo_profile.open_ms = open_ms;
+	servo_profile.close_ms = close_ms;
+}
+
+// Starts a move from the current compare value. A move in progress is cut
+// where it stands, and a partial travel takes a proportional time.
+void servo_profile_move(uint16_t target)
+{
+	uint16_t from;
+	int32_t span;
+	uint32_t qty;
+
+	servo_profile_stop();
+
+	from = __HAL_TIM_GET_COMPARE(&htim1, TIM_CHANNEL_1);
+	span = (int32_t)target - (int32_t)from;
+
+	servo_profile.target = target;
+	servo_profile.done = false;
+
+	if (0 == span)
+	{
+		servo_profile.done = true;
+		if (NULL != servo_profile.p_done)
+		{
+			servo_profile.p_done(target);
+		}
+		return;
+	}
+
+	qty = (span > 0) ? ((uint32_t)servo_profile.open_ms * span) : ((uint32_t)servo_profile.close_ms * -span);
+	qty /= (SERVO_PROFILE_SPAN * SERVO_PROFILE_PERIOD_MS);
+	qty = (0 == qty) ? 1 : qty;
+	qty = (SERVO_PROFILE_STEPS_MAX < qty) ? SERVO_PROFILE_STEPS_MAX : qty;
+
+	if (SERVO_PROFILE_TRAPEZOID == servo_profile.shape)
+	{
+		servo_profile_trapezoid(from, span, qty);
+	}
+	else
+	{
+		servo_profile_scurve(from, span, qty);
+	}
+
+	servo_profile.qty = qty;
+	servo_profile.busy = true;
+
+	/* One compare value per TIM1 update event, no CPU until the end */
+	HAL_DMA_Start_IT(htim1.hdma[TIM_DMA_ID_UPDATE], (uint32_t)servo_profile.table,
+					 (uint32_t)&htim1.Instance->CCR1, qty);
+	__HAL_TIM_ENABLE_DMA(&htim1, TIM_DMA_UPDATE);
+}
+
+// Called from the system task: turns the completion flag into a system event.
+void servo_profile_update(void)
+{
+	if (false == servo_profile.done)
+	{
+		return;
+	}
+
+	servo_profile.done = false;
+
+	put_event_task_system((SERVO_PROFILE_POS_OPEN == servo_profile.target) ?
+						  EV_SYS_XX_LOCK_OPENED : EV_SYS_XX_LOCK_CLOSED);
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,276 @@
+/*
+ *
+ * @file   : settings.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "logger.h"
+#include "i2c_bus.h"
+#include "crc32.h"
+#include "memory_handler.h"
+#include "settings.h"
+
+/********************** macros and definitions *******************************/
+#define SETTINGS_I2C_ADDRESS	(0xA0)
+#define SETTINGS_I2C_TIMEOUT	(50ul)
+#define SETTINGS_DIFF_GAP		(4)		// Changed bytes closer than this go in one write
+#define SETTINGS_LEGACY_SIZE	(15)
+#define SETTINGS_LEGACY_PWD		(8)		// Offset of the plain text password
+
+/********************** internal data definition *****************************/
+/* What each slot holds in the EEPROM: the diff writes compare against it */
+static uint8_t settings_image[2][SETTINGS_SLOT_SIZE];
+static settings_data_t settings_saved;
+static int8_t settings_active = -1;
+static uint32_t settings_seq;
+
+/* settings_load() over several calls: the burst, then maybe the legacy header */
+static i2c_bus_req_t settings_req;
+static bool settings_b_legacy;
+
+/********************** external data definition *****************************/
+settings_data_t settings;
+settings_stats_t settings_stats;
+
+/********************** internal functions definition ************************/
+static uint32_t settings_get32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void settings_put32(uint8_t *p, uint32_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	p[2] = (uint8_t)(value >> 16);
+	p[3] = (uint8_t)(value >> 24);
+}
+
+// Slot image: magic, version, payload size, sequence, payload, CRC-32 of all
+// the previous bytes. Returns its length.
+static uint16_t settings_build(uint8_t image[], uint32_t seq)
+{
+	uint16_t length = SETTINGS_HEADER_SIZE + sizeof(settings_data_t);
+
+	image[0] = (uint8_t)SETTINGS_MAGIC;
+	image[1] = (uint8_t)(SETTINGS_MAGIC >> 8);
+	image[2] = SETTINGS_VERSION;
+	image[3] = sizeof(settings_data_t);
+	settings_put32(&image[4], seq);
+	memcpy(&image[SETTINGS_HEADER_SIZE], &settings, sizeof(settings_data_t));
+	settings_put32(&image[length], crc32(image, length));
+
+	return length + SETTINGS_CRC_SIZE;
+}
+
+// Validates a slot image; fields missing from an older version keep the
+// values already in p_data.
+static bool settings_check(const uint8_t image[], uint32_t *p_seq, uint8_t *p_version, settings_data_t *p_data)
+{
+	uint8_t size = image[3];
+
+	if (((uint16_t)(image[0] | (image[1] << 8)) != SETTINGS_MAGIC) || (0 == image[2]) || (SETTINGS_VERSION < image[2]) ||
+		((SETTINGS_SLOT_SIZE - SETTINGS_HEADER_SIZE - SETTINGS_CRC_SIZE) < size) ||
+		(settings_get32(&image[SETTINGS_HEADER_SIZE + size]) != crc32(image, SETTINGS_HEADER_SIZE + size)))
+	{
+		return false;
+	}
+
+	*p_seq = settings_get32(&image[4]);
+	*p_version = image[2];
+	memcpy(p_data, &image[SETTINGS_HEADER_SIZE], (sizeof(settings_data_t) < size) ? sizeof(settings_data_t) : size);
+
+	return true;
+}
+
+// Only the bytes that differ from what the target slot holds are written.
+// The runs are queued in address order, so the CRC goes last: a save cut by
+// a reset leaves a bad slot and the other one is used.
+static bool settings_write(uint8_t target)
+{
+	uint8_t image[SETTINGS_SLOT_SIZE];
+	uint16_t length = settings_build(image, settings_seq + 1);
+	uint16_t index;
+	uint16_t start;
+	uint16_t last;
+
+	for (index = 0; length > index; )
+	{
+		if (image[index] == settings_image[target][index])
+		{
+			index++;
+			continue;
+		}
+
+		start = index;
+		last = index;
+		for (index = start + 1; (length > index) && ((index - last) <= SETTINGS_DIFF_GAP); index++)
+		{
+			if (image[index] != settings_image[target][index])
+			{
+				last = index;
+			}
+		}
+
+		if (!write_memory(SETTINGS_SLOT_A_ADDR + (target * SETTINGS_SLOT_SIZE) + start, &image[start], last - start + 1))
+		{
+			return false;
+		}
+
+		settings_stats.bytes += last - start + 1;
+		index = last + 1;
+	}
+
+	memcpy(settings_image[target], image, length);
+	settings_saved = settings;
+	settings_active = target;
+	settings_seq++;
+	settings_stats.saves++;
+
+	return true;
+}
+
+// The legacy header and version 1 kept the password in plain text: it is
+// replaced by its salted digest and the legacy copy is overwritten.
+static void settings_hash_password(void)
+{
+	static const uint8_t zero[sizeof(settings.password)] = {0};
+	char password[sizeof(settings.password) + 1] = {0};
+
+	if (0 != (settings.flags & SETTINGS_FLAG_WRITTEN))
+	{
+		memcpy(password, settings.password, sizeof(settings.password));
+		pin_hash_make(&settings.pwd, password);
+		memset(password, 0, sizeof(password));
+	}
+
+	memset(settings.password, 0, sizeof(settings.password));
+	write_memory(SETTINGS_LEGACY_ADDR + SETTINGS_LEGACY_PWD, zero, sizeof(zero));
+}
+
+// "written"/"notinit" header of the first firmware versions.
+static HAL_StatusTypeDef settings_migrate_legacy(void)
+{
+	uint8_t header[SETTINGS_LEGACY_SIZE];
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_HIGH, SETTINGS_I2C_ADDRESS, SETTINGS_LEGACY_ADDR,
+						   I2C_MEMADD_SIZE_16BIT, sizeof(header), header, NULL, NULL};
+	HAL_StatusTypeDef status;
+
+	if (HAL_BUSY == (status = i2c_bus_poll(I2C_BUS_2, &xfer, &settings_req, SETTINGS_I2C_TIMEOUT)))
+	{
+		return HAL_BUSY;
+	}
+
+	settings_b_legacy = false;
+
+	if (HAL_OK != status)
+	{
+		return HAL_ERROR;
+	}
+
+	if ((0 == memcmp(header, "written", 8)) && ('\0' != header[SETTINGS_LEGACY_PWD]))
+	{
+		memcpy(settings.password, &header[SETTINGS_LEGACY_PWD], sizeof(settings.password));
+		settings.saved_entries = header[14];
+		settings.flags |= SETTINGS_FLAG_WRITTEN;
+	}
+
+	settings_hash_password();
+	settings_stats.migrations++;
+
+	return settings_write(0) ? HAL_OK : HAL_ERROR;
+}
+
+/********************** external functions definition ************************/
+// Both slots in one burst; the valid one with the newest sequence wins.
+// With no valid slot the legacy header is migrated. Does not wait on the bus:
+// HAL_BUSY until the reads are done, call again on a later tick.
+HAL_StatusTypeDef settings_load(void)
+{
+	uint8_t burst[2 * SETTINGS_SLOT_SIZE];
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_HIGH, SETTINGS_I2C_ADDRESS, SETTINGS_SLOT_A_ADDR,
+						   I2C_MEMADD_SIZE_16BIT, sizeof(burst), burst, NULL, NULL};
+	settings_data_t data[2];
+	uint32_t seq[2];
+	uint8_t version[2];
+	bool b_valid[2];
+	HAL_StatusTypeDef status;
+	bool b_ok = true;
+	uint8_t slot;
+
+	if (settings_b_legacy)
+	{
+		return settings_migrate_legacy();
+	}
+
+	if (HAL_OK != (status = i2c_bus_poll(I2C_BUS_2, &xfer, &settings_req, SETTINGS_I2C_TIMEOUT)))
+	{
+		return (HAL_BUSY == status) ? HAL_BUSY : HAL_ERROR;
+	}
+
+	for (slot = 0; 2 > slot; slot++)
+	{
+		memcpy(settings_image[slot], &burst[slot * SETTINGS_SLOT_SIZE], SETTINGS_SLOT_SIZE);
+		data[slot] = settings;
+		b_valid[slot] = settings_check(settings_image[slot], &seq[slot], &version[slot], &data[slot]);
+		if (!b_valid[slot])
+		{
+			settings_stats.bad_slots++;
+		}
+	}
+
+	if (!b_valid[0] && !b_valid[1])
+	{
+		settings_b_legacy = true;
+		return settings_migrate_legacy();
+	}
+
+	slot = (b_valid[0] && (!b_valid[1] || ((int32_t)(seq[0] - seq[1]) > 0))) ? 0 : 1;
+
+	settings = data[slot];
+	settings_saved = settings;
+	settings_active = slot;
+	settings_seq = seq[slot];
+	settings_stats.loads++;
+
+	if (SETTINGS_VERSION > version[slot])
+	{
+		/* Rewritten in the current layout on the other slot */
+		settings_stats.migrations++;
+		if (2 > version[slot])
+		{
+			settings_hash_password();
+		}
+		b_ok = settings_write(1 - slot);
+		version[1 - slot] = SETTINGS_VERSION;
+	}
+
+	/* A version 1 slot left behind holds the password in plain text */
+	for (slot = 0; b_ok && (2 > slot); slot++)
+	{
+		if (b_valid[slot] && (2 > version[slot]))
+		{
+			b_ok = settings_write(slot);
+		}
+	}
+
+	return b_ok ? HAL_OK : HAL_ERROR;
+}
+
+// Writes settings to the slot not in use; see settings_write().
+bool settings_save(void)
+{
+	if ((0 <= settings_active) && (0 == memcmp(&settings, &settings_saved, sizeof(settings_data_t))))
+	{
+		return true;
+	}
+
+	return settings_write((0 == settings_active) ? 1 : 0);
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,117 @@
+/*
+ *
+ * @file   : sha256.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "sha256.h"
+
+/********************** macros and definitions *******************************/
+/* Rotates compile to a single ROR on the Cortex-M3 */
+#define SHA256_ROR(x, n)	(((x) >> (n)) | ((x) << (32 - (n))))
+
+#define SHA256_S0(x)		(SHA256_ROR(x, 2) ^ SHA256_ROR(x, 13) ^ SHA256_ROR(x, 22))
+#define SHA256_S1(x)		(SHA256_ROR(x, 6) ^ SHA256_ROR(x, 11) ^ SHA256_ROR(x, 25))
+#define SHA256_G0(x)		(SHA256_ROR(x, 7) ^ SHA256_ROR(x, 18) ^ ((x) >> 3))
+#define SHA256_G1(x)		(SHA256_ROR(x, 17) ^ SHA256_ROR(x, 19) ^ ((x) >> 10))
+
+#define SHA256_BLOCK		(64)
+
+/********************** internal data definition *****************************/
+static const uint32_t sha256_k[64] = {
+	0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+	0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+	0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+	0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+	0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+	0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+	0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+	0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+static const uint32_t sha256_h0[8] = {
+	0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+/********************** internal functions definition ************************/
+// One 64 byte block. The message schedule is kept as a rolling window of 16
+// words (64 bytes of stack instead of 256).
+static void sha256_block(uint32_t state[8], const uint8_t *p)
+{
+	uint32_t w[16];
+	uint32_t a, b, c, d, e, f, g, h;
+	uint32_t t1, t2;
+	uint32_t i;
+
+	for (i = 0; 16 > i; i++)
+	{
+		w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) | ((uint32_t)p[4 * i + 2] << 8) | p[4 * i + 3];
+	}
+
+	a = state[0]; b = state[1]; c = state[2]; d = state[3];
+	e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+	for (i = 0; 64 > i; i++)
+	{
+		if (16 <= i)
+		{
+			w[i & 15] += SHA256_G1(w[(i - 2) & 15]) + w[(i - 7) & 15] + SHA256_G0(w[(i - 15) & 15]);
+		}
+
+		t1 = h + SHA256_S1(e) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i & 15];
+		t2 = SHA256_S0(a) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+
+	state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+	state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+/********************** external functions definition ************************/
+void sha256(const void *p_data, uint32_t size, uint8_t digest[SHA256_SIZE])
+{
+	const uint8_t *p = (const uint8_t *)p_data;
+	uint8_t tail[2 * SHA256_BLOCK];
+	uint32_t state[8];
+	uint32_t rest;
+	uint32_t length;
+	uint32_t i;
+
+	memcpy(state, sha256_h0, sizeof(state));
+
+	for (rest = size; SHA256_BLOCK <= rest; rest -= SHA256_BLOCK, p += SHA256_BLOCK)
+	{
+		sha256_block(state, p);
+	}
+
+	/* Padding: 0x80, zeros, then the length in bits (big endian) */
+	length = ((rest + 9) <= SHA256_BLOCK) ? SHA256_BLOCK : (2 * SHA256_BLOCK);
+	memset(tail, 0, length);
+	memcpy(tail, p, rest);
+	tail[rest] = 0x80;
+	tail[length - 5] = (uint8_t)(size >> 29);
+	tail[length - 4] = (uint8_t)(size >> 21);
+	tail[length - 3] = (uint8_t)(size >> 13);
+	tail[length - 2] = (uint8_t)(size >> 5);
+	tail[length - 1] = (uint8_t)(size << 3);
+
+	for (i = 0; length > i; i += SHA256_BLOCK)
+	{
+		sha256_block(state, &tail[i]);
+	}
+
+	for (i = 0; 8 > i; i++)
+	{
+		digest[4 * i] = (uint8_t)(state[i] >> 24);
+		digest[4 * i + 1] = (uint8_t)(state[i] >> 16);
+		digest[4 * i + 2] = (uint8_t)(state[i] >> 8);
+		digest[4 * i + 3] = (uint8_t)state[i];
+	}
+}
+
+/********************** end of file ******************************************/
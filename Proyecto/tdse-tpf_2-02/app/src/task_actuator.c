@@ -43,12 +43,15 @@
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "budget.h"
+#include "trace.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
 #include "app.h"
 #include "task_actuator_attribute.h"
 #include "task_actuator_interface.h"
+#include "act_engine.h"
 
 /********************** macros and definitions *******************************/
 #define G_TASK_ACT_CNT_INIT			0ul
@@ -60,48 +63,227 @@
 
 #define DEL_ACT_XX_FAST_BLI			120ul
 
+#define PATTERN(steps, repeat)		{steps, sizeof(steps)/sizeof(task_actuator_step_t), repeat}
+
+/* Wrap-safe: true once now has reached deadline */
+#define ACT_DEADLINE_REACHED(now, deadline)	((int32_t)((now) - (deadline)) >= 0)
+
 /********************** internal data declaration ****************************/
 const task_actuator_cfg_t task_actuator_cfg_list[] = {
-	{ID_LED_1,  LED_1_PORT,  LED_1_PIN, LED_1_ON,  LED_1_OFF,
-	 DEL_ACT_XX_BLI, DEL_ACT_XX_PUL},
-	{ID_LED_2,  LED_2_PORT,  LED_2_PIN, LED_2_ON,  LED_2_OFF,
-	 DEL_ACT_XX_BLI, DEL_ACT_XX_PUL},
-	{ID_LED_3,  LED_3_PORT,  LED_3_PIN, LED_3_ON,  LED_3_OFF,
-	 DEL_ACT_XX_BLI, DEL_ACT_XX_PUL},
-	{ID_BUZ,  BUZ_PORT,  BUZ_PIN, BUZ_ON,  BUZ_OFF,
-	 DEL_ACT_XX_BLI, DEL_ACT_XX_PUL}
+	{ID_LED_1,  LED_1_PORT,  LED_1_PIN, LED_1_ON,  LED_1_OFF},
+	{ID_LED_2,  LED_2_PORT,  LED_2_PIN, LED_2_ON,  LED_2_OFF},
+	{ID_LED_3,  LED_3_PORT,  LED_3_PIN, LED_3_ON,  LED_3_OFF},
+	{ID_BUZ,  BUZ_PORT,  BUZ_PIN, BUZ_ON,  BUZ_OFF}
 };
 
 #define ACTUATOR_CFG_QTY	(sizeof(task_actuator_cfg_list)/sizeof(task_actuator_cfg_t))
 
 task_actuator_dta_t task_actuator_dta_list[] = {
-	{DEL_ACT_XX_MIN, ST_ACT_XX_OFF, EV_ACT_XX_NOT_BLINK, false},
-	{DEL_ACT_XX_MIN, ST_ACT_XX_OFF, EV_ACT_XX_NOT_BLINK, false},
-	{DEL_ACT_XX_MIN, ST_ACT_XX_OFF, EV_ACT_XX_NOT_BLINK, false},
-	{DEL_ACT_XX_MIN, ST_ACT_XX_OFF, EV_ACT_XX_NOT_BLINK, false}
+	{ST_ACT_XX_OFF, EV_ACT_XX_NOT_BLINK, false, NULL, 0, 0, DEL_ACT_XX_MIN},
+	{ST_ACT_XX_OFF, EV_ACT_XX_NOT_BLINK, false, NULL, 0, 0, DEL_ACT_XX_MIN},
+	{ST_ACT_XX_OFF, EV_ACT_XX_NOT_BLINK, false, NULL, 0, 0, DEL_ACT_XX_MIN},
+	{ST_ACT_XX_OFF, EV_ACT_XX_NOT_BLINK, false, NULL, 0, 0, DEL_ACT_XX_MIN}
 };
 
 #define ACTUATOR_DTA_QTY	(sizeof(task_actuator_dta_list)/sizeof(task_actuator_dta_t))
 
+/* Pattern steps: {level, value, duration (mS)} */
+static const task_actuator_step_t step_blink[] = {
+	{LVL_ACT_ON, 0, DEL_ACT_XX_BLI}, {LVL_ACT_OFF, 0, DEL_ACT_XX_BLI}
+};
+
+static const task_actuator_step_t step_fast_blink[] = {
+	{LVL_ACT_ON, 0, DEL_ACT_XX_FAST_BLI}, {LVL_ACT_OFF, 0, DEL_ACT_XX_FAST_BLI}
+};
+
+static const task_actuator_step_t step_pulse[] = {
+	{LVL_ACT_ON, 0, DEL_ACT_XX_PUL}
+};
+
+static const task_actuator_step_t step_chirp[] = {
+	{LVL_ACT_ON, 0, 60}, {LVL_ACT_OFF, 0, 60}
+};
+
+static const task_actuator_step_t step_siren[] = {
+	{LVL_ACT_TONE, 80, 400}, {LVL_ACT_TONE, 120, 400}
+};
+
+static const task_actuator_step_t step_low_bat[] = {
+	{LVL_ACT_ON, 0, 50}, {LVL_ACT_OFF, 0, 4950}
+};
+
+static const task_actuator_step_t step_held_open[] = {
+	{LVL_ACT_ON, 0, 100}, {LVL_ACT_OFF, 0, 100},
+	{LVL_ACT_ON, 0, 100}, {LVL_ACT_DIM, 10, 1700}
+};
+
+/* Indexed by event; NULL for the static level events */
+static const task_actuator_pattern_t task_actuator_pattern_list[EV_ACT_XX_QTY] = {
+	[EV_ACT_XX_BLINK]		= PATTERN(step_blink, 0),
+	[EV_ACT_XX_FAST_BLINK]	= PATTERN(step_fast_blink, 0),
+	[EV_ACT_XX_PULSE]		= PATTERN(step_pulse, 1),
+	[EV_ACT_XX_CHIRP]		= PATTERN(step_chirp, 2),
+	[EV_ACT_XX_SIREN]		= PATTERN(step_siren, 0),
+	[EV_ACT_XX_LOW_BAT]		= PATTERN(step_low_bat, 0),
+	[EV_ACT_XX_HELD_OPEN]	= PATTERN(step_held_open, 0)
+};
+
 /********************** internal functions declaration ***********************/
+static bool task_actuator_square(const task_actuator_pattern_t *p_pattern);
+static void task_actuator_step_apply(uint32_t index, const task_actuator_step_t *p_step);
+static void task_actuator_event(uint32_t index, task_actuator_dta_t *p_task_actuator_dta);
+static void task_actuator_step_next(uint32_t index, task_actuator_dta_t *p_task_actuator_dta);
+static void task_actuator_deadline_update(void);
 
 /********************** internal data definition *****************************/
 const char *p_task_actuator 		= "Task Actuator (Actuator Statechart)";
 const char *p_task_actuator_ 		= "Non-Blocking & Update By Time Code";
 
+/* Sequencer time base and the earliest deadline of all running patterns */
+static uint32_t task_actuator_now;
+static uint32_t task_actuator_next_deadline;
+static uint32_t task_actuator_running;
+
 /********************** external data declaration ****************************/
 uint32_t g_task_actuator_cnt;
 volatile uint32_t g_task_actuator_tick_cnt;
+volatile uint32_t g_task_actuator_pending;
+
+/********************** internal functions definition ************************/
+// Endless on/off pattern (blink, low battery): a square wave the TIM2 compare
+// engine keeps up by itself, with no deadline in the sequencer.
+static bool task_actuator_square(const task_actuator_pattern_t *p_pattern)
+{
+	return (2 == p_pattern->qty) && (0 == p_pattern->repeat) &&
+		   (LVL_ACT_ON == p_pattern->p_step[0].level) && (LVL_ACT_OFF == p_pattern->p_step[1].level);
+}
+
+static void task_actuator_step_apply(uint32_t index, const task_actuator_step_t *p_step)
+{
+	switch (p_step->level)
+	{
+		case LVL_ACT_ON:
+
+			act_engine_level(index, true);
+
+			break;
+
+		case LVL_ACT_DIM:
+
+			act_engine_dim(index, p_step->value);
+
+			break;
+
+		case LVL_ACT_TONE:
+
+			act_engine_tone(index, (uint32_t)p_step->value * 10);
+
+			break;
+
+		default:
+
+			act_engine_level(index, false);
+
+			break;
+	}
+}
+
+/* Any event overrides what the actuator is doing */
+static void task_actuator_event(uint32_t index, task_actuator_dta_t *p_task_actuator_dta)
+{
+	const task_actuator_pattern_t *p_pattern = NULL;
+
+	p_task_actuator_dta->flag = false;
+
+	if (EV_ACT_XX_QTY > p_task_actuator_dta->event)
+	{
+		p_pattern = &task_actuator_pattern_list[p_task_actuator_dta->event];
+	}
+
+	if (ST_ACT_XX_PATTERN == p_task_actuator_dta->state)
+	{
+		task_actuator_running--;
+	}
+
+	if ((NULL != p_pattern) && (NULL != p_pattern->p_step) && task_actuator_square(p_pattern))
+	{
+		act_engine_square(index, p_pattern->p_step[0].duration * 1000ul, p_pattern->p_step[1].duration * 1000ul);
+		p_task_actuator_dta->state = ST_ACT_XX_SQUARE;
+	}
+	else if ((NULL != p_pattern) && (NULL != p_pattern->p_step))
+	{
+		p_task_actuator_dta->p_pattern = p_pattern;
+		p_task_actuator_dta->step = 0;
+		p_task_actuator_dta->repeat = p_pattern->repeat;
+		p_task_actuator_dta->deadline = task_actuator_now + p_pattern->p_step[0].duration;
+		task_actuator_step_apply(index, &p_pattern->p_step[0]);
+		p_task_actuator_dta->state = ST_ACT_XX_PATTERN;
+		task_actuator_running++;
+	}
+	else if (EV_ACT_XX_ON == p_task_actuator_dta->event)
+	{
+		act_engine_level(index, true);
+		p_task_actuator_dta->state = ST_ACT_XX_ON;
+	}
+	else
+	{
+		act_engine_level(index, false);
+		p_task_actuator_dta->state = ST_ACT_XX_OFF;
+	}
+
+	TRACE_ACT_GET(index, p_task_actuator_dta->event);
+}
+
+static void task_actuator_step_next(uint32_t index, task_actuator_dta_t *p_task_actuator_dta)
+{
+	const task_actuator_pattern_t *p_pattern = p_task_actuator_dta->p_pattern;
+
+	p_task_actuator_dta->step++;
+
+	if (p_pattern->qty <= p_task_actuator_dta->step)
+	{
+		p_task_actuator_dta->step = 0;
+
+		/* Last run of a finite pattern: back to off */
+		if ((0 != p_task_actuator_dta->repeat) && (0 == --p_task_actuator_dta->repeat))
+		{
+			act_engine_level(index, false);
+			p_task_actuator_dta->state = ST_ACT_XX_OFF;
+			task_actuator_running--;
+			return;
+		}
+	}
+
+	p_task_actuator_dta->deadline += p_pattern->p_step[p_task_actuator_dta->step].duration;
+	task_actuator_step_apply(index, &p_pattern->p_step[p_task_actuator_dta->step]);
+}
+
+/* Only runs when an event arrived or a deadline fired, never on idle ticks */
+static void task_actuator_deadline_update(void)
+{
+	uint32_t index;
+	bool b_first = true;
+
+	for (index = 0; ACTUATOR_DTA_QTY > index; index++)
+	{
+		if (ST_ACT_XX_PATTERN != task_actuator_dta_list[index].state)
+		{
+			continue;
+		}
+
+		if (b_first || ((int32_t)(task_actuator_dta_list[index].deadline - task_actuator_next_deadline) < 0))
+		{
+			task_actuator_next_deadline = task_actuator_dta_list[index].deadline;
+			b_first = false;
+		}
+	}
+}
 
 /********************** external functions definition ************************/
 void task_actuator_init(void *parameters)
 {
 	uint32_t index;
 	const task_actuator_cfg_t *p_task_actuator_cfg;
-	task_actuator_dta_t *p_task_actuator_dta;
-	task_actuator_st_t state;
-	task_actuator_ev_t event;
-	bool b_event;
 
 	/* Print out: Task Initialized */
 	LOGGER_LOG("  %s is running - %s\r\n", GET_NAME(task_actuator_init), p_task_actuator);
@@ -112,36 +294,37 @@ void task_actuator_init(void *parameters)
 	/* Print out: Task execution counter */
 	LOGGER_LOG("   %s = %lu\r\n", GET_NAME(g_task_actuator_cnt), g_task_actuator_cnt);
 
+	/* Outputs are driven by the TIM2 compare engine, one channel per actuator */
+	act_engine_init();
+
 	for (index = 0; ACTUATOR_DTA_QTY > index; index++)
 	{
-		/* Update Task Actuator Configuration & Data Pointer */
+		/* Update Task Actuator Configuration Pointer */
 		p_task_actuator_cfg = &task_actuator_cfg_list[index];
-		p_task_actuator_dta = &task_actuator_dta_list[index];
 
 		/* Print out: Index & Task execution FSM */
 		LOGGER_LOG("   %s = %lu", GET_NAME(index), index);
+		LOGGER_LOG("   %s = %lu", GET_NAME(state), (uint32_t)task_actuator_dta_list[index].state);
+		LOGGER_LOG("   %s = %lu", GET_NAME(event), (uint32_t)task_actuator_dta_list[index].event);
+		LOGGER_LOG("   %s = %s\r\n", GET_NAME(b_event), (task_actuator_dta_list[index].flag ? "true" : "false"));
 
-		state = p_task_actuator_dta->state;
-		LOGGER_LOG("   %s = %lu", GET_NAME(state), (uint32_t)state);
-
-		event = p_task_actuator_dta->event;
-		LOGGER_LOG("   %s = %lu", GET_NAME(event), (uint32_t)event);
-
-		b_event = p_task_actuator_dta->flag;
-		LOGGER_LOG("   %s = %s\r\n", GET_NAME(b_event), (b_event ? "true" : "false"));
-
-		HAL_GPIO_WritePin(p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin, p_task_actuator_cfg->act_off);
+		act_engine_attach(index, p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin, p_task_actuator_cfg->act_on);
 	}
 
+	task_actuator_now = DEL_ACT_XX_MIN;
+	task_actuator_next_deadline = DEL_ACT_XX_MIN;
+	task_actuator_running = 0;
+
 	g_task_actuator_tick_cnt = G_TASK_ACT_TICK_CNT_INI;
 }
 
 void task_actuator_update(void *parameters)
 {
 	uint32_t index;
-	const task_actuator_cfg_t *p_task_actuator_cfg;
+	uint32_t pending;
 	task_actuator_dta_t *p_task_actuator_dta;
 	bool b_time_update_required = false;
+	bool b_deadline_changed;
 
 	/* Update Task Actuator Counter */
 	g_task_actuator_cnt++;
@@ -159,7 +342,7 @@ void task_actuator_update(void *parameters)
     {
 		/* Protect shared resource (g_task_actuator_tick_cnt) */
 		__asm("CPSID i");	/* disable interrupts*/
-		if (G_TASK_ACT_TICK_CNT_INI < g_task_actuator_tick_cnt)
+		if ((G_TASK_ACT_TICK_CNT_INI < g_task_actuator_tick_cnt) && (0 != budget_remaining_cycles()))
 		{
 			g_task_actuator_tick_cnt--;
 			b_time_update_required = true;
@@ -170,103 +353,48 @@ void task_actuator_update(void *parameters)
 		}
 		__asm("CPSIE i");	/* enable interrupts*/
 
-    	for (index = 0; ACTUATOR_DTA_QTY > index; index++)
+		task_actuator_now++;
+		b_deadline_changed = false;
+
+		/* Events: only the actuators flagged by put_event_task_actuator() */
+		pending = g_task_actuator_pending;
+		if (0 != pending)
 		{
-    		/* Update Task Actuator Configuration & Data Pointer */
-			p_task_actuator_cfg = &task_actuator_cfg_list[index];
-			p_task_actuator_dta = &task_actuator_dta_list[index];
+			g_task_actuator_pending = 0;
 
-			switch (p_task_actuator_dta->state)
+			for (index = 0; ACTUATOR_DTA_QTY > index; index++)
 			{
-				case ST_ACT_XX_OFF:
-
-					if ((true == p_task_actuator_dta->flag) && (EV_ACT_XX_ON == p_task_actuator_dta->event))
-					{
-						p_task_actuator_dta->flag = false;
-						HAL_GPIO_WritePin(p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin, p_task_actuator_cfg->act_on);
-						p_task_actuator_dta->state = ST_ACT_XX_ON;
-					} else if ((true == p_task_actuator_dta->flag) && (EV_ACT_XX_BLINK == p_task_actuator_dta->event))
-					{
-						p_task_actuator_dta->flag = false;
-						p_task_actuator_dta->state = ST_ACT_XX_BLINK;
-					} else if ((true == p_task_actuator_dta->flag) && (EV_ACT_XX_FAST_BLINK == p_task_actuator_dta->event))
-					{
-						p_task_actuator_dta->flag = false;
-						p_task_actuator_dta->state = ST_ACT_XX_FAST_BLINK;
-					}
-
-					break;
-
-				case ST_ACT_XX_ON:
-
-					if ((true == p_task_actuator_dta->flag) && (EV_ACT_XX_OFF == p_task_actuator_dta->event))
-					{
-						p_task_actuator_dta->flag = false;
-						HAL_GPIO_WritePin(p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin, p_task_actuator_cfg->act_off);
-						p_task_actuator_dta->state = ST_ACT_XX_OFF;
-					}
-
-					break;
-
-				case ST_ACT_XX_BLINK:
-
-					if (p_task_actuator_dta->tick == 0)
-					{
-						p_task_actuator_dta->tick = DEL_ACT_XX_BLI;
-						HAL_GPIO_TogglePin(p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin);
-					}
-					else
-					{
-						p_task_actuator_dta->tick--;
-					}
-
-					if ((true == p_task_actuator_dta->flag) && (EV_ACT_XX_OFF == p_task_actuator_dta->event))
-					{
-						p_task_actuator_dta->flag = false;
-						HAL_GPIO_WritePin(p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin, p_task_actuator_cfg->act_off);
-						p_task_actuator_dta->state = ST_ACT_XX_OFF;
-						p_task_actuator_dta->tick = 0;
-					}
-
-					if ((true == p_task_actuator_dta->flag) && (EV_ACT_XX_FAST_BLINK == p_task_actuator_dta->event))
-					{
-						p_task_actuator_dta->flag = false;
-						p_task_actuator_dta->state = ST_ACT_XX_FAST_BLINK;
-						p_task_actuator_dta->tick = 0;
-					}
-
-					break;
-
-				case ST_ACT_XX_FAST_BLINK:
-
-					if (p_task_actuator_dta->tick == 0)
-					{
-						p_task_actuator_dta->tick = DEL_ACT_XX_FAST_BLI;
-						HAL_GPIO_TogglePin(p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin);
-					}
-					else
-					{
-						p_task_actuator_dta->tick--;
-					}
-
-					if ((true == p_task_actuator_dta->flag) && (EV_ACT_XX_OFF == p_task_actuator_dta->event))
-					{
-						p_task_actuator_dta->flag = false;
-						HAL_GPIO_WritePin(p_task_actuator_cfg->gpio_port, p_task_actuator_cfg->pin, p_task_actuator_cfg->act_off);
-						p_task_actuator_dta->state = ST_ACT_XX_OFF;
-						p_task_actuator_dta->tick = 0;
-					}
-
-					break;
-
-				case ST_ACT_XX_PULSE:
-
-					break;
-
-				default:
-
-					break;
+				p_task_actuator_dta = &task_actuator_dta_list[index];
+
+				if ((pending & (1ul << index)) && (true == p_task_actuator_dta->flag))
+				{
+					task_actuator_event(index, p_task_actuator_dta);
+				}
+			}
+
+			b_deadline_changed = true;
+		}
+
+		/* Patterns: nothing to do until the earliest deadline */
+		if ((0 != task_actuator_running) && ACT_DEADLINE_REACHED(task_actuator_now, task_actuator_next_deadline))
+		{
+	    	for (index = 0; ACTUATOR_DTA_QTY > index; index++)
+			{
+				p_task_actuator_dta = &task_actuator_dta_list[index];
+
+				if ((ST_ACT_XX_PATTERN == p_task_actuator_dta->state) &&
+					ACT_DEADLINE_REACHED(task_actuator_now, p_task_actuator_dta->deadline))
+				{
+					task_actuator_step_next(index, p_task_actuator_dta);
+				}
 			}
+
+			b_deadline_changed = true;
+		}
+
+		if (b_deadline_changed && (0 != task_actuator_running))
+		{
+			task_actuator_deadline_update();
 		}
     }
 }
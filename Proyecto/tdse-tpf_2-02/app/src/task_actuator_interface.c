@@ -43,6 +43,7 @@
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "trace.h"
 
 /* External module includes. */
 #include "i2c_lcd.h"
@@ -69,8 +70,11 @@ void put_event_task_actuator(task_actuator_ev_t event, task_actuator_id_t identi
 
 	p_task_actuator_dta = &task_actuator_dta_list[identifier];
 
+	TRACE_ACT_PUT(identifier, event);
+
 	p_task_actuator_dta->event = event;
 	p_task_actuator_dta->flag = true;
+	g_task_actuator_pending |= (1ul << identifier);
 }
 
 // Pushes a char to the buffer.
@@ -43,6 +43,7 @@
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "budget.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
@@ -50,29 +51,41 @@
 #include "task_sensor_attribute.h"
 #include "task_system_attribute.h"
 #include "task_system_interface.h"
+#include "input_rec.h"
 
 /********************** macros and definitions *******************************/
 #define G_TASK_SEN_CNT_INIT			0ul
 #define G_TASK_SEN_TICK_CNT_INI		0ul
 
-#define DEL_BTN_XX_MIN				0ul
-#define DEL_BTN_XX_MED				25ul
-#define DEL_BTN_XX_MAX				50ul
+#define DEL_BTN_XX_SAMPLE			12ul	// 4 equal samples -> ~50 mS debounce
+
+#define SENSOR_PORT_MAX				4ul
 
 /********************** internal data declaration ****************************/
 const task_sensor_cfg_t task_sensor_cfg_list[] = {
-	{ID_BTN, BTN_1_PORT, BTN_1_PIN, BTN_1_PRESSED, DEL_BTN_XX_MAX,
-	 EV_SYS_XX_BTN_IDLE,  EV_SYS_XX_BTN_ACTIVE}
+	{ID_BTN, BTN_1_PORT, BTN_1_PIN, BTN_1_PRESSED,
+	 EV_SYS_XX_BTN_IDLE,  EV_SYS_XX_BTN_ACTIVE},
+#if 1 == DOOR_1_CONNECTED
+	{ID_DOOR, DOOR_1_PORT, DOOR_1_PIN, DOOR_1_CLOSED,
+	 EV_SYS_XX_DOOR_OPENED,  EV_SYS_XX_DOOR_CLOSED}
+#endif
 };
 
 #define SENSOR_CFG_QTY	(sizeof(task_sensor_cfg_list)/sizeof(task_sensor_cfg_t))
 
 task_sensor_dta_t task_sensor_dta_list[] = {
-	{DEL_BTN_XX_MIN, ST_BTN_XX_UP, EV_BTN_XX_UP}
+	{EV_BTN_XX_UP},
+#if 1 == DOOR_1_CONNECTED
+	{EV_BTN_XX_UP}
+#endif
 };
 
 #define SENSOR_DTA_QTY	(sizeof(task_sensor_dta_list)/sizeof(task_sensor_dta_t))
 
+task_sensor_port_t task_sensor_port_list[SENSOR_PORT_MAX];
+uint32_t task_sensor_port_qty;
+uint32_t task_sensor_sample_tick;
+
 /********************** internal functions declaration ***********************/
 
 /********************** internal data definition *****************************/
@@ -87,9 +100,8 @@ volatile uint32_t g_task_sensor_tick_cnt;
 void task_sensor_init(void *parameters)
 {
 	uint32_t index;
-	task_sensor_dta_t *p_task_sensor_dta;
-	task_sensor_st_t state;
-	task_sensor_ev_t event;
+	uint32_t port;
+	const task_sensor_cfg_t *p_task_sensor_cfg;
 
 	/* Print out: Task Initialized */
 	LOGGER_LOG("  %s is running - %s\r\n", GET_NAME(task_sensor_init), p_task_sensor);
@@ -102,26 +114,70 @@ void task_sensor_init(void *parameters)
 
 	for (index = 0; SENSOR_DTA_QTY > index; index++)
 	{
-		/* Update Task Sensor Data Pointer */
-		p_task_sensor_dta = &task_sensor_dta_list[index];
-
 		/* Print out: Index & Task execution FSM */
 		LOGGER_LOG("   %s = %lu", GET_NAME(index), index);
+		LOGGER_LOG("   %s = %lu\r\n", GET_NAME(event), (uint32_t)task_sensor_dta_list[index].event);
+	}
+
+	/* Group the inputs by port: one IDR read per port and sample */
+	task_sensor_port_qty = 0;
+
+	for (index = 0; SENSOR_CFG_QTY > index; index++)
+	{
+		p_task_sensor_cfg = &task_sensor_cfg_list[index];
 
-		state = p_task_sensor_dta->state;
-		LOGGER_LOG("   %s = %lu", GET_NAME(state), (uint32_t)state);
+		for (port = 0; task_sensor_port_qty > port; port++)
+		{
+			if (task_sensor_port_list[port].gpio_port == p_task_sensor_cfg->gpio_port)
+			{
+				break;
+			}
+		}
 
-		event = p_task_sensor_dta->event;
-		LOGGER_LOG("   %s = %lu\r\n", GET_NAME(event), (uint32_t)event);
+		if (task_sensor_port_qty == port)
+		{
+			if (SENSOR_PORT_MAX == port)
+			{
+				LOGGER_LOG("   too many sensor ports, input %lu ignored\r\n", index);
+				continue;
+			}
+
+			task_sensor_port_list[port].gpio_port = p_task_sensor_cfg->gpio_port;
+			task_sensor_port_list[port].mask = 0;
+			task_sensor_port_list[port].invert = 0;
+			task_sensor_port_qty++;
+		}
+
+		task_sensor_port_list[port].mask |= p_task_sensor_cfg->pin;
+
+		if (GPIO_PIN_RESET == p_task_sensor_cfg->pressed)
+		{
+			task_sensor_port_list[port].invert |= p_task_sensor_cfg->pin;
+		}
 	}
+
+	/* All counters idle (3), all inputs released */
+	for (index = 0; task_sensor_port_qty > index; index++)
+	{
+		task_sensor_port_list[index].ct0 = 0xFFFF;
+		task_sensor_port_list[index].ct1 = 0xFFFF;
+		task_sensor_port_list[index].state = 0;
+	}
+
+	task_sensor_sample_tick = DEL_BTN_XX_SAMPLE;
+
 	g_task_sensor_tick_cnt = G_TASK_SEN_TICK_CNT_INI;
 }
 
 void task_sensor_update(void *parameters)
 {
 	uint32_t index;
+	uint32_t port;
 	const task_sensor_cfg_t *p_task_sensor_cfg;
 	task_sensor_dta_t *p_task_sensor_dta;
+	task_sensor_port_t *p_task_sensor_port;
+	uint16_t level;
+	uint16_t delta;
 	bool b_time_update_required = false;
 
 	/* Update Task Sensor Counter */
@@ -140,7 +196,7 @@ void task_sensor_update(void *parameters)
     {
 		/* Protect shared resource (g_task_sensor_tick_cnt) */
 		__asm("CPSID i");	/* disable interrupts*/
-		if (G_TASK_SEN_TICK_CNT_INI < g_task_sensor_tick_cnt)
+		if ((G_TASK_SEN_TICK_CNT_INI < g_task_sensor_tick_cnt) && (0 != budget_remaining_cycles()))
 		{
 			g_task_sensor_tick_cnt--;
 			b_time_update_required = true;
@@ -151,88 +207,54 @@ void task_sensor_update(void *parameters)
 		}
 		__asm("CPSIE i");	/* enable interrupts*/
 
-    	for (index = 0; SENSOR_DTA_QTY > index; index++)
+		task_sensor_sample_tick--;
+
+		if (task_sensor_sample_tick > 0)
 		{
-    		/* Update Task Sensor Configuration & Data Pointer */
-			p_task_sensor_cfg = &task_sensor_cfg_list[index];
-			p_task_sensor_dta = &task_sensor_dta_list[index];
+			continue;
+		}
+		task_sensor_sample_tick = DEL_BTN_XX_SAMPLE;
 
-			if (p_task_sensor_cfg->pressed == HAL_GPIO_ReadPin(p_task_sensor_cfg->gpio_port, p_task_sensor_cfg->pin))
-			{
-				p_task_sensor_dta->event =	EV_BTN_XX_DOWN;
-			}
-			else
+    	for (port = 0; task_sensor_port_qty > port; port++)
+		{
+			p_task_sensor_port = &task_sensor_port_list[port];
+
+			/* One IDR read, levels normalized to 1 = pressed */
+			level = (input_rec_port(port, p_task_sensor_port->gpio_port) ^ p_task_sensor_port->invert) & p_task_sensor_port->mask;
+
+			delta = level ^ p_task_sensor_port->state;
+			p_task_sensor_port->ct0 = ~(p_task_sensor_port->ct0 & delta);
+			p_task_sensor_port->ct1 = p_task_sensor_port->ct0 ^ (p_task_sensor_port->ct1 & delta);
+			delta &= p_task_sensor_port->ct0 & p_task_sensor_port->ct1;
+			p_task_sensor_port->state ^= delta;
+
+			if (0 == delta)
 			{
-				p_task_sensor_dta->event =	EV_BTN_XX_UP;
+				continue;
 			}
 
-			switch (p_task_sensor_dta->state)
+			/* Edges: only the inputs of this port that toggled */
+			for (index = 0; SENSOR_CFG_QTY > index; index++)
 			{
-				case ST_BTN_XX_UP:
-
-					if (EV_BTN_XX_DOWN == p_task_sensor_dta->event)
-					{
-						p_task_sensor_dta->state = ST_BTN_XX_FALLING;
-						p_task_sensor_dta->tick = p_task_sensor_cfg->tick_max;
-					}
-
-					break;
-
-				case ST_BTN_XX_FALLING:
-
-					if (p_task_sensor_dta->tick > 0)
-					{
-						p_task_sensor_dta->tick--;
-					}
-					else
-					{
-						if (EV_BTN_XX_DOWN == p_task_sensor_dta->event)
-						{
-							p_task_sensor_dta->state = ST_BTN_XX_DOWN;
-							put_event_task_system(p_task_sensor_cfg->signal_down);
-						}
-						else if (EV_BTN_XX_UP == p_task_sensor_dta->event)
-						{
-							p_task_sensor_dta->state = ST_BTN_XX_UP;
-						}
-					}
-
-					break;
-
-				case ST_BTN_XX_DOWN:
-
-					if (EV_BTN_XX_UP == p_task_sensor_dta->event)
-					{
-						p_task_sensor_dta->state = ST_BTN_XX_RISING;
-						p_task_sensor_dta->tick = p_task_sensor_cfg->tick_max;
-					}
-
-					break;
-
-				case ST_BTN_XX_RISING:
-
-					if (p_task_sensor_dta->tick > 0)
-					{
-						p_task_sensor_dta->tick--;
-					}
-					else
-					{
-						if (EV_BTN_XX_UP == p_task_sensor_dta->event)
-						{
-							p_task_sensor_dta->state = ST_BTN_XX_UP;
-							put_event_task_system(p_task_sensor_cfg->signal_up);
-						}
-						else if (EV_BTN_XX_DOWN == p_task_sensor_dta->event)
-						{
-							p_task_sensor_dta->state = ST_BTN_XX_DOWN;
-						}
-					}
-
-					break;
-
-				default:
-
-					break;
+				p_task_sensor_cfg = &task_sensor_cfg_list[index];
+				p_task_sensor_dta = &task_sensor_dta_list[index];
+
+				if ((p_task_sensor_cfg->gpio_port != p_task_sensor_port->gpio_port) ||
+					(0 == (delta & p_task_sensor_cfg->pin)))
+				{
+					continue;
+				}
+
+				if (p_task_sensor_port->state & p_task_sensor_cfg->pin)
+				{
+					p_task_sensor_dta->event = EV_BTN_XX_DOWN;
+					put_event_task_system(p_task_sensor_cfg->signal_down);
+				}
+				else
+				{
+					p_task_sensor_dta->event = EV_BTN_XX_UP;
+					put_event_task_system(p_task_sensor_cfg->signal_up);
+				}
 			}
 		}
     }
@@ -37,12 +37,18 @@
  */
 
 /********************** inclusions *******************************************/
+#include <string.h>
+
 /* Project includes. */
 #include "main.h"
 
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "budget.h"
+#include "trace.h"
+#include "bench.h"
+#include "latency.h"
 
 /* External module includes. */
 #include "i2c_lcd.h"
@@ -58,6 +64,23 @@
 #include "task_actuator_attribute.h"
 #include "task_actuator_interface.h"
 #include "memory_handler.h"
+#include "access_queue.h"
+#include "input_rec.h"
+#include "servo_profile.h"
+#include "timer_service.h"
+#include "init_seq.h"
+#include "i2c_bus.h"
+#include "fmt.h"
+#include "eeprom_emu.h"
+#include "settings.h"
+#include "pin_hash.h"
+#include "pin_db.h"
+#include "card_db.h"
+#include "cred_store.h"
+#include "lockout.h"
+#include "log_export.h"
+#include "console.h"
+#include "rs485_link.h"
 
 /********************** macros and definitions *******************************/
 #define G_TASK_SYS_CNT_INI			0ul
@@ -67,22 +90,25 @@
 #define DEL_SYS_XX_MED				50ul
 #define DEL_SYS_XX_MAX				500ul
 
-#define DEL_SYS_INIT				1500ul
+#define DEL_SYS_I2C_TIMEOUT			50ul	// Bring-up transfers, with the wait behind the other lanes
 #define DEL_ADC_READ				5000ul
 #define DEL_RFID_READ				400ul
 #define DEL_RESET_STATE				10000ul
-#define DEL_WRONG_PWD_WAIT			2000ul
+
+#define DEL_DOOR_WINDOW				5000u
+#define DEL_DOOR_HELD				30000u
+#define DEL_DOOR_RELOCK				1500u
+#define DEL_DOOR_STATS				3600000ul	// One hour
 
 #define ADC_INITIAL_CALIBRATION		1500
 
-#define MAX_STORED_ENTRIES			5
 
 #define MEMORY_CONNECTED			(1)
 #define MEMORY_ACCESS				(1)
 
 /********************** internal data declaration ****************************/
 task_system_dta_t task_system_dta = {
-    .tick = DEL_SYS_INIT,
+    .tick = DEL_SYS_XX_MIN,
 	.adc_tick = 0,
     .reset_tick = 0,
 	.rfid_tick = 0,
@@ -91,38 +117,79 @@ task_system_dta_t task_system_dta = {
     .event = EV_SYS_XX_BTN_IDLE,
     .flag = false,
     .system_parameters = {
-        .mem_status = {'\0'},
-        .password = {'\0'},
+        .mem_written = false,
         .system_status = true,
         .alarm_status = true,
         .ldr_mode = false,
         .ldr_adj = 5,
-		.saved_entries = 0
-    }
+		.saved_entries = 0,
+		.door_window = DEL_DOOR_WINDOW,
+		.door_held = DEL_DOOR_HELD,
+		.door_relock = DEL_DOOR_RELOCK
+    },
+	.door = DOOR_UNLOCKING,
+	.door_cycles = 0,
+	.door_cycles_hour = 0,
+	.door_cycles_cnt = 0,
+	.rtc_present = false
 };
 
 #define SYSTEM_DTA_QTY	(sizeof(task_system_dta)/sizeof(task_system_dta_t))
 
-// Utility variables.
-uint8_t wrong_tries = 0;
-
 // Password buffer.
 char pwd_buffer[6] = "xxxxx";
 uint8_t buffer_idx = 0;
 
 // Memory handler data.
 MEM_WriteType_t MEM_WriteType = MEM_NO_WRITE;
-char pwd_to_mem[6];
 
-// Allowed UIDs array.
-const char* allowed_uids[] = {
-	"90245C21"
+// Latency probe of the unlock in progress, LAT_QTY: none.
+static volatile latency_probe_t system_unlock_probe = LAT_QTY;
+
+// Bring-up lanes, run overlapped by init_seq.c.
+static int32_t system_init_lcd(uint32_t step);
+static int32_t system_init_rfid(uint32_t step);
+#if MEMORY_CONNECTED
+static int32_t system_init_mem(uint32_t step);
+#endif
+static int32_t system_init_rtc(uint32_t step);
+
+const init_seq_lane_t system_init_lanes[] = {
+	system_init_lcd,
+	system_init_rfid,
+#if MEMORY_CONNECTED
+	system_init_mem,
+#endif
+	cred_store_init_lane,			// Without the EEPROM: master password and the seed card
+	system_init_rtc
 };
 
-#define ALLOWED_UIDS_QTY (sizeof(allowed_uids)/sizeof(allowed_uids[0]))
+#define SYSTEM_INIT_LANES_QTY (sizeof(system_init_lanes)/sizeof(system_init_lanes[0]))
 
 
 /********************** internal functions declaration ***********************/
+static char system_keypad_read(void);
+static void system_door_unlock(task_system_dta_t *p_task_system_dta, latency_probe_t probe);
+static void system_door_relock(task_system_dta_t *p_task_system_dta);
+static void system_door_done(task_system_dta_t *p_task_system_dta);
+static void system_door_timeout(void);
+static void system_door_stats(void);
+static void system_lockout(task_system_dta_t *p_task_system_dta, lockout_type_t type, uint32_t id);
+static void system_lockout_done(void);
+static bool system_lockout_held(task_system_dta_t *p_task_system_dta);
+static void system_lockout_screen(uint32_t wait);
+static void system_lcd_shown(void);
+static void system_lock_moved(uint16_t target);
+static uint32_t system_card_id(const uint8_t UID[]);
+static void system_settings_load(task_system_dta_t *p_task_system_dta);
+static void system_menu_line(char status_str[], const char *p_label, bool on);
+static void system_adj_line(char status_str[], uint8_t ldr_adj);
+static uint16_t system_pin_check(task_system_dta_t *p_task_system_dta, const char buffer[], uint8_t length, uint8_t *p_role);
+static void system_card_who(char who[], const uint8_t UID[]);
+static void system_pin_who(char who[], uint16_t user);
+#if MEMORY_CONNECTED
+static void system_access_log(const char *p_who);
+#endif
 
 /********************** internal data definition *****************************/
 const char *p_task_system 		= "Task System (System Statechart)";
@@ -134,13 +201,365 @@ volatile uint32_t g_task_system_tick_cnt;
 
 I2C_LCD_HandleTypeDef lcd1;
 
+/********************** internal functions definition ************************/
+// Reads the keypad and stamps the input side of the keypad latency probes.
+static char system_keypad_read(void)
+{
+	char key = input_rec_keypad();
+
+	if (key != 0)
+	{
+		LATENCY_START(LAT_KEY_TO_LCD);
+		LATENCY_START(LAT_PWD_TO_UNLOCK);
+	}
+
+	return key;
+}
+
+// Enters ST_SYS_OPEN_DOOR. The window timer relocks the door even if no
+// button or contact event ever arrives. 'probe' ends when the lock is open.
+static void system_door_unlock(task_system_dta_t *p_task_system_dta, latency_probe_t probe)
+{
+	system_unlock_probe = probe;
+
+	p_task_system_dta->state = ST_SYS_OPEN_DOOR;
+	p_task_system_dta->door = DOOR_UNLOCKING;
+	p_task_system_dta->flag = false;
+
+	servo_profile_move(SERVO_PROFILE_POS_OPEN);
+	timer_service_start(TIMER_DOOR, p_task_system_dta->system_parameters.door_window, 0, system_door_timeout);
+
+	put_event_task_actuator(EV_ACT_XX_CHIRP, ID_BUZ);
+}
+
+static void system_door_relock(task_system_dta_t *p_task_system_dta)
+{
+	p_task_system_dta->door = DOOR_RELOCKING;
+
+	servo_profile_move(SERVO_PROFILE_POS_CLOSED);
+	timer_service_start(TIMER_DOOR, p_task_system_dta->system_parameters.door_relock, 0, system_door_timeout);
+
+	put_event_task_actuator(EV_ACT_XX_PULSE, ID_BUZ);
+}
+
+// End of a door cycle. ST_SYS_WAIT with no delay restores the idle screen.
+static void system_door_done(task_system_dta_t *p_task_system_dta)
+{
+	p_task_system_dta->door_cycles++;
+	p_task_system_dta->door_cycles_cnt++;
+
+	p_task_system_dta->state = ST_SYS_WAIT;
+	p_task_system_dta->tick = DEL_SYS_XX_MIN;
+}
+
+static void system_door_timeout(void)
+{
+	put_event_task_system(EV_SYS_XX_DOOR_TIMEOUT);
+}
+
+static void system_door_stats(void)
+{
+	task_system_dta.door_cycles_hour = task_system_dta.door_cycles_cnt;
+	task_system_dta.door_cycles_cnt = 0;
+
+	LOGGER_LOG("door cycles/h %u total %lu\r\n", task_system_dta.door_cycles_hour, task_system_dta.door_cycles);
+}
+
+// Failed attempt: ST_SYS_LOCKED until TIMER_LOCKOUT expires, input ignored.
+// Past the free failures the buzzer alarm starts and the wait is shown.
+static void system_lockout(task_system_dta_t *p_task_system_dta, lockout_type_t type, uint32_t id)
+{
+	uint32_t wait = lockout_fail(type, id);
+
+	p_task_system_dta->state = ST_SYS_LOCKED;
+
+	if (LOCKOUT_CONFIG_BASE_MS < wait)
+	{
+		system_lockout_screen(wait);
+		put_event_task_actuator(EV_ACT_XX_BLINK, ID_BUZ);
+	}
+}
+
+static void system_lockout_done(void)
+{
+	put_event_task_system(EV_SYS_XX_LOCKOUT_END);
+}
+
+// A lockout the console started while the keypad was waiting: ST_SYS_LOCKED
+// too, before a key or a card is taken.
+static bool system_lockout_held(task_system_dta_t *p_task_system_dta)
+{
+	uint32_t wait = lockout_remaining();
+
+	if (0 == wait)
+	{
+		return false;
+	}
+
+	buffer_reset(pwd_buffer, &buffer_idx);
+	lcd_clear(&lcd1);
+	system_lockout_screen(wait);
+	p_task_system_dta->state = ST_SYS_LOCKED;
+
+	return true;
+}
+
+// lcd_flush() callback, I2C interrupt: the keypad digit is on the display.
+static void system_lcd_shown(void)
+{
+	LATENCY_STOP(LAT_KEY_TO_LCD);
+}
+
+// servo_profile callback, DMA interrupt: the lock has reached the open
+// position, which ends the unlock latency of the PIN or card that opened it.
+static void system_lock_moved(uint16_t target)
+{
+	if ((SERVO_PROFILE_POS_OPEN == target) && (LAT_QTY > system_unlock_probe))
+	{
+		LATENCY_STOP(system_unlock_probe);
+		system_unlock_probe = LAT_QTY;
+	}
+}
+
+// "Espere 900 s" on the third line.
+static void system_lockout_screen(uint32_t wait)
+{
+	char line[21];
+	char *p = fmt_str(line, "Espere ");
+
+	p = fmt_dec(p, (wait + 999) / 1000, 1);
+	p = fmt_str(p, " s");
+	*p = '\0';
+
+	lcd_pos(&lcd1, 2, 0);
+	lcd_puts(&lcd1, line);
+}
+
+static uint32_t system_card_id(const uint8_t UID[])
+{
+	return ((uint32_t)UID[0] << 24) | ((uint32_t)UID[1] << 16) | ((uint32_t)UID[2] << 8) | UID[3];
+}
+
+// Settings kept in the internal flash (menu options, door timeouts). Ids never
+// written keep the defaults of task_system_dta.
+static void system_settings_load(task_system_dta_t *p_task_system_dta)
+{
+	system_parameters_t *p_parameters = &p_task_system_dta->system_parameters;
+	uint16_t value;
+
+	eeprom_emu_init();
+
+	if (eeprom_emu_read(EE_SYSTEM_STATUS, &value))
+	{
+		p_parameters->system_status = (0 != value);
+		p_parameters->alarm_status = p_parameters->system_status;
+	}
+	if (eeprom_emu_read(EE_LDR_MODE, &value))
+	{
+		p_parameters->ldr_mode = (0 != value);
+	}
+	if (eeprom_emu_read(EE_LDR_ADJ, &value) && (1 <= value) && (9 >= value))
+	{
+		p_parameters->ldr_adj = (uint8_t)value;
+	}
+	if (eeprom_emu_read(EE_DOOR_WINDOW, &value))
+	{
+		p_parameters->door_window = value;
+	}
+	if (eeprom_emu_read(EE_DOOR_HELD, &value))
+	{
+		p_parameters->door_held = value;
+	}
+	if (eeprom_emu_read(EE_DOOR_RELOCK, &value))
+	{
+		p_parameters->door_relock = value;
+	}
+}
+
+// "A-Sistema ON " / "B-Modo LDR OFF": same width either way, so a toggle
+// overwrites the previous text on the LCD.
+static void system_menu_line(char status_str[], const char *p_label, bool on)
+{
+	char *p = fmt_str(status_str, p_label);
+
+	p = fmt_str(p, on ? "ON " : "OFF");
+	*p = '\0';
+}
+
+// "C-Ajuste LDR <n> "
+static void system_adj_line(char status_str[], uint8_t ldr_adj)
+{
+	char *p = fmt_str(status_str, "C-Ajuste LDR ");
+
+	p = fmt_int(p, ldr_adj);
+	*p++ = ' ';
+	*p = '\0';
+}
+
+// Settings password (user PIN_DB_MASTER, admin) or a PIN of the database.
+// Both digests are checked on every attempt; the cost goes to pin_hash_stats.
+// Only the digits typed are hashed, not the 'x' that pad the buffer: a short
+// PIN is the same string pin_db_add() got from the console.
+static uint16_t system_pin_check(task_system_dta_t *p_task_system_dta, const char buffer[], uint8_t length, uint8_t *p_role)
+{
+	char pin[PIN_DB_PIN_MAX + 1] = {0};
+	uint32_t cycles = cycle_counter_get();
+	uint16_t user;
+
+	memcpy(pin, buffer, (PIN_DB_PIN_MAX < length) ? PIN_DB_PIN_MAX : length);
+	user = pin_db_find(pin, p_role);
+
+	if (pin_hash_verify(&p_task_system_dta->system_parameters.pwd, pin))
+	{
+		user = PIN_DB_MASTER;
+		*p_role = PIN_ROLE_ADMIN;
+	}
+
+	pin_hash_cost(cycle_counter_get() - cycles);
+	memset(pin, 0, sizeof(pin));
+
+	return user;
+}
+
+// Who opened, 8 chars: the card UID in hex, or "PIN-" and the user id.
+static void system_card_who(char who[], const uint8_t UID[])
+{
+	char *p = who;
+	uint8_t index;
+
+	for (index = 0; 4 > index; index++)
+	{
+		p = fmt_hex2(p, UID[index]);
+	}
+	*p = '\0';
+}
+
+static void system_pin_who(char who[], uint16_t user)
+{
+	char *p = fmt_str(who, "PIN-");
+
+	p = fmt_dec(p, user, 4);
+	*p = '\0';
+}
+
+#if MEMORY_CONNECTED
+// Stamps the access with the RTC time now; access_queue writes it later.
+static void system_access_log(const char *p_who)
+{
+	access_event_t event;
+	uint8_t dow;
+
+	input_rec_rtc_date(&event.day, &event.mth, &event.year, &dow);
+	input_rec_rtc_time(&event.hr, &event.min, &event.sec);
+	strncpy(event.who, p_who, sizeof(event.who) - 1);
+	event.who[sizeof(event.who) - 1] = '\0';
+
+	access_queue_put(&event);
+}
+#endif
+
+// LCD power-on sequence, one command per step (over 80 mS of waits in total).
+static int32_t system_init_lcd(uint32_t step)
+{
+	int delay = lcd_init_step(&lcd1, step);
+
+	/* The sequence ends with a cleared display, ready for the first screen */
+	return (delay >= 0) ? delay : INIT_SEQ_DONE;
+}
+
+static int32_t system_init_rfid(uint32_t step)
+{
+	if (0 == step)
+	{
+		MFRC522_Start();
+		return 1;
+	}
+
+	MFRC522_Config();
+	return INIT_SEQ_DONE;
+}
+
+#if MEMORY_CONNECTED
+// Step 0 loads the settings record (both A/B slots in one burst, CRC
+// checked). MEMORY_ACCESS builds log one record per step.
+static int32_t system_init_mem(uint32_t step)
+{
+	task_system_dta_t *p_task_system_dta = &task_system_dta;
+	HAL_StatusTypeDef status;
+
+	if (0 == step)
+	{
+		if (HAL_BUSY == (status = settings_load()))
+		{
+			return INIT_SEQ_AGAIN;
+		}
+
+		if (HAL_OK == status)
+		{
+			p_task_system_dta->system_parameters.mem_written = (0 != (settings.flags & SETTINGS_FLAG_WRITTEN));
+			p_task_system_dta->system_parameters.pwd = settings.pwd;
+			p_task_system_dta->system_parameters.saved_entries = settings.saved_entries;
+		}
+
+	#if MEMORY_ACCESS
+		LOGGER_LOG("Se inició el sistema en modo de acceso a la memoria.\n\n");
+		LOGGER_LOG("Estado: %s\n\n", (p_task_system_dta->system_parameters.mem_written ? "written" : "notinit"));
+		LOGGER_LOG("En total hay %d entradas guardadas.\n\n", p_task_system_dta->system_parameters.saved_entries);
+
+		return 0;
+	#else
+		return INIT_SEQ_DONE;
+	#endif
+	}
+
+	#if MEMORY_ACCESS
+	if (step <= p_task_system_dta->system_parameters.saved_entries)
+	{
+		static i2c_bus_req_t req;
+		char time_str[MEM_ACCESS_SIZE] = {0};
+		i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_HIGH, 0xA0, MEM_ACCESS_BASE + MEM_ACCESS_STRIDE*(step - 1), I2C_MEMADD_SIZE_16BIT,
+							   sizeof(time_str), (uint8_t*)time_str, NULL, NULL};
+
+		if (HAL_BUSY == i2c_bus_poll(I2C_BUS_2, &xfer, &req, DEL_SYS_I2C_TIMEOUT))
+		{
+			return INIT_SEQ_AGAIN;
+		}
+
+		time_str[sizeof(time_str) - 1] = '\0';
+		LOGGER_LOG("%s\n", time_str);
+
+		return 0;
+	}
+
+	LOGGER_LOG("\n");
+	#endif
+
+	return INIT_SEQ_DONE;
+}
+#endif
+
+// Probe only: a missing RTC must not stop the lock from coming up.
+static int32_t system_init_rtc(uint32_t step)
+{
+	static i2c_bus_req_t req;
+	uint8_t seconds;
+	i2c_bus_xfer_t xfer = {I2C_BUS_OP_MEM_READ, I2C_BUS_PRIO_HIGH, DS3231_ADDRESS, DS3231_SEC, I2C_MEMADD_SIZE_8BIT, 1, &seconds, NULL, NULL};
+	HAL_StatusTypeDef status;
+
+	if (HAL_BUSY == (status = i2c_bus_poll(I2C_BUS_2, &xfer, &req, DEL_SYS_I2C_TIMEOUT)))
+	{
+		return INIT_SEQ_AGAIN;
+	}
+
+	task_system_dta.rtc_present = (HAL_OK == status);
+
+	return INIT_SEQ_DONE;
+}
+
 /********************** external functions definition ************************/
 void task_system_init(void *parameters)
 {
 	task_system_dta_t 	*p_task_system_dta;
-	task_system_st_t	state;
-	task_system_ev_t	event;
-	bool b_event;
 
 	/* Print out: Task Initialized */
 	LOGGER_LOG("  %s is running - %s\r\n", GET_NAME(task_system_init), p_task_system);
@@ -157,56 +576,33 @@ void task_system_init(void *parameters)
 	p_task_system_dta = &task_system_dta;
 
 	/* Print out: Task execution FSM */
-	state = p_task_system_dta->state;
-	LOGGER_LOG("   %s = %lu", GET_NAME(state), (uint32_t)state);
-
-	event = p_task_system_dta->event;
-	LOGGER_LOG("   %s = %lu", GET_NAME(event), (uint32_t)event);
-
-	b_event = p_task_system_dta->flag;
-	LOGGER_LOG("   %s = %s\r\n", GET_NAME(b_event), (b_event ? "true" : "false"));
+	LOGGER_LOG("   %s = %lu", GET_NAME(state), (uint32_t)p_task_system_dta->state);
+	LOGGER_LOG("   %s = %lu", GET_NAME(event), (uint32_t)p_task_system_dta->event);
+	LOGGER_LOG("   %s = %s\r\n", GET_NAME(b_event), (p_task_system_dta->flag ? "true" : "false"));
 
 	/* Init LCD Screen */
 	lcd1.hi2c = &hi2c1;
 	lcd1.address = 0x4E;
-	lcd_init(&lcd1);
-	lcd_clear(&lcd1);
-	lcd_pos(&lcd1, 1, 5);
-	lcd_puts(&lcd1, "BIENVENIDO");
-	lcd_pos(&lcd1, 2, 1);
-	lcd_puts(&lcd1, "Iniciando sistema");
-
-	/* Init PWM */
-	HAL_TIM_PWM_Start(&htim1, TIM_CHANNEL_1);
-	__HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, 1000);
-
-	/* Init RFID module */
-	MFRC522_Init();
+	lcd1.p_shown = system_lcd_shown;
 
-	/* Read memory */
-	#if MEMORY_CONNECTED
-		HAL_I2C_Mem_Read(&hi2c2, 0xA0, 0x0000, I2C_MEMADD_SIZE_16BIT, (uint8_t*)p_task_system_dta->system_parameters.mem_status, 8, HAL_MAX_DELAY);
-		HAL_I2C_Mem_Read(&hi2c2, 0xA0, 0x0008, I2C_MEMADD_SIZE_16BIT, (uint8_t*)p_task_system_dta->system_parameters.password, 6, HAL_MAX_DELAY);
-		HAL_I2C_Mem_Read(&hi2c2, 0xA0, 0x000E, I2C_MEMADD_SIZE_16BIT, &p_task_system_dta->system_parameters.saved_entries, 1, HAL_MAX_DELAY);
+	/* Settings from the internal flash: no I2C at boot for them */
+	system_settings_load(p_task_system_dta);
 
-	#if MEMORY_ACCESS
-		LOGGER_LOG("Se inició el sistema en modo de acceso a la memoria.\n\n");
-		LOGGER_LOG("Estado: %s\nContraseña: %s\n\n", p_task_system_dta->system_parameters.mem_status, p_task_system_dta->system_parameters.password);
-		LOGGER_LOG("En total hay %d entradas guardadas.\n\n", p_task_system_dta->system_parameters.saved_entries);
+	/* Init PWM: lock servo, moved by DMA-fed motion profiles */
+	servo_profile_init(system_lock_moved);
 
-		char time_str[33];
+	/* Soft timers: door cycle and door throughput */
+	timer_service_init();
+	timer_service_start(TIMER_DOOR_STATS, DEL_DOOR_STATS, DEL_DOOR_STATS, system_door_stats);
 
-		for (uint8_t i = 0; i < p_task_system_dta->system_parameters.saved_entries; i++)
-		{
-			HAL_I2C_Mem_Read(&hi2c2, 0xA0, 0x000F + 64*i, I2C_MEMADD_SIZE_16BIT, (uint8_t*)time_str, sizeof(time_str), HAL_MAX_DELAY);
+	/* Wrong PIN / card back-off; its counters are in the internal flash too */
+	lockout_init(system_lockout_done);
 
-			LOGGER_LOG("%s\n", time_str);
-		}
+	/* RS-485 node: its address is in the flash too */
+	rs485_link_init();
 
-		LOGGER_LOG("\n");
-	#endif
-
-	#endif
+	/* LCD, RFID, memory and RTC bring-up run overlapped from ST_SYS_INIT */
+	init_seq_start(system_init_lanes, SYSTEM_INIT_LANES_QTY);
 
 	/* Turn off actuators */
 		put_event_task_actuator(EV_ACT_XX_OFF, ID_LED_1);
@@ -221,6 +617,7 @@ void task_system_init(void *parameters)
 void task_system_update(void *parameters)
 {
 	task_system_dta_t *p_task_system_dta;
+	task_system_st_t state;
 
 	bool b_time_update_required = false;
 
@@ -238,9 +635,10 @@ void task_system_update(void *parameters)
 
     while (b_time_update_required)
     {
-		/* Protect shared resource (g_task_system_tick) */
+		/* Protect shared resource (g_task_system_tick). Ticks behind are
+		 * replayed while the budget lasts, the rest on the next app tick */
 		__asm("CPSID i");	/* disable interrupts*/
-		if (G_TASK_SYS_TICK_CNT_INI < g_task_system_tick_cnt)
+		if ((G_TASK_SYS_TICK_CNT_INI < g_task_system_tick_cnt) && (0 != budget_remaining_cycles()))
 		{
 			g_task_system_tick_cnt--;
 			b_time_update_required = true;
@@ -254,6 +652,18 @@ void task_system_update(void *parameters)
     	/* Update Task System Data Pointer */
 		p_task_system_dta = &task_system_dta;
 
+		i2c_bus_update();
+		DS3231_Update();
+		timer_service_update();
+		servo_profile_update();
+		flush_memory();
+		access_queue_update();
+		eeprom_emu_update();
+		console_update();
+		log_export_update();
+		rs485_link_update();
+		cred_store_update();
+
 		if (true == any_event_task_system())
 		{
 			p_task_system_dta->flag = true;
@@ -265,10 +675,7 @@ void task_system_update(void *parameters)
 		{
 			p_task_system_dta->adc_tick = DEL_ADC_READ;
 
-			HAL_ADC_Start(&hadc1);
-			HAL_ADC_PollForConversion(&hadc1, 0);
-
-			uint16_t adc_val = HAL_ADC_GetValue(&hadc1);
+			uint16_t adc_val = input_rec_adc();
 
 			if (adc_val > (ADC_INITIAL_CALIBRATION + 200 * p_task_system_dta->system_parameters.ldr_adj))
 			{
@@ -309,22 +716,23 @@ void task_system_update(void *parameters)
 
 		uint8_t UID[8];
 		uint8_t TagType;
+		uint8_t card;
 
-		uint8_t day, mth, year, dow, hr, min, sec;
-		char time_str[33];
+		char who[9];
+		uint16_t user;
+		uint8_t role;
+
+		state = p_task_system_dta->state;
 
 		switch (p_task_system_dta->state)
 		{
 
 			case ST_SYS_INIT:
 
-				if (p_task_system_dta->tick > 0) {
-					p_task_system_dta->tick--;
-				}
-				else
+				if (true == init_seq_update())
 				{
 					#if MEMORY_CONNECTED
-						if (strcmp(p_task_system_dta->system_parameters.mem_status, "written") == 0)
+						if (p_task_system_dta->system_parameters.mem_written)
 						{
 							// Prepare LCD.
 							lcd_clear(&lcd1);
@@ -338,6 +746,14 @@ void task_system_update(void *parameters)
 							put_event_task_actuator(EV_ACT_XX_OFF, ID_LED_1);
 
 							p_task_system_dta->state = ST_SYS_AWAIT_PWD;
+
+							/* A lockout running before the reset goes on */
+							if (0 != lockout_remaining())
+							{
+								lcd_clear(&lcd1);
+								system_lockout_screen(lockout_remaining());
+								p_task_system_dta->state = ST_SYS_LOCKED;
+							}
 						}
 						else
 						{
@@ -364,7 +780,7 @@ void task_system_update(void *parameters)
 
 			case ST_SYS_REQ_PWD:
 
-				key = keypad_get_char();
+				key = system_keypad_read();
 
 				if (key != 0)
 				{
@@ -395,14 +811,13 @@ void task_system_update(void *parameters)
 							lcd_pos(&lcd1, 3, 0);
 							lcd_puts(&lcd1, "C-Opciones");
 
+							pin_hash_make(&p_task_system_dta->system_parameters.pwd, pwd_buffer);
+
 							#if MEMORY_CONNECTED
-								strcpy(pwd_to_mem, pwd_buffer);
 								MEM_WriteType = MEM_WRITE_PWD;
 								p_task_system_dta->mem_tick = 300;
 							#endif
 
-							memcpy(p_task_system_dta->system_parameters.password, pwd_buffer, 6);
-
 							buffer_reset(pwd_buffer, &buffer_idx);
 
 							put_event_task_actuator(EV_ACT_XX_ON, ID_LED_2);
@@ -433,7 +848,12 @@ void task_system_update(void *parameters)
 					break;
 				}
 
-				key = keypad_get_char();
+				if (system_lockout_held(p_task_system_dta))
+				{
+					break;
+				}
+
+				key = system_keypad_read();
 
 				if (key != 0)
 				{
@@ -467,11 +887,21 @@ void task_system_update(void *parameters)
 					}
 					else if ((key == 'D') && (buffer_idx > 0))
 					{
-						if (strcmp(p_task_system_dta->system_parameters.password, pwd_buffer) == 0)
+						user = system_pin_check(p_task_system_dta, pwd_buffer, buffer_idx, &role);
+
+						if (PIN_DB_NONE != user)
 						{
-							p_task_system_dta->state = ST_SYS_OPEN_DOOR;
-							__HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, 2000);
+							system_door_unlock(p_task_system_dta, LAT_PWD_TO_UNLOCK);
 							buffer_reset(pwd_buffer, &buffer_idx);
+							pin_db_used(user);
+
+							#if MEMORY_CONNECTED
+								if (PIN_DB_MASTER != user)
+								{
+									system_pin_who(who, user);
+									system_access_log(who);
+								}
+							#endif
 
 							// Prepare LCD.
 							lcd_clear(&lcd1);
@@ -480,8 +910,7 @@ void task_system_update(void *parameters)
 							lcd_pos(&lcd1, 2, 0);
 							lcd_puts(&lcd1, "Puerta abierta.");
 
-							wrong_tries = 0;
-							put_event_task_actuator(EV_ACT_XX_FAST_BLINK, ID_BUZ);
+							lockout_success(LOCKOUT_PIN, user);
 						}
 						else
 						{
@@ -490,34 +919,27 @@ void task_system_update(void *parameters)
 							lcd_puts(&lcd1, "  CLAVE INCORRECTA");
 							buffer_reset(pwd_buffer, &buffer_idx);
 
-							p_task_system_dta->tick = DEL_WRONG_PWD_WAIT;
-							p_task_system_dta->state = ST_SYS_WAIT;
-
-							if (wrong_tries < 2)
-							{
-								wrong_tries++;
-							}
-							else if (wrong_tries == 2)
-							{
-								wrong_tries++;
-								put_event_task_actuator(EV_ACT_XX_BLINK, ID_BUZ);
-							}
+							system_lockout(p_task_system_dta, LOCKOUT_PIN, LOCKOUT_ANY);
 						}
 					}
 				}
 
 				if (p_task_system_dta->rfid_tick == 0)
 				{
-					p_task_system_dta->rfid_tick = DEL_RFID_READ;
+					card = input_rec_rfid_card(&TagType);
+
+					/* The request is on the air: its answer is checked next tick */
+					p_task_system_dta->rfid_tick = (MFRC522_CARD_BUSY == card) ? 0 : DEL_RFID_READ;
 
-					if (MFRC522_IsCard(&TagType))
+					if (MFRC522_CARD_FOUND == card)
 					{
-						if (MFRC522_ReadCardSerial((uint8_t*)&UID))
+						if (input_rec_rfid_serial((uint8_t*)&UID))
 						{
-							if (verify_uid(allowed_uids, ALLOWED_UIDS_QTY, UID))
+							LATENCY_START(LAT_CARD_TO_UNLOCK);
+
+							if (CARD_DB_NONE != card_db_find(system_card_id(UID)))
 							{
-								p_task_system_dta->state = ST_SYS_OPEN_DOOR;
-								__HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, 2000);
+								system_door_unlock(p_task_system_dta, LAT_CARD_TO_UNLOCK);
 
 								// Prepare LCD.
 								lcd_clear(&lcd1);
@@ -528,23 +950,11 @@ void task_system_update(void *parameters)
 
 								buffer_reset(pwd_buffer, &buffer_idx);
 
-								wrong_tries = 0;
-								put_event_task_actuator(EV_ACT_XX_FAST_BLINK, ID_BUZ);
+								lockout_success(LOCKOUT_CARD, system_card_id(UID));
 
 								#if MEMORY_CONNECTED
-									if (p_task_system_dta->system_parameters.saved_entries >= MAX_STORED_ENTRIES)
-									{
-										p_task_system_dta->system_parameters.saved_entries = 0;
-									}
-
-									DS3231_Get_Date(&day, &mth, &year, &dow);
-									DS3231_Get_Time(&hr, &min, &sec);
-									snprintf(time_str, sizeof(time_str), "%02u/%02u/20%02u | %02u:%02u:%02u | %02X%02X%02X%02X", day, mth, year, hr, min, sec, UID[0], UID[1], UID[2], UID[3]);
-
-									p_task_system_dta->system_parameters.saved_entries++;
-
-									MEM_WriteType = MEM_WRITE_TIME;
-									p_task_system_dta->mem_tick = 200;
+									system_card_who(who, UID);
+									system_access_log(who);
 								#endif
 							}
 							else
@@ -554,18 +964,7 @@ void task_system_update(void *parameters)
 								lcd_puts(&lcd1, "TARJETA NO ACEPTADA");
 								buffer_reset(pwd_buffer, &buffer_idx);
 
-								p_task_system_dta->tick = DEL_WRONG_PWD_WAIT;
-								p_task_system_dta->state = ST_SYS_WAIT;
-
-								if (wrong_tries < 2)
-								{
-									wrong_tries++;
-								}
-								else if (wrong_tries == 2)
-								{
-									wrong_tries++;
-									put_event_task_actuator(EV_ACT_XX_BLINK, ID_BUZ);
-								}
+								system_lockout(p_task_system_dta, LOCKOUT_CARD, system_card_id(UID));
 							}
 
 						}
@@ -611,21 +1010,23 @@ void task_system_update(void *parameters)
 					break;
 				}
 
-				key = keypad_get_char();
+				if (system_lockout_held(p_task_system_dta))
+				{
+					break;
+				}
+
+				key = system_keypad_read();
 
 				if (key != 0)
 				{
 					if (key >= '0' && key <= '9')
 					{
-						p_task_system_dta->state = ST_SYS_OPEN_DOOR;
-						__HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, 2000);
+						system_door_unlock(p_task_system_dta, LAT_PWD_TO_UNLOCK);
 
 						// Prepare LCD.
 						lcd_clear(&lcd1);
 						lcd_pos(&lcd1, 2, 0);
 						lcd_puts(&lcd1, "Puerta abierta.");
-
-						put_event_task_actuator(EV_ACT_XX_FAST_BLINK, ID_BUZ);
 					}
 					else if (key == 'C')
 					{
@@ -645,16 +1046,20 @@ void task_system_update(void *parameters)
 
 				if (p_task_system_dta->rfid_tick == 0)
 				{
-					p_task_system_dta->rfid_tick = DEL_RFID_READ;
+					card = input_rec_rfid_card(&TagType);
+
+					/* The request is on the air: its answer is checked next tick */
+					p_task_system_dta->rfid_tick = (MFRC522_CARD_BUSY == card) ? 0 : DEL_RFID_READ;
 
-					if (MFRC522_IsCard(&TagType))
+					if (MFRC522_CARD_FOUND == card)
 					{
-						if (MFRC522_ReadCardSerial((uint8_t*)&UID))
+						if (input_rec_rfid_serial((uint8_t*)&UID))
 						{
-							if (verify_uid(allowed_uids, ALLOWED_UIDS_QTY, UID))
+							LATENCY_START(LAT_CARD_TO_UNLOCK);
+
+							if (CARD_DB_NONE != card_db_find(system_card_id(UID)))
 							{
-								p_task_system_dta->state = ST_SYS_OPEN_DOOR;
-								__HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, 2000);
+								system_door_unlock(p_task_system_dta, LAT_CARD_TO_UNLOCK);
 
 								// Prepare LCD.
 								lcd_clear(&lcd1);
@@ -665,23 +1070,11 @@ void task_system_update(void *parameters)
 
 								buffer_reset(pwd_buffer, &buffer_idx);
 
-								wrong_tries = 0;
-								put_event_task_actuator(EV_ACT_XX_FAST_BLINK, ID_BUZ);
+								lockout_success(LOCKOUT_CARD, system_card_id(UID));
 
 								#if MEMORY_CONNECTED
-									if (p_task_system_dta->system_parameters.saved_entries >= MAX_STORED_ENTRIES)
-									{
-										p_task_system_dta->system_parameters.saved_entries = 0;
-									}
-
-									DS3231_Get_Date(&day, &mth, &year, &dow);
-									DS3231_Get_Time(&hr, &min, &sec);
-									snprintf(time_str, sizeof(time_str), "%02u/%02u/20%02u | %02u:%02u:%02u | %02X%02X%02X%02X", day, mth, year, hr, min, sec, UID[0], UID[1], UID[2], UID[3]);
-
-									p_task_system_dta->system_parameters.saved_entries++;
-
-									MEM_WriteType = MEM_WRITE_TIME;
-									p_task_system_dta->mem_tick = 200;
+									system_card_who(who, UID);
+									system_access_log(who);
 								#endif
 							}
 						}
@@ -698,7 +1091,12 @@ void task_system_update(void *parameters)
 
 			case ST_SYS_OPT_PWD:
 
-				key = keypad_get_char();
+				if (system_lockout_held(p_task_system_dta))
+				{
+					break;
+				}
+
+				key = system_keypad_read();
 
 				if (key != 0)
 				{
@@ -749,7 +1147,9 @@ void task_system_update(void *parameters)
 					}
 					else if ((key == 'D') && (buffer_idx > 0))
 					{
-						if (strcmp(p_task_system_dta->system_parameters.password, pwd_buffer) == 0)
+						user = system_pin_check(p_task_system_dta, pwd_buffer, buffer_idx, &role);
+
+						if ((PIN_DB_NONE != user) && (PIN_ROLE_ADMIN == role))
 						{
 							p_task_system_dta->state = ST_SYS_OPT_MENU;
 							buffer_reset(pwd_buffer, &buffer_idx);
@@ -759,55 +1159,34 @@ void task_system_update(void *parameters)
 
 							lcd_pos(&lcd1, 0, 0);
 
-							snprintf(status_str, sizeof(status_str), "A-Sistema %s", (p_task_system_dta->system_parameters.system_status == true ? "ON " : "OFF"));
+							system_menu_line(status_str, "A-Sistema ", p_task_system_dta->system_parameters.system_status);
 							lcd_puts(&lcd1, status_str);
 
 							lcd_pos(&lcd1, 1, 0);
 
-							snprintf(status_str, sizeof(status_str), "B-Modo LDR %s", (p_task_system_dta->system_parameters.ldr_mode == true ? "ON " : "OFF"));
+							system_menu_line(status_str, "B-Modo LDR ", p_task_system_dta->system_parameters.ldr_mode);
 							lcd_puts(&lcd1, status_str);
 
 							lcd_pos(&lcd1, 2, 0);
 
-							snprintf(status_str, sizeof(status_str), "C-Ajuste LDR %d ", p_task_system_dta->system_parameters.ldr_adj);
+							system_adj_line(status_str, p_task_system_dta->system_parameters.ldr_adj);
 							lcd_puts(&lcd1, status_str);
 
 							lcd_pos(&lcd1, 3, 0);
 							lcd_puts(&lcd1, "D-Volver     *-Reset");
 
-							wrong_tries = 0;
+							lockout_success(LOCKOUT_OPT, user);
 							put_event_task_actuator(EV_ACT_XX_OFF, ID_BUZ);
 						}
-
-						#if MEMORY_CONNECTED
-
-						else if (strcmp("65535", pwd_buffer) == 0)
-						{
-							MEM_WriteType = MEM_CLEAR;
-							p_task_system_dta->mem_tick = 300;
-
-							buffer_reset(pwd_buffer, &buffer_idx);
-							lcd_pos(&lcd1, 1, 0);
-							buffer_to_lcd(&lcd1, pwd_buffer);
-						}
-
-						#endif
-
 						else
 						{
-							buffer_reset(pwd_buffer, &buffer_idx);
+							lcd_clear(&lcd1);
 							lcd_pos(&lcd1, 1, 0);
-							buffer_to_lcd(&lcd1, pwd_buffer);
+							lcd_puts(&lcd1, "  CLAVE INCORRECTA");
+							buffer_reset(pwd_buffer, &buffer_idx);
 
-							if (wrong_tries < 2)
-							{
-								wrong_tries++;
-							}
-							else if (wrong_tries == 2)
-							{
-								wrong_tries++;
-								put_event_task_actuator(EV_ACT_XX_BLINK, ID_BUZ);
-							}
+							/* A known PIN without the admin role counts for its user too */
+							system_lockout(p_task_system_dta, LOCKOUT_OPT, (PIN_DB_NONE != user) ? user : LOCKOUT_ANY);
 						}
 					}
 				}
@@ -850,7 +1229,7 @@ void task_system_update(void *parameters)
 
 			case ST_SYS_OPT_MENU:
 
-				key = keypad_get_char();
+				key = system_keypad_read();
 
 				if (key != 0)
 				{
@@ -859,10 +1238,11 @@ void task_system_update(void *parameters)
 					if (key == 'A')
 					{
 						p_task_system_dta->system_parameters.system_status = !p_task_system_dta->system_parameters.system_status;
+						eeprom_emu_write(EE_SYSTEM_STATUS, p_task_system_dta->system_parameters.system_status);
 
 						lcd_pos(&lcd1, 0, 0);
 
-						snprintf(status_str, sizeof(status_str), "A-Sistema %s", (p_task_system_dta->system_parameters.system_status == true ? "ON " : "OFF"));
+						system_menu_line(status_str, "A-Sistema ", p_task_system_dta->system_parameters.system_status);
 						lcd_puts(&lcd1, status_str);
 
 						if (p_task_system_dta->system_parameters.system_status == true)
@@ -883,10 +1263,11 @@ void task_system_update(void *parameters)
 					else if (key == 'B')
 					{
 						p_task_system_dta->system_parameters.ldr_mode = !p_task_system_dta->system_parameters.ldr_mode;
+						eeprom_emu_write(EE_LDR_MODE, p_task_system_dta->system_parameters.ldr_mode);
 
 						lcd_pos(&lcd1, 1, 0);
 
-						snprintf(status_str, sizeof(status_str), "B-Modo LDR %s", (p_task_system_dta->system_parameters.ldr_mode == true ? "ON " : "OFF"));
+						system_menu_line(status_str, "B-Modo LDR ", p_task_system_dta->system_parameters.ldr_mode);
 						lcd_puts(&lcd1, status_str);
 
 						if (p_task_system_dta->system_parameters.system_status == true && p_task_system_dta->system_parameters.ldr_mode == false)
@@ -900,10 +1281,11 @@ void task_system_update(void *parameters)
 					else if (key == 'C')
 					{
 						p_task_system_dta->system_parameters.ldr_adj = (p_task_system_dta->system_parameters.ldr_adj % 9) + 1;
+						eeprom_emu_write(EE_LDR_ADJ, p_task_system_dta->system_parameters.ldr_adj);
 
 						lcd_pos(&lcd1, 2, 0);
 
-						snprintf(status_str, sizeof(status_str), "C-Ajuste LDR %d ", p_task_system_dta->system_parameters.ldr_adj);
+						system_adj_line(status_str, p_task_system_dta->system_parameters.ldr_adj);
 						lcd_puts(&lcd1, status_str);
 					}
 					else if (key == 'D')
@@ -987,41 +1369,105 @@ void task_system_update(void *parameters)
 
 			case ST_SYS_OPEN_DOOR:
 
-				if ((true == p_task_system_dta->flag) && (EV_SYS_XX_BTN_ACTIVE == p_task_system_dta->event))
+				if (true == p_task_system_dta->flag)
 				{
-					__HAL_TIM_SET_COMPARE(&htim1, TIM_CHANNEL_1, 1000);
-					put_event_task_actuator(EV_ACT_XX_OFF, ID_BUZ);
+					p_task_system_dta->flag = false;
 
-					if (p_task_system_dta->system_parameters.alarm_status)
+					switch (p_task_system_dta->event)
 					{
-						p_task_system_dta->state = ST_SYS_AWAIT_PWD;
+						case EV_SYS_XX_BTN_ACTIVE:
 
-						// Prepare LCD.
-						lcd_clear(&lcd1);
-						lcd_pos(&lcd1, 0, 0);
-						lcd_puts(&lcd1, "Ingrese clave:");
-						lcd_pos(&lcd1, 2, 0);
-						lcd_puts(&lcd1, "A-Borrar D-Confirmar");
-						lcd_pos(&lcd1, 3, 0);
-						lcd_puts(&lcd1, "C-Opciones");
-					}
-					else
-					{
-						p_task_system_dta->state = ST_SYS_OFF_MODE;
+							if (DOOR_RELOCKING != p_task_system_dta->door)
+							{
+								system_door_relock(p_task_system_dta);
+							}
 
-						// Prepare LCD.
-						lcd_clear(&lcd1);
-						lcd_pos(&lcd1, 0, 0);
-						lcd_puts(&lcd1, "Presione cualquier");
-						lcd_pos(&lcd1, 1, 0);
-						lcd_puts(&lcd1, "numero para entrar.");
-						lcd_pos(&lcd1, 3, 0);
-						lcd_puts(&lcd1, "C-Opciones");
+							break;
+
+						case EV_SYS_XX_LOCK_OPENED:
+
+							if (DOOR_UNLOCKING == p_task_system_dta->door)
+							{
+								p_task_system_dta->door = DOOR_WINDOW;
+							}
+
+							break;
+
+						case EV_SYS_XX_DOOR_OPENED:
+
+							if ((DOOR_UNLOCKING == p_task_system_dta->door) || (DOOR_WINDOW == p_task_system_dta->door))
+							{
+								p_task_system_dta->door = DOOR_OPEN;
+								timer_service_start(TIMER_DOOR, p_task_system_dta->system_parameters.door_held, 0, system_door_timeout);
+							}
+
+							break;
+
+						case EV_SYS_XX_DOOR_CLOSED:
+
+							if ((DOOR_OPEN == p_task_system_dta->door) || (DOOR_HELD_OPEN == p_task_system_dta->door))
+							{
+								system_door_relock(p_task_system_dta);
+							}
+
+							break;
+
+						case EV_SYS_XX_DOOR_TIMEOUT:
+
+							if (DOOR_OPEN == p_task_system_dta->door)
+							{
+								/* Can't relock an open door: alarm until it is closed */
+								p_task_system_dta->door = DOOR_HELD_OPEN;
+								put_event_task_actuator(EV_ACT_XX_HELD_OPEN, ID_BUZ);
+
+								lcd_pos(&lcd1, 3, 0);
+								lcd_puts(&lcd1, "Cierre la puerta.");
+							}
+							else if (DOOR_RELOCKING == p_task_system_dta->door)
+							{
+								/* Guard: the servo never reported, the lock is commanded closed anyway */
+								system_door_done(p_task_system_dta);
+							}
+							else if (DOOR_HELD_OPEN != p_task_system_dta->door)
+							{
+								system_door_relock(p_task_system_dta);
+							}
+
+							break;
+
+						case EV_SYS_XX_LOCK_CLOSED:
+
+							if (DOOR_RELOCKING == p_task_system_dta->door)
+							{
+								timer_service_stop(TIMER_DOOR);
+								system_door_done(p_task_system_dta);
+							}
+
+							break;
+
+						default:
+
+							break;
 					}
 				}
 
 				break;
 
+			case ST_SYS_LOCKED:
+
+				/* Keys pressed during the lockout are dropped, cards are not read */
+				(void)system_keypad_read();
+
+				if ((true == p_task_system_dta->flag) && (EV_SYS_XX_LOCKOUT_END == p_task_system_dta->event))
+				{
+					p_task_system_dta->flag = false;
+
+					p_task_system_dta->state = ST_SYS_WAIT;
+					p_task_system_dta->tick = DEL_SYS_XX_MIN;
+				}
+
+				break;
+
 			case ST_SYS_WAIT:
 
 				if (p_task_system_dta->tick == 0)
@@ -1065,16 +1511,24 @@ void task_system_update(void *parameters)
 				break;
 		}
 
+		if (state != p_task_system_dta->state)
+		{
+			TRACE_STATE(state, p_task_system_dta->state);
+		}
+
 		// Handle memory.
 		if (p_task_system_dta->mem_tick > 0)
 		{
-			handle_memory(p_task_system_dta->mem_tick, MEM_WriteType, pwd_to_mem, p_task_system_dta->system_parameters.saved_entries, time_str);
+			handle_memory(p_task_system_dta->mem_tick, MEM_WriteType, &p_task_system_dta->system_parameters.pwd);
 			p_task_system_dta->mem_tick--;
 		}
 		else
 		{
 			MEM_WriteType = MEM_NO_WRITE;
 		}
+
+		// Send what changed on the LCD, as far as the budget goes.
+		lcd_flush(&lcd1);
 	}
 }
 
@@ -43,6 +43,7 @@
 /* Demo includes. */
 #include "logger.h"
 #include "dwt.h"
+#include "trace.h"
 
 /* Application & Tasks includes. */
 #include "board.h"
@@ -83,6 +84,8 @@ void init_queue_event_task_system(void)
 
 void put_event_task_system(task_system_ev_t event)
 {
+	TRACE_SYS_PUT(event);
+
 	queue_task_a.count++;
 	queue_task_a.queue[queue_task_a.head++] = event;
 
@@ -101,6 +104,8 @@ task_system_ev_t get_event_task_system(void)
 	if (MAX_EVENTS == queue_task_a.tail)
 		queue_task_a.tail = 0;
 
+	TRACE_SYS_GET(event);
+
 	return event;
 }
 
@@ -109,21 +114,4 @@ bool any_event_task_system(void)
   return (queue_task_a.head != queue_task_a.tail);
 }
 
-bool verify_uid(const char* uid_array[], uint8_t array_size, uint8_t uid_to_verify[])
-{
-	bool is_allowed = false;
-
-	char uid_str[9];
-	sprintf(uid_str, "%02X%02X%02X%02X", uid_to_verify[0], uid_to_verify[1], uid_to_verify[2], uid_to_verify[3]);
-
-	for (uint8_t i = 0; i < array_size; i++)
-	{
-        if (strcmp(uid_array[i], uid_str) == 0) {
-        	is_allowed = true;
-        }
-	}
-
-	return is_allowed;
-}
-
 /********************** end of file ******************************************/
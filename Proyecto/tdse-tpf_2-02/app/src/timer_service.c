@@ -0,0 +1,109 @@
+/*
+ *
+ * @file   : timer_service.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "timer_service.h"
+
+/********************** macros and definitions *******************************/
+/* Wrap-safe: true once now has reached deadline */
+#define TIMER_EXPIRED(now, deadline)	((int32_t)((now) - (deadline)) >= 0)
+
+/********************** internal data definition *****************************/
+static uint32_t timer_service_tick;
+static uint32_t timer_service_running;
+
+/********************** external data definition *****************************/
+timer_service_tmr_t timer_service_list[TIMER_QTY];
+
+/********************** external functions definition ************************/
+void timer_service_init(void)
+{
+	memset(timer_service_list, 0, sizeof(timer_service_list));
+
+	timer_service_tick = 0;
+	timer_service_running = 0;
+}
+
+// (Re)starts a timer: p_cb runs ms ticks from now, then every period_ms if not 0.
+void timer_service_start(timer_service_id_t id, uint32_t ms, uint32_t period_ms, timer_service_cb_t p_cb)
+{
+	timer_service_tmr_t *p_tmr = &timer_service_list[id];
+
+	if (false == p_tmr->active)
+	{
+		timer_service_running++;
+	}
+
+	p_tmr->deadline = timer_service_tick + ms;
+	p_tmr->period = period_ms;
+	p_tmr->p_cb = p_cb;
+	p_tmr->active = true;
+}
+
+void timer_service_stop(timer_service_id_t id)
+{
+	if (timer_service_list[id].active)
+	{
+		timer_service_list[id].active = false;
+		timer_service_running--;
+	}
+}
+
+bool timer_service_active(timer_service_id_t id)
+{
+	return timer_service_list[id].active;
+}
+
+uint32_t timer_service_now(void)
+{
+	return timer_service_tick;
+}
+
+// One call per tick, from the system task: callbacks run in task context and
+// may post events or restart their own timer.
+void timer_service_update(void)
+{
+	uint32_t id;
+	timer_service_tmr_t *p_tmr;
+
+	timer_service_tick++;
+
+	if (0 == timer_service_running)
+	{
+		return;
+	}
+
+	for (id = 0; TIMER_QTY > id; id++)
+	{
+		p_tmr = &timer_service_list[id];
+
+		if ((false == p_tmr->active) || !TIMER_EXPIRED(timer_service_tick, p_tmr->deadline))
+		{
+			continue;
+		}
+
+		if (0 != p_tmr->period)
+		{
+			p_tmr->deadline += p_tmr->period;
+		}
+		else
+		{
+			p_tmr->active = false;
+			timer_service_running--;
+		}
+
+		if (NULL != p_tmr->p_cb)
+		{
+			p_tmr->p_cb();
+		}
+	}
+}
+
+/********************** end of file ******************************************/
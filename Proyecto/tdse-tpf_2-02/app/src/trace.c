@@ -0,0 +1,49 @@
+/*
+ *
+ * @file   : trace.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include "main.h"
+#include "dwt.h"
+#include "trace.h"
+
+/********************** macros and definitions *******************************/
+#define TRACE_INDEX_MASK	(TRACE_CONFIG_RECORDS - 1)
+
+/********************** external data definition *****************************/
+trace_log_t trace_log;
+
+/********************** external functions definition ************************/
+void trace_init(void)
+{
+	trace_log.magic = TRACE_MAGIC;
+	trace_log.version = TRACE_VERSION;
+	trace_log.core_clock = SystemCoreClock;
+	trace_log.capacity = TRACE_CONFIG_RECORDS;
+	trace_log.head = 0;
+}
+
+// Appends a record to the ring. Safe to call from ISRs and from code that
+// already runs with interrupts disabled (the previous mask is restored).
+void trace_put(trace_ev_t type, uint8_t id, uint16_t arg)
+{
+	trace_record_t *p_record;
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	p_record = &trace_log.record[trace_log.head & TRACE_INDEX_MASK];
+	p_record->cycles = cycle_counter_get();
+	p_record->type = (uint8_t)type;
+	p_record->id = id;
+	p_record->arg = arg;
+	trace_log.head++;
+
+	__set_PRIMASK(primask);
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,259 @@
+/*
+ *
+ * @file   : uart_dma.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/********************** inclusions *******************************************/
+#include <string.h>
+
+#include "main.h"
+#include "uart_dma.h"
+
+/********************** macros and definitions *******************************/
+/* Register level: the HAL UART driver is not part of this project */
+typedef struct
+{
+	USART_TypeDef *			p_usart;
+	DMA_Channel_TypeDef *	p_tx_dma;
+	DMA_Channel_TypeDef *	p_rx_dma;
+	uint32_t				tx_flags;		// DMA1 IFCR bits of the TX channel
+	IRQn_Type				tx_irq;
+	IRQn_Type				usart_irq;
+	GPIO_TypeDef *			gpio_port;
+	uint16_t				tx_pin;
+	uint16_t				rx_pin;
+	GPIO_TypeDef *			de_port;		// RS-485 driver enable, NULL: none
+	uint16_t				de_pin;
+} uart_dma_cfg_t;
+
+typedef struct
+{
+	uint8_t				tx_buf[UART_DMA_CONFIG_TX_SIZE];
+	volatile uint16_t	tx_head;		// Written by the task
+	volatile uint16_t	tx_tail;		// Advanced by the TX DMA interrupt
+	volatile uint16_t	tx_run;			// Bytes the DMA is sending now
+	uint8_t				rx_buf[UART_DMA_CONFIG_RX_SIZE];
+	uint16_t			rx_tail;
+} uart_dma_port_t;
+
+/********************** internal data definition *****************************/
+static const uart_dma_cfg_t uart_dma_cfg[UART_DMA_QTY] = {
+	{USART2, DMA1_Channel7, DMA1_Channel6, DMA_IFCR_CGIF7, DMA1_Channel7_IRQn, USART2_IRQn, GPIOA, GPIO_PIN_2, GPIO_PIN_3, NULL, 0},
+	{USART3, DMA1_Channel2, DMA1_Channel3, DMA_IFCR_CGIF2, DMA1_Channel2_IRQn, USART3_IRQn, GPIOC, GPIO_PIN_10, GPIO_PIN_11, GPIOC, GPIO_PIN_12}
+};
+
+static uart_dma_port_t uart_dma_port[UART_DMA_QTY];
+
+/********************** external data definition *****************************/
+uart_dma_stats_t uart_dma_stats[UART_DMA_QTY];
+
+/********************** internal functions definition ************************/
+// Starts the DMA on the contiguous part of the ring. Task context calls it
+// with the TX interrupt masked.
+static void uart_dma_kick(uart_dma_id_t id)
+{
+	const uart_dma_cfg_t *p_cfg = &uart_dma_cfg[id];
+	uart_dma_port_t *p_port = &uart_dma_port[id];
+	uint16_t head = p_port->tx_head;
+	uint16_t tail = p_port->tx_tail;
+
+	if ((0 != p_port->tx_run) || (head == tail))
+	{
+		return;
+	}
+
+	p_port->tx_run = (head > tail) ? (head - tail) : (UART_DMA_CONFIG_TX_SIZE - tail);
+
+	if (NULL != p_cfg->de_port)
+	{
+		/* Driver on; TC cleared so it only sets after the last byte */
+		p_cfg->p_usart->CR1 &= ~USART_CR1_TCIE;
+		p_cfg->de_port->BSRR = p_cfg->de_pin;
+		p_cfg->p_usart->SR = (uint32_t)~USART_SR_TC;
+	}
+
+	p_cfg->p_tx_dma->CCR &= ~DMA_CCR_EN;
+	p_cfg->p_tx_dma->CMAR = (uint32_t)&p_port->tx_buf[tail];
+	p_cfg->p_tx_dma->CNDTR = p_port->tx_run;
+	p_cfg->p_tx_dma->CCR |= DMA_CCR_EN;
+}
+
+/********************** external functions definition ************************/
+void uart_dma_init(uart_dma_id_t id, uint32_t baud)
+{
+	const uart_dma_cfg_t *p_cfg = &uart_dma_cfg[id];
+	uart_dma_port_t *p_port = &uart_dma_port[id];
+	GPIO_InitTypeDef gpio = {0};
+
+	memset(p_port, 0, sizeof(uart_dma_port_t));
+	memset(&uart_dma_stats[id], 0, sizeof(uart_dma_stats_t));
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+	switch (id)
+	{
+		case UART_DMA_2:
+
+			__HAL_RCC_USART2_CLK_ENABLE();
+			__HAL_RCC_GPIOA_CLK_ENABLE();
+
+			break;
+
+		case UART_DMA_3:
+
+			__HAL_RCC_USART3_CLK_ENABLE();
+			__HAL_RCC_GPIOC_CLK_ENABLE();
+			__HAL_RCC_AFIO_CLK_ENABLE();
+			__HAL_AFIO_REMAP_USART3_PARTIAL();
+
+			break;
+
+		default:
+
+			break;
+	}
+
+	if (NULL != p_cfg->de_port)
+	{
+		/* Receiving until the first write */
+		HAL_GPIO_WritePin(p_cfg->de_port, p_cfg->de_pin, GPIO_PIN_RESET);
+		gpio.Pin = p_cfg->de_pin;
+		gpio.Mode = GPIO_MODE_OUTPUT_PP;
+		gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+		HAL_GPIO_Init(p_cfg->de_port, &gpio);
+	}
+
+	gpio.Pin = p_cfg->tx_pin;
+	gpio.Mode = GPIO_MODE_AF_PP;
+	gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+	HAL_GPIO_Init(p_cfg->gpio_port, &gpio);
+
+	gpio.Pin = p_cfg->rx_pin;
+	gpio.Mode = GPIO_MODE_INPUT;
+	gpio.Pull = GPIO_PULLUP;
+	HAL_GPIO_Init(p_cfg->gpio_port, &gpio);
+
+	p_cfg->p_usart->CR1 = 0;
+	p_cfg->p_usart->BRR = (HAL_RCC_GetPCLK1Freq() + (baud / 2)) / baud;
+	p_cfg->p_usart->CR3 = USART_CR3_DMAT | USART_CR3_DMAR;
+	p_cfg->p_usart->CR1 = USART_CR1_UE | USART_CR1_TE | USART_CR1_RE;
+
+	/* RX: circular, never stopped; uart_dma_read() follows CNDTR */
+	p_cfg->p_rx_dma->CCR = 0;
+	p_cfg->p_rx_dma->CPAR = (uint32_t)&p_cfg->p_usart->DR;
+	p_cfg->p_rx_dma->CMAR = (uint32_t)p_port->rx_buf;
+	p_cfg->p_rx_dma->CNDTR = UART_DMA_CONFIG_RX_SIZE;
+	p_cfg->p_rx_dma->CCR = DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_EN;
+
+	/* TX: one transfer per contiguous part of the ring, chained from the
+	 * transfer complete interrupt */
+	p_cfg->p_tx_dma->CCR = 0;
+	p_cfg->p_tx_dma->CPAR = (uint32_t)&p_cfg->p_usart->DR;
+	p_cfg->p_tx_dma->CCR = DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TCIE;
+
+	HAL_NVIC_SetPriority(p_cfg->tx_irq, UART_DMA_CONFIG_IRQ_PRIO, 0);
+	HAL_NVIC_EnableIRQ(p_cfg->tx_irq);
+
+	/* Same priority as the DMA one: the two never preempt each other */
+	if (NULL != p_cfg->de_port)
+	{
+		HAL_NVIC_SetPriority(p_cfg->usart_irq, UART_DMA_CONFIG_IRQ_PRIO, 0);
+		HAL_NVIC_EnableIRQ(p_cfg->usart_irq);
+	}
+}
+
+// All or nothing, so a frame is never cut: false if the ring has no room.
+bool uart_dma_write(uart_dma_id_t id, const uint8_t *p_data, uint16_t size)
+{
+	uart_dma_port_t *p_port = &uart_dma_port[id];
+	uint16_t head = p_port->tx_head;
+	uint16_t first;
+
+	if (uart_dma_free(id) < size)
+	{
+		uart_dma_stats[id].tx_full++;
+		return false;
+	}
+
+	first = ((UART_DMA_CONFIG_TX_SIZE - head) < size) ? (UART_DMA_CONFIG_TX_SIZE - head) : size;
+	memcpy(&p_port->tx_buf[head], p_data, first);
+	memcpy(p_port->tx_buf, &p_data[first], size - first);
+	p_port->tx_head = (head + size) % UART_DMA_CONFIG_TX_SIZE;
+	uart_dma_stats[id].tx_bytes += size;
+
+	HAL_NVIC_DisableIRQ(uart_dma_cfg[id].tx_irq);
+	uart_dma_kick(id);
+	HAL_NVIC_EnableIRQ(uart_dma_cfg[id].tx_irq);
+
+	return true;
+}
+
+uint16_t uart_dma_free(uart_dma_id_t id)
+{
+	uart_dma_port_t *p_port = &uart_dma_port[id];
+
+	return (UART_DMA_CONFIG_TX_SIZE - 1) -
+		   ((p_port->tx_head + UART_DMA_CONFIG_TX_SIZE - p_port->tx_tail) % UART_DMA_CONFIG_TX_SIZE);
+}
+
+// What the RX DMA wrote since the last call, up to size bytes.
+uint16_t uart_dma_read(uart_dma_id_t id, uint8_t *p_data, uint16_t size)
+{
+	const uart_dma_cfg_t *p_cfg = &uart_dma_cfg[id];
+	uart_dma_port_t *p_port = &uart_dma_port[id];
+	uint16_t head = (UART_DMA_CONFIG_RX_SIZE - p_cfg->p_rx_dma->CNDTR) % UART_DMA_CONFIG_RX_SIZE;
+	uint16_t qty = 0;
+
+	if (p_cfg->p_usart->SR & USART_SR_ORE)
+	{
+		/* Read of DR after SR clears it */
+		(void)p_cfg->p_usart->DR;
+		uart_dma_stats[id].rx_lost++;
+	}
+
+	while ((head != p_port->rx_tail) && (size > qty))
+	{
+		p_data[qty++] = p_port->rx_buf[p_port->rx_tail];
+		p_port->rx_tail = (p_port->rx_tail + 1) % UART_DMA_CONFIG_RX_SIZE;
+	}
+
+	uart_dma_stats[id].rx_bytes += qty;
+
+	return qty;
+}
+
+// DMA transfer complete (stm32f1xx_it.c): the sent part leaves the ring and
+// the next one starts right away.
+void uart_dma_tx_isr(uart_dma_id_t id)
+{
+	uart_dma_port_t *p_port = &uart_dma_port[id];
+
+	DMA1->IFCR = uart_dma_cfg[id].tx_flags;
+
+	p_port->tx_tail = (p_port->tx_tail + p_port->tx_run) % UART_DMA_CONFIG_TX_SIZE;
+	p_port->tx_run = 0;
+
+	uart_dma_kick(id);
+
+	/* Ring empty: the driver goes off once the last byte has left */
+	if ((0 == p_port->tx_run) && (NULL != uart_dma_cfg[id].de_port))
+	{
+		uart_dma_cfg[id].p_usart->CR1 |= USART_CR1_TCIE;
+	}
+}
+
+// USART transmission complete (stm32f1xx_it.c), RS-485 ports only: back to
+// receive, the bus is free for the next node.
+void uart_dma_usart_isr(uart_dma_id_t id)
+{
+	const uart_dma_cfg_t *p_cfg = &uart_dma_cfg[id];
+
+	if ((p_cfg->p_usart->CR1 & USART_CR1_TCIE) && (p_cfg->p_usart->SR & USART_SR_TC))
+	{
+		p_cfg->p_usart->CR1 &= ~USART_CR1_TCIE;
+		p_cfg->de_port->BSRR = (uint32_t)p_cfg->de_pin << 16;
+	}
+}
+
+/********************** end of file ******************************************/
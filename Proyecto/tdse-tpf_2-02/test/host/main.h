@@ -0,0 +1,61 @@
+/*
+ *
+ * @file   : main.h
+ * @date   : Oct 19, 2026
+ *
+ */
+
+#ifndef MAIN_H
+#define MAIN_H
+
+/* Host stand-in for Core/Inc/main.h: the types and pins the app modules under
+ * test use, without the HAL. The Cortex-M instructions become no-ops */
+
+/********************** inclusions *******************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/********************** macros ***********************************************/
+#define __asm(x)
+
+#define GPIO_PIN_RESET		(0)
+#define GPIO_PIN_SET		(1)
+
+#define GPIO_PIN_0			((uint16_t)0x0001)
+#define GPIO_PIN_2			((uint16_t)0x0004)
+
+#define I2C_MEMADD_SIZE_16BIT	(0x00000010u)
+
+#define BTN_Pin				GPIO_PIN_0
+#define BTN_GPIO_Port		(&host_gpioc)
+#define DOOR_Pin			GPIO_PIN_2
+#define DOOR_GPIO_Port		(&host_gpioc)
+
+/********************** typedef **********************************************/
+typedef struct
+{
+	volatile uint32_t	IDR;
+} GPIO_TypeDef;
+
+typedef int GPIO_PinState;
+
+typedef enum {
+	HAL_OK,
+	HAL_ERROR,
+	HAL_BUSY,
+	HAL_TIMEOUT
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+	uint32_t			ErrorCode;
+} I2C_HandleTypeDef;
+
+/********************** external data declaration ****************************/
+extern GPIO_TypeDef host_gpioc;
+
+#endif // MAIN_H
+
+/********************** end of file ******************************************/
@@ -0,0 +1,562 @@
+/*
+ *
+ * @file   : test_cred_store.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/* Host test of cred_store.c: the module is built as is, with pin_db, card_db,
+ * eeprom_emu, write_memory and the AT24 read as the stubs below. From the
+ * project directory:
+ *
+ *   $ gcc -std=gnu11 -Wall -Itest/host -Iapp/inc test/test_cred_store.c \
+ *         app/src/cred_store.c app/src/crc32.c -o test_cred_store
+ *   $ ./test_cred_store
+ *
+ * Exit status 1 if a check fails. The stub tables keep a RAM copy and an AT24
+ * copy of each record, and eeprom_emu a RAM cache and a flash copy, so
+ * test_reset() can drop what a reset loses and run the init lane again. */
+
+/********************** inclusions *******************************************/
+#include <stdio.h>
+
+#include "main.h"
+#include "i2c_bus.h"
+#include "init_seq.h"
+#include "eeprom_emu.h"
+#include "memory_handler.h"
+#include "pin_db.h"
+#include "card_db.h"
+#include "cred_store.h"
+
+/********************** macros and definitions *******************************/
+#define TEST_IDS			(32)		// Ids of each stub table
+#define TEST_AT24_SIZE		(0x1000u)
+#define TEST_UPDATES		(64)		// Ticks that finish any batch here
+#define TEST_KEY(id)		(0xC0DE0000ul + (id))
+
+#define TEST_CHECK(cond)	test_check((cond), #cond, __LINE__)
+
+/********************** typedef **********************************************/
+typedef struct
+{
+	bool		b_used;
+	bool		b_dirty;		// RAM copy not in the AT24 yet
+	uint32_t	key;
+	uint32_t	at24_key;
+	bool		b_at24_used;
+} test_rec_t;
+
+typedef struct
+{
+	const char *	p_name;
+	void			(*p_run)(void);
+} test_case_t;
+
+/********************** internal data definition *****************************/
+static test_rec_t test_pin[TEST_IDS];
+static test_rec_t test_card[TEST_IDS];
+
+static uint16_t test_ee[EE_QTY];
+static bool test_ee_set[EE_QTY];
+static uint16_t test_ee_flash[EE_QTY];
+static bool test_ee_flash_set[EE_QTY];
+
+static uint8_t test_at24[TEST_AT24_SIZE];
+
+static uint32_t test_checks;
+static uint32_t test_failed;
+
+/********************** external functions definition ************************/
+/* Stub tables: one dirty record goes to the AT24 per flush */
+static bool test_put(test_rec_t table[], uint16_t id, bool b_used, uint32_t key)
+{
+	if (TEST_IDS <= id)
+	{
+		return false;
+	}
+
+	table[id].b_used = b_used;
+	table[id].key = key;
+	table[id].b_dirty = true;
+
+	return true;
+}
+
+static bool test_flush(test_rec_t table[])
+{
+	uint32_t id;
+
+	for (id = 0; TEST_IDS > id; id++)
+	{
+		if (table[id].b_dirty)
+		{
+			table[id].b_dirty = false;
+			table[id].b_at24_used = table[id].b_used;
+			table[id].at24_key = table[id].key;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void test_load(test_rec_t table[])
+{
+	uint32_t id;
+
+	for (id = 0; TEST_IDS > id; id++)
+	{
+		table[id].b_used = table[id].b_at24_used;
+		table[id].key = table[id].at24_key;
+		table[id].b_dirty = false;
+	}
+}
+
+int32_t pin_db_init_lane(uint32_t step)
+{
+	(void)step;
+	test_load(test_pin);
+
+	return INIT_SEQ_DONE;
+}
+
+uint16_t pin_db_add(const char *p_pin, pin_role_t role, uint16_t uses)
+{
+	(void)p_pin;
+	(void)role;
+	(void)uses;
+
+	return PIN_DB_NONE;
+}
+
+bool pin_db_put(uint16_t user, pin_role_t role, uint16_t uses, uint32_t tag, const uint8_t digest[PIN_HASH_SIZE])
+{
+	(void)role;
+	(void)uses;
+	(void)digest;
+
+	return test_put(test_pin, user, true, tag);
+}
+
+bool pin_db_remove(uint16_t user)
+{
+	return (TEST_IDS > user) && test_pin[user].b_used && test_put(test_pin, user, false, 0);
+}
+
+bool pin_db_flush(void)
+{
+	return test_flush(test_pin);
+}
+
+bool pin_db_key(uint16_t user, uint32_t *p_tag, uint8_t digest[PIN_HASH_SIZE])
+{
+	(void)digest;
+	*p_tag = test_pin[user].key;
+
+	return true;
+}
+
+int32_t card_db_init_lane(uint32_t step)
+{
+	(void)step;
+	test_load(test_card);
+
+	return INIT_SEQ_DONE;
+}
+
+uint16_t card_db_add(uint32_t uid)
+{
+	uint16_t card;
+
+	for (card = 1; TEST_IDS > card; card++)
+	{
+		if (!test_card[card].b_used)
+		{
+			test_put(test_card, card, true, uid);
+			return card;
+		}
+	}
+
+	return CARD_DB_NONE;
+}
+
+bool card_db_put(uint16_t card, uint32_t uid)
+{
+	return test_put(test_card, card, true, uid);
+}
+
+bool card_db_remove(uint16_t card)
+{
+	return (TEST_IDS > card) && test_card[card].b_used && test_put(test_card, card, false, 0);
+}
+
+bool card_db_flush(void)
+{
+	return test_flush(test_card);
+}
+
+/* eeprom_emu: writes reach the flash on a commit only */
+bool eeprom_emu_read(eeprom_emu_id_t id, uint16_t *p_value)
+{
+	if (test_ee_set[id])
+	{
+		*p_value = test_ee[id];
+	}
+
+	return test_ee_set[id];
+}
+
+void eeprom_emu_write(eeprom_emu_id_t id, uint16_t value)
+{
+	test_ee[id] = value;
+	test_ee_set[id] = true;
+}
+
+void eeprom_emu_commit(void)
+{
+	memcpy(test_ee_flash, test_ee, sizeof(test_ee));
+	memcpy(test_ee_flash_set, test_ee_set, sizeof(test_ee_set));
+}
+
+/* AT24: writes land at once, so the queue is always empty */
+bool write_memory(uint16_t mem_addr, const uint8_t *p_data, uint16_t size)
+{
+	memcpy(&test_at24[mem_addr], p_data, size);
+
+	return true;
+}
+
+uint8_t pending_memory(void)
+{
+	return 0;
+}
+
+// Like the bus: the first call queues the read, the next one returns it.
+HAL_StatusTypeDef i2c_bus_poll(i2c_bus_id_t bus, const i2c_bus_xfer_t *p_xfer, i2c_bus_req_t *p_req, uint32_t timeout_ms)
+{
+	(void)bus;
+	(void)timeout_ms;
+
+	if (I2C_BUS_OP_MEM_READ != p_xfer->op)
+	{
+		return HAL_ERROR;
+	}
+
+	if (!p_req->b_started)
+	{
+		p_req->b_started = true;
+		return HAL_BUSY;
+	}
+
+	p_req->b_started = false;
+	memcpy(p_xfer->p_data, &test_at24[p_xfer->mem_addr], p_xfer->size);
+
+	return HAL_OK;
+}
+
+/********************** internal functions definition ************************/
+static void test_check(bool b_pass, const char *p_what, int line)
+{
+	test_checks++;
+	if (!b_pass)
+	{
+		test_failed++;
+		printf("FAIL line %d: %s\n", line, p_what);
+	}
+}
+
+// RAM is lost, the AT24 and the flash stay; then the init lane runs again.
+static void test_reset(void)
+{
+	uint32_t step = 0;
+	int32_t wait;
+
+	memcpy(test_ee, test_ee_flash, sizeof(test_ee));
+	memcpy(test_ee_set, test_ee_flash_set, sizeof(test_ee_set));
+
+	while (INIT_SEQ_DONE != (wait = cred_store_init_lane(step)))
+	{
+		step += (INIT_SEQ_AGAIN == wait) ? 0 : 1;
+	}
+}
+
+// Blank AT24, flash and tables.
+static void test_factory(void)
+{
+	memset(test_pin, 0, sizeof(test_pin));
+	memset(test_card, 0, sizeof(test_card));
+	memset(test_ee_flash, 0, sizeof(test_ee_flash));
+	memset(test_ee_flash_set, 0, sizeof(test_ee_flash_set));
+	memset(test_at24, 0xFF, sizeof(test_at24));
+
+	test_reset();
+}
+
+static void test_update(uint32_t ticks)
+{
+	while (0 != ticks--)
+	{
+		cred_store_update();
+	}
+}
+
+static cred_change_t test_card_put(uint16_t card)
+{
+	cred_change_t change = {CRED_OP_CARD_PUT, 0, card, 0, TEST_KEY(card), {0}};
+
+	return change;
+}
+
+// Stages the card puts of ids first.. as the whole batch base -> target.
+static void test_batch(uint16_t base, uint16_t target, uint8_t count, uint16_t first)
+{
+	cred_change_t change;
+	uint8_t index;
+
+	for (index = 0; count > index; index++)
+	{
+		change = test_card_put(first + index);
+		TEST_CHECK(CRED_STORE_STAGED == cred_store_stage(base, target, index, count, &change));
+	}
+}
+
+static bool test_card_in(uint16_t card, bool b_at24)
+{
+	return b_at24 ? (test_card[card].b_at24_used && (TEST_KEY(card) == test_card[card].at24_key))
+				  : (test_card[card].b_used && (TEST_KEY(card) == test_card[card].key));
+}
+
+/* Changes come in any order; the batch goes in with the last of them */
+static void test_stage_order(void)
+{
+	cred_change_t change;
+
+	test_factory();
+
+	change = test_card_put(12);
+	TEST_CHECK(CRED_STORE_STAGED == cred_store_stage(0, 1, 2, 3, &change));
+	change = test_card_put(10);
+	TEST_CHECK(CRED_STORE_STAGED == cred_store_stage(0, 1, 0, 3, &change));
+	TEST_CHECK(0x05 == cred_store_staged());
+
+	test_update(TEST_UPDATES);
+	TEST_CHECK(0 == cred_store_vv.head);
+	TEST_CHECK(!test_card_in(10, false));
+
+	change = test_card_put(11);
+	TEST_CHECK(CRED_STORE_STAGED == cred_store_stage(0, 1, 1, 3, &change));
+	TEST_CHECK(0x07 == cred_store_staged());
+
+	test_update(TEST_UPDATES);
+	TEST_CHECK(1 == cred_store_vv.head);
+	TEST_CHECK(1 == test_ee_flash[EE_CRED_GEN]);
+	TEST_CHECK(test_card_in(10, true) && test_card_in(11, true) && test_card_in(12, true));
+	TEST_CHECK((1 == cred_store_stats.batches) && (3 == cred_store_stats.changes));
+}
+
+/* BAD, BUSY, STALE, DONE and the resend of a batch being written */
+static void test_stage_results(void)
+{
+	cred_change_t change = test_card_put(5);
+	cred_change_t bad_op = change;
+
+	bad_op.op = CRED_OP_QTY;
+
+	test_factory();
+
+	TEST_CHECK(CRED_STORE_BAD == cred_store_stage(0, 1, 0, 0, &change));
+	TEST_CHECK(CRED_STORE_BAD == cred_store_stage(0, 1, 0, CRED_STORE_CONFIG_BATCH + 1, &change));
+	TEST_CHECK(CRED_STORE_BAD == cred_store_stage(0, 1, 2, 2, &change));
+	TEST_CHECK(CRED_STORE_BAD == cred_store_stage(1, 1, 0, 1, &change));
+	TEST_CHECK(CRED_STORE_BAD == cred_store_stage(0, 1, 0, 1, &bad_op));
+
+	/* Loading: the journal may still replay */
+	cred_store_init_lane(0);
+	TEST_CHECK(CRED_STORE_BUSY == cred_store_stage(0, 1, 0, 1, &change));
+	test_reset();
+
+	TEST_CHECK(CRED_STORE_STALE == cred_store_stage(4, 5, 0, 1, &change));
+
+	/* IDLE -> JOURNAL: another batch waits, a resend of this one is taken */
+	TEST_CHECK(CRED_STORE_STAGED == cred_store_stage(0, 1, 0, 1, &change));
+	test_update(1);
+	TEST_CHECK(CRED_STORE_BUSY == cred_store_stage(0, 2, 0, 1, &change));
+	TEST_CHECK(CRED_STORE_STAGED == cred_store_stage(0, 1, 0, 1, &change));
+	TEST_CHECK(2 == cred_store_stats.stale);
+
+	test_update(TEST_UPDATES);
+	TEST_CHECK(1 == cred_store_vv.head);
+	TEST_CHECK(CRED_STORE_DONE == cred_store_stage(0, 1, 0, 1, &change));
+	TEST_CHECK(1 == cred_store_stats.batches);
+
+	/* A change of another batch starts the staging over */
+	test_batch(1, 2, 2, 20);
+	change = test_card_put(6);
+	TEST_CHECK(CRED_STORE_STAGED == cred_store_stage(1, 3, 0, 2, &change));
+	TEST_CHECK(0x01 == cred_store_staged());
+	change = test_card_put(7);
+	TEST_CHECK(CRED_STORE_STAGED == cred_store_stage(1, 3, 1, 2, &change));
+
+	test_update(TEST_UPDATES);
+	TEST_CHECK(3 == cred_store_vv.head);
+	TEST_CHECK(test_card_in(6, true) && test_card_in(7, true));
+	TEST_CHECK(!test_card_in(20, false) && !test_card_in(21, false));
+}
+
+/* Part of a batch never reaches the tables, nor does a batch cut short
+ * before the flash commit */
+static void test_all_or_nothing(void)
+{
+	cred_change_t change;
+
+	test_factory();
+
+	change = test_card_put(1);
+	cred_store_stage(0, 1, 0, 3, &change);
+	change = test_card_put(2);
+	cred_store_stage(0, 1, 1, 3, &change);
+
+	test_update(TEST_UPDATES);
+	TEST_CHECK(0 == cred_store_vv.head);
+	TEST_CHECK(!test_card_in(1, false) && !test_card_in(2, false));
+
+	test_reset();
+	TEST_CHECK(0 == cred_store_staged());
+	TEST_CHECK(!test_card_in(1, false) && !test_card_in(2, false));
+
+	/* Reset with two of three journal pages written */
+	test_batch(0, 1, 3, 1);
+	test_update(3);
+	TEST_CHECK(0 == test_ee_flash[EE_CRED_GEN]);
+
+	test_reset();
+	TEST_CHECK(0 == cred_store_vv.head);
+	TEST_CHECK(0 == cred_store_stats.replayed);
+	TEST_CHECK(!test_card_in(1, false) && !test_card_in(2, false) && !test_card_in(3, false));
+}
+
+/* Reset after the flash commit, before the tables are in the AT24: the
+ * journal finishes the batch, once */
+static void test_replay(void)
+{
+	cred_change_t change = {CRED_OP_CARD_DEL, 0, 8, 0, 0, {0}};
+	uint32_t ticks = 0;
+
+	test_factory();
+
+	test_batch(0, 1, 2, 8);
+	test_update(TEST_UPDATES);
+
+	/* Removes 8, puts 9 again and adds 14 */
+	TEST_CHECK(CRED_STORE_STAGED == cred_store_stage(1, 2, 0, 3, &change));
+	change = test_card_put(9);
+	TEST_CHECK(CRED_STORE_STAGED == cred_store_stage(1, 2, 1, 3, &change));
+	change = test_card_put(14);
+	TEST_CHECK(CRED_STORE_STAGED == cred_store_stage(1, 2, 2, 3, &change));
+
+	while ((2 != test_ee_flash[EE_CRED_GEN]) && (TEST_UPDATES > ticks++))
+	{
+		cred_store_update();
+	}
+	TEST_CHECK(2 == test_ee_flash[EE_CRED_GEN]);
+	TEST_CHECK(test_card_in(8, true) && !test_card_in(14, true));
+
+	test_reset();
+	TEST_CHECK(1 == cred_store_stats.replayed);
+	TEST_CHECK(2 == cred_store_vv.head);
+	TEST_CHECK(!test_card_in(8, false) && test_card_in(9, false) && test_card_in(14, false));
+
+	test_update(TEST_UPDATES);
+	TEST_CHECK(!test_card_in(8, true) && test_card_in(9, true) && test_card_in(14, true));
+
+	/* Closed: no second replay */
+	test_reset();
+	TEST_CHECK(0 == cred_store_stats.replayed);
+	TEST_CHECK(2 == cred_store_vv.head);
+	TEST_CHECK(test_card_in(9, false) && test_card_in(14, false));
+}
+
+/* Local versions wrap at 0xFFFF; only the last CRED_STORE_CONFIG_LOCAL are
+ * kept */
+static void test_since_wrap(void)
+{
+	cred_change_t changes[CRED_STORE_CONFIG_LOCAL];
+	uint16_t first;
+	uint16_t card;
+	uint32_t index;
+
+	test_factory();
+	eeprom_emu_write(EE_CRED_LOCAL, 0xFFFDu);
+	eeprom_emu_commit();
+	test_reset();
+
+	/* Versions 0xFFFE, 0xFFFF, 0x0000, 0x0001, 0x0002: cards 1 to 5 */
+	for (index = 0; 5 > index; index++)
+	{
+		TEST_CHECK(CARD_DB_NONE != cred_store_card_add(TEST_KEY(index + 1)));
+	}
+	TEST_CHECK(0x0002 == cred_store_vv.local);
+
+	TEST_CHECK(5 == cred_store_since(0xFFFDu, &first, changes, CRED_STORE_CONFIG_LOCAL));
+	TEST_CHECK(0xFFFEu == first);
+	for (index = 0; 5 > index; index++)
+	{
+		TEST_CHECK((CRED_OP_CARD_PUT == changes[index].op) && (index + 1 == changes[index].id));
+	}
+
+	TEST_CHECK(3 == cred_store_since(0xFFFFu, &first, changes, CRED_STORE_CONFIG_LOCAL));
+	TEST_CHECK((0x0000 == first) && (3 == changes[0].id));
+
+	TEST_CHECK(2 == cred_store_since(0xFFFDu, &first, changes, 2));
+	TEST_CHECK((0xFFFEu == first) && (2 == changes[1].id));
+
+	/* Older than kept: from the oldest one */
+	TEST_CHECK(5 == cred_store_since(0xFFF0u, &first, changes, CRED_STORE_CONFIG_LOCAL));
+	TEST_CHECK(0xFFFEu == first);
+
+	/* Up to date, and a head-end ahead of this door */
+	TEST_CHECK(0 == cred_store_since(0x0002, &first, changes, CRED_STORE_CONFIG_LOCAL));
+	TEST_CHECK(0x0003 == first);
+	TEST_CHECK(0 == cred_store_since(0x0010, &first, changes, CRED_STORE_CONFIG_LOCAL));
+
+	/* Six more: versions 0x0003 to 0x0008, the ring keeps 0x0001 on */
+	for (card = 6; 11 >= card; card++)
+	{
+		cred_store_card_add(TEST_KEY(card));
+	}
+	TEST_CHECK(CRED_STORE_CONFIG_LOCAL == cred_store_since(0xFFFDu, &first, changes, CRED_STORE_CONFIG_LOCAL));
+	TEST_CHECK((0x0001 == first) && (4 == changes[0].id) && (11 == changes[CRED_STORE_CONFIG_LOCAL - 1].id));
+}
+
+static const test_case_t test_cases[] = {
+	{"stage order",			test_stage_order},
+	{"stage results",		test_stage_results},
+	{"all or nothing",		test_all_or_nothing},
+	{"journal replay",		test_replay},
+	{"since wrap-around",	test_since_wrap},
+};
+
+#define TEST_CASE_QTY	(sizeof(test_cases) / sizeof(test_cases[0]))
+
+int main(void)
+{
+	uint32_t index;
+	uint32_t failed;
+	uint32_t cases_failed = 0;
+
+	for (index = 0; TEST_CASE_QTY > index; index++)
+	{
+		failed = test_failed;
+		test_cases[index].p_run();
+		printf("%-20s %s\n", test_cases[index].p_name, (failed == test_failed) ? "ok" : "FAIL");
+		cases_failed += (failed == test_failed) ? 0 : 1;
+	}
+
+	printf("%lu/%lu passed (%lu checks)\n", (unsigned long)(TEST_CASE_QTY - cases_failed),
+		   (unsigned long)TEST_CASE_QTY, (unsigned long)test_checks);
+
+	return (0 == cases_failed) ? 0 : 1;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,173 @@
+/*
+ *
+ * @file   : test_debounce.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/* Host test of the task_sensor.c debouncer (vertical counters): the module is
+ * built as is, its port read and system events go through the stubs below.
+ * From the project directory:
+ *
+ *   $ gcc -std=gnu11 -Wall -Itest/host -Iapp/inc \
+ *         test/test_debounce.c app/src/task_sensor.c -o test_debounce
+ *   $ ./test_debounce
+ *
+ * Exit status 1 if a case fails. The button samples every DEL_BTN_XX_SAMPLE
+ * (12) ticks, the first at tick 12, and takes a level after 4 equal samples
+ * in a row. */
+
+/********************** inclusions *******************************************/
+#include <stdio.h>
+
+#include "main.h"
+#include "task_sensor.h"
+#include "task_sensor_attribute.h"
+#include "task_system_attribute.h"
+#include "task_system_interface.h"
+#include "input_rec.h"
+#include "budget.h"
+
+/********************** macros and definitions *******************************/
+#define TEST_TICKS			(600u)
+#define TEST_EDGES_MAX		(12)
+#define TEST_EVENTS_MAX		(8)
+
+/********************** typedef **********************************************/
+/* Button contact, from released: it toggles at each edge tick. Two events
+ * (tick, pressed or released) are checked, 0: none expected */
+typedef struct
+{
+	const char *	p_name;
+	uint16_t		edge[TEST_EDGES_MAX];
+	uint16_t		down_tick;
+	uint16_t		up_tick;
+} test_case_t;
+
+/********************** internal data definition *****************************/
+static const test_case_t test_cases[] = {
+	/* 4 samples: 108, 120, 132, 144 */
+	{"clean press",				{100},						144, 0},
+	/* The edge on a sample counts as its first */
+	{"press on a sample",		{120},						156, 0},
+	/* 6 mS of chatter, all of it between two samples */
+	{"chatter then hold",		{100, 101, 103, 104, 106},	144, 0},
+	/* Released again at sample 132: the count starts over at 144 */
+	{"chatter on a sample",		{118, 130, 134},			180, 0},
+	/* 3 samples (120, 132, 144) pressed: not taken */
+	{"3-sample glitch",			{110, 146},					0, 0},
+	/* One released sample (204) while held, then a real release */
+	{"release glitch, release",	{100, 200, 210, 300},		144, 336},
+	/* Release bouncing back between samples: 300, 312, 324, 336 */
+	{"release bounce",			{100, 300, 302, 305},		144, 336},
+	/* Bounced back at sample 312: released from 324 to 360 */
+	{"release bounce on a sample",	{100, 300, 310, 314},	144, 360},
+};
+
+#define TEST_CASE_QTY	(sizeof(test_cases) / sizeof(test_cases[0]))
+
+static uint32_t test_tick;
+static uint32_t test_events;
+static task_system_ev_t test_event[TEST_EVENTS_MAX];
+static uint32_t test_event_tick[TEST_EVENTS_MAX];
+
+/********************** external data definition *****************************/
+GPIO_TypeDef host_gpioc;
+
+/********************** external functions definition ************************/
+uint16_t input_rec_port(uint8_t id, GPIO_TypeDef *port)
+{
+	(void)id;
+
+	return (uint16_t)port->IDR;
+}
+
+uint32_t budget_remaining_cycles(void)
+{
+	return BUDGET_UNLIMITED;
+}
+
+void put_event_task_system(task_system_ev_t event)
+{
+	if (TEST_EVENTS_MAX > test_events)
+	{
+		test_event[test_events] = event;
+		test_event_tick[test_events] = test_tick;
+	}
+	test_events++;
+}
+
+/********************** internal functions definition ************************/
+static bool test_pressed(const test_case_t *p_case, uint32_t tick)
+{
+	bool b_pressed = false;
+	uint32_t index;
+
+	for (index = 0; (TEST_EDGES_MAX > index) && (0 != p_case->edge[index]) && (p_case->edge[index] <= tick); index++)
+	{
+		b_pressed = !b_pressed;
+	}
+
+	return b_pressed;
+}
+
+static bool test_run(const test_case_t *p_case)
+{
+	uint32_t expected = (0 != p_case->down_tick) + (0 != p_case->up_tick);
+	bool b_pass;
+
+	test_events = 0;
+	host_gpioc.IDR = BTN_Pin;
+	task_sensor_init(NULL);
+
+	for (test_tick = 1; TEST_TICKS >= test_tick; test_tick++)
+	{
+		/* Pressed is low (BTN_1_PRESSED) */
+		host_gpioc.IDR = test_pressed(p_case, test_tick) ? 0 : BTN_Pin;
+
+		g_task_sensor_tick_cnt = 1;
+		task_sensor_update(NULL);
+	}
+
+	b_pass = (expected == test_events);
+	if (b_pass && (0 != p_case->down_tick))
+	{
+		b_pass = (EV_SYS_XX_BTN_ACTIVE == test_event[0]) && (p_case->down_tick == test_event_tick[0]);
+	}
+	if (b_pass && (0 != p_case->up_tick))
+	{
+		b_pass = (EV_SYS_XX_BTN_IDLE == test_event[1]) && (p_case->up_tick == test_event_tick[1]);
+	}
+
+	printf("%-26s %s", p_case->p_name, b_pass ? "ok" : "FAIL");
+	if (!b_pass)
+	{
+		printf(" (%lu events:", (unsigned long)test_events);
+		for (expected = 0; (test_events > expected) && (TEST_EVENTS_MAX > expected); expected++)
+		{
+			printf(" %s@%lu", (EV_SYS_XX_BTN_ACTIVE == test_event[expected]) ? "down" : "up",
+				   (unsigned long)test_event_tick[expected]);
+		}
+		printf(")");
+	}
+	printf("\n");
+
+	return b_pass;
+}
+
+int main(void)
+{
+	uint32_t index;
+	uint32_t failed = 0;
+
+	for (index = 0; TEST_CASE_QTY > index; index++)
+	{
+		failed += test_run(&test_cases[index]) ? 0 : 1;
+	}
+
+	printf("%lu/%lu passed\n", (unsigned long)(TEST_CASE_QTY - failed), (unsigned long)TEST_CASE_QTY);
+
+	return (0 == failed) ? 0 : 1;
+}
+
+/********************** end of file ******************************************/
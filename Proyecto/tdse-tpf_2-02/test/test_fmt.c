@@ -0,0 +1,192 @@
+/*
+ *
+ * @file   : test_fmt.c
+ * @date   : Oct 19, 2026
+ *
+ */
+
+/* Host test of fmt.c against the libc printf it replaces. From the project
+ * directory:
+ *
+ *   $ gcc -std=gnu11 -Wall -Iapp/inc test/test_fmt.c app/src/fmt.c -o test_fmt
+ *   $ ./test_fmt
+ *
+ * Exit status 1 if a case fails. Each call writes into a buffer filled with
+ * a guard byte: the text up to the returned end must match snprintf and the
+ * byte after it must still be the guard (fmt writes no NUL). */
+
+/********************** inclusions *******************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "fmt.h"
+
+/********************** macros and definitions *******************************/
+#define TEST_BUF_SIZE		(32)
+#define TEST_GUARD			('#')
+#define TEST_WIDTH_MAX		(12)	// Past the 10 digits of a uint32_t
+
+/********************** internal data definition *****************************/
+static const uint32_t test_dec[] = {
+	0, 1, 7, 9, 10, 42, 99, 100, 999, 1000, 12345, 65535, 65536,
+	99999, 100000, 999999999, 1000000000, 2147483647, 2147483648ul, 4294967295ul,
+};
+
+static const int32_t test_int[] = {
+	0, 1, -1, 9, -9, 10, -10, 32767, -32768, 2147483647, -2147483647, INT32_MIN,
+};
+
+static const char * const test_str[] = {
+	"", "A", "PIN", "users add", "0123456789ABCDEF0123456789",
+};
+
+#define TEST_QTY(a)		(sizeof(a) / sizeof((a)[0]))
+
+static char test_buf[TEST_BUF_SIZE];
+static uint32_t test_cases;
+static uint32_t test_failed;
+
+/********************** internal functions definition ************************/
+static char *test_begin(void)
+{
+	memset(test_buf, TEST_GUARD, sizeof(test_buf));
+
+	return test_buf;
+}
+
+static void test_check(const char *p_what, const char *p_end, const char *p_expected)
+{
+	size_t length = (size_t)(p_end - test_buf);
+	bool b_pass;
+
+	b_pass = (strlen(p_expected) == length)
+			 && (0 == memcmp(test_buf, p_expected, length))
+			 && (TEST_GUARD == test_buf[length]);
+
+	test_cases++;
+	if (!b_pass)
+	{
+		test_failed++;
+		printf("FAIL %s: \"%.*s\", expected \"%s\"\n", p_what,
+			   (int)((TEST_BUF_SIZE > length) ? length : TEST_BUF_SIZE), test_buf, p_expected);
+	}
+}
+
+static void test_fmt_dec(void)
+{
+	char expected[TEST_BUF_SIZE];
+	char what[TEST_BUF_SIZE];
+	uint32_t index;
+	uint8_t width;
+
+	// Width 0 and 1 (no padding), zero padding, and values wider than width
+	for (index = 0; TEST_QTY(test_dec) > index; index++)
+	{
+		for (width = 0; TEST_WIDTH_MAX >= width; width++)
+		{
+			snprintf(expected, sizeof(expected), "%0*lu", width, (unsigned long)test_dec[index]);
+			snprintf(what, sizeof(what), "fmt_dec(%lu, %u)", (unsigned long)test_dec[index], width);
+			test_check(what, fmt_dec(test_begin(), test_dec[index], width), expected);
+		}
+	}
+}
+
+static void test_fmt_int(void)
+{
+	char expected[TEST_BUF_SIZE];
+	char what[TEST_BUF_SIZE];
+	uint32_t index;
+
+	for (index = 0; TEST_QTY(test_int) > index; index++)
+	{
+		snprintf(expected, sizeof(expected), "%ld", (long)test_int[index]);
+		snprintf(what, sizeof(what), "fmt_int(%ld)", (long)test_int[index]);
+		test_check(what, fmt_int(test_begin(), test_int[index]), expected);
+	}
+}
+
+static void test_fmt_hex2(void)
+{
+	char expected[TEST_BUF_SIZE];
+	char what[TEST_BUF_SIZE];
+	uint32_t value;
+
+	for (value = 0; 0xFF >= value; value++)
+	{
+		snprintf(expected, sizeof(expected), "%02X", (unsigned)value);
+		snprintf(what, sizeof(what), "fmt_hex2(%lu)", (unsigned long)value);
+		test_check(what, fmt_hex2(test_begin(), (uint8_t)value), expected);
+	}
+}
+
+// Valid BCD only (both nibbles 0..9): its digits are the hex ones
+static void test_fmt_bcd2(void)
+{
+	char expected[TEST_BUF_SIZE];
+	char what[TEST_BUF_SIZE];
+	uint32_t value;
+
+	for (value = 0; 99 >= value; value++)
+	{
+		snprintf(expected, sizeof(expected), "%02lu", (unsigned long)value);
+		snprintf(what, sizeof(what), "fmt_bcd2(%lu)", (unsigned long)value);
+		test_check(what, fmt_bcd2(test_begin(), (uint8_t)(((value / 10) << 4) | (value % 10))), expected);
+	}
+}
+
+static void test_fmt_str(void)
+{
+	char expected[TEST_BUF_SIZE];
+	uint32_t index;
+
+	for (index = 0; TEST_QTY(test_str) > index; index++)
+	{
+		snprintf(expected, sizeof(expected), "%s", test_str[index]);
+		test_check("fmt_str", fmt_str(test_begin(), test_str[index]), expected);
+	}
+}
+
+// The chaining the callers use: "dd/mm hh:mm:ss <uid> <n>"
+static void test_fmt_chain(void)
+{
+	char expected[TEST_BUF_SIZE];
+	char *p = test_begin();
+
+	p = fmt_dec(p, 5, 2);
+	*p++ = '/';
+	p = fmt_dec(p, 10, 2);
+	*p++ = ' ';
+	p = fmt_bcd2(p, 0x09);
+	*p++ = ':';
+	p = fmt_bcd2(p, 0x30);
+	*p++ = ':';
+	p = fmt_bcd2(p, 0x07);
+	*p++ = ' ';
+	p = fmt_hex2(p, 0xDE);
+	p = fmt_hex2(p, 0x0A);
+	*p++ = ' ';
+	p = fmt_int(p, -123);
+
+	snprintf(expected, sizeof(expected), "%02u/%02u %02X:%02X:%02X %02X%02X %ld",
+			 5, 10, 0x09, 0x30, 0x07, 0xDE, 0x0A, -123l);
+	test_check("chain", p, expected);
+}
+
+/********************** external functions definition ************************/
+int main(void)
+{
+	test_fmt_dec();
+	test_fmt_int();
+	test_fmt_hex2();
+	test_fmt_bcd2();
+	test_fmt_str();
+	test_fmt_chain();
+
+	printf("%lu/%lu passed\n", (unsigned long)(test_cases - test_failed), (unsigned long)test_cases);
+
+	return (0 == test_failed) ? 0 : 1;
+}
+
+/********************** end of file ******************************************/
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+#
+# @file   : bench_compare.py
+# @date   : Oct 19, 2026
+#
+# Collects the benchmark windows printed by the console "bench" command
+# (app/src/bench.c, one JSON object per line) and compares them against a
+# stored baseline.
+#
+#   $ python3 tools/bench_compare.py console.log > bench.json
+#   $ python3 tools/bench_compare.py --save baseline.json console.log
+#   $ python3 tools/bench_compare.py --baseline baseline.json console.log
+#
+# With --baseline every metric is reported as {"now", "base", "delta_pct"} and
+# the exit status is 1 when any of them got worse by more than --tolerance
+# percent (default 10). Counts are normalised per 1000 ticks so windows of
+# different length compare fairly.
+#
+
+import json
+import sys
+
+PROBES = ["key_to_lcd", "pwd_to_unlock", "card_to_unlock"]
+
+
+def parse(lines):
+    # A "cyc" line opens a new window of its scenario; the following lines of
+    # the same scenario complete it.
+    windows = []
+    current = None
+    for line in lines:
+        start = line.find('{"s":')
+        if start < 0:
+            continue
+        try:
+            obj = json.loads(line[start:].strip())
+        except ValueError:
+            continue
+
+        scenario = obj.pop("s")
+        if "cyc" in obj:
+            current = {"scenario": scenario, "ticks": obj["n"],
+                       "cycles_avg": obj["cyc"][0], "cycles_max": obj["cyc"][1]}
+            windows.append(current)
+        elif current is None or current["scenario"] != scenario:
+            continue
+        elif "ovr" in obj:
+            current.update(overruns=obj["ovr"][0], overrun_max_us=obj["ovr"][1],
+                           backlog_max=obj["blog"])
+        elif "i2c" in obj:
+            bus = "i2c%d" % obj["i2c"]
+            current[bus + "_bytes"] = obj["b"]
+            current[bus + "_busy_us"] = obj["us"]
+        elif "l" in obj:
+            probe = PROBES[obj["l"]] if obj["l"] < len(PROBES) else str(obj["l"])
+            current[probe] = {"n": obj["n"], "p50": obj["p50"], "p99": obj["p99"]}
+
+    return windows
+
+
+def metrics(window):
+    # Flat, comparable view of one window. Lower is better for all of them.
+    per_k = 1000.0 / window["ticks"]
+    out = {
+        "cycles_avg": window["cycles_avg"],
+        "cycles_max": window["cycles_max"],
+        "overruns_per_k": window.get("overruns", 0) * per_k,
+        "overrun_max_us": window.get("overrun_max_us", 0),
+        "backlog_max": window.get("backlog_max", 0),
+    }
+    for key in ("i2c1_bytes", "i2c1_busy_us", "i2c2_bytes", "i2c2_busy_us"):
+        out[key + "_per_k"] = window.get(key, 0) * per_k
+    for probe in PROBES:
+        if probe in window and window[probe]["n"]:
+            out[probe + "_p50_us"] = window[probe]["p50"]
+            out[probe + "_p99_us"] = window[probe]["p99"]
+    return out
+
+
+def summarize(windows):
+    # Last complete window of each scenario.
+    summary = {}
+    for window in windows:
+        if window["ticks"]:
+            summary[window["scenario"]] = metrics(window)
+    return summary
+
+
+def compare(summary, baseline, tolerance):
+    report = {}
+    regressed = False
+    for scenario, now in summary.items():
+        base = baseline.get(scenario, {})
+        entry = {}
+        for key, value in now.items():
+            if key not in base:
+                entry[key] = {"now": value, "base": None, "delta_pct": None}
+                continue
+            if base[key]:
+                delta = 100.0 * (value - base[key]) / base[key]
+            else:
+                delta = 0.0 if not value else 100.0
+            entry[key] = {"now": value, "base": base[key], "delta_pct": round(delta, 1)}
+            regressed |= delta > tolerance
+        report[scenario] = entry
+    return report, regressed
+
+
+def main(argv):
+    args = argv[1:]
+    baseline = None
+    save = None
+    tolerance = 10.0
+    while args and args[0].startswith("--"):
+        opt = args.pop(0)
+        if opt == "--baseline" and args:
+            baseline = args.pop(0)
+        elif opt == "--save" and args:
+            save = args.pop(0)
+        elif opt == "--tolerance" and args:
+            tolerance = float(args.pop(0))
+        else:
+            args = []
+            break
+    if len(args) != 1:
+        sys.exit("usage: %s [--save out.json | --baseline base.json [--tolerance pct]] console.log"
+                 % argv[0])
+
+    with open(args[0], errors="replace") as f:
+        summary = summarize(parse(f))
+
+    if save:
+        with open(save, "w") as f:
+            json.dump(summary, f, indent=1, sort_keys=True)
+            f.write("\n")
+
+    status = 0
+    if baseline:
+        with open(baseline) as f:
+            report, regressed = compare(summary, json.load(f), tolerance)
+        status = 1 if regressed else 0
+    else:
+        report = summary
+
+    json.dump(report, sys.stdout, indent=1, sort_keys=True)
+    sys.stdout.write("\n")
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+#
+# @file   : console.py
+# @date   : Oct 19, 2026
+#
+# Runs commands on the admin console (app/src/console.c) and prints what they
+# answer, one command at a time: each waits for the "> " prompt. PORT is the
+# ST-LINK virtual COM port or any pseudo-terminal wired to it (socat, a
+# simulator). Needs pyserial:
+#
+#   $ python3 tools/console.py /dev/ttyACM0 stats "login 1234" "users"
+#
+# Without commands they are read from stdin, one per line; lines starting
+# with '#' are skipped. The exit status is 1 if a command times out:
+#
+#   $ python3 tools/console.py /dev/pts/3 < script.txt
+#
+
+import sys
+import time
+
+import serial
+
+BAUD = 460800
+PROMPT = b"> "
+TIMEOUT = 3.0
+BENCH_TIMEOUT = 60.0    # "bench <scenario>" answers when its window closes
+
+
+def run(link, command):
+    link.write(command.encode("ascii") + b"\r")
+    data = b""
+    start = time.time()
+    timeout = BENCH_TIMEOUT if command.startswith("bench ") else TIMEOUT
+    while not data.endswith(b"\r\n" + PROMPT):
+        chunk = link.read(256)
+        data += chunk
+        if not chunk and time.time() - start > timeout:
+            return None
+    lines = data[:-len(PROMPT)].decode("ascii", "replace").split("\r\n")
+    # First line is the echo of the command
+    return [line for line in lines[1:] if line]
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.exit("usage: %s PORT [command ...]" % argv[0])
+
+    link = serial.Serial(argv[1], BAUD, timeout=0.05)
+    # Ctrl-C stops whatever is running, CR gets a fresh prompt
+    link.write(b"\x03\r")
+    time.sleep(0.2)
+    link.reset_input_buffer()
+
+    commands = argv[2:] or [line.strip() for line in sys.stdin]
+    status = 0
+    for command in commands:
+        if not command or command.startswith("#"):
+            continue
+        lines = run(link, command)
+        print("> " + command)
+        if lines is None:
+            print("(timeout)")
+            status = 1
+            continue
+        for line in lines:
+            print(line)
+    sys.exit(status)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+#
+# @file   : log2csv.py
+# @date   : Oct 19, 2026
+#
+# Exports the access log of the lock over the ST-LINK virtual COM port
+# (app/src/log_export.c) and writes it as CSV. Needs pyserial:
+#
+#   $ python3 tools/log2csv.py /dev/ttyACM0 > access.csv
+#
+# With --file it decodes a raw capture of the device frames instead (no acks
+# are sent, so the capture must hold a complete export):
+#
+#   $ python3 tools/log2csv.py --file capture.bin > access.csv
+#
+
+import struct
+import sys
+import time
+import zlib
+
+BAUD = 460800
+ACK_TIMEOUT = 1.0
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_at = 0
+    code = 1
+    for byte in data:
+        if byte:
+            out.append(byte)
+            code += 1
+        if not byte or code == 0xFF:
+            out[code_at] = code
+            code_at = len(out)
+            out.append(0)
+            code = 1
+    out[code_at] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        pos += 1
+        if code == 0 or pos + code - 1 > len(data):
+            return None
+        out += data[pos:pos + code - 1]
+        pos += code - 1
+        if code != 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+# The leading 0x00 tells the console (app/src/console.c) a frame follows.
+def frame(kind, seq, payload=b""):
+    body = struct.pack("<BH", ord(kind), seq) + payload
+    return b"\x00" + cobs_encode(body + struct.pack("<I", zlib.crc32(body))) + b"\x00"
+
+
+def parse(raw):
+    data = cobs_decode(raw)
+    if data is None or len(data) < 7:
+        return None
+    body, crc = data[:-4], struct.unpack("<I", data[-4:])[0]
+    if zlib.crc32(body) != crc:
+        return None
+    kind, seq = struct.unpack("<BH", body[:3])
+    return chr(kind), seq, body[3:]
+
+
+def record(payload):
+    index, valid, day, mth, year, hr, mn, sec = struct.unpack("<HBBBBBBB", payload[:9])[:8]
+    who = payload[9:17].decode("ascii", "replace")
+    if not valid:
+        return None
+    return "%d,20%02d-%02d-%02d,%02d:%02d:%02d,%s" % (index, year, mth, day, hr, mn, sec, who)
+
+
+class Export:
+    def __init__(self):
+        self.expected = 0
+        self.rows = []
+        self.done = False
+
+    # In-order frames only (go-back-N): anything else is dropped and the
+    # device resends from the last ack.
+    def handle(self, parsed):
+        if parsed is None:
+            return
+        kind, seq, payload = parsed
+        if seq != self.expected:
+            return
+        self.expected += 1
+        if kind == "R":
+            row = record(payload)
+            if row:
+                self.rows.append(row)
+        elif kind == "E":
+            self.done = True
+
+
+def split(buffer):
+    frames = buffer.split(b"\x00")
+    return frames[:-1], frames[-1]
+
+
+def from_port(port):
+    import serial
+
+    export = Export()
+    link = serial.Serial(port, BAUD, timeout=0.05)
+    link.reset_input_buffer()
+    link.write(frame("L", 0))
+    pending = b""
+    last = time.time()
+    start = last
+    while not export.done:
+        data = link.read(4096)
+        if data:
+            frames, pending = split(pending + data)
+            for raw in frames:
+                export.handle(parse(raw))
+            link.write(frame("A", export.expected))
+            last = time.time()
+        elif time.time() - last > ACK_TIMEOUT:
+            if export.expected == 0:
+                link.write(frame("L", 0))
+            else:
+                link.write(frame("A", export.expected))
+            last = time.time()
+        if time.time() - start > 60:
+            link.write(frame("X", 0))
+            sys.exit("export timed out")
+    sys.stderr.write("%d records, %.2f s\n" % (len(export.rows), time.time() - start))
+    return export.rows
+
+
+def from_file(path):
+    export = Export()
+    with open(path, "rb") as f:
+        frames, _ = split(f.read())
+    for raw in frames:
+        export.handle(parse(raw))
+    if not export.done:
+        sys.exit("%s: incomplete export" % path)
+    return export.rows
+
+
+def main(argv):
+    args = argv[1:]
+    if len(args) == 2 and args[0] == "--file":
+        rows = from_file(args[1])
+    elif len(args) == 1:
+        rows = from_port(args[0])
+    else:
+        sys.exit("usage: %s PORT | --file capture.bin" % argv[0])
+
+    print("index,date,time,who")
+    for row in rows:
+        print(row)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
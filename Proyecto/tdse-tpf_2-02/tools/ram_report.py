@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+#
+# @file   : ram_report.py
+# @date   : Oct 19, 2026
+#
+# RAM budget per module from the linker map (.data + .bss input sections),
+# plus the heap and stack reservations and what is left of the 20K:
+#
+#   $ python3 tools/ram_report.py Debug/tdse-tpf_2-02.map
+#
+# With --refs it lists the archive members pulled in for an allocator symbol
+# and who asked for them, to chase a "_No_Heap: malloc is linked in" failure:
+#
+#   $ python3 tools/ram_report.py --refs Debug/tdse-tpf_2-02.map
+#
+
+import os
+import re
+import sys
+
+RAM_START = 0x20000000
+RAM_SIZE = 20 * 1024
+
+ALLOC_SYMBOLS = ("malloc", "_malloc_r", "calloc", "_calloc_r", "realloc", "_realloc_r", "_sbrk", "_sbrk_r")
+
+SECTION = re.compile(r"^ (\.data\S*|\.bss\S*|COMMON)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*))?$")
+CONT = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*)$")
+OUTPUT = re.compile(r"^(\._user_heap_stack)\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)")
+SYMBOL = re.compile(r"^\s+(0x[0-9a-f]+)\s+(_Min_Heap_Size|_Min_Stack_Size)\s*=")
+
+
+def module(path):
+    # "lib/libc_nano.a(lib_a-x.o)" -> "libc_nano.a", "./app/src/x.o" -> "x"
+    path = path.strip()
+    if "(" in path:
+        return os.path.basename(path.split("(")[0])
+    return os.path.splitext(os.path.basename(path))[0]
+
+
+def ram_usage(lines):
+    usage = {}
+    reserved = {}
+    pending = None
+    for line in lines:
+        line = line.rstrip("\n")
+        match = SYMBOL.match(line)
+        if match:
+            reserved[match.group(2)] = int(match.group(1), 16)
+            continue
+        if pending:
+            match = CONT.match(line)
+            pending_kind = pending
+            pending = None
+            if match:
+                add(usage, pending_kind, *match.groups())
+            continue
+        match = SECTION.match(line)
+        if match:
+            kind = "data" if match.group(1).startswith(".data") else "bss"
+            if match.group(2):
+                add(usage, kind, match.group(2), match.group(3), match.group(4))
+            else:
+                pending = kind
+    return usage, reserved
+
+
+def add(usage, kind, addr, size, path):
+    addr = int(addr, 16)
+    size = int(size, 16)
+    if size == 0 or not RAM_START <= addr < RAM_START + RAM_SIZE:
+        return
+    entry = usage.setdefault(module(path), {"data": 0, "bss": 0})
+    entry[kind] += size
+
+
+def refs(lines):
+    # "Archive member included to satisfy reference by file (symbol)" block
+    inside = False
+    member = None
+    for line in lines:
+        line = line.rstrip("\n")
+        if line.startswith("Archive member included"):
+            inside = True
+            continue
+        if not inside:
+            continue
+        if line.startswith(("Discarded input sections", "Allocating common symbols", "Memory Configuration")):
+            return
+        if line and not line[0].isspace():
+            member = line.strip()
+            continue
+        match = re.match(r"^\s+(\S.*) \((\S+)\)$", line)
+        if match and match.group(2) in ALLOC_SYMBOLS:
+            yield match.group(2), member, match.group(1)
+
+
+def main(argv):
+    args = argv[1:]
+    show_refs = "--refs" in args
+    args = [arg for arg in args if arg != "--refs"]
+    if len(args) != 1:
+        sys.exit("usage: %s [--refs] firmware.map" % argv[0])
+
+    with open(args[0], errors="replace") as f:
+        lines = f.readlines()
+
+    if show_refs:
+        found = False
+        for symbol, member, by in refs(lines):
+            print("%-12s %s\n%12s <- %s" % (symbol, os.path.basename(member), "", os.path.basename(by)))
+            found = True
+        if not found:
+            print("no allocator pulled in")
+        return
+
+    usage, reserved = ram_usage(lines)
+    heap = reserved.get("_Min_Heap_Size", 0)
+    stack = reserved.get("_Min_Stack_Size", 0)
+
+    print("%-24s %7s %7s %7s" % ("module", "data", "bss", "total"))
+    total = 0
+    for name, entry in sorted(usage.items(), key=lambda item: -(item[1]["data"] + item[1]["bss"])):
+        size = entry["data"] + entry["bss"]
+        total += size
+        print("%-24s %7d %7d %7d" % (name, entry["data"], entry["bss"], size))
+
+    print("%-24s %23d" % ("static total", total))
+    print("%-24s %23d" % ("heap (_Min_Heap_Size)", heap))
+    print("%-24s %23d" % ("stack (_Min_Stack_Size)", stack))
+    print("%-24s %23d" % ("free", RAM_SIZE - total - heap - stack))
+
+
+if __name__ == "__main__":
+    main(sys.argv)
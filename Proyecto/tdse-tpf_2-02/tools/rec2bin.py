@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+#
+# @file   : rec2bin.py
+# @date   : Oct 19, 2026
+#
+# Rebuilds the binary input stream of app/src/input_rec.c from the "rec <hex>"
+# lines flushed over the logger, ready to be restored for a replay run:
+#
+#   $ python3 tools/rec2bin.py console.log stream.bin
+#
+# With --dump it decodes a stream (or a console log) and prints one JSON object
+# per record, to inspect what a field unit actually saw:
+#
+#   $ python3 tools/rec2bin.py --dump stream.bin
+#
+
+import json
+import sys
+
+HEADER = b"INR"
+VERSION = 2
+
+# input_rec_ch_t: name and payload length
+CHANNELS = [("keypad", 1), ("adc", 2), ("rfid_card", 1), ("rfid_serial", 6),
+            ("rtc_date", 4), ("rtc_time", 3)] + [("port%d" % n, 2) for n in range(8)]
+
+
+def from_log(path):
+    data = bytearray()
+    with open(path, errors="replace") as f:
+        for line in f:
+            start = line.find("rec ")
+            if start < 0:
+                continue
+            try:
+                data += bytes.fromhex(line[start + 4:].strip())
+            except ValueError:
+                continue
+    return bytes(data)
+
+
+def load(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    return data if data[:3] == HEADER else from_log(path)
+
+
+def varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        if pos >= len(data):
+            raise EOFError
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def decode(data):
+    if data[:3] != HEADER or data[3] != VERSION:
+        sys.exit("not an input_rec stream (version %d expected)" % VERSION)
+
+    pos = 4
+    reads = 0
+    tick = 0
+    while pos < len(data):
+        try:
+            dreads, pos = varint(data, pos)
+            dticks, pos = varint(data, pos)
+        except EOFError:
+            return
+        ch = data[pos]
+        pos += 1
+        if ch >= len(CHANNELS):
+            sys.exit("bad channel %d at offset %d" % (ch, pos - 1))
+        name, size = CHANNELS[ch]
+        payload = data[pos:pos + size]
+        pos += size
+        if len(payload) < size:
+            return
+        reads += dreads
+        tick += dticks
+
+        if name == "keypad":
+            value = chr(payload[0]) if payload[0] else 0
+        elif name == "adc" or name.startswith("port"):
+            value = payload[0] | payload[1] << 8
+        elif name == "rfid_serial":
+            value = {"status": payload[0], "serial": payload[1:].hex().upper()}
+        else:
+            value = list(payload) if size > 1 else payload[0]
+        yield {"read": reads, "tick": tick, "ch": name, "value": value}
+
+
+def main(argv):
+    args = argv[1:]
+    if len(args) == 2 and args[0] == "--dump":
+        for record in decode(load(args[1])):
+            print(json.dumps(record))
+    elif len(args) == 2:
+        data = from_log(args[0])
+        if data[:3] != HEADER:
+            sys.exit("%s: no input_rec stream found" % args[0])
+        with open(args[1], "wb") as f:
+            f.write(data)
+        print("%d bytes" % len(data))
+    else:
+        sys.exit("usage: %s console.log stream.bin | --dump stream.bin" % argv[0])
+
+
+if __name__ == "__main__":
+    main(sys.argv)
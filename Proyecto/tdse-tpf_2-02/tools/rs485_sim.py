@@ -0,0 +1,783 @@
+#!/usr/bin/env python3
+#
+# @file   : rs485_sim.py
+# @date   : Oct 19, 2026
+#
+# Head-end side of the RS-485 link (app/src/rs485_link.c). By default it
+# simulates the bus: one pseudo-terminal per door plus one for the head-end,
+# a hub that plays the shared wire at the link baud rate, and each door
+# answering as the firmware does (a tick of turnaround, EEPROM read and
+# journal write times). It polls, syncs credential changes and uploads the
+# logs for 1 to 32 doors and prints the time and throughput of each:
+#
+#   $ python3 tools/rs485_sim.py
+#   $ python3 tools/rs485_sim.py --nodes 1,8,32 --changes 16
+#
+# The head-end keeps a versioned credential store: the version each card
+# and PIN id last changed at. A door reports the head version it has and
+# gets the ids changed since, in batches it applies all or nothing
+# (app/src/cred_store.c); changes made at a door are pulled and merged, the
+# head-end winning when both changed an id. Door changes lost to a reset
+# before they were pulled cost a full push. --check runs that merge against
+# a bus that drops and repeats bytes, doors that reset and console changes
+# at the doors, and fails unless every door ends up with the head-end store:
+#
+#   $ python3 tools/rs485_sim.py --check
+#   $ python3 tools/rs485_sim.py --check --nodes 6 --rounds 40 --seed 7
+#
+# With --port it runs the same head-end on a real RS-485 adapter against the
+# given node addresses (needs pyserial). The store is kept in a JSON file;
+# --card and --revoke change it before the sync:
+#
+#   $ python3 tools/rs485_sim.py --port /dev/ttyUSB0 1 2 3
+#   $ python3 tools/rs485_sim.py --port /dev/ttyUSB0 --store site.json --card 90245C21 1 2
+#
+
+import hashlib
+import json
+import os
+import pty
+import random
+import select
+import struct
+import sys
+import threading
+import time
+import tty
+import zlib
+
+BAUD = 230400
+HEAD = 0x00
+BROADCAST = 0xFF
+LOG_QTY = 5                 # MEM_ACCESS_QTY
+LOG_BATCH = 4               # RS485_LINK_CONFIG_LOG_BATCH
+BATCH = 8                   # CRED_STORE_CONFIG_BATCH
+LOCAL_KEPT = 8              # CRED_STORE_CONFIG_LOCAL
+JOURNAL_MAX = 4             # RS485_LINK_JOURNAL_MAX
+PINS = 128                  # PIN_DB_CONFIG_USERS
+CARDS = 64                  # CARD_DB_CONFIG_CARDS
+SEED_CARD = 0x90245C21      # CARD_DB_CONFIG_SEED, card 1 of a new table
+TICK = 0.001
+EEPROM_READ = 0.004         # One access record over the 100 kHz I2C bus
+EEPROM_WRITE = 0.006        # One journal page: write cycle and a tick
+REPLY_TIMEOUT = 0.02
+LOG_TIMEOUT = 0.06
+COMMIT_TIMEOUT = 0.2
+ROLES = {"admin": 0, "user": 1, "temp": 2}
+
+PIN_PUT, PIN_DEL, CARD_PUT, CARD_DEL = range(4)
+CHANGE = struct.Struct("<BBHHI8s")  # cred_store_pack()
+
+
+def cobs_encode(data):
+    out = bytearray([0])
+    code_at = 0
+    code = 1
+    for byte in data:
+        if byte:
+            out.append(byte)
+            code += 1
+        if not byte or code == 0xFF:
+            out[code_at] = code
+            code_at = len(out)
+            out.append(0)
+            code = 1
+    out[code_at] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        pos += 1
+        if code == 0 or pos + code - 1 > len(data):
+            return None
+        out += data[pos:pos + code - 1]
+        pos += code - 1
+        if code != 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def frame(dst, src, kind, seq, payload=b""):
+    body = struct.pack("<BBBB", dst, src, ord(kind), seq) + payload
+    return b"\x00" + cobs_encode(body + struct.pack("<I", zlib.crc32(body))) + b"\x00"
+
+
+def parse(raw):
+    data = cobs_decode(raw)
+    if data is None or len(data) < 8:
+        return None
+    body, crc = data[:-4], struct.unpack("<I", data[-4:])[0]
+    if zlib.crc32(body) != crc:
+        return None
+    dst, src, kind, seq = struct.unpack("<BBBB", body[:4])
+    return dst, src, chr(kind), seq, body[4:]
+
+
+class Splitter:
+    def __init__(self):
+        self.pending = b""
+
+    def feed(self, data):
+        frames = (self.pending + data).split(b"\x00")
+        self.pending = frames[-1]
+        return [parsed for parsed in map(parse, frames[:-1]) if parsed]
+
+
+# pin_hash.c: salt (little endian) and the PIN zero padded to 8 bytes
+def pin_input(salt, pin):
+    return struct.pack("<I", salt) + pin.encode("ascii").ljust(8, b"\x00")
+
+
+# CRC unit of the STM32F1: CRC-32/MPEG-2 over little endian words
+def stm32_crc(data):
+    crc = 0xFFFFFFFF
+    for pos in range(0, len(data), 4):
+        crc ^= struct.unpack("<I", data[pos:pos + 4])[0]
+        for _ in range(32):
+            crc = ((crc << 1) ^ 0x04C11DB7) if crc & 0x80000000 else (crc << 1)
+            crc &= 0xFFFFFFFF
+    return crc
+
+
+def pin_change(salt, user, role, uses, pin):
+    data = pin_input(salt, pin)
+    return CHANGE.pack(PIN_PUT, role, user, uses if role == ROLES["temp"] else 0, stm32_crc(data),
+                       hashlib.sha256(data).digest()[:8])
+
+
+def log_record(index, raw):
+    who = raw[24:32].encode("ascii") if raw else b"\x00" * 8
+    if not raw:
+        return struct.pack("<HB6B", index, 0, *([0] * 6)) + who
+    day, mth, year = int(raw[0:2]), int(raw[3:5]), int(raw[8:10])
+    hr, mn, sec = int(raw[13:15]), int(raw[16:18]), int(raw[19:21])
+    return struct.pack("<HB6B", index, 1, day, mth, year, hr, mn, sec) + who
+
+
+def later(version, than):
+    return 0 < ((version - than) & 0xFFFF) < 0x8000
+
+
+class Node(threading.Thread):
+    """One door: the frame handling of rs485_link.c and cred_store.c, with
+    their timing. reset() and console() play a power cut and the console."""
+
+    def __init__(self, fd, addr, stop):
+        super().__init__(daemon=True)
+        self.fd = fd
+        self.addr = addr
+        self.stop = stop
+        self.lock = threading.Lock()
+        self.head = 0
+        self.local = 0
+        self.kept = []                  # (version, change) made here, last LOCAL_KEPT
+        self.batch = None
+        self.salt = random.getrandbits(32)
+        self.pins = {}                  # id: (role, uses, tag, digest)
+        self.cards = {1: SEED_CARD}
+        self.log = ["%02d/10/2026 | 08:%02d:00 | PIN-%04d" % (19, n, n + 1) for n in range(LOG_QTY)]
+
+    def send(self, kind, seq, payload):
+        os.write(self.fd, frame(HEAD, self.addr, kind, seq, payload))
+
+    def apply(self, change):
+        op, role, ident, uses, key, digest = CHANGE.unpack(change)
+        if op == PIN_PUT:
+            self.pins[ident] = (role, uses, key, digest)
+        elif op == PIN_DEL:
+            self.pins.pop(ident, None)
+        elif op == CARD_PUT:
+            self.cards[ident] = key
+        else:
+            self.cards.pop(ident, None)
+
+    def committed(self):
+        """The batch goes in once its journal pages are written."""
+        batch = self.batch
+        if batch and batch["commit_at"] is not None and time.time() >= batch["commit_at"]:
+            for index in range(batch["count"]):
+                self.apply(batch["changes"][index])
+            self.head = batch["target"]
+            self.batch = None
+
+    def stage(self, base, target, index, count, change):
+        self.committed()
+        batch = self.batch
+        same = batch is not None and (batch["base"], batch["target"], batch["count"]) == (base, target, count)
+        if not 0 < count <= BATCH or index >= count or not later(target, base) or change[0] > CARD_DEL:
+            return
+        if target == self.head or (batch and batch["commit_at"] is not None):
+            return
+        if base != self.head:
+            return
+        if not same:
+            batch = self.batch = {"base": base, "target": target, "count": count, "changes": {}, "commit_at": None}
+        batch["changes"][index] = change
+        if len(batch["changes"]) == count:
+            batch["commit_at"] = time.time() + count * EEPROM_WRITE
+
+    def staged(self):
+        if self.batch is None:
+            return 0
+        return sum(1 << index for index in self.batch["changes"])
+
+    def since(self, since):
+        oldest = self.local - len(self.kept) + 1
+        first = since + 1
+        if not later(self.local + 1, since):
+            first = self.local + 1
+        elif later(oldest, first):
+            first = oldest
+        changes = [change for version, change in self.kept if not later(first, version)]
+        return first, changes[:JOURNAL_MAX]
+
+    def handle(self, dst, src, kind, seq, payload):
+        mine = dst == self.addr
+        if src != HEAD or not (mine or dst == BROADCAST):
+            return
+        time.sleep(TICK)
+        with self.lock:
+            self.committed()
+            if kind == "P" and mine:
+                self.send("S", seq, struct.pack("<HHBBHIHH", self.head, len(self.pins), 0, 1, 0, self.salt,
+                                                self.local, len(self.cards)))
+            elif kind == "C" and len(payload) == 6 + CHANGE.size:
+                base, target, index, count = struct.unpack("<HHBB", payload[:6])
+                self.stage(base, target, index, count, payload[6:])
+                if mine:
+                    self.send("K", seq, struct.pack("<HHB", self.head, self.local, self.staged()))
+            elif kind == "J" and mine and len(payload) == 2:
+                first, changes = self.since(struct.unpack("<H", payload)[0])
+                self.send("L", seq, struct.pack("<HHB", self.local, first & 0xFFFF, len(changes)) + b"".join(changes))
+            elif kind == "G" and mine:
+                index, count = struct.unpack("<HB", payload)
+                count = max(0, min(count, LOG_BATCH, LOG_QTY - index))
+                time.sleep(EEPROM_READ * count)
+                records = b"".join(log_record(index + n, self.log[index + n]) for n in range(count))
+                self.send("R", seq, struct.pack("<HB", index, count) + records)
+
+    def reset(self):
+        """Power cut: a batch not in the journal yet is lost, and so are the
+        changes kept for the head-end (the local version is in the flash)."""
+        with self.lock:
+            self.committed()
+            if self.batch and self.batch["commit_at"] is not None:
+                self.batch["commit_at"] = 0
+                self.committed()
+            self.batch = None
+            self.kept = []
+
+    def console(self, rand):
+        """users add / users del / cards add / cards del, as cred_store.c."""
+        with self.lock:
+            self.committed()
+            if self.batch and self.batch["commit_at"] is not None:
+                return
+            what = rand.randrange(4)
+            if what == PIN_PUT:
+                ident = next((n for n in range(1, PINS + 1) if n not in self.pins), None)
+                if ident is None:
+                    return
+                change = pin_change(self.salt, ident, ROLES["user"], 0, "%05d" % rand.randrange(100000))
+            elif what == CARD_PUT:
+                ident = next((n for n in range(1, CARDS + 1) if n not in self.cards), None)
+                if ident is None:
+                    return
+                change = CHANGE.pack(CARD_PUT, 0, ident, 0, rand.getrandbits(32) | 1, b"\x00" * 8)
+            else:
+                table = self.pins if what == PIN_DEL else self.cards
+                if not table:
+                    return
+                change = CHANGE.pack(what, 0, rand.choice(sorted(table)), 0, 0, b"\x00" * 8)
+            self.apply(change)
+            self.local = (self.local + 1) & 0xFFFF
+            self.kept = (self.kept + [(self.local, change)])[-LOCAL_KEPT:]
+
+    def run(self):
+        splitter = Splitter()
+        while not self.stop.is_set():
+            ready, _, _ = select.select([self.fd], [], [], 0.05)
+            if ready:
+                for parsed in splitter.feed(os.read(self.fd, 256)):
+                    self.handle(*parsed)
+
+
+class Hub(threading.Thread):
+    """The shared wire: what one port sends, every other port receives, one
+    byte time per byte (10 bits at BAUD). With faults, chunks are dropped or
+    sent twice."""
+
+    def __init__(self, masters, stop, rand=None, drop=0.0, repeat=0.0):
+        super().__init__(daemon=True)
+        self.masters = masters
+        self.stop = stop
+        self.rand = rand or random.Random()
+        self.drop = drop
+        self.repeat = repeat
+        self.bytes = 0
+
+    def run(self):
+        while not self.stop.is_set():
+            ready, _, _ = select.select(self.masters, [], [], 0.05)
+            for fd in ready:
+                data = os.read(fd, 512)
+                time.sleep(len(data) * 10.0 / BAUD)
+                self.bytes += len(data)
+                if self.rand.random() < self.drop:
+                    continue
+                copies = 2 if self.rand.random() < self.repeat else 1
+                for other in self.masters:
+                    if other != fd:
+                        os.write(other, data * copies)
+
+
+class PtyLink:
+    def __init__(self, fd):
+        self.fd = fd
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def read(self, timeout):
+        ready, _, _ = select.select([self.fd], [], [], max(timeout, 0))
+        return os.read(self.fd, 512) if ready else b""
+
+
+class SerialLink:
+    def __init__(self, port):
+        import serial
+        self.port = serial.Serial(port, BAUD, timeout=0)
+
+    def write(self, data):
+        self.port.write(data)
+
+    def read(self, timeout):
+        self.port.timeout = max(timeout, 0)
+        return self.port.read(512)
+
+
+class Store:
+    """Head-end credential store. Each card and PIN id keeps its value and
+    the version it last changed at: a door at head version N needs the ids
+    changed after N, whatever the number of changes to each, so a sync costs
+    what changed and not the size of the store. A removed id stays as None
+    for the doors that still have it. A PIN added at a door is only valid
+    there (its digest uses that door's salt): the others get it removed."""
+
+    def __init__(self):
+        self.version = 0
+        self.cards = {1: SEED_CARD}
+        self.pins = {}          # id: {"role", "uses", "pin"} or {"role", "uses", "door", "tag", "digest"}
+        self.changed = {}       # ("card" | "pin", id): version
+        self.pulled = {}        # door: last local version merged
+
+    def bump(self, key):
+        self.version = (self.version + 1) & 0xFFFF
+        self.changed[key] = self.version
+
+    def put_card(self, ident, uid):
+        self.cards[ident] = uid
+        self.bump(("card", ident))
+
+    def put_pin(self, ident, role, uses, pin):
+        self.pins[ident] = {"role": role, "uses": uses, "pin": pin}
+        self.bump(("pin", ident))
+
+    def put_door_pin(self, ident, door, change):
+        _, role, _, uses, tag, digest = CHANGE.unpack(change)
+        self.pins[ident] = {"role": role, "uses": uses, "door": door, "tag": tag, "digest": digest.hex()}
+        self.bump(("pin", ident))
+
+    def remove(self, kind, ident):
+        (self.cards if kind == "card" else self.pins)[ident] = None
+        self.bump((kind, ident))
+
+    def resync(self):
+        """Every id changes version: all doors get the whole store again. For
+        door changes lost before they were pulled, which only a full push
+        undoes."""
+        for kind, top, table in (("card", CARDS, self.cards), ("pin", PINS, self.pins)):
+            for ident in range(1, top + 1):
+                table.setdefault(ident, None)
+                self.bump((kind, ident))
+
+    def free(self, kind):
+        """Ids from the top: doors take theirs from the bottom."""
+        table, top = (self.cards, CARDS) if kind == "card" else (self.pins, PINS)
+        return next((n for n in range(top, 0, -1) if table.get(n) is None), None)
+
+    def change(self, key, door, salt):
+        kind, ident = key
+        if kind == "card":
+            uid = self.cards.get(ident)
+            if uid is None:
+                return CHANGE.pack(CARD_DEL, 0, ident, 0, 0, b"\x00" * 8)
+            return CHANGE.pack(CARD_PUT, 0, ident, 0, uid, b"\x00" * 8)
+        entry = self.pins.get(ident)
+        if entry is None or entry.get("door", door) != door:
+            return CHANGE.pack(PIN_DEL, 0, ident, 0, 0, b"\x00" * 8)
+        if "door" in entry:
+            return CHANGE.pack(PIN_PUT, entry["role"], ident, entry["uses"], entry["tag"], bytes.fromhex(entry["digest"]))
+        return pin_change(salt, ident, entry["role"], entry["uses"], entry["pin"])
+
+    def delta(self, since, door, salt):
+        """Batches (base, target, changes) that take a door from since to
+        the current version, at most BATCH ids each."""
+        keys = sorted((((version - since) & 0xFFFF), key) for key, version in self.changed.items()
+                      if later(version, since))
+        batches = []
+        base = since
+        for start in range(0, len(keys), BATCH):
+            chunk = keys[start:start + BATCH]
+            target = (since + chunk[-1][0]) & 0xFFFF
+            batches.append((base, target, [self.change(key, door, salt) for _, key in chunk]))
+            base = target
+        return batches
+
+    def expected(self, door, salt):
+        """(cards, pins) a door must end up with, as Node keeps them."""
+        cards = {ident: uid for ident, uid in self.cards.items() if uid is not None}
+        pins = {}
+        for ident in self.pins:
+            change = self.change(("pin", ident), door, salt)
+            op, role, _, uses, tag, digest = CHANGE.unpack(change)
+            if op == PIN_PUT:
+                pins[ident] = (role, uses, tag, digest)
+        return cards, pins
+
+    def save(self, path):
+        with open(path, "w") as out:
+            json.dump({"version": self.version, "cards": self.cards, "pins": self.pins,
+                       "changed": [[kind, ident, version] for (kind, ident), version in self.changed.items()],
+                       "pulled": self.pulled},
+                      out, indent=1)
+
+    def load(self, path):
+        with open(path) as src:
+            data = json.load(src)
+        self.version = data["version"]
+        self.cards = {int(ident): uid for ident, uid in data["cards"].items()}
+        self.pins = {int(ident): entry for ident, entry in data["pins"].items()}
+        self.changed = {(kind, ident): version for kind, ident, version in data["changed"]}
+        self.pulled = {int(addr): local for addr, local in data["pulled"].items()}
+
+
+class Head:
+    def __init__(self, link, store):
+        self.link = link
+        self.store = store
+        self.splitter = Splitter()
+        self.seq = 0
+        self.timeouts = 0
+        self.frames = 0
+        self.adopted = 0
+        self.conflicts = 0
+        self.lost = 0           # Door changes gone before they were pulled
+
+    def request(self, addr, kind, payload=b"", answer=None, timeout=REPLY_TIMEOUT):
+        self.seq = (self.seq + 1) & 0xFF
+        self.frames += 1
+        self.link.write(frame(addr, HEAD, kind, self.seq, payload))
+        if addr == BROADCAST:
+            return None
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            for dst, src, got, seq, body in self.splitter.feed(self.link.read(deadline - time.time())):
+                if dst == HEAD and src == addr and got == answer and seq == self.seq:
+                    return body
+        self.timeouts += 1
+        return None
+
+    def poll(self, addr):
+        body = self.request(addr, "P", answer="S")
+        if body is None or len(body) < 16:
+            return None
+        head, users, log_next, state, lock_s, salt, local, cards = struct.unpack("<HHBBHIHH", body[:16])
+        return {"head": head, "users": users, "salt": salt, "local": local, "cards": cards}
+
+    def merge(self, addr, node_head, change):
+        """A change made at door addr, which had head version node_head. If
+        the head-end changed that id after node_head, both changed it without
+        seeing the other: the head-end wins and the door gets its value."""
+        op, _, ident, _, key, _ = CHANGE.unpack(change)
+        kind = "card" if op in (CARD_PUT, CARD_DEL) else "pin"
+        if later(self.store.changed.get((kind, ident), node_head), node_head):
+            self.conflicts += 1
+            return
+        if op == CARD_PUT:
+            self.store.put_card(ident, key)
+        elif op == PIN_PUT:
+            self.store.put_door_pin(ident, addr, change)
+        else:
+            self.store.remove(kind, ident)
+        self.adopted += 1
+
+    def pull(self, addr, status):
+        seen = self.store.pulled.get(addr, status["local"])
+        while later(status["local"], seen):
+            body = self.request(addr, "J", struct.pack("<H", seen), answer="L")
+            if body is None:
+                return False
+            local, first, count = struct.unpack("<HHB", body[:5])
+            if later(first, (seen + 1) & 0xFFFF):
+                self.lost += (first - seen - 1) & 0xFFFF
+                self.store.resync()
+            for index in range(count):
+                self.merge(addr, status["head"], body[5 + index * CHANGE.size:5 + (index + 1) * CHANGE.size])
+            seen = (first + count - 1) & 0xFFFF if count else local
+        self.store.pulled[addr] = seen
+        return True
+
+    def push(self, addr, base, target, changes):
+        """One batch: every change until the door has them all, then its head
+        version is read back until the batch is in."""
+        missing = set(range(len(changes)))
+        for _ in range(4):
+            for index in sorted(missing):
+                body = self.request(addr, "C", struct.pack("<HHBB", base, target, index, len(changes)) + changes[index],
+                                    answer="K")
+                if body is None:
+                    continue
+                head, local, staged = struct.unpack("<HHB", body)
+                if head == target:
+                    return True
+                if head != base:
+                    return False
+                missing = {n for n in missing if not staged & (1 << n)}
+            if not missing:
+                break
+        deadline = time.time() + COMMIT_TIMEOUT
+        while time.time() < deadline:
+            status = self.poll(addr)
+            if status and status["head"] == target:
+                return True
+            time.sleep(TICK * 5)
+        return False
+
+    def sync(self, addr):
+        """Poll, merge what changed at the door, send what changed here."""
+        status = self.poll(addr)
+        if status is None or not self.pull(addr, status):
+            return None
+        sent = 0
+        for base, target, changes in self.store.delta(status["head"], addr, status["salt"]):
+            if not self.push(addr, base, target, changes):
+                return None
+            sent += len(changes)
+        return sent
+
+    def log(self, addr):
+        records = []
+        index = 0
+        while index < LOG_QTY:
+            body = self.request(addr, "G", struct.pack("<HB", index, LOG_BATCH), answer="R", timeout=LOG_TIMEOUT)
+            if body is None:
+                return records
+            count = body[2]
+            records += [body[3 + n * 17:3 + (n + 1) * 17] for n in range(count)]
+            index += max(count, 1)
+        return records
+
+
+class Bus:
+    """Doors on pseudo-terminals around a hub, and a head-end."""
+
+    def __init__(self, size, store, rand=None, drop=0.0, repeat=0.0):
+        self.stop = threading.Event()
+        self.nodes = []
+        masters = []
+        for addr in range(1, size + 1):
+            master, slave = pty.openpty()
+            tty.setraw(master)
+            tty.setraw(slave)
+            masters.append(master)
+            self.nodes.append(Node(slave, addr, self.stop))
+        head_master, head_slave = pty.openpty()
+        tty.setraw(head_master)
+        tty.setraw(head_slave)
+        self.fds = masters + [head_master, head_slave] + [node.fd for node in self.nodes]
+        self.hub = Hub(masters + [head_master], self.stop, rand, drop, repeat)
+        self.head = Head(PtyLink(head_slave), store)
+        for thread in self.nodes + [self.hub]:
+            thread.start()
+
+    def close(self):
+        self.stop.set()
+        for thread in self.nodes + [self.hub]:
+            thread.join()
+        for fd in self.fds:
+            os.close(fd)
+
+
+def preload(store, nodes, cards, pins):
+    """A site already in sync: store and doors at the same version."""
+    for ident in range(2, cards + 1):
+        store.put_card(ident, 0x10000000 + ident)
+    for ident in range(1, pins + 1):
+        store.put_pin(ident, ROLES["user"], 0, "%05d" % (10000 + ident))
+    for node in nodes:
+        for base, target, changes in store.delta(0, node.addr, node.salt):
+            for change in changes:
+                node.apply(change)
+        node.head = store.version
+
+
+def changes(store, rand, count):
+    """count changes: new cards and PINs, removals, replaced PINs."""
+    for _ in range(count):
+        what = rand.randrange(4)
+        if what == 0 and store.free("card"):
+            store.put_card(store.free("card"), rand.getrandbits(32) | 1)
+        elif what == 1 and store.free("pin"):
+            store.put_pin(store.free("pin"), ROLES["user"], 0, "%05d" % rand.randrange(100000))
+        elif what == 2:
+            store.put_pin(rand.randrange(1, PINS + 1), ROLES["temp"], 3, "%05d" % rand.randrange(100000))
+        else:
+            ident = rand.choice([n for n, uid in store.cards.items() if uid is not None] or [1])
+            store.remove("card", ident)
+
+
+def simulate(sizes, count):
+    print("store: 48 cards, 100 PINs; a full push is 148 changes per door")
+    print("nodes  poll round  polls/s  sync (%d chg)  frames  log upload  records/s  bus kB" % count)
+    rand = random.Random(1)
+    for size in sizes:
+        store = Store()
+        bus = Bus(size, store)
+        head = bus.head
+        addrs = [node.addr for node in bus.nodes]
+        preload(store, bus.nodes, 48, 100)
+
+        start = time.time()
+        polled = sum(1 for addr in addrs if head.poll(addr))
+        poll_s = time.time() - start
+
+        changes(store, rand, count)
+        frames = head.frames
+        start = time.time()
+        synced = sum(1 for addr in addrs if head.sync(addr) is not None)
+        sync_s = time.time() - start
+        frames = head.frames - frames
+        matching = sum(1 for node in bus.nodes if (node.cards, node.pins) == store.expected(node.addr, node.salt))
+
+        start = time.time()
+        records = sum(len(head.log(addr)) for addr in addrs)
+        log_s = time.time() - start
+
+        print("%5d  %7.1f ms  %7.0f  %9.1f ms  %6d  %7.1f ms  %9.0f  %6.1f%s" % (
+            size, poll_s * 1000, polled / poll_s, sync_s * 1000, frames, log_s * 1000,
+            records / log_s, bus.hub.bytes / 1024.0,
+            "" if synced == matching == polled == size else "  (%d synced, %d timeouts)" % (matching, head.timeouts)))
+        bus.close()
+
+
+def check(size, rounds, seed):
+    """Random head-end changes, console changes and resets at the doors, on
+    a bus losing and repeating bytes; then a clean bus until every door
+    matches the store."""
+    rand = random.Random(seed)
+    random.seed(seed)
+    store = Store()
+    bus = Bus(size, store, rand, drop=0.05, repeat=0.05)
+    head = bus.head
+    for node in bus.nodes:
+        store.pulled[node.addr] = 0
+
+    for _ in range(rounds):
+        changes(store, rand, rand.randrange(0, 12))
+        for node in bus.nodes:
+            if rand.random() < 0.3:
+                node.console(rand)
+            if rand.random() < 0.1:
+                node.reset()
+        for node in bus.nodes:
+            head.sync(node.addr)
+
+    bus.hub.drop = bus.hub.repeat = 0.0
+    for _ in range(4):
+        for node in bus.nodes:
+            head.sync(node.addr)
+
+    bad = [node.addr for node in bus.nodes if (node.cards, node.pins) != store.expected(node.addr, node.salt)]
+    print("check: %d doors, %d rounds, store version %d: %d door changes merged, %d lost to the head-end, "
+          "%d lost to a reset, %d timeouts -> %s" % (
+              size, rounds, store.version, head.adopted, head.conflicts, head.lost, head.timeouts,
+              "doors %s differ" % bad if bad else "all doors match"))
+    bus.close()
+    return not bad
+
+
+def main(argv):
+    args = argv[1:]
+    sizes = [1, 2, 4, 8, 16, 32]
+    count = 8
+    rounds = 20
+    seed = 1
+    port = None
+    store_path = None
+    cards = []
+    revoke = []
+    addrs = []
+    run_check = False
+    while args:
+        arg = args.pop(0)
+        if arg == "--nodes":
+            sizes = [int(n) for n in args.pop(0).split(",")]
+        elif arg == "--changes":
+            count = int(args.pop(0))
+        elif arg == "--check":
+            run_check = True
+        elif arg == "--rounds":
+            rounds = int(args.pop(0))
+        elif arg == "--seed":
+            seed = int(args.pop(0))
+        elif arg == "--port":
+            port = args.pop(0)
+        elif arg == "--store":
+            store_path = args.pop(0)
+        elif arg == "--card":
+            cards.append(int(args.pop(0), 16))
+        elif arg == "--revoke":
+            revoke.append(int(args.pop(0)))
+        else:
+            addrs.append(int(arg))
+
+    if run_check:
+        sys.exit(0 if check(sizes[-1] if len(sizes) == 1 else 4, rounds, seed) else 1)
+
+    if port is None:
+        simulate(sizes, count)
+        return
+
+    if not addrs:
+        sys.exit("usage: %s --port PORT [--store FILE] [--card UID] [--revoke ID] ADDR..." % argv[0])
+    store = Store()
+    if store_path and os.path.exists(store_path):
+        store.load(store_path)
+    for uid in cards:
+        store.put_card(store.free("card"), uid)
+    for ident in revoke:
+        store.remove("card", ident)
+    head = Head(SerialLink(port), store)
+    for addr in addrs:
+        status = head.poll(addr)
+        print("node %d: %s" % (addr, status if status else "no answer"))
+        if not status:
+            continue
+        sent = head.sync(addr)
+        print("  %s, %d door changes merged" % ("sync failed" if sent is None else "%d changes sent" % sent, head.adopted))
+        for record in head.log(addr):
+            index, valid, day, mth, year, hr, mn, sec = struct.unpack("<HB6B", record[:9])
+            if valid:
+                print("  %d 20%02d-%02d-%02d %02d:%02d:%02d %s" % (index, year, mth, day, hr, mn, sec,
+                                                               record[9:17].decode("ascii", "replace")))
+    if store_path:
+        store.save(store_path)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+#
+# @file   : trace2json.py
+# @date   : Oct 19, 2026
+#
+# Converts a binary dump of `trace_log` (app/inc/trace.h) into the Chrome
+# trace-event JSON format (open it with chrome://tracing or ui.perfetto.dev).
+#
+#   (gdb) dump binary value trace.bin trace_log
+#   $ python3 tools/trace2json.py trace.bin > trace.json
+#
+# With --latency it prints instead the end-to-end latency percentiles of the
+# probes in app/inc/latency.h as JSON, for regression tracking between builds.
+#   $ python3 tools/trace2json.py --latency trace.bin > latency.json
+#
+
+import json
+import struct
+import sys
+
+TRACE_MAGIC = 0x45435254
+HEADER = struct.Struct("<IIIII")
+RECORD = struct.Struct("<IBBH")
+
+(EV_TASK_ENTER, EV_TASK_EXIT, EV_SYS_PUT, EV_SYS_GET, EV_ACT_PUT, EV_ACT_GET,
+ EV_STATE, EV_I2C_START, EV_I2C_END, EV_ISR, EV_LAT_START, EV_LAT_STOP) = range(12)
+
+TASKS = ["task_sensor", "task_system", "task_actuator"]
+SYS_EVENTS = ["EV_SYS_XX_BTN_IDLE", "EV_SYS_XX_BTN_ACTIVE", "EV_SYS_XX_LOCK_OPENED", "EV_SYS_XX_LOCK_CLOSED",
+              "EV_SYS_XX_DOOR_TIMEOUT", "EV_SYS_XX_DOOR_OPENED", "EV_SYS_XX_DOOR_CLOSED",
+              "EV_SYS_XX_LOCKOUT_END"]
+SYS_STATES = ["ST_SYS_INIT", "ST_SYS_REQ_PWD", "ST_SYS_AWAIT_PWD", "ST_SYS_OFF_MODE",
+              "ST_SYS_OPT_PWD", "ST_SYS_OPT_MENU", "ST_SYS_OPEN_DOOR", "ST_SYS_WAIT",
+              "ST_SYS_LOCKED"]
+ACTUATORS = ["ID_LED_1", "ID_LED_2", "ID_LED_3", "ID_BUZ"]
+ACT_EVENTS = ["EV_ACT_XX_OFF", "EV_ACT_XX_ON", "EV_ACT_XX_NOT_BLINK", "EV_ACT_XX_BLINK",
+              "EV_ACT_XX_FAST_BLINK", "EV_ACT_XX_PULSE", "EV_ACT_XX_CHIRP", "EV_ACT_XX_SIREN",
+              "EV_ACT_XX_LOW_BAT", "EV_ACT_XX_HELD_OPEN"]
+ISRS = ["SysTick"]
+PROBES = ["key_to_lcd", "pwd_to_unlock", "card_to_unlock"]
+LATENCY_TIMEOUT_US = 2000000    # LATENCY_CONFIG_TIMEOUT_US
+
+PID = 1
+TID_SCHED = 1
+TID_QUEUES = 2
+TID_STATE = 3
+TID_ISR = 4
+TID_I2C = 10    # + bus number
+
+
+def name(table, index):
+    return table[index] if index < len(table) else str(index)
+
+
+def read_records(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    magic, version, core_clock, capacity, head = HEADER.unpack_from(data, 0)
+    if magic != TRACE_MAGIC:
+        sys.exit("%s: not a trace_log dump (bad magic 0x%08X)" % (path, magic))
+
+    first = max(0, head - capacity)
+    records = []
+    for n in range(first, head):
+        offset = HEADER.size + (n % capacity) * RECORD.size
+        records.append(RECORD.unpack_from(data, offset))
+
+    return core_clock, records
+
+
+def unwrap(records):
+    # CYCCNT wraps every 2^32 cycles (~67 s at 64 MHz); SysTick records keep
+    # consecutive timestamps far closer than that, so any step back is a wrap.
+    base = 0
+    last = None
+    for cycles, rtype, rid, arg in records:
+        if last is not None and cycles < last:
+            base += 1 << 32
+        last = cycles
+        yield base + cycles, rtype, rid, arg
+
+
+def convert(core_clock, records):
+    cycles_per_us = core_clock / 1e6
+    events = [
+        {"ph": "M", "pid": PID, "name": "process_name", "args": {"name": "tdse-tpf_2-02"}},
+        {"ph": "M", "pid": PID, "tid": TID_SCHED, "name": "thread_name", "args": {"name": "app_update"}},
+        {"ph": "M", "pid": PID, "tid": TID_QUEUES, "name": "thread_name", "args": {"name": "queues"}},
+        {"ph": "M", "pid": PID, "tid": TID_STATE, "name": "thread_name", "args": {"name": "task_system state"}},
+        {"ph": "M", "pid": PID, "tid": TID_ISR, "name": "thread_name", "args": {"name": "ISR"}},
+        {"ph": "M", "pid": PID, "tid": TID_I2C + 1, "name": "thread_name", "args": {"name": "I2C1"}},
+        {"ph": "M", "pid": PID, "tid": TID_I2C + 2, "name": "thread_name", "args": {"name": "I2C2"}},
+    ]
+
+    t0 = None
+    for cycles, rtype, rid, arg in unwrap(records):
+        if t0 is None:
+            t0 = cycles
+        ts = (cycles - t0) / cycles_per_us
+        ev = {"pid": PID, "ts": ts}
+
+        if rtype in (EV_TASK_ENTER, EV_TASK_EXIT):
+            ev.update(ph="B" if rtype == EV_TASK_ENTER else "E", tid=TID_SCHED, name=name(TASKS, rid))
+        elif rtype in (EV_SYS_PUT, EV_SYS_GET):
+            ev.update(ph="i", s="t", tid=TID_QUEUES,
+                      name=("put " if rtype == EV_SYS_PUT else "get ") + name(SYS_EVENTS, arg))
+        elif rtype in (EV_ACT_PUT, EV_ACT_GET):
+            ev.update(ph="i", s="t", tid=TID_QUEUES,
+                      name=("put " if rtype == EV_ACT_PUT else "get ") + name(ACT_EVENTS, arg),
+                      args={"actuator": name(ACTUATORS, rid)})
+        elif rtype == EV_STATE:
+            ev.update(ph="i", s="t", tid=TID_STATE, name=name(SYS_STATES, arg),
+                      args={"from": name(SYS_STATES, rid)})
+            events.append({"pid": PID, "ts": ts, "ph": "C", "name": "task_system_dta.state",
+                           "args": {"state": arg}})
+        elif rtype == EV_I2C_START:
+            ev.update(ph="B", tid=TID_I2C + rid, name="0x%02X" % (arg >> 8),
+                      args={"len": arg & 0xFF})
+        elif rtype == EV_I2C_END:
+            ev.update(ph="E", tid=TID_I2C + rid, args={"status": arg})
+        elif rtype == EV_ISR:
+            ev.update(ph="i", s="t", tid=TID_ISR, name=name(ISRS, rid))
+        elif rtype in (EV_LAT_START, EV_LAT_STOP):
+            # Async spans: a restarted probe simply opens a new span.
+            ev.update(ph="b" if rtype == EV_LAT_START else "e", cat="latency",
+                      id=rid, name=name(PROBES, rid))
+        else:
+            continue
+
+        events.append(ev)
+
+    return {"traceEvents": events, "displayTimeUnit": "ns"}
+
+
+def percentile(sorted_values, percent):
+    rank = max(1, -(-len(sorted_values) * percent // 100))
+    return sorted_values[rank - 1]
+
+
+def latency(core_clock, records):
+    # Mirrors latency_start()/latency_stop(): a start restarts the span, a stop
+    # without an open span is ignored and over-long spans are dropped.
+    cycles_per_us = core_clock / 1e6
+    opened = {}
+    spans = {}
+    dropped = {}
+    for cycles, rtype, rid, arg in unwrap(records):
+        if rtype == EV_LAT_START:
+            opened[rid] = cycles
+        elif rtype == EV_LAT_STOP and rid in opened:
+            us = int((cycles - opened.pop(rid)) / cycles_per_us)
+            if us > LATENCY_TIMEOUT_US:
+                dropped[rid] = dropped.get(rid, 0) + 1
+            else:
+                spans.setdefault(rid, []).append(us)
+
+    summary = {}
+    for rid in sorted(set(spans) | set(dropped)):
+        values = sorted(spans.get(rid, []))
+        entry = {"count": len(values), "dropped": dropped.get(rid, 0)}
+        if values:
+            entry.update(min=values[0], max=values[-1], p50=percentile(values, 50),
+                         p90=percentile(values, 90), p99=percentile(values, 99))
+        summary[name(PROBES, rid)] = entry
+
+    return summary
+
+
+def main(argv):
+    args = argv[1:]
+    summary = "--latency" in args
+    if summary:
+        args.remove("--latency")
+    if len(args) != 1:
+        sys.exit("usage: %s [--latency] trace.bin > out.json" % argv[0])
+
+    core_clock, records = read_records(args[0])
+    if summary:
+        json.dump(latency(core_clock, records), sys.stdout, indent=1, sort_keys=True)
+    else:
+        json.dump(convert(core_clock, records), sys.stdout, indent=1)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main(sys.argv)